@@ -83,6 +83,48 @@ protected:
 
 extern NonBlockingExecutor& thread_pool_executor;
 
+/**
+ * A fixed-size pool of worker threads, one per core, sharing work by stealing.
+ *
+ * Each worker keeps its own deques of work. Work spawned from a worker goes on that worker's deques and
+ * is taken newest-first, while idle workers steal oldest-first from the others. Work spawned from any
+ * other thread is shared round-robin among the workers.
+ *
+ * Unlike the thread_pool_executor, there are only so many workers, so work spawned here must not block
+ * waiting for other work. Work that may block indefinitely belongs on the thread_pool_executor.
+ */
+class WorkStealingExecutor : public NonBlockingExecutor
+{
+public:
+    /**
+     * Set a handler to be called should an unhandled exception escape work on either priority class
+     *
+     * By default unhandled exceptions are allowed to propagate, resulting in process termination.
+     */
+    static void set_unhandled_exception_handler(void (*handler)());
+
+    /**
+     * Wait for all current work to finish and terminate all worker threads
+     *
+     * The workers are started again by the next call to spawn().
+     */
+    static void quiesce();
+protected:
+    WorkStealingExecutor() = default;
+};
+
+/**
+ * Work on the work-stealing pool that someone is waiting on this frame (such as input or compositing).
+ *
+ * Every worker takes latency-critical work, its own or stolen, before any background work.
+ */
+extern NonBlockingExecutor& latency_critical_executor;
+
+/**
+ * Work on the work-stealing pool that nobody is waiting on this frame (such as screenshots)
+ */
+extern NonBlockingExecutor& background_executor;
+
 /**
  * An Executor that makes the following concurrency guarantees:
  *
@@ -0,0 +1,69 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_LOGGING_ASYNC_LOGGER_H_
+#define MIR_LOGGING_ASYNC_LOGGER_H_
+
+#include "mir/logging/logger.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace mir
+{
+namespace logging
+{
+/**
+ * A Logger that passes messages on to another Logger from a background thread.
+ *
+ * Logging costs the calling thread a copy of the message into a buffer of its own;
+ * the sink's formatting and I/O happen later, on the AsyncLogger's thread. A thread
+ * that logs faster than the sink can keep up has messages dropped (and counted)
+ * rather than being blocked.
+ *
+ * Each thread's messages reach the sink in the order they were logged, but those of
+ * different threads may be interleaved differently. Messages keep the time they were
+ * logged at (see format_message()).
+ *
+ * Critical messages are not deferred: they are written before log() returns, after
+ * everything logged before them, in case the process is about to die.
+ */
+class AsyncLogger : public Logger
+{
+public:
+    /// \param buffer_size  Bytes of messages each thread can have queued before dropping any
+    explicit AsyncLogger(std::shared_ptr<Logger> const& sink, std::size_t buffer_size = 64 * 1024);
+    ~AsyncLogger();
+
+    /// Wait until everything logged so far has been passed to the sink
+    void flush();
+
+    /// The number of messages dropped because the logging thread's buffer was full
+    auto dropped_messages() const -> uint64_t;
+
+    void log(Severity severity, std::string const& message, std::string const& component) override;
+    void log(char const* component, Severity severity, char const* format, ...) override
+        __attribute__ ((format (printf, 4, 5)));
+
+private:
+    class State;
+    std::unique_ptr<State> const state;
+};
+}
+}
+
+#endif // MIR_LOGGING_ASYNC_LOGGER_H_
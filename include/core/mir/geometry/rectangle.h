@@ -123,6 +123,38 @@ Rectangle<T> intersection_of(Rectangle<T> const& a, Rectangle<T> const& b)
         return {};
 }
 
+/**
+ * Write the rectangles (at most four, not overlapping) that together make up
+ * the part of a outside b to out, and return the iterator past the last.
+ */
+template<typename T, typename OutputIt>
+OutputIt difference_of(Rectangle<T> const& a, Rectangle<T> const& b, OutputIt out)
+{
+    if (a.size.width == decltype(a.size.width){} || a.size.height == decltype(a.size.height){})
+        return out;
+
+    auto const overlap = intersection_of(a, b);
+    if (overlap.size.width == decltype(overlap.size.width){})
+    {
+        *out++ = a;
+        return out;
+    }
+
+    // Full-width bands above and below the overlap...
+    if (a.top() < overlap.top())
+        *out++ = Rectangle<T>{a.top_left, {a.size.width, (overlap.top() - a.top()).as_value()}};
+    if (overlap.bottom() < a.bottom())
+        *out++ = Rectangle<T>{{a.left(), overlap.bottom()}, {a.size.width, (a.bottom() - overlap.bottom()).as_value()}};
+
+    // ...and the pieces either side of it
+    if (a.left() < overlap.left())
+        *out++ = Rectangle<T>{{a.left(), overlap.top()}, {(overlap.left() - a.left()).as_value(), overlap.size.height}};
+    if (overlap.right() < a.right())
+        *out++ = Rectangle<T>{{overlap.right(), overlap.top()}, {(a.right() - overlap.right()).as_value(), overlap.size.height}};
+
+    return out;
+}
+
 template<typename T>
 inline constexpr bool operator == (Rectangle<T> const& lhs, Rectangle<T> const& rhs)
 {
@@ -22,6 +22,7 @@
 #include <memory>
 #include <functional>
 #include <chrono>
+#include <optional>
 
 namespace mir
 {
@@ -75,6 +76,23 @@ public:
      */
     virtual std::chrono::milliseconds recommended_sleep() const = 0;
 
+    /**
+     * The most recent frame shown by this group, as timestamped by the hardware.
+     *
+     * The compositor uses successive frames to predict the next vblank, and to
+     * schedule compositing just ahead of it. Platforms that don't know when their
+     * frames are shown return std::nullopt, and recommended_sleep() is used instead.
+     */
+    virtual auto last_frame() const -> std::optional<Frame> { return std::nullopt; }
+
+    /**
+     * Whether last_frame() shows the latest post().
+     *
+     * Platforms that wait for a flip only when next posting (so the wait overlaps rendering)
+     * return false until then, as last_frame() is of the post before.
+     */
+    virtual auto last_frame_is_latest_post() const -> bool { return true; }
+
     virtual ~DisplaySyncGroup() = default;
 protected:
     DisplaySyncGroup() = default;
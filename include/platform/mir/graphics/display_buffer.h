@@ -23,6 +23,7 @@
 #include <glm/glm.hpp>
 
 #include <memory>
+#include <optional>
 
 namespace mir
 {
@@ -66,6 +67,29 @@ public:
     **/
     virtual bool overlay(RenderableList const& renderlist) = 0;
 
+    /** Scan out as much of renderlist as the hardware can directly, leaving
+     *  the rest to be rendered.
+     *
+     *  This generalises overlay() for hardware with several planes, where
+     *  some renderables can be displayed directly while the others still
+     *  need rendering. Anything scanned out appears, along with the rendered
+     *  content, on the next post().
+     *  \param [in] renderlist
+     *      The renderables that should appear on the screen.
+     *  eturns
+     *      The renderables the caller should render using a graphics library
+     *      such as OpenGL (which may be none of them, or all of them); or
+     *      std::nullopt if the hardware displays the whole list and nothing
+     *      should be rendered at all.
+    **/
+    virtual auto assign_planes(RenderableList const& renderlist) -> std::optional<RenderableList>
+    {
+        if (overlay(renderlist))
+            return std::nullopt;
+
+        return renderlist;
+    }
+
     /**
      * Returns a transformation that the renderer must apply to all rendering.
      * There is usually no transformation required (just the identity matrix)
@@ -38,6 +38,11 @@ struct Frame
 
     int64_t msc = 0;   /**< Media Stream Counter */
     Timestamp ust;     /**< Unadjusted System Time */
+
+    bool vsync = false;         /**< The flip was synchronised to the vertical retrace */
+    bool hw_clock = false;      /**< The ust was measured by the display hardware */
+    bool hw_completion = false; /**< The hardware signalled the flip completed */
+    bool zero_copy = false;     /**< A client buffer was scanned out without being copied */
 };
 
 }} // namespace mir::graphics
@@ -19,6 +19,8 @@
 
 #include <optional>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/graphics/buffer_id.h>
 #include <glm/glm.hpp>
 #include <memory>
 #include <vector>
@@ -47,6 +49,18 @@ public:
      */
     virtual std::shared_ptr<Buffer> buffer() const = 0;
 
+    /**
+     * Return the region of buffer() that differs from an earlier buffer of
+     * this renderable, in buffer coordinates.
+     *
+     * \returns std::nullopt if the difference is not known, in which case
+     *          the whole buffer should be assumed to have changed.
+     */
+    virtual std::optional<geometry::Rectangles> buffer_damage_since(BufferID /*previous*/) const
+    {
+        return std::nullopt;
+    }
+
     virtual geometry::Rectangle screen_position() const = 0;
     virtual std::optional<geometry::Rectangle> clip_area() const = 0;
 
@@ -69,6 +83,19 @@ public:
     virtual glm::mat4 transformation() const = 0;
 
     virtual bool shaped() const = 0;  // meaning the pixel format has alpha
+
+    /**
+     * Return the parts of screen_position() whose content is known to be
+     * fully opaque (before alpha() is applied), in screen coordinates.
+     *
+     * \returns std::nullopt if this is not known, in which case the whole
+     *          renderable should be assumed opaque if and only if it is not
+     *          shaped().
+     */
+    virtual std::optional<geometry::Rectangles> opaque_region() const
+    {
+        return std::nullopt;
+    }
 protected:
     Renderable() = default;
     Renderable(Renderable const&) = delete;
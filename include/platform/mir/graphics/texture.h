@@ -70,6 +70,15 @@ public:
      */
     virtual void bind() = 0;
 
+    /**
+     * Hint that the texture will be needed soon.
+     *
+     * Implementations for which bind() is expensive (for example, because the pixels have to be
+     * uploaded from CPU memory) may use this to start that work early, on another thread.
+     * bind() must give the same result whether or not this has been called.
+     */
+    virtual void prepare() {}
+
     /**
      * Called by the renderer immediately *after* the texture has been used in a GL call.
      *
@@ -39,6 +39,11 @@ public:
     virtual void opened_input_device(char const* device_name, char const* input_platform) = 0;
     virtual void failed_to_open_input_device(char const* device_name, char const* input_platform) = 0;
 
+    /// An event from the kernel is being traced (through the server, to a client and onto the screen) as trace_id
+    virtual void received_traced_event(uint64_t trace_id, int64_t event_time) = 0;
+    /// The traced event has been sent to a client
+    virtual void sent_traced_event(uint64_t trace_id, int64_t event_time) = 0;
+
 protected:
     InputReport() = default;
     InputReport(InputReport const&) = delete;
@@ -0,0 +1,67 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/**
+ * An output drawn into on the CPU, by the software renderer
+ *
+ * This is the software counterpart of renderer::gl::RenderTarget: a DisplayBuffer whose
+ * native_display_buffer() is one of these is composited without GL.
+ */
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    /** Returns the current size in pixels of the render target */
+    virtual auto size() const -> geometry::Size = 0;
+    /**
+     * Maps the buffer the next frame is to be drawn into.
+     *
+     * The mapping is in mir_pixel_format_argb_8888 or mir_pixel_format_xrgb_8888, and is
+     * destroyed before swap_buffers().
+     */
+    virtual auto map_back_buffer() -> std::unique_ptr<Mapping<unsigned char>> = 0;
+    /**
+     * The age, in frames, of the contents of the buffer map_back_buffer() will return
+     * (as for EGL_EXT_buffer_age). Zero means the contents are undefined.
+     */
+    virtual auto buffer_age() const -> int { return 0; }
+    /** Shows the frame drawn into the mapped buffer */
+    virtual void swap_buffers() = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+}
+}
+}
+
+#endif // MIR_RENDERER_SW_RENDER_TARGET_H_
@@ -20,10 +20,15 @@
 #include "buffer_render_target.h"
 
 #include <optional>
+#include <vector>
 #include <GLES2/gl2.h>
 
 namespace mir
 {
+namespace graphics
+{
+struct EGLExtensions;
+}
 namespace renderer
 {
 namespace gl
@@ -35,8 +40,10 @@ class BasicBufferRenderTarget: public BufferRenderTarget
 {
 public:
     BasicBufferRenderTarget(std::shared_ptr<Context> const& ctx);
+    ~BasicBufferRenderTarget();
 
     void set_buffer(std::shared_ptr<software::WriteMappableBuffer> const& buffer) override;
+    void set_dmabuf(std::shared_ptr<graphics::Buffer> const& buffer) override;
 
     auto size() const -> geometry::Size override;
     void make_current() override;
@@ -63,10 +70,21 @@ private:
         GLuint fbo;
     };
 
+    /// Renders into a texture backed by the target dmabuf, so there's nothing to copy
+    class DMABufFramebuffer;
+
     std::shared_ptr<Context> const ctx;
 
     std::shared_ptr<software::WriteMappableBuffer> buffer{nullptr};
     std::optional<Framebuffer> framebuffer;
+
+    /// Only created if a dmabuf is set, as it needs a current EGL display
+    std::unique_ptr<graphics::EGLExtensions> egl_extensions;
+    std::shared_ptr<graphics::Buffer> dmabuf{nullptr};
+    /// The dmabufs imported most recently, most recent first, so a client reusing its buffers isn't re-imported
+    std::vector<std::unique_ptr<DMABufFramebuffer>> dmabuf_framebuffers;
+    /// The current target, if it's a dmabuf
+    DMABufFramebuffer* dmabuf_framebuffer{nullptr};
 };
 
 }
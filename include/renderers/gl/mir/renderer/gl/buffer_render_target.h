@@ -24,6 +24,10 @@
 
 namespace mir
 {
+namespace graphics
+{
+class Buffer;
+}
 namespace renderer
 {
 namespace software
@@ -38,6 +42,13 @@ class BufferRenderTarget: public RenderTarget
 {
 public:
     virtual void set_buffer(std::shared_ptr<software::WriteMappableBuffer> const& buffer) = 0;
+
+    /**
+     * Render directly into a dmabuf-backed buffer, without a copy through the CPU
+     *
+     * \throws std::logic_error if buffer is not backed by a dmabuf
+     */
+    virtual void set_dmabuf(std::shared_ptr<graphics::Buffer> const& buffer) = 0;
 };
 
 }
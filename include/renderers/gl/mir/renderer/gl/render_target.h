@@ -18,6 +18,7 @@
 #define MIR_RENDERER_GL_RENDER_TARGET_H_
 
 #include <mir/geometry/forward.h>
+#include <mir/geometry/rectangles.h>
 
 namespace mir
 {
@@ -47,6 +48,18 @@ public:
      * in preparation for drawing.
      */
     virtual void bind() = 0;
+    /**
+     * The age, in frames, of the contents of the buffer about to be rendered
+     * to (as for EGL_EXT_buffer_age). Zero means the contents are undefined
+     * and the whole target must be redrawn.
+     */
+    virtual auto buffer_age() const -> int { return 0; }
+    /**
+     * Hint the region, in GL window coordinates, that the next frame will
+     * modify (as for EGL_KHR_partial_update). Must be called after
+     * buffer_age() and before any drawing.
+     */
+    virtual void set_damage_region(geometry::Rectangles const& /*damage*/) {}
 
 protected:
     RenderTarget() = default;
@@ -0,0 +1,229 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/events/event_pool.h"
+
+#include "mir/events/keyboard_event.h"
+#include "mir/events/pointer_event.h"
+#include "mir/events/touch_event.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace mev = mir::events;
+
+namespace
+{
+std::size_t constexpr block_size = std::max({sizeof(MirPointerEvent), sizeof(MirKeyboardEvent), sizeof(MirTouchEvent)});
+
+/// Beyond this many free blocks a thread returns them to the heap rather than keeping them
+std::size_t constexpr max_free_blocks = 1024;
+
+class Pool;
+
+/// Precedes each block of storage
+struct alignas(alignof(std::max_align_t)) Header
+{
+    Pool* pool;     ///< nullptr for storage that came straight from ::operator new
+    Header* next;   ///< Free list link while the block is not in use
+};
+
+class Pool
+{
+public:
+    /// Only called on the owning thread
+    auto allocate() -> Header*
+    {
+        if (!free_list)
+        {
+            adopt(remote_free_list.exchange(nullptr, std::memory_order_acquire));
+        }
+
+        Header* block;
+        if (free_list)
+        {
+            block = free_list;
+            free_list = block->next;
+            --free_count;
+        }
+        else
+        {
+            block = static_cast<Header*>(::operator new(sizeof(Header) + block_size));
+        }
+
+        block->pool = this;
+        references.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+
+    /// Only called on the owning thread
+    void release_local(Header* block)
+    {
+        keep(block);
+        unreference();
+    }
+
+    /// Called on any thread but the owner
+    void release_remote(Header* block)
+    {
+        block->next = remote_free_list.load(std::memory_order_relaxed);
+        while (!remote_free_list.compare_exchange_weak(
+            block->next, block, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        unreference();
+    }
+
+    /// The owning thread is exiting; the pool goes once the last of its blocks is released
+    void abandon()
+    {
+        free_all(free_list);
+        free_list = nullptr;
+        free_count = 0;
+        free_all(remote_free_list.exchange(nullptr, std::memory_order_acquire));
+        unreference();
+    }
+
+private:
+    ~Pool() = default;
+
+    void keep(Header* block)
+    {
+        if (free_count < max_free_blocks)
+        {
+            block->next = free_list;
+            free_list = block;
+            ++free_count;
+        }
+        else
+        {
+            ::operator delete(block);
+        }
+    }
+
+    void adopt(Header* list)
+    {
+        while (list)
+        {
+            auto const next = list->next;
+            keep(list);
+            list = next;
+        }
+    }
+
+    void unreference()
+    {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            free_all(remote_free_list.exchange(nullptr, std::memory_order_acquire));
+            delete this;
+        }
+    }
+
+    static void free_all(Header* list)
+    {
+        while (list)
+        {
+            auto const next = list->next;
+            ::operator delete(list);
+            list = next;
+        }
+    }
+
+    /// One for the owning thread, and one for each block in use
+    std::atomic<std::size_t> references{1};
+
+    Header* free_list{nullptr};
+    std::size_t free_count{0};
+
+    /// Blocks released by other threads, taken all at once by the owner when free_list runs dry
+    std::atomic<Header*> remote_free_list{nullptr};
+};
+
+thread_local Pool* this_threads_pool{nullptr};
+thread_local bool this_thread_exiting{false};
+
+class PoolOwner
+{
+public:
+    PoolOwner()
+        : pool{new Pool}
+    {
+        this_threads_pool = pool;
+    }
+
+    ~PoolOwner()
+    {
+        this_threads_pool = nullptr;
+        this_thread_exiting = true;
+        pool->abandon();
+    }
+
+private:
+    Pool* const pool;
+};
+
+/// The calling thread's pool, or nullptr if the thread is too far into exiting to have one
+auto pool_for_this_thread() -> Pool*
+{
+    if (!this_threads_pool && !this_thread_exiting)
+    {
+        thread_local PoolOwner owner;
+    }
+    return this_threads_pool;
+}
+}
+
+auto mev::allocate_pooled_event(std::size_t size) -> void*
+{
+    auto const pool = size <= block_size ? pool_for_this_thread() : nullptr;
+
+    Header* block;
+    if (pool)
+    {
+        block = pool->allocate();
+    }
+    else
+    {
+        block = static_cast<Header*>(::operator new(sizeof(Header) + size));
+        block->pool = nullptr;
+    }
+
+    return block + 1;
+}
+
+void mev::deallocate_pooled_event(void* storage) noexcept
+{
+    if (!storage)
+        return;
+
+    auto const block = static_cast<Header*>(storage) - 1;
+
+    if (!block->pool)
+    {
+        ::operator delete(block);
+    }
+    else if (block->pool == this_threads_pool)
+    {
+        block->pool->release_local(block);
+    }
+    else
+    {
+        block->pool->release_remote(block);
+    }
+}
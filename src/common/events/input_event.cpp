@@ -15,6 +15,7 @@
  */
 
 #include "mir/events/event.h"
+#include "mir/events/event_pool.h"
 #include "mir/events/input_event.h"
 #include "mir/events/keyboard_event.h"
 #include "mir/events/pointer_event.h"
@@ -89,6 +90,16 @@ MirTouchEvent const* MirInputEvent::to_touch() const
     return static_cast<MirTouchEvent const*>(this);
 }
 
+void* MirInputEvent::operator new(std::size_t size)
+{
+    return mir::events::allocate_pooled_event(size);
+}
+
+void MirInputEvent::operator delete(void* storage) noexcept
+{
+    mir::events::deallocate_pooled_event(storage);
+}
+
 std::chrono::nanoseconds MirInputEvent::event_time() const
 {
     return event_time_;
@@ -119,6 +130,16 @@ void MirInputEvent::set_modifiers(MirInputEventModifiers modifiers)
     modifiers_ = modifiers;
 }
 
+uint64_t MirInputEvent::trace_id() const
+{
+    return trace_id_;
+}
+
+void MirInputEvent::set_trace_id(uint64_t id)
+{
+    trace_id_ = id;
+}
+
 MirInputEvent::MirInputEvent(MirInputEventType input_type) :
     MirEvent{mir_event_type_input},
     input_type_{input_type}
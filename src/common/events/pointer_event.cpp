@@ -148,6 +148,16 @@ MirBlob* MirPointerEvent::dnd_handle() const
     return blob.release();
 }
 
+auto MirPointerEvent::coalesced_event_times() const -> std::vector<std::chrono::nanoseconds>
+{
+    return coalesced_event_times_;
+}
+
+void MirPointerEvent::set_coalesced_event_times(std::vector<std::chrono::nanoseconds> const& times)
+{
+    coalesced_event_times_ = times;
+}
+
 auto MirPointerEvent::axis_source() const -> MirPointerAxisSource
 {
     return axis_source_;
@@ -0,0 +1,482 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/logging/message_time.h"
+#include "mir/thread_name.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ml = mir::logging;
+
+namespace
+{
+/// Longer messages are truncated (as they are by Logger::log(char const*, ...))
+std::size_t const max_message_size = 4096;
+std::size_t const max_component_size = 256;
+std::size_t const min_buffer_size = 4096;
+
+/// How long the logging thread waits for more messages after writing some, before being woken for them
+std::chrono::milliseconds const linger{10};
+
+struct RecordHeader
+{
+    uint32_t size;              ///< Of the whole record, including alignment padding
+    uint32_t message_size;
+    uint16_t component_size;
+    bool skip_to_start;         ///< Not a message: the next record is at the start of the buffer
+    ml::Severity severity;
+    timespec time;
+};
+
+auto aligned(std::size_t size) -> std::size_t
+{
+    return (size + alignof(RecordHeader) - 1) & ~(alignof(RecordHeader) - 1);
+}
+
+/**
+ * A queue of log records in a ring of bytes, with a single producer (the thread that
+ * owns it) and a single consumer (the AsyncLogger's thread).
+ *
+ * Records are never split across the end of the ring; when one doesn't fit the
+ * producer skips to the start, leaving a skip_to_start record if there's room for one.
+ */
+class ThreadBuffer
+{
+public:
+    explicit ThreadBuffer(std::size_t size)
+        : size{std::bit_ceil(std::max(size, min_buffer_size))},
+          mask{this->size - 1},
+          storage{new char[this->size]}
+    {
+    }
+
+    /// Called only by the owning thread. Returns false if the record doesn't fit.
+    auto try_push(ml::Severity severity, timespec const& time, std::string_view component, std::string_view message)
+        -> bool
+    {
+        component = component.substr(0, max_component_size);
+        message = message.substr(0, std::min(max_message_size, size / 4));
+
+        auto const needed = aligned(sizeof(RecordHeader) + component.size() + message.size());
+        auto position = head.load(std::memory_order_relaxed);
+        auto const to_end = size - (position & mask);
+        auto const skip = to_end < needed ? to_end : 0;
+
+        if (position + skip + needed - cached_tail > size)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (position + skip + needed - cached_tail > size)
+                return false;
+        }
+
+        if (skip >= sizeof(RecordHeader))
+        {
+            RecordHeader const skip_record{static_cast<uint32_t>(skip), 0, 0, true, severity, time};
+            std::memcpy(storage.get() + (position & mask), &skip_record, sizeof skip_record);
+        }
+        position += skip;
+
+        RecordHeader const header{
+            static_cast<uint32_t>(needed),
+            static_cast<uint32_t>(message.size()),
+            static_cast<uint16_t>(component.size()),
+            false,
+            severity,
+            time};
+        auto const record = storage.get() + (position & mask);
+        std::memcpy(record, &header, sizeof header);
+        std::memcpy(record + sizeof header, component.data(), component.size());
+        std::memcpy(record + sizeof header + component.size(), message.data(), message.size());
+
+        // Sequentially consistent, to order it before the check for a sleeping consumer (see State::run())
+        head.store(position + needed, std::memory_order_seq_cst);
+        return true;
+    }
+
+    /// Called only by the consumer. Returns false if there was nothing to pop.
+    template<typename Deliver>
+    auto try_pop(Deliver const& deliver) -> bool
+    {
+        auto position = tail.load(std::memory_order_relaxed);
+        if (position == head.load(std::memory_order_acquire))
+            return false;
+
+        RecordHeader header;
+        auto const to_end = size - (position & mask);
+        if (to_end >= sizeof header)
+            std::memcpy(&header, storage.get() + (position & mask), sizeof header);
+
+        if (to_end < sizeof header || header.skip_to_start)
+        {
+            position += to_end;
+            std::memcpy(&header, storage.get(), sizeof header);
+        }
+
+        auto const data = storage.get() + (position & mask) + sizeof header;
+        deliver(
+            header.severity,
+            header.time,
+            std::string_view{data, header.component_size},
+            std::string_view{data + header.component_size, header.message_size});
+
+        tail.store(position + header.size, std::memory_order_release);
+        return true;
+    }
+
+    auto empty() const -> bool
+    {
+        return head.load(std::memory_order_seq_cst) == tail.load(std::memory_order_relaxed);
+    }
+
+    /// Set when the owning thread exits: once empty the buffer can be discarded
+    std::atomic<bool> thread_exited{false};
+    /// Set when the AsyncLogger is destroyed: the owning thread can discard the buffer
+    std::atomic<bool> logger_gone{false};
+
+private:
+    std::size_t const size;
+    std::size_t const mask;
+    std::unique_ptr<char[]> const storage;
+
+    // Both count bytes ever written/read, so are only masked to index the storage
+    alignas(64) std::atomic<std::size_t> head{0};
+    std::size_t cached_tail{0};     ///< The producer's last sight of tail
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
+
+/// The buffers the current thread logs to, one per AsyncLogger it has logged to
+struct ThisThreadsBuffers
+{
+    ~ThisThreadsBuffers()
+    {
+        destroyed = true;
+        for (auto const& [_, buffer] : buffers)
+            buffer->thread_exited = true;
+    }
+
+    std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> buffers;
+    static thread_local inline bool destroyed{false};
+};
+
+thread_local ThisThreadsBuffers this_threads_buffers;
+
+auto next_logger_id() -> uint64_t
+{
+    static std::atomic<uint64_t> next{0};
+    return next++;
+}
+
+auto now() -> timespec
+{
+    timespec result;
+    clock_gettime(CLOCK_REALTIME, &result);
+    return result;
+}
+}
+
+class ml::AsyncLogger::State
+{
+public:
+    State(std::shared_ptr<Logger> const& sink, std::size_t buffer_size)
+        : sink{sink},
+          buffer_size{buffer_size},
+          thread{[this] { run(); }}
+    {
+    }
+
+    ~State()
+    {
+        running = false;
+        wake();
+        thread.join();
+
+        std::lock_guard lock{buffers_mutex};
+        for (auto const& buffer : buffers)
+            buffer->logger_gone = true;
+    }
+
+    void log(Severity severity, std::string_view component, std::string_view message)
+    {
+        if (severity == Severity::critical || ThisThreadsBuffers::destroyed)
+        {
+            flush();
+            sink->log(severity, std::string{message}, std::string{component});
+            return;
+        }
+
+        if (!buffer_for_this_thread().try_push(severity, now(), component, message))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // See the end of run() for the other half of this
+        if (consumer_waiting.load(std::memory_order_seq_cst))
+            wake();
+    }
+
+    void flush()
+    {
+        if (std::this_thread::get_id() == thread.get_id())
+            return;
+
+        std::unique_lock lock{flush_mutex};
+        // The pass in progress may have missed what was just logged; the one after won't
+        auto const target = passes + 2;
+        ++flushes_pending;
+        wake();
+        flushed.wait(lock, [&] { return passes >= target || stopped; });
+        --flushes_pending;
+    }
+
+    std::shared_ptr<Logger> const sink;
+    std::atomic<uint64_t> dropped{0};
+
+private:
+    auto buffer_for_this_thread() -> ThreadBuffer&
+    {
+        auto& mine = this_threads_buffers.buffers;
+        for (auto const& [logger, buffer] : mine)
+        {
+            if (logger == id)
+                return *buffer;
+        }
+
+        std::erase_if(mine, [](auto const& entry) { return entry.second->logger_gone.load(); });
+
+        auto const buffer = std::make_shared<ThreadBuffer>(buffer_size);
+        {
+            std::lock_guard lock{buffers_mutex};
+            buffers.push_back(buffer);
+        }
+        buffers_changed = true;
+        mine.emplace_back(id, buffer);
+        return *buffer;
+    }
+
+    void wake()
+    {
+        {
+            std::lock_guard lock{wake_mutex};
+            wake_requested = true;
+        }
+        woken.notify_one();
+    }
+
+    /// Sleep until woken, or (if timeout is set) it has passed
+    void sleep(std::optional<std::chrono::milliseconds> timeout)
+    {
+        std::unique_lock lock{wake_mutex};
+        if (timeout)
+            woken.wait_for(lock, timeout.value(), [this] { return wake_requested; });
+        else
+            woken.wait(lock, [this] { return wake_requested; });
+        wake_requested = false;
+    }
+
+    void run()
+    {
+        mir::set_thread_name("Mir/Logger");
+
+        std::vector<std::shared_ptr<ThreadBuffer>> current_buffers;
+        for (;;)
+        {
+            bool const stopping = !running;
+
+            if (buffers_changed.exchange(false))
+            {
+                std::lock_guard lock{buffers_mutex};
+                current_buffers = buffers;
+            }
+
+            bool const delivered = drain(current_buffers);
+            report_dropped();
+
+            {
+                std::lock_guard lock{flush_mutex};
+                ++passes;
+                stopped = stopping;
+            }
+            flushed.notify_all();
+
+            if (stopping)
+                break;
+
+            if (flushes_pending > 0)
+                continue;
+
+            if (delivered)
+            {
+                // More messages are likely soon. Collecting them in a while, rather than
+                // being woken for each, saves the threads logging them a system call.
+                sleep(linger);
+                continue;
+            }
+
+            /*
+             * Producers only wake us if they see consumer_waiting set after they've pushed,
+             * so after setting it we check (with sequentially consistent operations
+             * throughout) for anything they might have pushed before seeing it.
+             */
+            consumer_waiting = true;
+            bool const idle =
+                running &&
+                flushes_pending == 0 &&
+                !buffers_changed &&
+                std::all_of(current_buffers.begin(), current_buffers.end(),
+                            [](auto const& buffer) { return buffer->empty(); });
+            if (idle)
+                sleep(std::nullopt);
+            consumer_waiting = false;
+        }
+    }
+
+    /// Pass everything in current_buffers to the sink, returning whether there was anything
+    auto drain(std::vector<std::shared_ptr<ThreadBuffer>>& current_buffers) -> bool
+    {
+        auto const deliver =
+            [this](Severity severity, timespec const& time, std::string_view component, std::string_view message)
+            {
+                ScopedMessageTime const message_time{time};
+                this->component.assign(component);
+                this->message.assign(message);
+                try
+                {
+                    sink->log(severity, this->message, this->component);
+                }
+                catch (...)
+                {
+                    // There's nowhere to report a logger failing; carry on with the next message
+                }
+            };
+
+        bool delivered_any{false};
+        bool delivered;
+        do
+        {
+            delivered = false;
+            for (auto i = current_buffers.begin(); i != current_buffers.end();)
+            {
+                auto& buffer = **i;
+
+                // Take a few messages from each thread at a time, so none is starved by another
+                for (auto n = 0; n != 16 && buffer.try_pop(deliver); ++n)
+                    delivered = true;
+
+                if (buffer.thread_exited && buffer.empty())
+                {
+                    std::lock_guard lock{buffers_mutex};
+                    std::erase(buffers, *i);
+                    i = current_buffers.erase(i);
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            delivered_any = delivered_any || delivered;
+        }
+        while (delivered);
+
+        return delivered_any;
+    }
+
+    void report_dropped()
+    {
+        auto const total = dropped.load(std::memory_order_relaxed);
+        if (total != reported_dropped)
+        {
+            sink->log(
+                Severity::warning,
+                std::to_string(total - reported_dropped) +
+                    " log messages dropped: they were logged faster than they could be written",
+                "logging");
+            reported_dropped = total;
+        }
+    }
+
+    std::size_t const buffer_size;
+    uint64_t const id{next_logger_id()};
+
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::atomic<bool> buffers_changed{false};
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> consumer_waiting{false};
+    std::mutex wake_mutex;
+    std::condition_variable woken;
+    bool wake_requested{false};     ///< Guarded by wake_mutex
+    std::atomic<int> flushes_pending{0};
+
+    std::mutex flush_mutex;
+    std::condition_variable flushed;
+    uint64_t passes{0};     ///< Guarded by flush_mutex
+    bool stopped{false};    ///< Guarded by flush_mutex
+
+    // Only used by the logging thread
+    uint64_t reported_dropped{0};
+    std::string component;
+    std::string message;
+
+    std::thread thread;
+};
+
+ml::AsyncLogger::AsyncLogger(std::shared_ptr<Logger> const& sink, std::size_t buffer_size)
+    : state{std::make_unique<State>(sink, buffer_size)}
+{
+}
+
+ml::AsyncLogger::~AsyncLogger() = default;
+
+void ml::AsyncLogger::flush()
+{
+    state->flush();
+}
+
+auto ml::AsyncLogger::dropped_messages() const -> uint64_t
+{
+    return state->dropped.load(std::memory_order_relaxed);
+}
+
+void ml::AsyncLogger::log(Severity severity, std::string const& message, std::string const& component)
+{
+    state->log(severity, component, message);
+}
+
+void ml::AsyncLogger::log(char const* component, Severity severity, char const* format, ...)
+{
+    char message[max_message_size];
+    va_list va;
+    va_start(va, format);
+    vsnprintf(message, sizeof message, format, va);
+    va_end(va);
+
+    state->log(severity, component, message);
+}
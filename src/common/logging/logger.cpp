@@ -16,8 +16,11 @@
 
 #include "mir/logging/dumb_console_logger.h"
 #include "mir/logging/logger.h"
+#include "mir/logging/message_time.h"
 
 #include <iostream>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <cstdarg>
 #include <cstdio>
@@ -40,36 +43,97 @@ void ml::Logger::log(char const* component, Severity severity, char const* forma
 
 namespace
 {
-std::mutex log_mutex;
+std::mutex logger_mutex;
+/// Guarded by logger_mutex
 std::shared_ptr<ml::Logger> the_logger;
+/// Bumped, with logger_mutex held, each time the_logger is replaced
+std::atomic<unsigned> logger_generation{0};
 
-std::shared_ptr<ml::Logger> get_logger()
+struct LoggerVersion
 {
-    std::lock_guard lock{log_mutex};
+    unsigned generation{0};
+    std::shared_ptr<ml::Logger> logger;
+};
 
+auto current_logger() -> LoggerVersion
+{
+    std::lock_guard lock{logger_mutex};
     if (!the_logger)
+    {
         the_logger = std::make_shared<ml::DumbConsoleLogger>();
-
-    return the_logger;
+    }
+    return {logger_generation.load(std::memory_order_relaxed), the_logger};
 }
+
+/// Set once this thread's logger_cache has been destroyed, for anything that logs as the thread exits
+thread_local bool logger_cache_destroyed{false};
+
+/**
+ * This thread's copy of the_logger, so logging takes neither logger_mutex nor a reference.
+ *
+ * The copy is refreshed when the generation changes. Until then the thread keeps the
+ * logger it last used alive, at most until it next logs or exits.
+ */
+thread_local struct LoggerCache
+{
+    ~LoggerCache() { logger_cache_destroyed = true; }
+
+    LoggerVersion version;
+} logger_cache;
 }
 
 void ml::log(ml::Severity severity, const std::string& message, const std::string& component)
 {
-    auto const logger = get_logger();
+    if (logger_cache_destroyed)
+    {
+        current_logger().logger->log(severity, message, component);
+        return;
+    }
 
-    logger->log(severity, message, component);
+    auto& cached = logger_cache.version;
+    if (!cached.logger || cached.generation != logger_generation.load(std::memory_order_acquire))
+    {
+        cached = current_logger();
+    }
+
+    cached.logger->log(severity, message, component);
 }
 
 void ml::set_logger(std::shared_ptr<Logger> const& new_logger)
 {
     if (new_logger)
     {
-        std::lock_guard lock{log_mutex};
-        the_logger = new_logger;
+        {
+            std::lock_guard lock{logger_mutex};
+            the_logger = new_logger;
+            logger_generation.fetch_add(1, std::memory_order_release);
+        }
+
+        // Don't keep the old logger alive on this thread
+        if (!logger_cache_destroyed)
+        {
+            logger_cache.version = current_logger();
+        }
     }
 }
 
+namespace
+{
+thread_local timespec const* message_time{nullptr};
+}
+
+ml::ScopedMessageTime::ScopedMessageTime(timespec const& time)
+    : previous{message_time},
+      time{time}
+{
+    message_time = &this->time;
+}
+
+ml::ScopedMessageTime::~ScopedMessageTime()
+{
+    message_time = previous;
+}
+
 void ml::format_message(std::ostream& out, Severity severity, std::string const& message, std::string const& component)
 {
     static const char* lut[5] =
@@ -82,9 +146,14 @@ void ml::format_message(std::ostream& out, Severity severity, std::string const&
     };
 
     struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
+    if (message_time)
+        ts = *message_time;
+    else
+        clock_gettime(CLOCK_REALTIME, &ts);
+    struct tm local;
+    localtime_r(&ts.tv_sec, &local);
     char now[32];
-    auto offset = strftime(now, sizeof(now), "%F %T", localtime(&ts.tv_sec));
+    auto offset = strftime(now, sizeof(now), "%F %T", &local);
     snprintf(now+offset, sizeof(now)-offset, ".%06ld", ts.tv_nsec / 1000);
 
     if (!out || !out.good())
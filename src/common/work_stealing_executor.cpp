@@ -0,0 +1,293 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/executor.h"
+
+#include "mir/thread_name.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/// Even on a single core, one worker busy with background work mustn't hold up latency-critical work
+unsigned const min_workers = 2;
+
+/* We use an atomic void(*)() rather than a std::function to avoid needing to take a mutex
+ * in exception context, as taking a mutex can itself throw an exception!
+ */
+std::atomic<void(*)()> exception_handler{[] { std::rethrow_exception(std::current_exception()); }};
+
+enum Priority : std::size_t
+{
+    latency_critical,
+    background,
+    priority_count
+};
+
+/// One worker's share of the queued work
+class WorkerQueues
+{
+public:
+    void push(Priority priority, std::function<void()>&& work)
+    {
+        std::lock_guard lock{mutex};
+        queues[priority].push_back(std::move(work));
+    }
+
+    /// Newest first, by the worker owning these queues
+    auto pop(Priority priority) -> std::function<void()>
+    {
+        std::lock_guard lock{mutex};
+        auto& queue = queues[priority];
+        if (queue.empty())
+        {
+            return {};
+        }
+        auto work = std::move(queue.back());
+        queue.pop_back();
+        return work;
+    }
+
+    /// Oldest first, by any other worker
+    auto steal(Priority priority) -> std::function<void()>
+    {
+        std::lock_guard lock{mutex};
+        auto& queue = queues[priority];
+        if (queue.empty())
+        {
+            return {};
+        }
+        auto work = std::move(queue.front());
+        queue.pop_front();
+        return work;
+    }
+
+private:
+    std::mutex mutex;
+    std::array<std::deque<std::function<void()>>, priority_count> queues;
+};
+
+class Pool;
+
+/// Set on each worker thread, so that work it spawns stays with it
+thread_local Pool* this_threads_pool{nullptr};
+thread_local std::size_t this_threads_worker{0};
+
+/**
+ * Theory of operation:
+ * There's a fixed number of workers, each with a WorkerQueues, started by the first spawn().
+ *
+ * queued counts the work in all the WorkerQueues. It's bumped after work is pushed and dropped after
+ * work is taken, so it can briefly go negative, but whenever there's work nobody has taken it
+ * is positive or about to become so. A worker that finds no work sleeps until it's positive; spawn()
+ * only takes the sleep mutex to wake a worker if any are asleep.
+ */
+class Pool
+{
+public:
+    Pool() noexcept
+        : worker_count{std::max(min_workers, std::thread::hardware_concurrency())},
+          worker_queues(worker_count)
+    {
+    }
+
+    ~Pool() noexcept
+    {
+        quiesce();
+    }
+
+    void spawn(Priority priority, std::function<void()>&& work)
+    {
+        if (this_threads_pool == this)
+        {
+            worker_queues[this_threads_worker].push(priority, std::move(work));
+        }
+        else
+        {
+            ensure_started();
+            auto const worker = next_worker.fetch_add(1, std::memory_order_relaxed) % worker_count;
+            worker_queues[worker].push(priority, std::move(work));
+        }
+
+        queued.fetch_add(1);
+        if (sleepers.load() > 0)
+        {
+            {
+                std::lock_guard lock{sleep_mutex};
+            }
+            work_queued.notify_one();
+        }
+    }
+
+    void quiesce()
+    {
+        std::lock_guard lifecycle_lock{lifecycle_mutex};
+        if (threads.empty())
+        {
+            return;
+        }
+
+        {
+            std::unique_lock lock{sleep_mutex};
+            workers_idle.wait(lock, [this] { return sleepers.load() == worker_count && queued.load() <= 0; });
+            stopping = true;
+        }
+        work_queued.notify_all();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        threads.clear();
+
+        std::lock_guard lock{sleep_mutex};
+        stopping = false;
+        started.store(false, std::memory_order_release);
+    }
+
+private:
+    void ensure_started()
+    {
+        if (started.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        std::lock_guard lock{lifecycle_mutex};
+        if (threads.empty())
+        {
+            for (std::size_t i = 0; i != worker_count; ++i)
+            {
+                threads.emplace_back([this, i] { work_loop(i); });
+            }
+            started.store(true, std::memory_order_release);
+        }
+    }
+
+    /// Latency-critical work from anywhere before any background work
+    auto find_work(std::size_t worker) -> std::function<void()>
+    {
+        for (auto priority : {latency_critical, background})
+        {
+            if (auto work = worker_queues[worker].pop(priority))
+            {
+                return work;
+            }
+            for (std::size_t i = 1; i != worker_count; ++i)
+            {
+                if (auto work = worker_queues[(worker + i) % worker_count].steal(priority))
+                {
+                    return work;
+                }
+            }
+        }
+        return {};
+    }
+
+    void work_loop(std::size_t worker)
+    {
+        mir::set_thread_name("Mir/Worker");
+        this_threads_pool = this;
+        this_threads_worker = worker;
+
+        for (;;)
+        {
+            if (auto work = find_work(worker))
+            {
+                queued.fetch_sub(1);
+                try
+                {
+                    work();
+                }
+                catch (...)
+                {
+                    (*exception_handler)();
+                }
+                continue;
+            }
+
+            std::unique_lock lock{sleep_mutex};
+            sleepers.fetch_add(1);
+            workers_idle.notify_all();
+            work_queued.wait(lock, [this] { return stopping || queued.load() > 0; });
+            sleepers.fetch_sub(1);
+
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    std::size_t const worker_count;
+    std::vector<WorkerQueues> worker_queues;
+    std::atomic<std::size_t> next_worker{0};
+    std::atomic<long> queued{0};
+
+    std::mutex sleep_mutex;
+    std::condition_variable work_queued;
+    std::condition_variable workers_idle;
+    std::atomic<std::size_t> sleepers{0};
+    bool stopping{false};
+
+    std::mutex lifecycle_mutex;
+    std::atomic<bool> started{false};
+    std::vector<std::thread> threads;
+};
+
+Pool pool;
+
+class PriorityExecutor : public mir::WorkStealingExecutor
+{
+public:
+    explicit PriorityExecutor(Priority priority)
+        : priority{priority}
+    {
+    }
+
+    void spawn(std::function<void()>&& work) override
+    {
+        pool.spawn(priority, std::move(work));
+    }
+
+private:
+    Priority const priority;
+};
+
+PriorityExecutor latency_critical_adaptor{latency_critical};
+PriorityExecutor background_adaptor{background};
+}
+
+mir::NonBlockingExecutor& mir::latency_critical_executor = latency_critical_adaptor;
+mir::NonBlockingExecutor& mir::background_executor = background_adaptor;
+
+void mir::WorkStealingExecutor::set_unhandled_exception_handler(void (*handler)())
+{
+    exception_handler = handler;
+}
+
+void mir::WorkStealingExecutor::quiesce()
+{
+    pool.quiesce();
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_EVENTS_EVENT_POOL_H_
+#define MIR_EVENTS_EVENT_POOL_H_
+
+#include <cstddef>
+
+namespace mir
+{
+namespace events
+{
+/**
+ * Storage for input events, recycled through a free list owned by the allocating thread.
+ *
+ * Input events are created at a high rate on the input thread and released wherever
+ * dispatch finishes with them. Storage released on another thread is handed back to
+ * the allocating thread's pool, so a steady stream of events allocates nothing once
+ * the pool has warmed up. A pool outlives its thread for as long as any of its storage
+ * is in use.
+ *
+ * Requests larger than the pool's fixed block size fall back to ::operator new.
+ */
+auto allocate_pooled_event(std::size_t size) -> void*;
+
+/// Release storage returned by allocate_pooled_event(), from any thread
+void deallocate_pooled_event(void* storage) noexcept;
+}
+}
+
+#endif // MIR_EVENTS_EVENT_POOL_H_
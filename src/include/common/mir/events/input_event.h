@@ -19,6 +19,8 @@
 
 #include "mir/events/event.h"
 
+#include <cstddef>
+
 struct MirInputEvent : MirEvent
 {
     MirInputEventType input_type() const;
@@ -38,6 +40,10 @@ struct MirInputEvent : MirEvent
     MirInputEventModifiers modifiers() const;
     void set_modifiers(MirInputEventModifiers mods);
 
+    /// Identifies the event while following it from the kernel to the screen, or 0 if it isn't traced
+    uint64_t trace_id() const;
+    void set_trace_id(uint64_t id);
+
     MirKeyboardEvent* to_keyboard();
     MirKeyboardEvent const* to_keyboard() const;
 
@@ -47,6 +53,10 @@ struct MirInputEvent : MirEvent
     MirTouchEvent* to_touch();
     MirTouchEvent const* to_touch() const;
 
+    /// Input events are created and released at a high rate, so come from a pool (see event_pool.h)
+    static void* operator new(std::size_t size);
+    static void operator delete(void* storage) noexcept;
+
 protected:
     MirInputEvent(MirInputEventType input_type,
                   MirInputDeviceId dev,
@@ -65,6 +75,7 @@ private:
     std::chrono::nanoseconds event_time_ = {};
     std::vector<uint8_t> cookie_;
     MirInputEventModifiers modifiers_ = 0;
+    uint64_t trace_id_ = 0;
 };
 
 #endif /* MIR_COMMON_INPUT_EVENT_H_ */
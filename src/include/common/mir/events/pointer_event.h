@@ -65,6 +65,10 @@ struct MirPointerEvent : MirInputEvent
     void set_dnd_handle(std::vector<uint8_t> const& handle);
     MirBlob* dnd_handle() const;
 
+    /// The times of earlier samples merged into this one (oldest first), if it was coalesced
+    auto coalesced_event_times() const -> std::vector<std::chrono::nanoseconds>;
+    void set_coalesced_event_times(std::vector<std::chrono::nanoseconds> const& times);
+
 private:
     std::optional<mir::geometry::PointF> position_;
     mir::geometry::DisplacementF motion_;
@@ -76,6 +80,7 @@ private:
     MirPointerButtons buttons_ = {};
 
     std::optional<std::vector<uint8_t>> dnd_handle_;
+    std::vector<std::chrono::nanoseconds> coalesced_event_times_;
 };
 
 #endif
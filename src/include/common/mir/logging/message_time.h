@@ -0,0 +1,49 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_LOGGING_MESSAGE_TIME_H_
+#define MIR_LOGGING_MESSAGE_TIME_H_
+
+#include <ctime>
+
+namespace mir
+{
+namespace logging
+{
+/**
+ * While in scope, format_message() on this thread stamps messages with time
+ * rather than the current time.
+ *
+ * This lets messages that are written some time after they were logged (by
+ * AsyncLogger) keep the time they were logged at.
+ */
+class ScopedMessageTime
+{
+public:
+    explicit ScopedMessageTime(timespec const& time);
+    ~ScopedMessageTime();
+
+    ScopedMessageTime(ScopedMessageTime const&) = delete;
+    ScopedMessageTime& operator=(ScopedMessageTime const&) = delete;
+
+private:
+    timespec const* const previous;
+    timespec const time;
+};
+}
+}
+
+#endif // MIR_LOGGING_MESSAGE_TIME_H_
@@ -23,6 +23,7 @@
 #include "mir/graphics/buffer_id.h"
 
 #include <memory>
+#include <optional>
 
 namespace mir
 {
@@ -40,6 +41,14 @@ public:
     virtual ~BufferStream() = default;
 
     virtual auto lock_compositor_buffer(void const* user_id) -> std::shared_ptr<graphics::Buffer> = 0;
+    /**
+     * The region, in buffer coordinates, that differs between two buffers submitted to this stream
+     *
+     * \returns std::nullopt if the difference is unknown (for example, if either buffer is too old
+     *          or was submitted without damage information). Callers should then assume everything changed.
+     */
+    virtual auto damage_between(graphics::BufferID older, graphics::BufferID newer) const
+        -> std::optional<geometry::Rectangles> = 0;
     /// Logical size of the stream (may be different than buffer sizes if scaled)
     virtual auto stream_size() -> geometry::Size = 0;
     virtual auto buffers_ready_for_compositor(void const* user_id) const -> int = 0;
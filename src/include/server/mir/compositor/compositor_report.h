@@ -19,6 +19,8 @@
 
 #include "mir/graphics/renderable.h"
 
+#include <cstdint>
+
 namespace mir
 {
 namespace compositor
@@ -36,6 +38,38 @@ public:
     virtual void started() = 0;
     virtual void stopped() = 0;
     virtual void scheduled() = 0;
+
+    /// The steps a compositor thread goes through for each frame
+    enum class FrameStage
+    {
+        delay,          ///< Waiting to sample the scene as close to the next vblank as it can
+        scene_snapshot, ///< Collecting the scene elements to composite
+        occlusion,      ///< Culling occluded elements and clipping the rest
+        render,         ///< Rendering (including the buffer swap) or assigning overlay planes
+        post,           ///< Posting to the display, which may wait for the previous page flip
+        sleep           ///< Sleeping after posting, on platforms that can't report presentation
+    };
+
+    /**
+     * \name The stages of each frame, in more detail than began_frame()..finished_frame()
+     * A compositor thread has no finer grained ID than its sub-compositors, so stages common to
+     * all the sub-compositors on a thread (delay, post and sleep) are reported for each of them.
+     * @{ */
+    virtual void began_stage(SubCompositorId id, FrameStage stage) = 0;
+    virtual void finished_stage(SubCompositorId id, FrameStage stage) = 0;
+    /** @} */
+
+    /**
+     * \name Following traced input events through a client's response
+     * A client has committed its response to the event traced as trace_id, then a compositor has
+     * used that commit (reported from the compositor's thread) or it was superseded unused, and
+     * finally the frame showing it was presented, latency after the event.
+     * @{ */
+    virtual void traced_input_committed(uint64_t trace_id) = 0;
+    virtual void traced_input_composited(uint64_t trace_id) = 0;
+    virtual void traced_input_discarded(uint64_t trace_id) = 0;
+    virtual void traced_input_presented(uint64_t trace_id, int64_t msc, int64_t latency) = 0;
+    /** @} */
 protected:
     CompositorReport() = default;
     virtual ~CompositorReport() = default;
@@ -29,7 +29,13 @@ class DisplayBufferCompositor
 public:
     virtual ~DisplayBufferCompositor() = default;
 
-    virtual void composite(SceneElementSequence&& scene_sequence) = 0;
+    /**
+     * Composite the scene onto the display buffer.
+     *
+     * \returns true if the display buffer has a new frame to be posted,
+     *          false if nothing visible changed and the frame was skipped.
+     */
+    virtual bool composite(SceneElementSequence&& scene_sequence) = 0;
 
 protected:
     DisplayBufferCompositor() = default;
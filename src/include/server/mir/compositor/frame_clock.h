@@ -0,0 +1,121 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_FRAME_CLOCK_H_
+#define MIR_COMPOSITOR_FRAME_CLOCK_H_
+
+#include "mir/compositor/compositor_id.h"
+#include "mir/graphics/frame.h"
+#include "mir/time/posix_timestamp.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Shares the compositors' predictions of when they will next sample the scene.
+ *
+ * Clients waiting on a frame callback can then be woken just in time to draw for the
+ * next frame the compositor will show, whatever the refresh rate of the outputs.
+ *
+ * Also relays the frames the compositors present, for clients that want feedback on
+ * when their content actually reached the screen. Content a compositor consumes is
+ * presented by that compositor's next post, so handlers for it wait for that post's frame.
+ */
+class FrameClock
+{
+public:
+    FrameClock() = default;
+
+    /// Note that compositor expects to next sample the scene at when, and every period after that
+    void predict(CompositorID compositor, time::PosixTimestamp when, std::chrono::nanoseconds period);
+
+    /// Forget any prediction by compositor (e.g. because it has stopped)
+    void forget(CompositorID compositor);
+
+    /**
+     * How long from now until any compositor next samples the scene.
+     *
+     * \returns fallback if no compositor has been able to make a prediction
+     */
+    auto time_until_next_frame(std::chrono::nanoseconds fallback) const -> std::chrono::nanoseconds;
+
+    using PresentationHandler = std::function<void(graphics::Frame const& frame, std::chrono::nanoseconds refresh)>;
+
+    /// Note that the calling thread composites for compositor (or, given std::nullopt, no longer does)
+    static void set_compositor_on_this_thread(std::optional<CompositorID> compositor);
+
+    /// The compositor the calling thread composites for, if any
+    static auto compositor_on_this_thread() -> std::optional<CompositorID>;
+
+    /// Note that compositor has posted what it composited since its last post
+    void posted(CompositorID compositor);
+
+    /**
+     * Note that compositor has presented frame (its page flip has completed).
+     *
+     * \param refresh  the estimated period until the next vblank, or zero if unknown
+     * \param latest   whether frame shows compositor's latest post, rather than the one before
+     *                 (which is the case on platforms that wait for a flip only when next posting)
+     */
+    void presented(
+        CompositorID compositor,
+        graphics::Frame const& frame,
+        std::chrono::nanoseconds refresh,
+        bool latest = true);
+
+    /**
+     * Call handler (once) with the frame presenting what compositor is compositing now, or
+     * without a compositor, with the next frame any compositor presents.
+     *
+     * If compositor is forgotten first, handler gets the next frame any compositor presents.
+     * The handler is called on the compositor's thread, so should not block.
+     */
+    void on_next_presentation(std::optional<CompositorID> compositor, PresentationHandler&& handler);
+
+private:
+    struct Prediction
+    {
+        time::PosixTimestamp when;
+        std::chrono::nanoseconds period;
+    };
+
+    std::mutex mutable mutex;
+    std::unordered_map<CompositorID, Prediction> predictions;
+    struct PendingPresentation
+    {
+        std::optional<CompositorID> compositor;
+        uint64_t posts;     ///< How many posts compositor had made when this was registered
+        PresentationHandler handler;
+    };
+
+    std::unordered_map<CompositorID, uint64_t> posts;
+    std::vector<PendingPresentation> pending_presentations;
+};
+
+}
+}
+
+#endif // MIR_COMPOSITOR_FRAME_CLOCK_H_
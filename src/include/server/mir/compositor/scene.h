@@ -52,6 +52,17 @@ public:
      */
     virtual SceneElementSequence scene_elements_for(CompositorID id) = 0;
 
+    /**
+     * As scene_elements_for(), but replacing the contents of \p elements.
+     *
+     * Compositors call this every frame, so passing the same sequence each
+     * time lets its storage be reused rather than reallocated.
+     */
+    virtual void collect_scene_elements_for(CompositorID id, SceneElementSequence& elements)
+    {
+        elements = scene_elements_for(id);
+    }
+
     /**
      * Return the number of additional frames that you need to render to get
      * fully up to date with the latest data in the scene. For a generic
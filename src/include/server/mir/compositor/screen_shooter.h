@@ -26,6 +26,10 @@
 
 namespace mir
 {
+namespace graphics
+{
+class Buffer;
+}
 namespace renderer
 {
 namespace software
@@ -49,6 +53,12 @@ public:
         mir::geometry::Rectangle const& area,
         std::function<void(std::optional<time::Timestamp>)>&& callback) = 0;
 
+    /// As capture(), but renders directly into a dmabuf-backed buffer so the capture never passes through the CPU
+    virtual void capture_dmabuf(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        mir::geometry::Rectangle const& area,
+        std::function<void(std::optional<time::Timestamp>)>&& callback) = 0;
+
 private:
     ScreenShooter(ScreenShooter const&) = delete;
     ScreenShooter& operator=(ScreenShooter const&) = delete;
@@ -53,6 +53,7 @@ class Scene;
 class DisplayBufferCompositorFactory;
 class Compositor;
 class CompositorReport;
+class FrameClock;
 }
 namespace frontend
 {
@@ -111,6 +112,7 @@ class GLConfig;
 namespace input
 {
 class InputReport;
+class InputLatency;
 class SeatObserver;
 class Scene;
 class InputManager;
@@ -239,6 +241,7 @@ public:
     virtual std::shared_ptr<compositor::DisplayBufferCompositorFactory> the_display_buffer_compositor_factory();
     virtual std::shared_ptr<compositor::DisplayBufferCompositorFactory> wrap_display_buffer_compositor_factory(
         std::shared_ptr<compositor::DisplayBufferCompositorFactory> const& wrapped);
+    virtual std::shared_ptr<compositor::FrameClock> the_frame_clock();
     /** @} */
 
     /** @name compositor configuration - dependencies
@@ -308,6 +311,7 @@ public:
     /** @name input configuration
      *  @{ */
     virtual std::shared_ptr<input::InputReport> the_input_report();
+    virtual std::shared_ptr<input::InputLatency> the_input_latency();
     virtual std::shared_ptr<ObserverRegistrar<input::SeatObserver>> the_seat_observer_registrar();
     virtual std::shared_ptr<input::CompositeEventFilter> the_composite_event_filter();
 
@@ -368,6 +372,7 @@ protected:
     CachedPtr<frontend::DragIconController> drag_icon_controller;
 
     CachedPtr<input::InputReport> input_report;
+    CachedPtr<input::InputLatency> input_latency;
     CachedPtr<input::EventFilterChainDispatcher> event_filter_chain_dispatcher;
     CachedPtr<input::CompositeEventFilter> composite_event_filter;
     CachedPtr<input::InputManager>    input_manager;
@@ -406,6 +411,7 @@ protected:
     CachedPtr<compositor::Compositor> compositor;
     CachedPtr<compositor::CompositorReport> compositor_report;
     CachedPtr<compositor::ScreenShooter> screen_shooter;
+    CachedPtr<compositor::FrameClock> frame_clock;
     CachedPtr<logging::Logger> logger;
     CachedPtr<graphics::DisplayReport> display_report;
     CachedPtr<time::Clock> clock;
@@ -20,6 +20,7 @@
 #include <mir_toolkit/common.h>
 #include "mir/graphics/buffer_id.h"
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
 #include <functional>
 #include <memory>
 
@@ -39,7 +40,16 @@ class BufferStream
 public:
     virtual ~BufferStream() = default;
 
+    /// Submit a buffer, all of which may differ from the previous one
     virtual void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) = 0;
+    /**
+     * Submit a buffer that differs from the previously submitted one only within damage
+     *
+     * \param [in] damage  The changed region, in buffer coordinates
+     */
+    virtual void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) = 0;
 
     virtual void set_frame_posted_callback(
         std::function<void(geometry::Size const&)> const& callback) = 0;
@@ -0,0 +1,115 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_INPUT_INPUT_LATENCY_H_
+#define MIR_INPUT_INPUT_LATENCY_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace compositor
+{
+class CompositorReport;
+class FrameClock;
+}
+namespace graphics
+{
+struct Frame;
+}
+namespace input
+{
+class InputReport;
+
+/**
+ * Follows traced input events from the kernel to the screen.
+ *
+ * An input platform gives the events it reads a trace ID (see MirInputEvent::trace_id()). Once one
+ * has been sent to a client, the client's next commit, the compositor using that commit and the page
+ * flip that showed it are all noted against the ID, in the input and compositor reports. The time
+ * from each event to its presentation is collected into a histogram the shell can query.
+ */
+class InputLatency : public std::enable_shared_from_this<InputLatency>
+{
+public:
+    struct Trace
+    {
+        uint64_t id;
+        /// When the event happened, in CLOCK_MONOTONIC
+        std::chrono::nanoseconds event_time;
+    };
+
+    /// How long after the input events their responses were presented
+    struct Histogram
+    {
+        static constexpr std::chrono::nanoseconds bucket_width{std::chrono::milliseconds{1}};
+        static constexpr size_t bucket_count{100};
+
+        /// counts[i] responses were presented between i and i+1 bucket widths after their events.
+        /// The last bucket also counts any presented later than that.
+        std::array<uint64_t, bucket_count> counts{};
+        uint64_t samples{0};
+        /// Responses that were superseded by later commits before they could be presented
+        uint64_t discarded{0};
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds max{0};
+
+        auto mean() const -> std::chrono::nanoseconds;
+
+        /// The latency (to the bucket width) within which fraction (0, 1] of the responses were presented
+        auto percentile(double fraction) const -> std::chrono::nanoseconds;
+    };
+
+    InputLatency(
+        std::shared_ptr<compositor::FrameClock> const& frame_clock,
+        std::shared_ptr<InputReport> const& input_report,
+        std::shared_ptr<compositor::CompositorReport> const& compositor_report);
+
+    /// The traced event has been sent to a client
+    void sent(Trace const& trace);
+
+    /// The client has committed its response to the traced event
+    void committed(Trace const& trace);
+
+    /**
+     * A compositor has used the client's response (consumed is true), or it has been superseded (false).
+     *
+     * Consumed responses are followed to the next frame presented by the compositor that used them, so this
+     * should be called on that compositor's thread (which is where buffers are consumed).
+     */
+    void composited(Trace const& trace, bool consumed);
+
+    auto histogram() const -> Histogram;
+    void reset_histogram();
+
+private:
+    void presented(Trace const& trace, graphics::Frame const& frame);
+
+    std::shared_ptr<compositor::FrameClock> const frame_clock;
+    std::shared_ptr<InputReport> const input_report;
+    std::shared_ptr<compositor::CompositorReport> const compositor_report;
+
+    std::mutex mutable mutex;
+    Histogram histogram_;
+};
+}
+}
+
+#endif // MIR_INPUT_INPUT_LATENCY_H_
@@ -27,6 +27,7 @@
 
 #include <vector>
 #include <list>
+#include <optional>
 
 namespace mir
 {
@@ -40,6 +41,8 @@ struct StreamInfo
     std::shared_ptr<compositor::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    /// The parts of the stream's content the client promises are opaque, relative to the stream (if known)
+    std::optional<std::vector<geometry::Rectangle>> opaque_region{};
 };
 
 class SurfaceObserver;
@@ -65,6 +68,12 @@ public:
     virtual geometry::Size window_size() const = 0;
 
     virtual graphics::RenderableList generate_renderables(compositor::CompositorID id) const = 0; 
+    /// Append what generate_renderables() would return to renderables (so their storage can be reused)
+    virtual void append_renderables(compositor::CompositorID id, graphics::RenderableList& renderables) const
+    {
+        auto const generated = generate_renderables(id);
+        renderables.insert(renderables.end(), generated.begin(), generated.end());
+    }
     virtual int buffers_ready_for_compositor(void const* compositor_id) const = 0;
 
     virtual MirWindowType type() const = 0;
@@ -88,6 +97,13 @@ public:
      * set_input_region({Rectangle{}}).
      */
     virtual void set_input_region(std::vector<geometry::Rectangle> const& region) = 0;
+    /**
+     * A rectangle containing every point input_area_contains() could accept, in the same coordinates.
+     *
+     * This lets the scene skip surfaces that can't be under a point without asking them. The default
+     * (std::nullopt) means the bounds are unknown, and input_area_contains() is always asked.
+     */
+    virtual auto input_area_bounds() const -> std::optional<geometry::Rectangle> { return std::nullopt; }
     /// Given value is the frame size of the window
     virtual void resize(geometry::Size const& window_size) = 0;
     virtual void set_transformation(glm::mat4 const& t) = 0;
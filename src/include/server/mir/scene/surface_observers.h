@@ -50,6 +50,7 @@ public:
     void placed_relative(Surface const* surf, geometry::Rectangle const& placement) override;
     void input_consumed(Surface const* surf, std::shared_ptr<MirEvent const> const& event) override;
     void depth_layer_set_to(Surface const* surf, MirDepthLayer depth_layer) override;
+    void input_region_set_to(Surface const* surf, std::vector<geometry::Rectangle> const& region) override;
     void application_id_set_to(Surface const* surf, std::string const& application_id) override;
 };
 
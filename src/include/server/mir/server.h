@@ -34,7 +34,7 @@ class ObserverRegistrar;
 
 namespace compositor { class Compositor; class DisplayBufferCompositorFactory; class CompositorReport; }
 namespace graphics { class Cursor; class DisplayPlatform; class RenderingPlatform; class Display; class GLConfig; class DisplayConfigurationPolicy; class DisplayConfigurationObserver; }
-namespace input { class CompositeEventFilter; class InputDispatcher; class CursorListener; class CursorImages; class TouchVisualizer; class InputDeviceHub;}
+namespace input { class CompositeEventFilter; class InputDispatcher; class CursorListener; class CursorImages; class TouchVisualizer; class InputDeviceHub; class InputLatency;}
 namespace logging { class Logger; }
 namespace options { class Option; }
 namespace frontend
@@ -409,6 +409,9 @@ public:
     /// \return the input device hub
     auto the_input_device_hub() const -> std::shared_ptr<input::InputDeviceHub>;
 
+    /// \return the latency of traced input events, from the kernel to the screen.
+    auto the_input_latency() const -> std::shared_ptr<input::InputLatency>;
+
     /// \return the application not responding detector
     auto the_application_not_responding_detector() const ->
         std::shared_ptr<scene::ApplicationNotRespondingDetector>;
@@ -28,6 +28,8 @@
 
 #include <string>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace mir
 {
@@ -49,6 +51,8 @@ struct StreamSpecification
     std::weak_ptr<frontend::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    /// The parts of the stream's content the client promises are opaque, relative to the stream (if known)
+    std::optional<std::vector<geometry::Rectangle>> opaque_region{};
 };
 auto operator==(StreamSpecification const& lhs, StreamSpecification const& rhs) -> bool;
 
@@ -53,6 +53,9 @@ public:
   void
   reception_mode_set_to(mir::scene::Surface const * /*surf*/,
                         mir::input::InputReceptionMode /*mode*/) override{};
+  void
+  input_region_set_to(mir::scene::Surface const * /*surf*/,
+                      std::vector<mir::geometry::Rectangle> const& /*region*/) override{};
   void renamed(mir::scene::Surface const *surf, std::string const& name) override;
   void transformation_set_to(mir::scene::Surface const *surf,
                              glm::mat4 const &t) override;
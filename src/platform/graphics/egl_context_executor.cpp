@@ -53,13 +53,22 @@ void mgc::EGLContextExecutor::process_loop(mgc::EGLContextExecutor* const me)
     std::unique_lock lock{me->mutex};
     while (!me->shutdown_requested)
     {
-        for (auto& work : me->work_queue)
+        // Run the work without holding the lock, so that (potentially slow) work such as
+        // texture uploads doesn't block the threads calling spawn()
+        std::vector<std::function<void()>> work_batch;
+        swap(work_batch, me->work_queue);
+        lock.unlock();
+        for (auto& work : work_batch)
         {
             work();
         }
-        me->work_queue.clear();
+        work_batch.clear();
+        lock.lock();
 
-        me->new_work.wait(lock);
+        if (me->work_queue.empty() && !me->shutdown_requested)
+        {
+            me->new_work.wait(lock);
+        }
     }
 
     // Drain the work-queue
@@ -26,6 +26,7 @@ namespace mo = mir::options;
 char const* const mo::arw_server_socket_opt       = "arw-file";
 char const* const mo::enable_input_opt            = "enable-input,i";
 char const* const mo::compositor_report_opt       = "compositor-report";
+char const* const mo::compositor_timeline_file_opt = "compositor-timeline-file";
 char const* const mo::display_report_opt          = "display-report";
 char const* const mo::scene_report_opt            = "scene-report";
 char const* const mo::input_report_opt            = "input-report";
@@ -37,6 +38,7 @@ char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
+char const* const mo::composite_margin_opt        = "composite-margin";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
 char const* const mo::x11_display_opt             = "enable-x11";
 char const* const mo::x11_scale_opt               = "x11-scale";
@@ -44,10 +46,13 @@ char const* const mo::wayland_extensions_opt      = "wayland-extensions";
 char const* const mo::add_wayland_extensions_opt  = "add-wayland-extensions";
 char const* const mo::drop_wayland_extensions_opt = "drop-wayland-extensions";
 char const* const mo::idle_timeout_opt            = "idle-timeout";
+char const* const mo::async_logging_opt           = "async-logging";
+char const* const mo::coalesce_pointer_motion_opt = "coalesce-pointer-motion";
 
 char const* const mo::off_opt_value = "off";
 char const* const mo::log_opt_value = "log";
 char const* const mo::lttng_opt_value = "lttng";
+char const* const mo::timeline_opt_value = "timeline";
 
 char const* const mo::platform_display_libs = "platform-display-libs";
 char const* const mo::platform_rendering_libs = "platform-rendering-libs";
@@ -151,7 +156,11 @@ mo::DefaultConfiguration::DefaultConfiguration(
         (enable_input_opt, po::value<bool>()->default_value(enable_input_default),
             "Enable input.")
         (compositor_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "Compositor reporting [{log,lttng,off}]")
+            "Compositor reporting [{log,lttng,timeline,off}]. The timeline records the "
+            "stages of recent frames, and writes them (as a Chrome trace) to the "
+            "compositor-timeline-file on SIGUSR2.")
+        (compositor_timeline_file_opt, po::value<std::string>()->default_value("mir-compositor-timeline.json"),
+            "Where to write the compositor timeline (see compositor-report)")
         (display_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Display report. [{log,lttng,off}]")
         (input_report_opt, po::value<std::string>()->default_value(off_opt_value),
@@ -164,11 +173,17 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "How to handle the SharedLibraryProber report. [{log,lttng,off}]")
         (shell_report_opt, po::value<std::string>()->default_value(off_opt_value),
          "How to handle the Shell report. [{log,off}]")
-        (composite_delay_opt, po::value<int>()->default_value(0),
+        (composite_delay_opt, po::value<int>()->default_value(-1),
             "Compositor frame delay in milliseconds (how long to wait for new "
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
-            "Default: A negative value means decide automatically.")
+            "Default: A negative value means decide automatically, from the "
+            "timing of each output's vblanks where the platform reports it.")
+        (composite_margin_opt, po::value<int>()->default_value(2),
+            "When deciding automatically, how long in milliseconds (on top of "
+            "the measured render time) before the predicted vblank to start "
+            "compositing. Higher values risk fewer missed frames, at the cost "
+            "of latency.")
         (touchspots_opt,
             "Display visualization of touchspots (e.g. for screencasting).")
         (cursor_opt,
@@ -176,11 +191,19 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Cursor (mouse pointer) to use [{auto,null,software}]")
         (enable_key_repeat_opt, po::value<bool>()->default_value(true),
              "Enable server generated key repeat")
+        (coalesce_pointer_motion_opt, po::value<int>()->default_value(0),
+            "Deliver pointer motion and scrolling at most once every this many "
+            "milliseconds (e.g. 16 to match a 60Hz display), merging the motion "
+            "in between. Button, key and touch events are never held back. "
+            "0 delivers every event as it arrives.")
         (idle_timeout_opt, po::value<int>()->default_value(0),
             "Time (in seconds) Mir will remain idle before turning off the display, "
             "or 0 to keep display on forever.")
         (fatal_except_opt, "On \"fatal error\" conditions [e.g. drivers behaving "
             "in unexpected ways] throw an exception (instead of a core dump)")
+        (async_logging_opt, "Write log messages from a background thread, so that logging "
+            "doesn't hold up the thread doing it. Messages are dropped (and counted) if a "
+            "thread logs faster than they can be written.")
         (debug_opt, "Enable extra development debugging. "
             "This is only interesting for people doing Mir server or client development.")
         (console_provider,
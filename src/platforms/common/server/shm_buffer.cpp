@@ -26,9 +26,14 @@
 
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
 
 #include <boost/throw_exception.hpp>
 
+#include <condition_variable>
+#include <optional>
+#include <sstream>
 #include <string.h>
 #include <endian.h>
 
@@ -95,9 +100,9 @@ mgc::ShmBuffer::ShmBuffer(
     geom::Size const& size,
     MirPixelFormat const& format,
     std::shared_ptr<EGLContextExecutor> egl_delegate)
-    : size_{size},
-      pixel_format_{format},
-      egl_delegate{std::move(egl_delegate)}
+    : egl_delegate{std::move(egl_delegate)},
+      size_{size},
+      pixel_format_{format}
 {
 }
 
@@ -287,6 +292,250 @@ void mgc::ShmBuffer::add_syncpoint()
 {
 }
 
+namespace
+{
+auto has_extension(char const* extensions, char const* name) -> bool
+{
+    if (!extensions)
+        return false;
+
+    std::istringstream tokens{extensions};
+    std::string token;
+    while (tokens >> token)
+    {
+        if (token == name)
+            return true;
+    }
+    return false;
+}
+
+/// The entry points needed to stage texture uploads through a pixel-unpack buffer
+struct PixelUnpackBuffer
+{
+    PFNGLMAPBUFFERRANGEEXTPROC const map_range;
+    PFNGLUNMAPBUFFEROESPROC const unmap;
+};
+
+/// \note This must be called with a current GL context
+auto pixel_unpack_buffer_support() -> std::optional<PixelUnpackBuffer>
+{
+    auto const version = reinterpret_cast<char const*>(glGetString(GL_VERSION));
+    auto const extensions = reinterpret_cast<char const*>(glGetString(GL_EXTENSIONS));
+
+    void (*map_range)(){nullptr};
+    void (*unmap)(){nullptr};
+    if (version && strncmp(version, "OpenGL ES 3", strlen("OpenGL ES 3")) == 0)
+    {
+        // Pixel-unpack buffers and buffer mapping are core in GLES 3.0, with the same enums
+        map_range = eglGetProcAddress("glMapBufferRange");
+        unmap = eglGetProcAddress("glUnmapBuffer");
+    }
+    else if (has_extension(extensions, "GL_NV_pixel_buffer_object") &&
+             has_extension(extensions, "GL_EXT_map_buffer_range"))
+    {
+        map_range = eglGetProcAddress("glMapBufferRangeEXT");
+        unmap = eglGetProcAddress("glUnmapBufferOES");
+    }
+
+    if (!map_range || !unmap)
+        return std::nullopt;
+
+    return PixelUnpackBuffer{
+        reinterpret_cast<PFNGLMAPBUFFERRANGEEXTPROC>(map_range),
+        reinterpret_cast<PFNGLUNMAPBUFFEROESPROC>(unmap)};
+}
+
+/**
+ * Upload mapping into the currently bound texture
+ *
+ * Where possible the pixels are staged through a pixel-unpack buffer, so that
+ * glTexImage2D() can return before the GL has finished reading them.
+ *
+ * \note This must be called with a current GL context
+ */
+void upload_pixels(mrs::Mapping<unsigned char const>& mapping, GLenum format, GLenum type)
+{
+    // The result depends only on the context, and each EGLContextExecutor thread has exactly one
+    thread_local auto const unpack_buffer = pixel_unpack_buffer_support();
+
+    // As in ShmBuffer::upload_to_texture() we assume that stride is a multiple of whole pixels
+    glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, mapping.stride().as_int() / MIR_BYTES_PER_PIXEL(mapping.format()));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    void const* pixels = mapping.data();
+    GLuint staging_buffer{0};
+    if (unpack_buffer)
+    {
+        glGenBuffers(1, &staging_buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER_NV, staging_buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER_NV, mapping.len(), nullptr, GL_STREAM_DRAW);
+
+        if (auto const staging = unpack_buffer->map_range(
+                GL_PIXEL_UNPACK_BUFFER_NV, 0, mapping.len(),
+                GL_MAP_WRITE_BIT_EXT | GL_MAP_INVALIDATE_BUFFER_BIT_EXT))
+        {
+            memcpy(staging, mapping.data(), mapping.len());
+            if (unpack_buffer->unmap(GL_PIXEL_UNPACK_BUFFER_NV))
+            {
+                pixels = nullptr;   // That is, offset 0 into the bound unpack buffer
+            }
+        }
+
+        if (pixels)
+        {
+            // Staging failed; fall back to uploading from client memory
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER_NV, 0);
+        }
+    }
+
+    auto const size = mapping.size();
+    glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        format,
+        size.width.as_int(), size.height.as_int(),
+        0,
+        format,
+        type,
+        pixels);
+
+    if (staging_buffer)
+    {
+        // The GL keeps the storage alive until the upload has completed
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER_NV, 0);
+        glDeleteBuffers(1, &staging_buffer);
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+}
+
+/**
+ * A texture upload running on the EGLContextExecutor
+ *
+ * This is shared between the buffer and the work queued on the executor, so that
+ * neither depends on the lifetime of the other.
+ */
+struct mgc::MappableBackedShmBuffer::AsyncUpload
+{
+    /// \note Called on the EGLContextExecutor thread
+    void run(mrs::ReadMappableBuffer& data)
+    {
+        GLuint id{0};
+        GLenum format, type;
+        if (mg::get_gl_pixel_format(data.format(), format, type))
+        {
+            auto const mapping = data.map_readable();
+
+            glGenTextures(1, &id);
+            glBindTexture(GL_TEXTURE_2D, id);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            upload_pixels(*mapping, format, type);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            insert_fence();
+        }
+
+        {
+            std::lock_guard lock{mutex};
+            tex_id = id;
+            done = true;
+        }
+        completed.notify_all();
+    }
+
+    /**
+     * Wait for run() to complete, and for the GL to have finished the upload
+     *
+     * \note   This must be called with a current GL context
+     * \return The texture, or 0 if the buffer could not be uploaded
+     */
+    auto wait_for_texture() -> GLuint
+    {
+        std::unique_lock lock{mutex};
+        completed.wait(lock, [this] { return done; });
+
+        if (fence != EGL_NO_SYNC_KHR && !fence_signalled)
+        {
+            if (wait_sync)
+            {
+                // Have the GPU wait for the upload, rather than blocking this thread
+                wait_sync(display, fence, 0);
+            }
+            else
+            {
+                client_wait_sync(display, fence, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR);
+                fence_signalled = true;
+            }
+        }
+
+        return tex_id;
+    }
+
+    /// \note Called on the EGLContextExecutor thread
+    void release()
+    {
+        std::lock_guard lock{mutex};
+        if (tex_id != 0)
+            glDeleteTextures(1, &tex_id);
+        if (fence != EGL_NO_SYNC_KHR)
+            destroy_sync(display, fence);
+    }
+
+private:
+    void insert_fence()
+    {
+        auto const current_display = eglGetCurrentDisplay();
+        auto const extensions = eglQueryString(current_display, EGL_EXTENSIONS);
+
+        if (has_extension(extensions, "EGL_KHR_fence_sync"))
+        {
+            auto const create_sync =
+                reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"));
+            destroy_sync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"));
+            client_wait_sync =
+                reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(eglGetProcAddress("eglClientWaitSyncKHR"));
+            if (has_extension(extensions, "EGL_KHR_wait_sync"))
+            {
+                wait_sync = reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(eglGetProcAddress("eglWaitSyncKHR"));
+            }
+
+            if (create_sync && destroy_sync && client_wait_sync)
+            {
+                display = current_display;
+                fence = create_sync(display, EGL_SYNC_FENCE_KHR, nullptr);
+            }
+        }
+
+        if (fence != EGL_NO_SYNC_KHR)
+        {
+            // Make sure the fence gets to the GPU before anyone waits on it from another context
+            glFlush();
+        }
+        else
+        {
+            // Without a fence, the best we can do is to complete the upload here
+            glFinish();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable completed;
+    bool done{false};
+    GLuint tex_id{0};
+
+    EGLDisplay display{EGL_NO_DISPLAY};
+    EGLSyncKHR fence{EGL_NO_SYNC_KHR};
+    bool fence_signalled{false};
+    PFNEGLDESTROYSYNCKHRPROC destroy_sync{nullptr};
+    PFNEGLCLIENTWAITSYNCKHRPROC client_wait_sync{nullptr};
+    PFNEGLWAITSYNCKHRPROC wait_sync{nullptr};
+};
+
 mgc::MappableBackedShmBuffer::MappableBackedShmBuffer(
     std::shared_ptr<mrs::RWMappableBuffer> data,
     std::shared_ptr<EGLContextExecutor> egl_delegate)
@@ -295,6 +544,18 @@ mgc::MappableBackedShmBuffer::MappableBackedShmBuffer(
 {
 }
 
+mgc::MappableBackedShmBuffer::~MappableBackedShmBuffer() noexcept
+{
+    if (async_upload)
+    {
+        egl_delegate->spawn(
+            [upload = std::move(async_upload)]()
+            {
+                upload->release();
+            });
+    }
+}
+
 auto mgc::MappableBackedShmBuffer::map_writeable() -> std::unique_ptr<mrs::Mapping<unsigned char>>
 {
     return data->map_writeable();
@@ -312,6 +573,20 @@ auto mgc::MappableBackedShmBuffer::map_rw() -> std::unique_ptr<mrs::Mapping<unsi
 
 void mgc::MappableBackedShmBuffer::bind()
 {
+    std::shared_ptr<AsyncUpload> upload;
+    {
+        std::lock_guard lock{uploaded_mutex};
+        upload = async_upload;
+    }
+    if (upload)
+    {
+        if (auto const id = upload->wait_for_texture())
+        {
+            glBindTexture(GL_TEXTURE_2D, id);
+            return;
+        }
+    }
+
     mgc::ShmBuffer::bind();
     std::lock_guard lock{uploaded_mutex};
     if (!uploaded)
@@ -322,6 +597,26 @@ void mgc::MappableBackedShmBuffer::bind()
     }
 }
 
+void mgc::MappableBackedShmBuffer::prepare()
+{
+    std::lock_guard lock{uploaded_mutex};
+    if (uploaded || async_upload)
+    {
+        return;
+    }
+
+    async_upload = std::make_shared<AsyncUpload>();
+
+    // Map data directly, rather than through map_readable(), which subclasses may
+    // treat as the buffer having been consumed
+    egl_delegate->spawn(
+        [upload = async_upload, data = data]() mutable
+        {
+            upload->run(*data);
+            data.reset();   // Don't keep the client's buffer alive until the whole work queue is drained
+        });
+}
+
 auto mgc::MappableBackedShmBuffer::format() const -> MirPixelFormat
 {
     return data->format();
@@ -65,10 +65,11 @@ protected:
 
     /// \note This must be called with a current GL context
     void upload_to_texture(void const* pixels, geometry::Stride const& stride);
+
+    std::shared_ptr<EGLContextExecutor> const egl_delegate;
 private:
     geometry::Size const size_;
     MirPixelFormat const pixel_format_;
-    std::shared_ptr<EGLContextExecutor> const egl_delegate;
     std::mutex tex_id_mutex;
     GLuint tex_id{0};
 };
@@ -118,12 +119,22 @@ public:
         std::shared_ptr<renderer::software::RWMappableBuffer> data,
         std::shared_ptr<EGLContextExecutor> egl_delegate);
 
+    ~MappableBackedShmBuffer() noexcept override;
+
     auto map_writeable() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
     auto map_readable() -> std::unique_ptr<renderer::software::Mapping<unsigned char const>> override;
     auto map_rw() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
 
     void bind() override;
 
+    /**
+     * Start uploading the buffer content to a texture on the EGLContextExecutor
+     *
+     * The upload goes through a pixel-unpack buffer where the GL supports one, and is
+     * followed by a fence; a subsequent bind() waits on the fence rather than uploading.
+     */
+    void prepare() override;
+
     auto format() const -> MirPixelFormat override;
     auto stride() const -> geometry::Stride override;
     auto size() const -> geometry::Size override;
@@ -131,9 +142,12 @@ public:
     MappableBackedShmBuffer(MappableBackedShmBuffer const&) = delete;
     MappableBackedShmBuffer& operator=(MappableBackedShmBuffer const&) = delete;
 private:
+    struct AsyncUpload;
+
     std::shared_ptr<renderer::software::RWMappableBuffer> const data;
     std::mutex uploaded_mutex;
     bool uploaded{false};
+    std::shared_ptr<AsyncUpload> async_upload;
 };
 
 class NotifyingMappableBackedShmBuffer : public MappableBackedShmBuffer
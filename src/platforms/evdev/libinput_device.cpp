@@ -26,6 +26,7 @@
 #include "mir/input/touchpad_settings.h"
 #include "mir/input/input_device_info.h"
 #include "mir/events/event_builders.h"
+#include "mir/events/input_event.h"
 #include "mir/geometry/displacement.h"
 #include "mir/dispatch/dispatchable.h"
 #include "mir/fd.h"
@@ -42,6 +43,7 @@
 #include <chrono>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 
 namespace md = mir::dispatch;
 namespace mi = mir::input;
@@ -69,6 +71,19 @@ double orientation(libinput_event_touch*)
     return 0;
 }
 
+/// Shared by all devices, so that IDs are unique in the process
+std::atomic<uint64_t> next_trace_id{1};
+
+/// Gives event an ID with which it can be followed through the server, to a client and onto the screen
+auto traced(mir::EventUPtr event, mi::InputReport& report) -> mir::EventUPtr
+{
+    auto const input_event = event->to_input();
+    auto const trace_id = next_trace_id.fetch_add(1, std::memory_order_relaxed);
+    input_event->set_trace_id(trace_id);
+    report.received_traced_event(trace_id, input_event->event_time().count());
+    return event;
+}
+
 template<typename T> auto load_function(char const* sym)
 {
     T result{};
@@ -209,16 +224,16 @@ void mie::LibInputDevice::process_event(libinput_event* event)
         switch(libinput_event_get_type(event))
         {
         case LIBINPUT_EVENT_KEYBOARD_KEY:
-            sink->handle_input(convert_event(libinput_event_get_keyboard_event(event)));
+            sink->handle_input(traced(convert_event(libinput_event_get_keyboard_event(event)), *report));
             break;
         case LIBINPUT_EVENT_POINTER_MOTION:
-            sink->handle_input(convert_motion_event(libinput_event_get_pointer_event(event)));
+            sink->handle_input(traced(convert_motion_event(libinput_event_get_pointer_event(event)), *report));
             break;
         case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
-            sink->handle_input(convert_absolute_motion_event(libinput_event_get_pointer_event(event)));
+            sink->handle_input(traced(convert_absolute_motion_event(libinput_event_get_pointer_event(event)), *report));
             break;
         case LIBINPUT_EVENT_POINTER_BUTTON:
-            sink->handle_input(convert_button_event(libinput_event_get_pointer_event(event)));
+            sink->handle_input(traced(convert_button_event(libinput_event_get_pointer_event(event)), *report));
             break;
 #ifdef MIR_LIBINPUT_HAS_VALUE120
         case LIBINPUT_EVENT_POINTER_SCROLL_WHEEL:
@@ -233,7 +248,7 @@ void mie::LibInputDevice::process_event(libinput_event* event)
         */
         case LIBINPUT_EVENT_POINTER_AXIS:
 #endif
-            sink->handle_input(convert_axis_event(libinput_event_get_pointer_event(event)));
+            sink->handle_input(traced(convert_axis_event(libinput_event_get_pointer_event(event)), *report));
             break;
         // touch events are processed as a batch of changes over all touch pointts
         case LIBINPUT_EVENT_TOUCH_DOWN:
@@ -253,7 +268,7 @@ void mie::LibInputDevice::process_event(libinput_event* event)
             {
                 if (auto input = convert_touch_frame(libinput_event_get_touch_event(event)))
                 {
-                    sink->handle_input(std::move(input));
+                    sink->handle_input(traced(std::move(input), *report));
                 }
             }
             break;
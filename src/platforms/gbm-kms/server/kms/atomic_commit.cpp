@@ -0,0 +1,87 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atomic_commit.h"
+
+#include <boost/throw_exception.hpp>
+#include <xf86drm.h>
+
+#include <new>
+#include <stdexcept>
+
+namespace mgg = mir::graphics::gbm;
+
+mgg::AtomicCommit::AtomicCommit(int drm_fd)
+    : drm_fd_{drm_fd},
+      request{drmModeAtomicAlloc(), &drmModeAtomicFree}
+{
+    if (!request)
+        BOOST_THROW_EXCEPTION(std::bad_alloc());
+}
+
+auto mgg::AtomicCommit::drm_fd() const -> int
+{
+    return drm_fd_;
+}
+
+void mgg::AtomicCommit::add_property(uint32_t object_id, uint32_t property_id, uint64_t value)
+{
+    if (drmModeAtomicAddProperty(request.get(), object_id, property_id, value) < 0)
+        BOOST_THROW_EXCEPTION(std::bad_alloc());
+}
+
+void mgg::AtomicCommit::add_target(
+    std::shared_ptr<PageFlipper> const& flipper,
+    PageFlipper::Target const& target,
+    std::function<void()> const& on_scheduled)
+{
+    if (this->flipper && this->flipper != flipper)
+        BOOST_THROW_EXCEPTION(std::logic_error("Atomic commit targets must share a page flipper"));
+
+    this->flipper = flipper;
+    targets.push_back(target);
+    this->on_scheduled.push_back(on_scheduled);
+}
+
+auto mgg::AtomicCommit::commit(uint32_t flags) -> int
+{
+    return drmModeAtomicCommit(drm_fd_, request.get(), flags, nullptr);
+}
+
+bool mgg::AtomicCommit::schedule()
+{
+    if (targets.empty())
+        return true;
+
+    auto const scheduled = flipper->schedule_commit(
+        targets,
+        [this](void* user_data)
+        {
+            return drmModeAtomicCommit(
+                drm_fd_,
+                request.get(),
+                DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT,
+                user_data);
+        });
+
+    if (scheduled)
+    {
+        for (auto const& notify : on_scheduled)
+            notify();
+    }
+
+    return scheduled;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_ATOMIC_COMMIT_H_
+#define MIR_GRAPHICS_GBM_ATOMIC_COMMIT_H_
+
+#include "page_flipper.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <xf86drmMode.h>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+
+/**
+ * An atomic KMS request, which may change the state of several outputs on one DRM device.
+ *
+ * Outputs add the properties they need to change, and register the CRTC each of them
+ * flips, so that a single commit updates all of them in the same vblank.
+ */
+class AtomicCommit
+{
+public:
+    /// \throws std::bad_alloc if the request can't be allocated
+    explicit AtomicCommit(int drm_fd);
+
+    auto drm_fd() const -> int;
+
+    void add_property(uint32_t object_id, uint32_t property_id, uint64_t value);
+
+    /**
+     * Note that this commit flips crtc_id, so that schedule() waits on it.
+     *
+     * \param [in] on_scheduled Called once the commit has been successfully scheduled
+     * \throws std::logic_error if flipper is not the page flipper of earlier targets
+     */
+    void add_target(
+        std::shared_ptr<PageFlipper> const& flipper,
+        PageFlipper::Target const& target,
+        std::function<void()> const& on_scheduled);
+
+    /// Apply the commit synchronously; returns 0 or -errno
+    auto commit(uint32_t flags) -> int;
+
+    /**
+     * Apply the commit at the next vblank through the page flipper of the targets.
+     *
+     * A commit with no targets has nothing to flip and trivially succeeds.
+     */
+    bool schedule();
+
+private:
+    int const drm_fd_;
+    std::unique_ptr<drmModeAtomicReq, void(*)(drmModeAtomicReqPtr)> const request;
+
+    std::shared_ptr<PageFlipper> flipper;
+    std::vector<PageFlipper::Target> targets;
+    std::vector<std::function<void()>> on_scheduled;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_GBM_ATOMIC_COMMIT_H_ */
@@ -0,0 +1,435 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atomic_kms_output.h"
+#include "atomic_commit.h"
+#include "fb_handle.h"
+#include "kms-utils/kms_connector.h"
+#include "mir/fatal.h"
+#include "mir/log.h"
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace mgg = mir::graphics::gbm;
+namespace mgk = mir::graphics::kms;
+namespace geom = mir::geometry;
+
+mgg::AtomicKMSOutput::AtomicKMSOutput(
+    int drm_fd,
+    kms::DRMModeConnectorUPtr&& connector,
+    std::shared_ptr<PageFlipper> const& page_flipper)
+    : RealKMSOutput{drm_fd, std::move(connector), page_flipper}
+{
+}
+
+mgg::AtomicKMSOutput::~AtomicKMSOutput()
+{
+    // RealKMSOutput restores the saved CRTC with the legacy API, which doesn't know about overlays
+    disable_active_planes();
+
+    if (mode_blob)
+        drmModeDestroyPropertyBlob(drm_fd_, *mode_blob);
+}
+
+bool mgg::AtomicKMSOutput::set_crtc(FBHandle const& fb)
+{
+    if (!ensure_crtc())
+    {
+        mir::log_error("Output %s has no associated CRTC to set a framebuffer on",
+                       mgk::connector_name(connector).c_str());
+        return false;
+    }
+
+    auto const primary = primary_plane();
+    if (!primary)
+        return RealKMSOutput::set_crtc(fb);
+
+    uint32_t new_mode_blob;
+    if (auto const result = drmModeCreatePropertyBlob(
+            drm_fd_, &connector->modes[mode_index], sizeof(drmModeModeInfo), &new_mode_blob))
+    {
+        mir::log_error("Failed to create mode blob for output %s: %s",
+                       mgk::connector_name(connector).c_str(), strerror(-result));
+        return false;
+    }
+
+    int result;
+    try
+    {
+        AtomicCommit commit{drm_fd_};
+        auto const crtc_id = current_crtc->crtc_id;
+        auto const& crtc_properties = properties_of(crtc_id, DRM_MODE_OBJECT_CRTC);
+        auto const& connector_properties = properties_of(connector->connector_id, DRM_MODE_OBJECT_CONNECTOR);
+
+        commit.add_property(crtc_id, crtc_properties.id_for("MODE_ID"), new_mode_blob);
+        commit.add_property(crtc_id, crtc_properties.id_for("ACTIVE"), 1);
+        commit.add_property(connector->connector_id, connector_properties.id_for("CRTC_ID"), crtc_id);
+        add_planes(commit, whole_output(fb, *primary));
+
+        result = commit.commit(DRM_MODE_ATOMIC_ALLOW_MODESET);
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_warning("Falling back to legacy modesetting for output %s: %s",
+                         mgk::connector_name(connector).c_str(), error.what());
+        drmModeDestroyPropertyBlob(drm_fd_, new_mode_blob);
+        disable_active_planes();
+        return RealKMSOutput::set_crtc(fb);
+    }
+
+    if (result)
+    {
+        drmModeDestroyPropertyBlob(drm_fd_, new_mode_blob);
+        current_crtc = nullptr;
+        return false;
+    }
+
+    // The kernel holds its own reference to the mode it is displaying
+    if (mode_blob)
+        drmModeDestroyPropertyBlob(drm_fd_, *mode_blob);
+    mode_blob = new_mode_blob;
+
+    active_planes.clear();
+    using_saved_crtc = false;
+    return true;
+}
+
+void mgg::AtomicKMSOutput::clear_crtc()
+{
+    try
+    {
+        if (!ensure_crtc())
+            return;
+    }
+    catch (...)
+    {
+        // As for RealKMSOutput: without a CRTC the output cannot be displaying anything
+        return;
+    }
+
+    auto const primary = primary_plane();
+    if (!primary)
+    {
+        RealKMSOutput::clear_crtc();
+        return;
+    }
+
+    int result;
+    try
+    {
+        AtomicCommit commit{drm_fd_};
+        auto const crtc_id = current_crtc->crtc_id;
+        auto const& crtc_properties = properties_of(crtc_id, DRM_MODE_OBJECT_CRTC);
+        auto const& connector_properties = properties_of(connector->connector_id, DRM_MODE_OBJECT_CONNECTOR);
+        auto const& primary_properties = properties_of(*primary, DRM_MODE_OBJECT_PLANE);
+
+        commit.add_property(crtc_id, crtc_properties.id_for("ACTIVE"), 0);
+        commit.add_property(crtc_id, crtc_properties.id_for("MODE_ID"), 0);
+        commit.add_property(connector->connector_id, connector_properties.id_for("CRTC_ID"), 0);
+        commit.add_property(*primary, primary_properties.id_for("FB_ID"), 0);
+        commit.add_property(*primary, primary_properties.id_for("CRTC_ID"), 0);
+        add_planes(commit, {});
+
+        result = commit.commit(DRM_MODE_ATOMIC_ALLOW_MODESET);
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_warning("Falling back to legacy modesetting for output %s: %s",
+                         mgk::connector_name(connector).c_str(), error.what());
+        disable_active_planes();
+        RealKMSOutput::clear_crtc();
+        return;
+    }
+
+    if (result)
+    {
+        if (result == -EACCES || result == -EPERM)
+        {
+            // As for RealKMSOutput: whatever we're switching to can handle the CRTCs
+            mir::log_info("Couldn't clear output %s (drmModeAtomicCommit: %s (%i))",
+                mgk::connector_name(connector).c_str(),
+                strerror(-result),
+                -result);
+        }
+        else
+        {
+            fatal_error("Couldn't clear output %s (drmModeAtomicCommit = %d)",
+                        mgk::connector_name(connector).c_str(), result);
+        }
+    }
+    else
+    {
+        active_planes.clear();
+    }
+
+    if (mode_blob)
+    {
+        drmModeDestroyPropertyBlob(drm_fd_, *mode_blob);
+        mode_blob = std::nullopt;
+    }
+
+    current_crtc = nullptr;
+}
+
+bool mgg::AtomicKMSOutput::schedule_page_flip(FBHandle const& fb)
+{
+    if (auto const primary = primary_plane())
+        return schedule_page_flip(whole_output(fb, *primary));
+
+    return RealKMSOutput::schedule_page_flip(fb);
+}
+
+auto mgg::AtomicKMSOutput::planes() -> std::vector<KMSPlane> const&
+{
+    static std::vector<KMSPlane> const no_planes;
+
+    if (!ensure_crtc())
+        return no_planes;
+
+    if (!crtc_planes || crtc_planes_crtc_id != current_crtc->crtc_id)
+    {
+        try
+        {
+            crtc_planes = KMSPlane::planes_for_crtc(drm_fd_, current_crtc->crtc_id);
+        }
+        catch (std::exception const& error)
+        {
+            mir::log_warning("Failed to enumerate planes of output %s: %s",
+                             mgk::connector_name(connector).c_str(), error.what());
+            crtc_planes.emplace();
+        }
+        crtc_planes_crtc_id = current_crtc->crtc_id;
+    }
+
+    return *crtc_planes;
+}
+
+bool mgg::AtomicKMSOutput::test_planes(PlaneConfiguration const& configuration)
+{
+    if (!current_crtc)
+        return false;
+
+    try
+    {
+        AtomicCommit commit{drm_fd_};
+        add_planes(commit, configuration);
+        return commit.commit(DRM_MODE_ATOMIC_TEST_ONLY) == 0;
+    }
+    catch (std::exception const&)
+    {
+        return false;
+    }
+}
+
+bool mgg::AtomicKMSOutput::schedule_page_flip(PlaneConfiguration const& configuration)
+{
+    std::unique_lock lg(power_mutex);
+    if (power_mode != mir_power_mode_on)
+        return true;
+    if (!current_crtc)
+    {
+        mir::log_error("Output %s has no associated CRTC to schedule page flips on",
+                       mgk::connector_name(connector).c_str());
+        return false;
+    }
+
+    try
+    {
+        AtomicCommit commit{drm_fd_};
+        add_flip(commit, configuration);
+        return commit.schedule();
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_error("Failed to schedule page flip on output %s: %s",
+                       mgk::connector_name(connector).c_str(), error.what());
+        return false;
+    }
+}
+
+bool mgg::AtomicKMSOutput::add_page_flip(AtomicCommit& commit, FBHandle const& fb)
+{
+    if (commit.drm_fd() != drm_fd_)
+        return false;
+
+    auto const primary = primary_plane();
+    if (!primary)
+        return false;
+
+    std::unique_lock lg(power_mutex);
+    if (power_mode != mir_power_mode_on)
+        return true;
+    if (!current_crtc)
+        return false;
+
+    try
+    {
+        add_flip(commit, whole_output(fb, *primary));
+    }
+    catch (std::exception const&)
+    {
+        return false;
+    }
+    return true;
+}
+
+auto mgg::AtomicKMSOutput::properties_of(uint32_t object_id, uint32_t object_type)
+    -> mgk::ObjectProperties const&
+{
+    // DRM object IDs are unique across object types, so a single cache will do
+    auto existing = object_properties.find(object_id);
+    if (existing == object_properties.end())
+    {
+        existing = object_properties.emplace(
+            object_id,
+            mgk::ObjectProperties{drm_fd_, object_id, object_type}).first;
+    }
+    return existing->second;
+}
+
+auto mgg::AtomicKMSOutput::primary_plane() -> std::optional<uint32_t>
+{
+    auto const& planes = this->planes();
+    auto const primary = std::find_if(
+        planes.begin(), planes.end(),
+        [](KMSPlane const& plane) { return plane.type() == KMSPlane::Type::primary; });
+
+    if (primary == planes.end())
+        return std::nullopt;
+
+    return primary->id();
+}
+
+auto mgg::AtomicKMSOutput::whole_output(FBHandle const& fb, uint32_t primary_plane_id) const
+    -> PlaneConfiguration
+{
+    return {{
+        primary_plane_id,
+        std::shared_ptr<FBHandle const>{std::shared_ptr<void>{}, &fb},
+        geom::Rectangle{geom::Point{} + fb_offset, size()},
+        geom::Rectangle{{0, 0}, size()}}};
+}
+
+void mgg::AtomicKMSOutput::add_planes(AtomicCommit& commit, PlaneConfiguration const& configuration)
+{
+    struct Change
+    {
+        uint32_t object_id;
+        uint32_t property_id;
+        uint64_t value;
+    };
+
+    // Look up every property before adding any, so a missing one leaves commit unchanged
+    std::vector<Change> changes;
+
+    for (auto const& state : configuration)
+    {
+        auto const& properties = properties_of(state.plane_id, DRM_MODE_OBJECT_PLANE);
+        auto const set = [&](char const* name, uint64_t value)
+            {
+                changes.push_back({state.plane_id, properties.id_for(name), value});
+            };
+
+        // Source coordinates are in 16.16 fixed point
+        set("FB_ID", state.fb->get_drm_fb_id());
+        set("CRTC_ID", current_crtc->crtc_id);
+        set("SRC_X", static_cast<uint64_t>(state.source.top_left.x.as_int()) << 16);
+        set("SRC_Y", static_cast<uint64_t>(state.source.top_left.y.as_int()) << 16);
+        set("SRC_W", static_cast<uint64_t>(state.source.size.width.as_int()) << 16);
+        set("SRC_H", static_cast<uint64_t>(state.source.size.height.as_int()) << 16);
+        set("CRTC_X", state.destination.top_left.x.as_int());
+        set("CRTC_Y", state.destination.top_left.y.as_int());
+        set("CRTC_W", state.destination.size.width.as_int());
+        set("CRTC_H", state.destination.size.height.as_int());
+    }
+
+    for (auto const plane_id : active_planes)
+    {
+        auto const still_active = std::any_of(
+            configuration.begin(), configuration.end(),
+            [plane_id](PlaneState const& state) { return state.plane_id == plane_id; });
+
+        if (!still_active)
+        {
+            auto const& properties = properties_of(plane_id, DRM_MODE_OBJECT_PLANE);
+            changes.push_back({plane_id, properties.id_for("FB_ID"), 0});
+            changes.push_back({plane_id, properties.id_for("CRTC_ID"), 0});
+        }
+    }
+
+    for (auto const& change : changes)
+        commit.add_property(change.object_id, change.property_id, change.value);
+}
+
+void mgg::AtomicKMSOutput::add_flip(AtomicCommit& commit, PlaneConfiguration const& configuration)
+{
+    add_planes(commit, configuration);
+    commit.add_target(
+        page_flipper,
+        {current_crtc->crtc_id, connector->connector_id},
+        [this, overlays = overlays_in(configuration)]()
+        {
+            active_planes = overlays;
+        });
+}
+
+auto mgg::AtomicKMSOutput::overlays_in(PlaneConfiguration const& configuration) const
+    -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> overlays;
+    for (auto const& state : configuration)
+    {
+        auto const is_primary = crtc_planes && std::any_of(
+            crtc_planes->begin(), crtc_planes->end(),
+            [&state](KMSPlane const& plane)
+            {
+                return plane.id() == state.plane_id && plane.type() == KMSPlane::Type::primary;
+            });
+
+        if (!is_primary)
+            overlays.push_back(state.plane_id);
+    }
+    return overlays;
+}
+
+void mgg::AtomicKMSOutput::disable_active_planes()
+{
+    if (active_planes.empty())
+        return;
+
+    try
+    {
+        AtomicCommit commit{drm_fd_};
+        add_planes(commit, {});
+        if (auto const result = commit.commit(0))
+        {
+            mir::log_warning("Failed to disable overlay planes of output %s: %s",
+                             mgk::connector_name(connector).c_str(), strerror(-result));
+        }
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_warning("Failed to disable overlay planes of output %s: %s",
+                         mgk::connector_name(connector).c_str(), error.what());
+    }
+
+    active_planes.clear();
+}
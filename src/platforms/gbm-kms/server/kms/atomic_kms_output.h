@@ -0,0 +1,92 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_ATOMIC_KMS_OUTPUT_H_
+#define MIR_GRAPHICS_GBM_ATOMIC_KMS_OUTPUT_H_
+
+#include "real_kms_output.h"
+
+#include <optional>
+#include <unordered_map>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+
+/**
+ * A KMSOutput driven through the atomic modesetting API.
+ *
+ * Mode changes and page flips replace the state of the CRTC, connector and planes in
+ * one commit, so they never show a partially-updated output, and flips of several
+ * outputs can share a commit (see add_page_flip()). Cursors, gamma and DPMS use the
+ * same legacy calls as RealKMSOutput, which atomic drivers continue to support.
+ *
+ * \note    The caller must have enabled DRM_CLIENT_CAP_ATOMIC on drm_fd.
+ */
+class AtomicKMSOutput : public RealKMSOutput
+{
+public:
+    AtomicKMSOutput(
+        int drm_fd,
+        kms::DRMModeConnectorUPtr&& connector,
+        std::shared_ptr<PageFlipper> const& page_flipper);
+    ~AtomicKMSOutput();
+
+    bool set_crtc(FBHandle const& fb) override;
+    void clear_crtc() override;
+    bool schedule_page_flip(FBHandle const& fb) override;
+
+    auto planes() -> std::vector<KMSPlane> const& override;
+    bool test_planes(PlaneConfiguration const& configuration) override;
+    bool schedule_page_flip(PlaneConfiguration const& configuration) override;
+    bool add_page_flip(AtomicCommit& commit, FBHandle const& fb) override;
+
+private:
+    auto properties_of(uint32_t object_id, uint32_t object_type) -> kms::ObjectProperties const&;
+    auto primary_plane() -> std::optional<uint32_t>;
+    auto whole_output(FBHandle const& fb, uint32_t primary_plane_id) const -> PlaneConfiguration;
+
+    /**
+     * Add the state of each plane in configuration to commit, and turn off any other
+     * plane we enabled.
+     *
+     * \throws std::out_of_range if a plane lacks one of the standard atomic properties
+     */
+    void add_planes(AtomicCommit& commit, PlaneConfiguration const& configuration);
+    /// Add configuration as the next page flip of this output
+    void add_flip(AtomicCommit& commit, PlaneConfiguration const& configuration);
+    /// The planes other than the primary plane that configuration enables
+    auto overlays_in(PlaneConfiguration const& configuration) const -> std::vector<uint32_t>;
+    /// Turn off the planes a previous commit enabled, before using the legacy API
+    void disable_active_planes();
+
+    std::optional<std::vector<KMSPlane>> crtc_planes;
+    uint32_t crtc_planes_crtc_id{0};
+    std::unordered_map<uint32_t, kms::ObjectProperties> object_properties;
+    /// The non-primary planes enabled by our last commit
+    std::vector<uint32_t> active_planes;
+    /// The property blob holding the mode we last set
+    std::optional<uint32_t> mode_blob;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_GBM_ATOMIC_KMS_OUTPUT_H_ */
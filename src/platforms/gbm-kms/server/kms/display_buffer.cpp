@@ -16,9 +16,11 @@
 
 #include "display_buffer.h"
 #include "kms_output.h"
+#include "atomic_commit.h"
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
 #include "bypass.h"
+#include "plane_assigner.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
 #include "native_buffer.h"
@@ -487,7 +489,8 @@ mgg::DisplayBuffer::DisplayBuffer(
         }
     }
 
-    set_crtc(*outputs.front()->fb_for(visible_composite_frame));
+    composite_fb = outputs.front()->fb_for(visible_composite_frame);
+    set_crtc(*composite_fb);
 
     release_current();
 
@@ -550,6 +553,49 @@ bool mgg::DisplayBuffer::overlay(RenderableList const& renderable_list)
     return false;
 }
 
+auto mgg::DisplayBuffer::assign_planes(RenderableList const& renderable_list) -> std::optional<RenderableList>
+{
+    assigned_planes.clear();
+    assigned_plane_buffers.clear();
+    primary_plane_assigned = false;
+
+    glm::mat2 static const no_transformation(1);
+    if (outputs.size() == 1 &&
+        transform == no_transformation &&
+        bypass_option == mgg::BypassOption::allowed &&
+        composite_fb)
+    {
+        auto& output = *outputs.front();
+        auto const& planes = output.planes();
+
+        auto const primary = std::find_if(
+            planes.begin(), planes.end(),
+            [](KMSPlane const& plane) { return plane.type() == KMSPlane::Type::primary; });
+
+        if (primary != planes.end())
+        {
+            PlaneAssigner const assigner{
+                planes,
+                surface.size(),
+                [&output](DMABufBuffer const& buffer) { return output.fb_for(buffer); },
+                [&output](PlaneConfiguration const& configuration) { return output.test_planes(configuration); }};
+
+            auto assignment = assigner.assign(renderable_list, area, composite_fb);
+
+            primary_plane_id = primary->id();
+            primary_plane_assigned = !assignment.to_composite;
+            assigned_planes = std::move(assignment.planes);
+            assigned_plane_buffers = std::move(assignment.buffers);
+            return std::move(assignment.to_composite);
+        }
+    }
+
+    if (overlay(renderable_list))
+        return std::nullopt;
+
+    return renderable_list;
+}
+
 void mgg::DisplayBuffer::for_each_display_buffer(
     std::function<void(graphics::DisplayBuffer&)> const& f)
 {
@@ -591,17 +637,39 @@ void mgg::DisplayBuffer::post()
      */
     wait_for_page_flip();
 
+    auto planes = std::move(assigned_planes);
+    assigned_planes.clear();
+
     std::shared_ptr<mgg::FBHandle const> bufobj;
     if (bypass_buf)
     {
         bufobj = bypass_bufobj;
     }
+    else if (primary_plane_assigned)
+    {
+        auto const primary = std::find_if(
+            planes.begin(), planes.end(),
+            [this](PlaneState const& state) { return state.plane_id == primary_plane_id; });
+        bufobj = primary->fb;
+    }
     else
     {
         scheduled_composite_frame = get_front_buffer(surface.lock_front());
         bufobj = outputs.front()->fb_for(scheduled_composite_frame);
         if (!bufobj)
             fatal_error("Failed to get front buffer object");
+
+        composite_fb = bufobj;
+
+        // Anything on overlays is shown above the composited frame
+        if (!planes.empty())
+        {
+            planes.push_back(PlaneState{
+                *primary_plane_id,
+                bufobj,
+                geom::Rectangle{{0, 0}, surface.size()},
+                geom::Rectangle{{0, 0}, surface.size()}});
+        }
     }
 
     scheduled_fb = std::move(bufobj);
@@ -609,8 +677,15 @@ void mgg::DisplayBuffer::post()
      * Try to schedule a page flip as first preference to avoid tearing.
      * [will complete in a background thread]
      */
-    if (!needs_set_crtc && !schedule_page_flip(*scheduled_fb))
-        needs_set_crtc = true;
+    if (!needs_set_crtc)
+    {
+        auto const scheduled = planes.empty() ?
+            schedule_page_flip(*scheduled_fb) :
+            schedule_page_flip(planes);
+
+        if (!scheduled)
+            needs_set_crtc = true;
+    }
 
     /*
      * Fallback blitting: Not pretty, since it may tear. VirtualBox seems
@@ -631,7 +706,15 @@ void mgg::DisplayBuffer::post()
     // Predicted worst case render time for the next frame...
     auto predicted_render_time = 50ms;
 
-    if (bypass_buf)
+    // Planes are only assigned to single outputs, so are always waited for below
+    scheduled_planes = std::move(planes);
+    scheduled_plane_buffers = std::move(assigned_plane_buffers);
+    assigned_plane_buffers.clear();
+
+    // With nothing composited, every client buffer on screen is scanned out as is
+    scheduled_zero_copy = bypass_buf || primary_plane_assigned;
+
+    if (bypass_buf || primary_plane_assigned)
     {
         /*
          * For composited frames we defer wait_for_page_flip till just before
@@ -671,6 +754,7 @@ void mgg::DisplayBuffer::post()
     // Buffer lifetimes are managed exclusively by scheduled*/visible* now
     bypass_buf = nullptr;
     bypass_bufobj = nullptr;
+    primary_plane_assigned = false;
 
     recommend_sleep = 0ms;
     if (outputs.size() == 1)
@@ -687,12 +771,44 @@ std::chrono::milliseconds mgg::DisplayBuffer::recommended_sleep() const
     return recommend_sleep;
 }
 
+auto mgg::DisplayBuffer::last_frame() const -> std::optional<Frame>
+{
+    // In clone mode the outputs flip together, so any of them will do
+    auto frame = outputs.front()->last_frame();
+    if (frame.msc == 0 && frame.ust.nanoseconds == std::chrono::nanoseconds::zero())
+        return std::nullopt;
+
+    frame.zero_copy = visible_zero_copy;
+    return frame;
+}
+
+auto mgg::DisplayBuffer::last_frame_is_latest_post() const -> bool
+{
+    // Composited frames in clone mode aren't waited for until the next post()
+    return !page_flips_pending;
+}
+
+bool mgg::DisplayBuffer::schedule_page_flip(PlaneConfiguration const& configuration)
+{
+    // Planes are only assigned when there's a single output
+    if (outputs.front()->schedule_page_flip(configuration))
+        page_flips_pending = true;
+
+    return page_flips_pending;
+}
+
 bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
 {
     /*
      * Schedule the current front buffer object for display. Note that
      * the page flip is asynchronous and synchronized with vertical refresh.
      */
+    if (outputs.size() > 1 && schedule_page_flip_together(bufobj))
+    {
+        page_flips_pending = true;
+        return true;
+    }
+
     for (auto& output : outputs)
     {
         if (output->schedule_page_flip(bufobj))
@@ -702,6 +818,23 @@ bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
     return page_flips_pending;
 }
 
+bool mgg::DisplayBuffer::schedule_page_flip_together(FBHandle const& bufobj)
+{
+    /*
+     * In clone mode, flipping all the outputs in a single atomic commit means
+     * they all show the new frame from the same vblank, rather than each flip
+     * waiting its turn.
+     */
+    AtomicCommit commit{outputs.front()->drm_fd()};
+    for (auto& output : outputs)
+    {
+        if (!output->add_page_flip(commit, bufobj))
+            return false;
+    }
+
+    return commit.schedule();
+}
+
 void mgg::DisplayBuffer::wait_for_page_flip()
 {
     if (page_flips_pending)
@@ -712,20 +845,26 @@ void mgg::DisplayBuffer::wait_for_page_flip()
         // The previously-scheduled FB has been page-flipped, and is now visible
         visible_fb = std::move(scheduled_fb);
         scheduled_fb = nullptr;
+        visible_zero_copy = scheduled_zero_copy;
 
         page_flips_pending = false;
     }
 
-    if (scheduled_bypass_frame || scheduled_composite_frame)
+    if (scheduled_bypass_frame || scheduled_composite_frame || !scheduled_planes.empty())
     {
-        // Why are both of these grouped into a single statement?
-        // Because in either case both types of frame need releasing each time.
+        // Why are all of these grouped into a single statement?
+        // Because in any case every type of frame needs releasing each time.
 
         visible_bypass_frame = scheduled_bypass_frame;
         scheduled_bypass_frame = nullptr;
 
         visible_composite_frame = std::move(scheduled_composite_frame);
         scheduled_composite_frame = nullptr;
+
+        visible_planes = std::move(scheduled_planes);
+        scheduled_planes.clear();
+        visible_plane_buffers = std::move(scheduled_plane_buffers);
+        scheduled_plane_buffers.clear();
     }
 }
 
@@ -744,6 +883,16 @@ void mgg::DisplayBuffer::bind()
     surface.bind();
 }
 
+auto mgg::DisplayBuffer::buffer_age() const -> int
+{
+    return surface.buffer_age();
+}
+
+void mgg::DisplayBuffer::set_damage_region(geometry::Rectangles const& damage)
+{
+    surface.set_damage_region(damage);
+}
+
 void mgg::DisplayBuffer::release_current()
 {
     surface.release_current();
@@ -811,6 +960,16 @@ void mgg::GBMOutputSurface::bind()
 
 }
 
+auto mgg::GBMOutputSurface::buffer_age() const -> int
+{
+    return egl.buffer_age();
+}
+
+void mgg::GBMOutputSurface::set_damage_region(geometry::Rectangles const& damage)
+{
+    egl.set_damage_region(damage);
+}
+
 auto mgg::GBMOutputSurface::lock_front() -> FrontBuffer
 {
     return FrontBuffer{surface.get()};
@@ -22,6 +22,7 @@
 #include "mir/renderer/gl/render_target.h"
 #include "display_helpers.h"
 #include "egl_helper.h"
+#include "kms_plane.h"
 #include "platform_common.h"
 
 #include <vector>
@@ -81,6 +82,8 @@ public:
     void release_current() override;
     void swap_buffers() override;
     void bind() override;
+    auto buffer_age() const -> int override;
+    void set_damage_region(geometry::Rectangles const& damage) override;
 
     FrontBuffer lock_front();
     void report_egl_configuration(std::function<void(EGLDisplay, EGLConfig)> const& to);
@@ -111,12 +114,17 @@ public:
     void release_current() override;
     void swap_buffers() override;
     bool overlay(RenderableList const& renderlist) override;
+    auto assign_planes(RenderableList const& renderlist) -> std::optional<RenderableList> override;
     void bind() override;
+    auto buffer_age() const -> int override;
+    void set_damage_region(geometry::Rectangles const& damage) override;
 
     void for_each_display_buffer(
         std::function<void(graphics::DisplayBuffer&)> const& f) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    auto last_frame() const -> std::optional<Frame> override;
+    auto last_frame_is_latest_post() const -> bool override;
 
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
@@ -127,6 +135,9 @@ public:
 
 private:
     bool schedule_page_flip(FBHandle const& bufobj);
+    bool schedule_page_flip(PlaneConfiguration const& configuration);
+    /// Flip every output with one atomic commit; false if they can't all take part
+    bool schedule_page_flip_together(FBHandle const& bufobj);
     void set_crtc(FBHandle const&);
 
     std::shared_ptr<graphics::Buffer> visible_bypass_frame, scheduled_bypass_frame;
@@ -151,6 +162,20 @@ private:
 
     std::shared_ptr<FBHandle const> scheduled_fb{nullptr};
     std::shared_ptr<FBHandle const> visible_fb{nullptr};
+    /// Whether the scheduled/visible frame was scanned out without compositing
+    bool scheduled_zero_copy{false}, visible_zero_copy{false};
+
+    /// The planes assign_planes() chose for the next post(), excluding any composited frame
+    PlaneConfiguration assigned_planes;
+    std::vector<std::shared_ptr<graphics::Buffer>> assigned_plane_buffers;
+    /// Whether a renderable, rather than the composited frame, is on the primary plane
+    bool primary_plane_assigned{false};
+    std::optional<uint32_t> primary_plane_id;
+    /// The most recent composited frame, as a stand-in for the next one when testing planes
+    std::shared_ptr<FBHandle const> composite_fb{nullptr};
+
+    PlaneConfiguration scheduled_planes, visible_planes;
+    std::vector<std::shared_ptr<graphics::Buffer>> scheduled_plane_buffers, visible_plane_buffers;
 
     geometry::Rectangle area;
     glm::mat2 transform;
@@ -20,6 +20,7 @@
 #include <boost/exception/errinfo_errno.hpp>
 #include <boost/throw_exception.hpp>
 #include <gbm.h>
+#include <cstring>
 
 #define MIR_LOG_COMPONENT "EGL"
 #include "mir/log.h"
@@ -54,7 +55,9 @@ mgmh::EGLHelper::EGLHelper(EGLHelper&& from)
       egl_config{from.egl_config},
       egl_context{from.egl_context},
       egl_surface{from.egl_surface},
-      should_terminate_egl{from.should_terminate_egl}
+      should_terminate_egl{from.should_terminate_egl},
+      has_buffer_age{from.has_buffer_age},
+      set_damage_region_khr{from.set_damage_region_khr}
 {
     from.should_terminate_egl = false;
     from.egl_display = EGL_NO_DISPLAY;
@@ -189,6 +192,16 @@ void mgmh::EGLHelper::setup(
     egl_context = eglCreateContext(egl_display, egl_config, shared_context, context_attr);
     if (egl_context == EGL_NO_CONTEXT)
         BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGL context"));
+
+    if (auto const extensions = eglQueryString(egl_display, EGL_EXTENSIONS))
+    {
+        has_buffer_age = strstr(extensions, "EGL_EXT_buffer_age") != nullptr;
+        if (strstr(extensions, "EGL_KHR_partial_update"))
+        {
+            set_damage_region_khr = reinterpret_cast<PFNEGLSETDAMAGEREGIONKHRPROC>(
+                eglGetProcAddress("eglSetDamageRegionKHR"));
+        }
+    }
 }
 
 mgmh::EGLHelper::~EGLHelper() noexcept
@@ -214,6 +227,34 @@ bool mgmh::EGLHelper::swap_buffers()
     return (ret == EGL_TRUE);
 }
 
+auto mgmh::EGLHelper::buffer_age() const -> int
+{
+    EGLint age{0};
+    if (has_buffer_age && eglQuerySurface(egl_display, egl_surface, EGL_BUFFER_AGE_EXT, &age) == EGL_TRUE)
+        return age;
+
+    return 0;
+}
+
+void mgmh::EGLHelper::set_damage_region(geometry::Rectangles const& damage)
+{
+    if (!set_damage_region_khr || damage.size() == 0)
+        return;
+
+    std::vector<EGLint> rects;
+    rects.reserve(damage.size() * 4);
+    for (auto const& rect : damage)
+    {
+        rects.push_back(rect.top_left.x.as_int());
+        rects.push_back(rect.top_left.y.as_int());
+        rects.push_back(rect.size.width.as_int());
+        rects.push_back(rect.size.height.as_int());
+    }
+
+    if (set_damage_region_khr(egl_display, egl_surface, rects.data(), static_cast<EGLint>(damage.size())) != EGL_TRUE)
+        mir::log_debug("eglSetDamageRegionKHR failed: %s", mg::egl_category().message(eglGetError()).c_str());
+}
+
 bool mgmh::EGLHelper::make_current() const
 {
     auto ret = eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
@@ -19,6 +19,7 @@
 
 #include "display_helpers.h"
 #include "mir/graphics/egl_extensions.h"
+#include "mir/geometry/rectangles.h"
 #include <stdexcept>
 #include <EGL/egl.h>
 
@@ -55,6 +56,11 @@ public:
     bool make_current() const;
     bool release_current() const;
 
+    /// The age of the surface's back buffer (EGL_EXT_buffer_age), or 0 if unknown
+    auto buffer_age() const -> int;
+    /// Set the damage region of the back buffer, if EGL_KHR_partial_update is supported
+    void set_damage_region(geometry::Rectangles const& damage);
+
     EGLContext context() const { return egl_context; }
 
     void report_egl_configuration(std::function<void(EGLDisplay, EGLConfig)>);
@@ -76,6 +82,8 @@ private:
     EGLContext egl_context;
     EGLSurface egl_surface;
     bool should_terminate_egl;
+    bool has_buffer_age{false};
+    PFNEGLSETDAMAGEREGIONKHRPROC set_damage_region_khr{nullptr};
     EGLExtensions::PlatformBaseEXT platform_base;
 };
 }
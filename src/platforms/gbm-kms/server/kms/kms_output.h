@@ -26,6 +26,7 @@
 #include "mir_toolkit/common.h"
 
 #include "kms-utils/drm_mode_resources.h"
+#include "kms_plane.h"
 
 #include <gbm.h>
 
@@ -39,6 +40,7 @@ namespace gbm
 {
 
 class FBHandle;
+class AtomicCommit;
 
 class KMSOutput
 {
@@ -67,6 +69,34 @@ public:
     virtual void clear_crtc() = 0;
     virtual bool schedule_page_flip(FBHandle const& fb) = 0;
     virtual void wait_for_page_flip() = 0;
+    /// The frame shown by the page flip most recently waited for by wait_for_page_flip()
+    virtual Frame last_frame() const = 0;
+
+    /**
+     * The hardware planes that can be attached to this output's CRTC.
+     *
+     * This is empty if the driver does not support atomic modesetting, in which case
+     * only whole-output framebuffers can be displayed.
+     */
+    virtual auto planes() -> std::vector<KMSPlane> const& = 0;
+    /**
+     * Check whether the hardware could display configuration, without displaying it.
+     */
+    virtual bool test_planes(PlaneConfiguration const& configuration) = 0;
+    /**
+     * As schedule_page_flip(FBHandle const&), but scanning out each plane in configuration
+     * and disabling any other plane previously enabled.
+     */
+    virtual bool schedule_page_flip(PlaneConfiguration const& configuration) = 0;
+    /**
+     * Add what schedule_page_flip(fb) would do to commit, so that several outputs can be
+     * flipped together by AtomicCommit::schedule().
+     *
+     * \return  false if this output can't be flipped by commit (for example, because it
+     *          uses legacy modesetting or is on another DRM device), in which case commit
+     *          is unchanged and schedule_page_flip(fb) should be used instead.
+     */
+    virtual bool add_page_flip(AtomicCommit& commit, FBHandle const& fb) = 0;
 
     virtual bool set_cursor(gbm_bo* buffer) = 0;
     virtual void move_cursor(geometry::Point destination) = 0;
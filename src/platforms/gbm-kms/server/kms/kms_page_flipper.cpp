@@ -42,6 +42,20 @@ void page_flip_handler(int /*fd*/, unsigned int seq,
                                               seq, ns);
 }
 
+/*
+ * An atomic commit can flip several CRTCs, each of which gets its own event
+ * carrying the same user data, so we need the CRTC the kernel tells us about.
+ */
+void page_flip_handler2(int /*fd*/, unsigned int seq,
+                        unsigned int sec, unsigned int usec,
+                        unsigned int crtc_id, void* data)
+{
+    auto page_flip_data = static_cast<mgg::PageFlipEventData*>(data);
+    std::chrono::nanoseconds ns{sec*1000000000LL + usec*1000LL};
+    page_flip_data->flipper->notify_page_flip(crtc_id ? crtc_id : page_flip_data->crtc_id,
+                                              seq, ns);
+}
+
 }
 
 mgg::KMSPageFlipper::KMSPageFlipper(
@@ -63,25 +77,48 @@ bool mgg::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
                                         uint32_t fb_id,
                                         uint32_t connector_id)
 {
-    std::unique_lock lock{pf_mutex};
-
-    if (pending_page_flips.find(crtc_id) != pending_page_flips.end())
-        BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
-
-    pending_page_flips[crtc_id] = PageFlipEventData{crtc_id, connector_id, this};
-
     /*
      * It appears we can't tell the difference between flipping being
      * unsupported or failing for other reasons. On VirtualBox this always
      * fails with -22 (Invalid argument) despite the arguments being
      * apparently valid.
      */
-    auto ret = drmModePageFlip(drm_fd, crtc_id, fb_id,
-                               DRM_MODE_PAGE_FLIP_EVENT,
-                               &pending_page_flips[crtc_id]);
+    return schedule_commit(
+        {{crtc_id, connector_id}},
+        [this, crtc_id, fb_id](void* user_data)
+        {
+            return drmModePageFlip(drm_fd, crtc_id, fb_id,
+                                   DRM_MODE_PAGE_FLIP_EVENT,
+                                   user_data);
+        });
+}
+
+bool mgg::KMSPageFlipper::schedule_commit(
+    std::vector<Target> const& targets,
+    std::function<int(void* user_data)> const& commit)
+{
+    std::unique_lock lock{pf_mutex};
+
+    if (targets.empty())
+        BOOST_THROW_EXCEPTION(std::logic_error("Page flip has no CRTC to flip"));
+
+    for (auto const& target : targets)
+    {
+        if (pending_page_flips.find(target.crtc_id) != pending_page_flips.end())
+            BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
+    }
+
+    for (auto const& target : targets)
+        pending_page_flips[target.crtc_id] = PageFlipEventData{target.crtc_id, target.connector_id, this};
+
+    // Elements of an unordered_map stay put, so this remains valid until the event arrives
+    auto ret = commit(&pending_page_flips[targets.front().crtc_id]);
 
     if (ret)
-        pending_page_flips.erase(crtc_id);
+    {
+        for (auto const& target : targets)
+            pending_page_flips.erase(target.crtc_id);
+    }
 
     return (ret == 0);
 }
@@ -90,8 +127,9 @@ mg::Frame mgg::KMSPageFlipper::wait_for_flip(uint32_t crtc_id)
 {
     drmEventContext evctx;
     memset(&evctx, 0, sizeof evctx);
-    evctx.version = 2;  // We only support the old v2 page_flip_handler
+    evctx.version = 3;
     evctx.page_flip_handler = &page_flip_handler;
+    evctx.page_flip_handler2 = &page_flip_handler2;
 
     static std::thread::id const invalid_tid;
 
@@ -182,6 +220,10 @@ void mgg::KMSPageFlipper::notify_page_flip(uint32_t crtc_id, int64_t msc,
         auto& frame = completed_page_flips[crtc_id];
         frame.msc = msc;
         frame.ust = {clock_id, ust};
+        // The kernel timestamps the flip event from the vblank interrupt it completed in
+        frame.vsync = true;
+        frame.hw_clock = true;
+        frame.hw_completion = true;
         report->report_vsync(pending->second.connector_id, frame);
         pending_page_flips.erase(pending);
     }
@@ -0,0 +1,184 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kms_plane.h"
+#include "kms-utils/drm_mode_resources.h"
+
+#include <boost/throw_exception.hpp>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <drm_fourcc.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mgg = mir::graphics::gbm;
+namespace mgk = mir::graphics::kms;
+
+namespace
+{
+auto crtc_index_for(int drm_fd, uint32_t crtc_id) -> int
+{
+    mgk::DRMModeResources resources{drm_fd};
+
+    int index = 0;
+    for (auto& crtc : resources.crtcs())
+    {
+        if (crtc->crtc_id == crtc_id)
+            return index;
+        ++index;
+    }
+
+    BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to find index of CRTC"});
+}
+
+auto type_of(mgk::ObjectProperties const& properties) -> std::optional<mgg::KMSPlane::Type>
+{
+    if (!properties.has_property("type"))
+        return std::nullopt;
+
+    switch (properties["type"])
+    {
+    case DRM_PLANE_TYPE_PRIMARY:
+        return mgg::KMSPlane::Type::primary;
+    case DRM_PLANE_TYPE_OVERLAY:
+        return mgg::KMSPlane::Type::overlay;
+    case DRM_PLANE_TYPE_CURSOR:
+        return mgg::KMSPlane::Type::cursor;
+    default:
+        return std::nullopt;
+    }
+}
+
+/**
+ * Parse the IN_FORMATS blob (a struct drm_format_modifier_blob) into a map from
+ * format to supported modifiers.
+ */
+auto formats_from_blob(int drm_fd, uint32_t blob_id) -> std::optional<std::unordered_map<uint32_t, std::vector<uint64_t>>>
+{
+    std::unique_ptr<drmModePropertyBlobRes, void(*)(drmModePropertyBlobPtr)> const blob{
+        drmModeGetPropertyBlob(drm_fd, blob_id),
+        &drmModeFreePropertyBlob};
+
+    if (!blob || blob->length < sizeof(drm_format_modifier_blob))
+        return std::nullopt;
+
+    auto const data = static_cast<char const*>(blob->data);
+    auto const header = reinterpret_cast<drm_format_modifier_blob const*>(data);
+    auto const formats = reinterpret_cast<uint32_t const*>(data + header->formats_offset);
+    auto const modifiers = reinterpret_cast<drm_format_modifier const*>(data + header->modifiers_offset);
+
+    std::unordered_map<uint32_t, std::vector<uint64_t>> result;
+    for (auto i = 0u; i != header->count_formats; ++i)
+        result[formats[i]];
+
+    for (auto i = 0u; i != header->count_modifiers; ++i)
+    {
+        auto const& modifier = modifiers[i];
+        for (auto bit = 0u; bit != 64; ++bit)
+        {
+            auto const format_index = modifier.offset + bit;
+            if ((modifier.formats & (1ull << bit)) && format_index < header->count_formats)
+                result[formats[format_index]].push_back(modifier.modifier);
+        }
+    }
+
+    return result;
+}
+}
+
+mgg::KMSPlane::KMSPlane(
+    uint32_t id,
+    Type type,
+    std::optional<uint64_t> zpos,
+    std::unordered_map<uint32_t, std::vector<uint64_t>> formats)
+    : id_{id},
+      type_{type},
+      zpos_{zpos},
+      formats{std::move(formats)}
+{
+}
+
+auto mgg::KMSPlane::planes_for_crtc(int drm_fd, uint32_t crtc_id) -> std::vector<KMSPlane>
+{
+    auto const crtc_mask = 1u << crtc_index_for(drm_fd, crtc_id);
+
+    std::vector<KMSPlane> planes;
+    mgk::PlaneResources plane_resources{drm_fd};
+
+    for (auto& plane : plane_resources.planes())
+    {
+        if (!(plane->possible_crtcs & crtc_mask))
+            continue;
+
+        mgk::ObjectProperties const properties{drm_fd, plane};
+        auto const type = type_of(properties);
+        if (!type)
+            continue;
+
+        if (*type != Type::primary && plane->possible_crtcs != crtc_mask)
+            continue;
+
+        std::optional<uint64_t> zpos;
+        if (properties.has_property("zpos"))
+            zpos = properties["zpos"];
+
+        std::optional<std::unordered_map<uint32_t, std::vector<uint64_t>>> formats;
+        if (properties.has_property("IN_FORMATS"))
+            formats = formats_from_blob(drm_fd, properties["IN_FORMATS"]);
+
+        if (!formats)
+        {
+            formats.emplace();
+            for (auto i = 0u; i != plane->count_formats; ++i)
+                (*formats)[plane->formats[i]];
+        }
+
+        planes.emplace_back(plane->plane_id, *type, zpos, std::move(*formats));
+    }
+
+    return planes;
+}
+
+auto mgg::KMSPlane::id() const -> uint32_t
+{
+    return id_;
+}
+
+auto mgg::KMSPlane::type() const -> Type
+{
+    return type_;
+}
+
+auto mgg::KMSPlane::zpos() const -> std::optional<uint64_t>
+{
+    return zpos_;
+}
+
+bool mgg::KMSPlane::supports(uint32_t format, std::optional<uint64_t> modifier) const
+{
+    auto const modifiers = formats.find(format);
+    if (modifiers == formats.end())
+        return false;
+
+    if (!modifier || *modifier == DRM_FORMAT_MOD_INVALID)
+        return true;
+
+    if (modifiers->second.empty())
+        return *modifier == DRM_FORMAT_MOD_LINEAR;
+
+    return std::find(modifiers->second.begin(), modifiers->second.end(), *modifier) != modifiers->second.end();
+}
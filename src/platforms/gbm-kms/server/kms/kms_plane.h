@@ -0,0 +1,117 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_KMS_PLANE_H_
+#define MIR_GRAPHICS_GBM_KMS_PLANE_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+
+class FBHandle;
+
+/**
+ * A hardware scanout plane, and the buffers it is able to scan out.
+ */
+class KMSPlane
+{
+public:
+    enum class Type
+    {
+        primary,
+        overlay,
+        cursor
+    };
+
+    /**
+     * \param [in] formats  Map from each DRM fourcc the plane supports to the modifiers it
+     *                      supports with that format. An empty list means the driver did not
+     *                      report modifiers, in which case only linear buffers are accepted.
+     */
+    KMSPlane(
+        uint32_t id,
+        Type type,
+        std::optional<uint64_t> zpos,
+        std::unordered_map<uint32_t, std::vector<uint64_t>> formats);
+
+    /**
+     * Enumerate the planes that can be attached to a CRTC.
+     *
+     * Overlay and cursor planes that could also be attached to some other CRTC are left
+     * out, so that separate outputs never compete for a plane.
+     *
+     * \note    The caller must have enabled DRM_CLIENT_CAP_UNIVERSAL_PLANES (which is
+     *          implied by DRM_CLIENT_CAP_ATOMIC) for primary and cursor planes to be listed.
+     */
+    static auto planes_for_crtc(int drm_fd, uint32_t crtc_id) -> std::vector<KMSPlane>;
+
+    auto id() const -> uint32_t;
+    auto type() const -> Type;
+
+    /**
+     * The position of the plane in the stacking order, if the driver exposes it.
+     *
+     * Planes with a higher zpos are displayed above those with a lower one.
+     */
+    auto zpos() const -> std::optional<uint64_t>;
+
+    /**
+     * Can this plane scan out a buffer of format with modifier?
+     *
+     * A buffer without an explicit modifier (or with DRM_FORMAT_MOD_INVALID) is accepted
+     * for any supported format; the driver will reject it on test if it's unsuitable.
+     */
+    bool supports(uint32_t format, std::optional<uint64_t> modifier) const;
+
+private:
+    uint32_t id_;
+    Type type_;
+    std::optional<uint64_t> zpos_;
+    std::unordered_map<uint32_t, std::vector<uint64_t>> formats;
+};
+
+/**
+ * The contents of a single plane in an atomic commit.
+ */
+struct PlaneState
+{
+    uint32_t plane_id;
+    std::shared_ptr<FBHandle const> fb;
+    geometry::Rectangle source;         ///< The region of fb to scan out, in buffer pixels
+    geometry::Rectangle destination;    ///< Where to display it, relative to the CRTC's origin
+};
+
+/**
+ * The contents of every enabled plane on a CRTC; any plane not listed is disabled.
+ */
+using PlaneConfiguration = std::vector<PlaneState>;
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_GBM_KMS_PLANE_H_ */
@@ -19,6 +19,8 @@
 
 #include "mir/graphics/frame.h"
 #include <cstdint>
+#include <functional>
+#include <vector>
 
 namespace mir
 {
@@ -32,7 +34,24 @@ class PageFlipper
 public:
     virtual ~PageFlipper() {}
 
+    /// A CRTC, and the connector it drives, flipped by a commit
+    struct Target
+    {
+        uint32_t crtc_id;
+        uint32_t connector_id;
+    };
+
     virtual bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) = 0;
+    /**
+     * Schedule a flip of every target, performed by commit (for example, an atomic commit).
+     *
+     * commit is called with the user data that its DRM_MODE_PAGE_FLIP_EVENTs must
+     * carry, and returns 0 on success or a negative errno on failure. Each target's
+     * flip can then be waited for separately with wait_for_flip().
+     */
+    virtual bool schedule_commit(
+        std::vector<Target> const& targets,
+        std::function<int(void* user_data)> const& commit) = 0;
     virtual Frame wait_for_flip(uint32_t crtc_id) = 0;
 
 protected:
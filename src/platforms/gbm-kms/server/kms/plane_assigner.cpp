@@ -0,0 +1,257 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "plane_assigner.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/dmabuf_buffer.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace mg = mir::graphics;
+namespace mgg = mir::graphics::gbm;
+namespace geom = mir::geometry;
+
+namespace
+{
+/**
+ * Is every pixel of renderable opaque?
+ *
+ * Whether (and how) a plane blends by per-pixel alpha depends on the hardware, so a shaped
+ * renderable only qualifies if a single rectangle of its opaque region covers all of it.
+ */
+bool is_opaque(mg::Renderable const& renderable)
+{
+    if (!renderable.shaped())
+        return true;
+
+    auto const opaque_region = renderable.opaque_region();
+    if (!opaque_region)
+        return false;
+
+    auto const position = renderable.screen_position();
+    return std::any_of(
+        opaque_region->begin(), opaque_region->end(),
+        [&position](geom::Rectangle const& opaque) { return opaque.contains(position); });
+}
+
+/// Scales offset along an output axis of logical_length to one of pixel_length, rounding to nearest
+auto to_pixels(int offset, int logical_length, int pixel_length) -> int
+{
+    auto const scaled = static_cast<long long>(offset) * pixel_length;
+    return static_cast<int>((scaled + logical_length / 2) / logical_length);
+}
+}
+
+mgg::PlaneAssigner::PlaneAssigner(
+    std::vector<KMSPlane> const& planes,
+    geom::Size output_size,
+    FBFor fb_for,
+    Test test)
+    : output_size{output_size},
+      fb_for{std::move(fb_for)},
+      test{std::move(test)}
+{
+    for (auto const& plane : planes)
+    {
+        switch (plane.type())
+        {
+        case KMSPlane::Type::primary:
+            primary = plane;
+            break;
+        case KMSPlane::Type::overlay:
+            overlays.push_back(plane);
+            break;
+        case KMSPlane::Type::cursor:
+            break;
+        }
+    }
+
+    std::stable_sort(
+        overlays.begin(), overlays.end(),
+        [](KMSPlane const& a, KMSPlane const& b) { return a.zpos() > b.zpos(); });
+
+    /*
+     * Without zpos we don't know how the overlays stack relative to each other,
+     * so we can only rely on one (which is above the primary by default).
+     */
+    auto const unordered = std::any_of(
+        overlays.begin(), overlays.end(),
+        [](KMSPlane const& plane) { return !plane.zpos(); });
+    if (unordered && overlays.size() > 1)
+        overlays.erase(overlays.begin() + 1, overlays.end());
+}
+
+auto mgg::PlaneAssigner::candidate_for(
+    Renderable const& renderable,
+    KMSPlane const& plane,
+    geom::Rectangle const& area) const -> std::optional<Candidate>
+{
+    static glm::mat4 const identity{1};
+
+    if (renderable.alpha() != 1.0f ||
+        !is_opaque(renderable) ||
+        renderable.transformation() != identity ||
+        renderable.clip_area() ||
+        !area.contains(renderable.screen_position()))
+    {
+        return std::nullopt;
+    }
+
+    auto buffer = renderable.buffer();
+    if (!buffer)
+        return std::nullopt;
+
+    auto const dmabuf = dynamic_cast<DMABufBuffer*>(buffer->native_buffer_base());
+    if (!dmabuf || !plane.supports(dmabuf->drm_fourcc(), dmabuf->modifier()))
+        return std::nullopt;
+
+    auto fb = fb_for(*dmabuf);
+    if (!fb)
+        return std::nullopt;
+
+    return Candidate{
+        PlaneState{
+            plane.id(),
+            std::move(fb),
+            geom::Rectangle{{0, 0}, buffer->size()},
+            to_output(renderable.screen_position(), area)},
+        std::move(buffer)};
+}
+
+auto mgg::PlaneAssigner::covers_output(Renderable const& renderable, geom::Rectangle const& area) const -> bool
+{
+    auto const buffer = renderable.buffer();
+    auto const fits = renderable.screen_position() == area;
+    auto const is_native = buffer && buffer->size() == output_size;
+
+    return is_opaque(renderable) && fits && is_native;
+}
+
+auto mgg::PlaneAssigner::to_output(geom::Rectangle const& rect, geom::Rectangle const& area) const
+    -> geom::Rectangle
+{
+    auto const offset = rect.top_left - area.top_left;
+    auto const left = offset.dx.as_int();
+    auto const top = offset.dy.as_int();
+    auto const right = left + rect.size.width.as_int();
+    auto const bottom = top + rect.size.height.as_int();
+
+    auto const logical_width = area.size.width.as_int();
+    auto const logical_height = area.size.height.as_int();
+    auto const pixel_width = output_size.width.as_int();
+    auto const pixel_height = output_size.height.as_int();
+
+    auto const x = to_pixels(left, logical_width, pixel_width);
+    auto const y = to_pixels(top, logical_height, pixel_height);
+    return {
+        {x, y},
+        {to_pixels(right, logical_width, pixel_width) - x, to_pixels(bottom, logical_height, pixel_height) - y}};
+}
+
+auto mgg::PlaneAssigner::assign(
+    RenderableList const& renderables,
+    geom::Rectangle const& area,
+    std::shared_ptr<FBHandle const> const& composite_fb) const -> Assignment
+{
+    Assignment assignment{{}, {}, renderables};
+    if (!primary || area.size.width.as_int() <= 0 || area.size.height.as_int() <= 0)
+        return assignment;
+
+    PlaneState const composited{
+        primary->id(),
+        composite_fb,
+        geom::Rectangle{{0, 0}, output_size},
+        geom::Rectangle{{0, 0}, output_size}};
+
+    // Renderables that aren't on this output don't affect it either way
+    std::vector<std::shared_ptr<Renderable>> visible;
+    std::copy_if(
+        renderables.begin(), renderables.end(), std::back_inserter(visible),
+        [&area](auto const& renderable) { return area.overlaps(renderable->screen_position()); });
+
+    std::unordered_set<Renderable const*> scanned_out;
+    auto next_overlay = overlays.begin();
+
+    // Working down from the top, until we find something we can't scan out
+    while (!visible.empty() && next_overlay != overlays.end())
+    {
+        auto const& renderable = *visible.back();
+
+        // The primary plane suits this better, and it hides everything below
+        if (covers_output(renderable, area))
+            break;
+
+        std::optional<Candidate> accepted;
+        for (auto plane = next_overlay; plane != overlays.end() && !accepted; ++plane)
+        {
+            if (auto candidate = candidate_for(renderable, *plane, area))
+            {
+                auto trial = assignment.planes;
+                trial.push_back(candidate->state);
+                trial.push_back(composited);
+
+                if (test(trial))
+                {
+                    accepted = std::move(candidate);
+                    next_overlay = plane + 1;
+                }
+            }
+        }
+
+        if (!accepted)
+            break;
+
+        assignment.planes.push_back(std::move(accepted->state));
+        assignment.buffers.push_back(std::move(accepted->buffer));
+        scanned_out.insert(&renderable);
+        visible.pop_back();
+    }
+
+    // If the top-most thing left hides the rest of the output it can replace the composited frame
+    if (!visible.empty())
+    {
+        auto const& renderable = *visible.back();
+
+        if (covers_output(renderable, area))
+        {
+            if (auto candidate = candidate_for(renderable, *primary, area))
+            {
+                auto trial = assignment.planes;
+                trial.push_back(candidate->state);
+
+                if (test(trial))
+                {
+                    assignment.planes = std::move(trial);
+                    assignment.buffers.push_back(std::move(candidate->buffer));
+                    assignment.to_composite = std::nullopt;
+                    return assignment;
+                }
+            }
+        }
+    }
+
+    if (!scanned_out.empty())
+    {
+        assignment.to_composite->erase(
+            std::remove_if(
+                assignment.to_composite->begin(), assignment.to_composite->end(),
+                [&scanned_out](auto const& renderable) { return scanned_out.count(renderable.get()) > 0; }),
+            assignment.to_composite->end());
+    }
+
+    return assignment;
+}
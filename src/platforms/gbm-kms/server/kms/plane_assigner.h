@@ -0,0 +1,123 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_PLANE_ASSIGNER_H_
+#define MIR_GRAPHICS_GBM_PLANE_ASSIGNER_H_
+
+#include "kms_plane.h"
+#include "mir/graphics/renderable.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+class DMABufBuffer;
+
+namespace gbm
+{
+
+/**
+ * Decides which renderables can be scanned out directly from hardware planes.
+ *
+ * Starting from the top of the stack, renderables are placed on overlay planes for
+ * as long as the hardware accepts the result; whatever is left is composited onto the
+ * primary plane. If the top-most of what's left is opaque and covers the whole output it
+ * is put on the primary plane itself and nothing need be composited at all.
+ *
+ * Each candidate configuration is checked with the Test functor (normally a
+ * DRM_MODE_ATOMIC_TEST_ONLY commit), so there's no need to model the many driver
+ * specific restrictions on scaling, stacking and bandwidth.
+ *
+ * Renderables are placed in the logical coordinates of the output's area, while planes are
+ * positioned in the pixels of the CRTC, so plane destinations are scaled from one to the other.
+ *
+ * Cursor planes are left to the hardware cursor.
+ */
+class PlaneAssigner
+{
+public:
+    using FBFor = std::function<std::shared_ptr<FBHandle const>(DMABufBuffer const&)>;
+    using Test = std::function<bool(PlaneConfiguration const&)>;
+
+    struct Assignment
+    {
+        /// The renderables to be scanned out directly, excluding the composited frame
+        PlaneConfiguration planes;
+        /// The buffers of those renderables; these must stay alive until they're off screen
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        /// What needs compositing onto the primary plane, if it isn't scanning out a renderable
+        std::optional<RenderableList> to_composite;
+    };
+
+    /**
+     * \param [in] planes      The planes of the output's CRTC
+     * \param [in] output_size The size of the output's mode, in pixels
+     * \param [in] fb_for      Creates a framebuffer to scan a buffer out from
+     * \param [in] test        Checks whether the hardware accepts a configuration
+     */
+    PlaneAssigner(std::vector<KMSPlane> const& planes, geometry::Size output_size, FBFor fb_for, Test test);
+
+    /**
+     * Assign renderables to planes.
+     *
+     * \param [in] renderables  The renderables to display, bottom-most first
+     * \param [in] area         The area of the output, in the same coordinates as renderables.
+     *                          This is scaled to the output's pixels, which may differ in size
+     * \param [in] composite_fb A framebuffer like the one the composited frame will be
+     *                          rendered to, for use in testing candidate configurations
+     */
+    auto assign(
+        RenderableList const& renderables,
+        geometry::Rectangle const& area,
+        std::shared_ptr<FBHandle const> const& composite_fb) const -> Assignment;
+
+private:
+    struct Candidate
+    {
+        PlaneState state;
+        std::shared_ptr<Buffer> buffer;
+    };
+
+    auto candidate_for(
+        Renderable const& renderable,
+        KMSPlane const& plane,
+        geometry::Rectangle const& area) const -> std::optional<Candidate>;
+
+    /// Could renderable take the place of the composited frame on the primary plane?
+    auto covers_output(Renderable const& renderable, geometry::Rectangle const& area) const -> bool;
+
+    /// Maps rect from the coordinates of area to the output's pixels
+    auto to_output(geometry::Rectangle const& rect, geometry::Rectangle const& area) const -> geometry::Rectangle;
+
+    std::optional<KMSPlane> primary;
+    /// Overlay planes we can use, top-most first
+    std::vector<KMSPlane> overlays;
+    geometry::Size const output_size;
+    FBFor const fb_for;
+    Test const test;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_GBM_PLANE_ASSIGNER_H_ */
@@ -15,6 +15,7 @@
  */
 
 #include "real_kms_output.h"
+#include "fb_handle.h"
 #include "mir/graphics/display_configuration.h"
 #include "page_flipper.h"
 #include "kms-utils/kms_connector.h"
@@ -31,31 +32,6 @@ namespace mgg = mg::gbm;
 namespace mgk = mg::kms;
 namespace geom = mir::geometry;
 
-class mgg::FBHandle
-{
-public:
-    FBHandle(int drm_fd, uint32_t fb_id)
-        : drm_fd{drm_fd},
-          fb_id{fb_id}
-    {
-    }
-
-    ~FBHandle()
-    {
-        // TODO: Some sort of logging on failure?
-        drmModeRmFB(drm_fd, fb_id);
-    }
-
-    auto get_drm_fb_id() const -> uint32_t
-    {
-        return fb_id;
-    }
-private:
-    int const drm_fd;
-    uint32_t const fb_id;
-};
-
-
 mgg::RealKMSOutput::RealKMSOutput(
     int drm_fd,
     kms::DRMModeConnectorUPtr&& connector,
@@ -247,7 +223,36 @@ void mgg::RealKMSOutput::wait_for_page_flip()
         fatal_error("Output %s has no associated CRTC to wait on",
                    mgk::connector_name(connector).c_str());
     }
-    page_flipper->wait_for_flip(current_crtc->crtc_id);
+    last_frame_ = page_flipper->wait_for_flip(current_crtc->crtc_id);
+}
+
+mg::Frame mgg::RealKMSOutput::last_frame() const
+{
+    return last_frame_;
+}
+
+auto mgg::RealKMSOutput::planes() -> std::vector<KMSPlane> const&
+{
+    // The legacy API can only show a single framebuffer covering the output
+    static std::vector<KMSPlane> const no_planes;
+    return no_planes;
+}
+
+bool mgg::RealKMSOutput::test_planes(PlaneConfiguration const&)
+{
+    return false;
+}
+
+bool mgg::RealKMSOutput::schedule_page_flip(PlaneConfiguration const&)
+{
+    mir::log_error("Output %s does not support hardware planes",
+                   mgk::connector_name(connector).c_str());
+    return false;
+}
+
+bool mgg::RealKMSOutput::add_page_flip(AtomicCommit&, FBHandle const&)
+{
+    return false;
 }
 
 bool mgg::RealKMSOutput::set_cursor(gbm_bo* buffer)
@@ -52,6 +52,12 @@ public:
     void clear_crtc() override;
     bool schedule_page_flip(FBHandle const& fb) override;
     void wait_for_page_flip() override;
+    Frame last_frame() const override;
+
+    auto planes() -> std::vector<KMSPlane> const& override;
+    bool test_planes(PlaneConfiguration const& configuration) override;
+    bool schedule_page_flip(PlaneConfiguration const& configuration) override;
+    bool add_page_flip(AtomicCommit& commit, FBHandle const& fb) override;
 
     bool set_cursor(gbm_bo* buffer) override;
     void move_cursor(geometry::Point destination) override;
@@ -70,7 +76,7 @@ public:
     bool buffer_requires_migration(gbm_bo* bo) const override;
     int drm_fd() const override;
 
-private:
+protected:
     bool ensure_crtc();
     void restore_saved_crtc();
 
@@ -103,6 +109,8 @@ private:
     MirPowerMode power_mode;
     int dpms_enum_id;
 
+    Frame last_frame_;
+
     std::mutex power_mutex;
 };
 
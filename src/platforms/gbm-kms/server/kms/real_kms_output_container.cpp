@@ -17,9 +17,51 @@
 #include <algorithm>
 #include "real_kms_output_container.h"
 #include "real_kms_output.h"
+#include "atomic_kms_output.h"
 #include "kms-utils/drm_mode_resources.h"
+#include "mir/log.h"
+
+#include <xf86drm.h>
 
 namespace mgg = mir::graphics::gbm;
+namespace mgk = mir::graphics::kms;
+
+namespace
+{
+/*
+ * Some drivers accept DRM_CLIENT_CAP_ATOMIC without exposing all the atomic
+ * properties (or with buggy ones), so check for the CRTC properties a modeset
+ * needs before committing to the atomic API. If they're missing, drop the cap
+ * again and stick to the legacy API.
+ */
+bool probe_atomic_kms(int drm_fd)
+{
+    if (drmSetClientCap(drm_fd, DRM_CLIENT_CAP_ATOMIC, 1))
+        return false;
+
+    try
+    {
+        mgk::DRMModeResources resources{drm_fd};
+
+        auto usable = resources.num_crtcs() > 0;
+        for (auto const& crtc : resources.crtcs())
+        {
+            mgk::ObjectProperties const properties{drm_fd, crtc};
+            usable = usable && properties.has_property("MODE_ID") && properties.has_property("ACTIVE");
+        }
+
+        if (usable)
+            return true;
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_debug("Failed to probe atomic modesetting: %s", error.what());
+    }
+
+    drmSetClientCap(drm_fd, DRM_CLIENT_CAP_ATOMIC, 0);
+    return false;
+}
+}
 
 mgg::RealKMSOutputContainer::RealKMSOutputContainer(
     std::vector<int> const& drm_fds,
@@ -55,6 +97,16 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
             continue;
         }
 
+        auto atomic = atomic_kms.find(drm_fd);
+        if (atomic == atomic_kms.end())
+        {
+            atomic = atomic_kms.emplace(drm_fd, probe_atomic_kms(drm_fd)).first;
+            mir::log_info(
+                "Using %s modesetting on DRM device fd %d",
+                atomic->second ? "atomic" : "legacy",
+                drm_fd);
+        }
+
         for (auto &&connector : resources->connectors())
         {
             // Caution: O(n²) here, but n is the number of outputs, so should
@@ -80,10 +132,20 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
             }
             else
             {
-                new_outputs.push_back(std::make_shared<RealKMSOutput>(
-                    drm_fd,
-                    std::move(connector),
-                    construct_page_flipper(drm_fd)));
+                if (atomic->second)
+                {
+                    new_outputs.push_back(std::make_shared<AtomicKMSOutput>(
+                        drm_fd,
+                        std::move(connector),
+                        construct_page_flipper(drm_fd)));
+                }
+                else
+                {
+                    new_outputs.push_back(std::make_shared<RealKMSOutput>(
+                        drm_fd,
+                        std::move(connector),
+                        construct_page_flipper(drm_fd)));
+                }
             }
         }
 
@@ -18,6 +18,7 @@
 #define MIR_GRAPHICS_GBM_REAL_KMS_OUTPUT_CONTAINER_H_
 
 #include "kms_output_container.h"
+#include <unordered_map>
 #include <vector>
 
 namespace mir
@@ -43,6 +44,8 @@ private:
     std::vector<int> const drm_fds;
     std::vector<std::shared_ptr<KMSOutput>> outputs;
     std::function<std::shared_ptr<PageFlipper>(int drm_fd)> const construct_page_flipper;
+    /// Whether each DRM device drives its outputs with atomic modesetting, once probed
+    std::unordered_map<int, bool> atomic_kms;
 };
 
 }
@@ -0,0 +1,293 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "display.h"
+#include "display_buffer.h"
+#include "display_configuration.h"
+
+#include "mir/graphics/display_configuration_policy.h"
+#include "mir/graphics/display_report.h"
+#include "mir/graphics/egl_error.h"
+#include "mir/graphics/egl_extensions.h"
+#include "mir/renderer/gl/context.h"
+
+#define MIR_LOG_COMPONENT "virtual-display"
+#include "mir/log.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace mg = mir::graphics;
+namespace mgv = mg::virt;
+namespace geom = mir::geometry;
+
+namespace
+{
+EGLint const context_attr[] = {
+    EGL_CONTEXT_CLIENT_VERSION, 2,
+    EGL_NONE
+};
+
+auto has_extension(char const* extensions, char const* extension) -> bool
+{
+    return extensions && strstr(extensions, extension);
+}
+}
+
+class mgv::Display::SurfacelessEGL
+{
+public:
+    SurfacelessEGL()
+        : display{surfaceless_display()}
+    {
+        EGLint major, minor;
+        if (eglInitialize(display, &major, &minor) == EGL_FALSE)
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to initialize EGL display"));
+
+        if (!has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+            BOOST_THROW_EXCEPTION(std::runtime_error("EGL implementation doesn't support EGL_KHR_surfaceless_context"));
+
+        eglBindAPI(EGL_OPENGL_ES_API);
+
+        // There are no window surfaces to match, which eglChooseConfig() asks for by default
+        EGLint const config_attr[] = {
+            EGL_SURFACE_TYPE, EGL_DONT_CARE,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+            EGL_NONE
+        };
+        EGLint num_configs;
+        if (eglChooseConfig(display, config_attr, &config, 1, &num_configs) == EGL_FALSE)
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to choose EGL config"));
+        if (num_configs != 1)
+            BOOST_THROW_EXCEPTION(std::runtime_error("No suitable EGL config for a surfaceless context"));
+
+        root_context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attr);
+        if (root_context == EGL_NO_CONTEXT)
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGL context"));
+    }
+
+    ~SurfacelessEGL()
+    {
+        // The display isn't terminated, as it may be shared with others in the process
+        eglDestroyContext(display, root_context);
+    }
+
+    EGLDisplay const display;
+    EGLConfig config;
+    EGLContext root_context;
+
+private:
+    static auto surfaceless_display() -> EGLDisplay
+    {
+        if (has_extension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS), "EGL_MESA_platform_surfaceless"))
+        {
+            try
+            {
+                mg::EGLExtensions::PlatformBaseEXT const platform_base;
+                auto const display = platform_base.eglGetPlatformDisplay(
+                    EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if (display != EGL_NO_DISPLAY)
+                    return display;
+            }
+            catch (std::runtime_error const&)
+            {
+            }
+        }
+
+        auto const display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY)
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to get EGL display"));
+        return display;
+    }
+};
+
+namespace
+{
+class SurfacelessContext : public mir::renderer::gl::Context
+{
+public:
+    SurfacelessContext(std::shared_ptr<void> egl_owner, EGLDisplay display, EGLConfig config, EGLContext shared_context)
+        : egl_owner{std::move(egl_owner)},
+          display{display},
+          context{eglCreateContext(display, config, shared_context, context_attr)}
+    {
+        if (context == EGL_NO_CONTEXT)
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to create EGL context"));
+    }
+
+    ~SurfacelessContext()
+    {
+        if (eglGetCurrentContext() == context)
+            release_current();
+        eglDestroyContext(display, context);
+    }
+
+    void make_current() const override
+    {
+        if (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) != EGL_TRUE)
+            BOOST_THROW_EXCEPTION(mg::egl_error("Failed to make EGL context current"));
+    }
+
+    void release_current() const override
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+private:
+    std::shared_ptr<void> const egl_owner;
+    EGLDisplay const display;
+    EGLContext const context;
+};
+}
+
+mgv::Display::Display(
+    std::vector<VirtualOutputConfig> const& output_configs,
+    FrameOptions const& frame_options,
+    std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+    std::shared_ptr<DisplayReport> const& report)
+    : report{report}
+{
+    geom::Point top_left{0, 0};
+    for (auto const& output_config : output_configs)
+    {
+        auto configuration = DisplayConfiguration::build_output(output_config, top_left);
+        auto display_buffer = std::make_unique<DisplayBuffer>(
+            configuration->id,
+            configuration->extents(),
+            configuration->modes[configuration->current_mode_index],
+            frame_options,
+            report);
+        top_left.x += as_delta(configuration->extents().size.width);
+        outputs.push_back(OutputInfo{std::move(display_buffer), std::move(configuration)});
+    }
+
+    auto const display_config = configuration();
+    initial_conf_policy->apply_to(*display_config);
+    configure(*display_config);
+    report->report_successful_display_construction();
+}
+
+mgv::Display::~Display() noexcept
+{
+    // What capacity tests come for: how many frames each output managed
+    for (auto const& output : outputs)
+    {
+        auto const [frames, elapsed] = output.display_buffer->frames_posted();
+        if (frames < 2)
+            continue;
+
+        auto const seconds = std::chrono::duration<double>{elapsed}.count();
+        mir::log_info(
+            "Output %d posted %lld frames in %.2fs (%.1f fps)",
+            output.config->id.as_value(),
+            static_cast<long long>(frames),
+            seconds,
+            seconds > 0 ? (frames - 1) / seconds : 0.0);
+    }
+}
+
+void mgv::Display::for_each_display_sync_group(std::function<void(mg::DisplaySyncGroup&)> const& f)
+{
+    std::lock_guard lock{mutex};
+    for (auto const& output : outputs)
+    {
+        f(*output.display_buffer);
+    }
+}
+
+auto mgv::Display::configuration() const -> std::unique_ptr<mg::DisplayConfiguration>
+{
+    std::lock_guard lock{mutex};
+    std::vector<DisplayConfigurationOutput> output_configurations;
+    for (auto const& output : outputs)
+    {
+        output_configurations.push_back(*output.config);
+    }
+    return std::make_unique<DisplayConfiguration>(output_configurations);
+}
+
+bool mgv::Display::apply_if_configuration_preserves_display_buffers(mg::DisplayConfiguration const& /*conf*/)
+{
+    return false;
+}
+
+void mgv::Display::configure(mg::DisplayConfiguration const& new_configuration)
+{
+    std::lock_guard lock{mutex};
+
+    if (!new_configuration.valid())
+    {
+        BOOST_THROW_EXCEPTION(std::logic_error("Invalid or inconsistent display configuration"));
+    }
+
+    new_configuration.for_each_output([&](DisplayConfigurationOutput const& conf_output)
+        {
+            auto const output = std::find_if(
+                outputs.begin(),
+                outputs.end(),
+                [&](auto const& candidate) { return candidate.config->id == conf_output.id; });
+
+            if (output == outputs.end())
+            {
+                mir::log_error("Could not find info for output %d", conf_output.id.as_value());
+                return;
+            }
+
+            *output->config = conf_output;
+            output->display_buffer->set_mode(conf_output.modes[conf_output.current_mode_index]);
+            output->display_buffer->set_view_area(conf_output.extents());
+            output->display_buffer->set_transformation(conf_output.transformation());
+        });
+}
+
+void mgv::Display::register_configuration_change_handler(
+    EventHandlerRegister& /*handlers*/,
+    DisplayConfigurationChangeHandler const& /*conf_change_handler*/)
+{
+    // Virtual outputs are never hotplugged
+}
+
+void mgv::Display::pause()
+{
+}
+
+void mgv::Display::resume()
+{
+}
+
+auto mgv::Display::create_hardware_cursor() -> std::shared_ptr<Cursor>
+{
+    return nullptr;
+}
+
+auto mgv::Display::create_gl_context() const -> std::unique_ptr<mir::renderer::gl::Context>
+{
+    std::lock_guard lock{mutex};
+    if (!egl)
+    {
+        egl = std::make_shared<SurfacelessEGL>();
+    }
+    return std::make_unique<SurfacelessContext>(egl, egl->display, egl->config, egl->root_context);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_VIRTUAL_DISPLAY_H_
+#define MIR_GRAPHICS_VIRTUAL_DISPLAY_H_
+
+#include "mir/graphics/display.h"
+#include "platform.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class DisplayReport;
+class DisplayConfigurationPolicy;
+struct DisplayConfigurationOutput;
+
+namespace virt
+{
+class DisplayBuffer;
+
+class Display : public graphics::Display
+{
+public:
+    Display(
+        std::vector<VirtualOutputConfig> const& outputs,
+        FrameOptions const& frame_options,
+        std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+        std::shared_ptr<DisplayReport> const& report);
+    ~Display() noexcept;
+
+    void for_each_display_sync_group(std::function<void(graphics::DisplaySyncGroup&)> const& f) override;
+
+    std::unique_ptr<graphics::DisplayConfiguration> configuration() const override;
+
+    bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const& conf) override;
+
+    void configure(graphics::DisplayConfiguration const&) override;
+
+    void register_configuration_change_handler(
+        EventHandlerRegister& handlers,
+        DisplayConfigurationChangeHandler const& conf_change_handler) override;
+
+    void pause() override;
+    void resume() override;
+
+    std::shared_ptr<Cursor> create_hardware_cursor() override;
+
+    /**
+     * Contexts on a surfaceless EGL display
+     *
+     * Nothing is composited with these (the outputs are drawn on the CPU), but the rendering
+     * platform and screenshots need them. They work with a software GL such as llvmpipe.
+     */
+    std::unique_ptr<renderer::gl::Context> create_gl_context() const override;
+
+private:
+    class SurfacelessEGL;
+
+    struct OutputInfo
+    {
+        std::unique_ptr<DisplayBuffer> display_buffer;
+        std::shared_ptr<DisplayConfigurationOutput> config;
+    };
+
+    std::shared_ptr<DisplayReport> const report;
+
+    std::mutex mutable mutex;
+    std::vector<OutputInfo> outputs;
+
+    /// Set up on first use, so that the outputs work even without EGL
+    std::shared_ptr<SurfacelessEGL> mutable egl;
+};
+}
+}
+}
+
+#endif // MIR_GRAPHICS_VIRTUAL_DISPLAY_H_
@@ -0,0 +1,251 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "display_buffer.h"
+#include "platform.h"
+#include "mir/graphics/display_report.h"
+
+#define MIR_LOG_COMPONENT "virtual-display"
+#include "mir/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace mg = mir::graphics;
+namespace mgv = mg::virt;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+class PixelMapping : public mrs::Mapping<unsigned char>
+{
+public:
+    PixelMapping(uint32_t* pixels, geom::Size size)
+        : pixels{pixels},
+          size_{size}
+    {
+    }
+
+    auto format() const -> MirPixelFormat override
+    {
+        return mir_pixel_format_xrgb_8888;
+    }
+
+    auto stride() const -> geom::Stride override
+    {
+        return geom::Stride{size_.width.as_int() * sizeof(uint32_t)};
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return size_;
+    }
+
+    auto data() -> unsigned char* override
+    {
+        return reinterpret_cast<unsigned char*>(pixels);
+    }
+
+    auto len() const -> size_t override
+    {
+        return stride().as_int() * size_.height.as_int();
+    }
+
+private:
+    uint32_t* const pixels;
+    geom::Size const size_;
+};
+
+auto period_of(mg::DisplayConfigurationMode const& mode) -> std::chrono::nanoseconds
+{
+    return std::chrono::nanoseconds{std::llround(1e9 / mode.vrefresh_hz)};
+}
+}
+
+mgv::DisplayBuffer::DisplayBuffer(
+    DisplayConfigurationOutputId output_id,
+    geom::Rectangle const& view_area,
+    DisplayConfigurationMode const& mode,
+    FrameOptions const& frame_options,
+    std::shared_ptr<DisplayReport> const& report)
+    : output_id{output_id},
+      vsync{frame_options.vsync},
+      dump_directory{frame_options.dump_directory},
+      dump_interval{std::max(frame_options.dump_interval, 1)},
+      report{report},
+      area{view_area},
+      epoch{time::PosixTimestamp::now(CLOCK_MONOTONIC)}
+{
+    set_mode(mode);
+}
+
+auto mgv::DisplayBuffer::view_area() const -> geom::Rectangle
+{
+    return area;
+}
+
+bool mgv::DisplayBuffer::overlay(RenderableList const& /*renderlist*/)
+{
+    return false;
+}
+
+auto mgv::DisplayBuffer::transformation() const -> glm::mat2
+{
+    return transform;
+}
+
+auto mgv::DisplayBuffer::native_display_buffer() -> NativeDisplayBuffer*
+{
+    return this;
+}
+
+auto mgv::DisplayBuffer::size() const -> geom::Size
+{
+    return pixel_size;
+}
+
+auto mgv::DisplayBuffer::map_back_buffer() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    return std::make_unique<PixelMapping>(pixels.data(), pixel_size);
+}
+
+auto mgv::DisplayBuffer::buffer_age() const -> int
+{
+    // There's nothing scanning out of our one buffer, so we draw straight into the last frame
+    return pixels_valid ? 1 : 0;
+}
+
+void mgv::DisplayBuffer::swap_buffers()
+{
+    pixels_valid = true;
+}
+
+void mgv::DisplayBuffer::for_each_display_buffer(std::function<void(graphics::DisplayBuffer&)> const& f)
+{
+    f(*this);
+}
+
+void mgv::DisplayBuffer::post()
+{
+    auto const now = time::PosixTimestamp::now(CLOCK_MONOTONIC);
+
+    Frame next;
+    {
+        std::lock_guard lock{frame_mutex};
+        next = frame;
+    }
+
+    if (vsync)
+    {
+        // Show the frame at the next tick, but never at the same one as the last
+        int64_t const ticks = (now - epoch) / frame_period + 1;
+        next.msc = std::max(ticks, next.msc + 1);
+        next.ust = epoch + next.msc * frame_period;
+        time::sleep_until(next.ust);
+    }
+    else
+    {
+        next.msc++;
+        next.ust = now;
+    }
+    next.vsync = vsync;
+
+    if (dump_directory && posted % dump_interval == 0)
+    {
+        dump_frame(posted);
+    }
+
+    {
+        std::lock_guard lock{frame_mutex};
+        if (posted++ == 0)
+            first_post = next.ust;
+        frame = next;
+    }
+    report->report_vsync(output_id.as_value(), next);
+}
+
+auto mgv::DisplayBuffer::recommended_sleep() const -> std::chrono::milliseconds
+{
+    return std::chrono::milliseconds::zero();
+}
+
+auto mgv::DisplayBuffer::last_frame() const -> std::optional<Frame>
+{
+    std::lock_guard lock{frame_mutex};
+    if (posted == 0)
+        return std::nullopt;
+    return frame;
+}
+
+void mgv::DisplayBuffer::set_view_area(geom::Rectangle const& a)
+{
+    area = a;
+}
+
+void mgv::DisplayBuffer::set_transformation(glm::mat2 const& t)
+{
+    transform = t;
+}
+
+void mgv::DisplayBuffer::set_mode(DisplayConfigurationMode const& mode)
+{
+    frame_period = period_of(mode);
+    if (mode.size == pixel_size)
+        return;
+
+    pixel_size = mode.size;
+    pixels.assign(pixel_size.width.as_int() * pixel_size.height.as_int(), 0);
+    pixels_valid = false;
+}
+
+auto mgv::DisplayBuffer::frames_posted() const -> std::pair<int64_t, std::chrono::nanoseconds>
+{
+    std::lock_guard lock{frame_mutex};
+    if (posted == 0)
+        return {0, std::chrono::nanoseconds::zero()};
+    return {posted, frame.ust - first_post};
+}
+
+void mgv::DisplayBuffer::dump_frame(int64_t frame_number) const
+{
+    char name[64];
+    snprintf(name, sizeof name, "/output-%d-%06lld.ppm", output_id.as_value(), static_cast<long long>(frame_number));
+    auto const path = dump_directory.value() + name;
+
+    std::ofstream file{path, std::ios::binary};
+    file << "P6\n" << pixel_size.width.as_int() << " " << pixel_size.height.as_int() << "\n255\n";
+
+    std::vector<char> row(pixel_size.width.as_int() * 3);
+    for (int y = 0; y != pixel_size.height.as_int(); ++y)
+    {
+        auto const* const source = pixels.data() + y * pixel_size.width.as_int();
+        for (int x = 0; x != pixel_size.width.as_int(); ++x)
+        {
+            row[3 * x] = static_cast<char>(source[x] >> 16);
+            row[3 * x + 1] = static_cast<char>(source[x] >> 8);
+            row[3 * x + 2] = static_cast<char>(source[x]);
+        }
+        file.write(row.data(), row.size());
+    }
+
+    if (!file)
+    {
+        mir::log_warning("Failed to dump frame to %s", path.c_str());
+    }
+}
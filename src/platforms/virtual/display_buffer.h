@@ -0,0 +1,113 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_VIRTUAL_DISPLAY_BUFFER_H_
+#define MIR_GRAPHICS_VIRTUAL_DISPLAY_BUFFER_H_
+
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/display.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/graphics/frame.h"
+#include "mir/renderer/sw/render_target.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class DisplayReport;
+
+namespace virt
+{
+struct FrameOptions;
+
+/**
+ * An output that exists only in memory
+ *
+ * Frames are composited on the CPU into a buffer of our own (so no GPU is needed) and
+ * "shown" at the next tick of a simulated vblank clock running at the mode's refresh rate.
+ */
+class DisplayBuffer : public graphics::DisplayBuffer,
+                      public graphics::DisplaySyncGroup,
+                      public graphics::NativeDisplayBuffer,
+                      public renderer::software::RenderTarget
+{
+public:
+    DisplayBuffer(
+        DisplayConfigurationOutputId output_id,
+        geometry::Rectangle const& view_area,
+        DisplayConfigurationMode const& mode,
+        FrameOptions const& frame_options,
+        std::shared_ptr<DisplayReport> const& report);
+
+    /* From graphics::DisplayBuffer */
+    geometry::Rectangle view_area() const override;
+    bool overlay(RenderableList const& renderlist) override;
+    glm::mat2 transformation() const override;
+    NativeDisplayBuffer* native_display_buffer() override;
+
+    /* From renderer::software::RenderTarget */
+    auto size() const -> geometry::Size override;
+    auto map_back_buffer() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
+    auto buffer_age() const -> int override;
+    void swap_buffers() override;
+
+    /* From graphics::DisplaySyncGroup */
+    void for_each_display_buffer(std::function<void(graphics::DisplayBuffer&)> const& f) override;
+    void post() override;
+    std::chrono::milliseconds recommended_sleep() const override;
+    auto last_frame() const -> std::optional<Frame> override;
+
+    void set_view_area(geometry::Rectangle const& a);
+    void set_transformation(glm::mat2 const& t);
+    void set_mode(DisplayConfigurationMode const& mode);
+
+    /// The number of frames posted so far, and the time taken to post them
+    auto frames_posted() const -> std::pair<int64_t, std::chrono::nanoseconds>;
+
+private:
+    void dump_frame(int64_t frame_number) const;
+
+    DisplayConfigurationOutputId const output_id;
+    bool const vsync;
+    std::optional<std::string> const dump_directory;
+    int const dump_interval;
+    std::shared_ptr<DisplayReport> const report;
+
+    geometry::Rectangle area;
+    glm::mat2 transform{1};
+    geometry::Size pixel_size;
+    std::chrono::nanoseconds frame_period;
+    std::vector<uint32_t> pixels;
+    /// Whether pixels holds the last frame drawn, which the renderer may then draw over
+    bool pixels_valid{false};
+
+    /// The simulated vblank clock ticks at epoch + n * frame_period
+    time::PosixTimestamp const epoch;
+    time::PosixTimestamp first_post;
+    int64_t posted{0};
+    std::mutex mutable frame_mutex;
+    Frame frame;
+};
+}
+}
+}
+
+#endif // MIR_GRAPHICS_VIRTUAL_DISPLAY_BUFFER_H_
@@ -0,0 +1,97 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "display_configuration.h"
+#include "platform.h"
+
+namespace mg = mir::graphics;
+namespace mgv = mg::virt;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// Outputs have no real physical size, so report that of a 96 DPI monitor
+auto millimetres(geom::Size pixels) -> geom::Size
+{
+    return pixels * (25.4 / 96);
+}
+}
+
+int mgv::DisplayConfiguration::last_output_id{0};
+
+auto mgv::DisplayConfiguration::build_output(
+    VirtualOutputConfig const& config,
+    geom::Point top_left) -> std::shared_ptr<DisplayConfigurationOutput>
+{
+    last_output_id++;
+    return std::shared_ptr<DisplayConfigurationOutput>(
+        new DisplayConfigurationOutput{
+            mg::DisplayConfigurationOutputId{last_output_id},
+            mg::DisplayConfigurationCardId{0},
+            mg::DisplayConfigurationLogicalGroupId{0},
+            mg::DisplayConfigurationOutputType::virt,
+            {mir_pixel_format_xrgb_8888},
+            config.modes,
+            0,
+            millimetres(config.modes[0].size),
+            true,
+            true,
+            top_left,
+            0,
+            mir_pixel_format_xrgb_8888,
+            mir_power_mode_on,
+            mir_orientation_normal,
+            config.scale,
+            mir_form_factor_monitor,
+            mir_subpixel_arrangement_unknown,
+            {},
+            mir_output_gamma_unsupported,
+            {},
+            {}});
+}
+
+mgv::DisplayConfiguration::DisplayConfiguration(std::vector<mg::DisplayConfigurationOutput> const& configuration)
+    : configuration{configuration}
+{
+}
+
+mgv::DisplayConfiguration::DisplayConfiguration(DisplayConfiguration const& other)
+    : mg::DisplayConfiguration(),
+      configuration(other.configuration)
+{
+}
+
+void mgv::DisplayConfiguration::for_each_output(std::function<void(mg::DisplayConfigurationOutput const&)> f) const
+{
+    for (auto const& output : configuration)
+    {
+        f(output);
+    }
+}
+
+void mgv::DisplayConfiguration::for_each_output(std::function<void(mg::UserDisplayConfigurationOutput&)> f)
+{
+    for (auto& output : configuration)
+    {
+        mg::UserDisplayConfigurationOutput user(output);
+        f(user);
+    }
+}
+
+auto mgv::DisplayConfiguration::clone() const -> std::unique_ptr<mg::DisplayConfiguration>
+{
+    return std::make_unique<mgv::DisplayConfiguration>(*this);
+}
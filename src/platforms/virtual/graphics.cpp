@@ -0,0 +1,120 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform.h"
+#include "mir/graphics/display_report.h"
+#include "mir/options/option.h"
+#include "mir/options/program_option.h"
+#include "mir/module_deleter.h"
+#include "mir/assert_module_entry_point.h"
+#include "mir/libname.h"
+
+namespace mo = mir::options;
+namespace mg = mir::graphics;
+namespace mgv = mg::virt;
+
+namespace
+{
+char const* virtual_output_option_name{"virtual-output"};
+char const* virtual_vsync_option_name{"virtual-vsync"};
+char const* virtual_dump_frames_option_name{"virtual-dump-frames"};
+char const* virtual_dump_interval_option_name{"virtual-dump-interval"};
+}
+
+mir::UniqueModulePtr<mg::DisplayPlatform> create_display_platform(
+    mg::SupportedDevice const&,
+    std::shared_ptr<mo::Option> const& options,
+    std::shared_ptr<mir::EmergencyCleanupRegistry> const&,
+    std::shared_ptr<mir::ConsoleServices> const&,
+    std::shared_ptr<mg::DisplayReport> const& report)
+{
+    mir::assert_entry_point_signature<mg::CreateDisplayPlatform>(&create_display_platform);
+
+    auto outputs = mgv::Platform::parse_output_configs(options->get<std::string>(virtual_output_option_name));
+
+    mgv::FrameOptions frame_options{
+        options->get<bool>(virtual_vsync_option_name),
+        std::nullopt,
+        options->get<int>(virtual_dump_interval_option_name)};
+    if (options->is_set(virtual_dump_frames_option_name))
+    {
+        frame_options.dump_directory = options->get<std::string>(virtual_dump_frames_option_name);
+    }
+
+    return mir::make_module_ptr<mgv::Platform>(std::move(outputs), std::move(frame_options), report);
+}
+
+void add_graphics_platform_options(boost::program_options::options_description& config)
+{
+    mir::assert_entry_point_signature<mg::AddPlatformOptions>(&add_graphics_platform_options);
+    config.add_options()
+        (virtual_output_option_name,
+         boost::program_options::value<std::string>(),
+         "[mir-on-virtual specific] Colon separated list of outputs to create, each a comma separated list of"
+         " WIDTHxHEIGHT@HZ modes (@HZ is optional, and defaults to 60). The first mode is the one the output"
+         " starts in. ^SCALE may also be appended to any output");
+
+    config.add_options()
+        (virtual_vsync_option_name,
+         boost::program_options::value<bool>()->default_value(true),
+         "[mir-on-virtual specific] Show frames at each output's refresh rate. When false, frames are shown"
+         " as fast as they can be composited");
+
+    config.add_options()
+        (virtual_dump_frames_option_name,
+         boost::program_options::value<std::string>(),
+         "[mir-on-virtual specific] Directory to write output frames to, as PPM images");
+
+    config.add_options()
+        (virtual_dump_interval_option_name,
+         boost::program_options::value<int>()->default_value(1),
+         "[mir-on-virtual specific] Write only every Nth frame of each output to the dump directory");
+}
+
+auto probe_display_platform(
+    std::shared_ptr<mir::ConsoleServices> const&,
+    std::shared_ptr<mir::udev::Context> const&,
+    mo::ProgramOption const& options) -> std::vector<mg::SupportedDevice>
+{
+    mir::assert_entry_point_signature<mg::PlatformProbe>(&probe_display_platform);
+
+    // Virtual outputs are only wanted when asked for, but then alongside any others
+    if (!options.is_set(virtual_output_option_name))
+    {
+        return {};
+    }
+
+    std::vector<mg::SupportedDevice> result;
+    result.emplace_back(mg::SupportedDevice{nullptr, mg::PlatformPriority::supported, nullptr});
+    return result;
+}
+
+namespace
+{
+mir::ModuleProperties const description = {
+    "mir:virtual",
+    MIR_VERSION_MAJOR,
+    MIR_VERSION_MINOR,
+    MIR_VERSION_MICRO,
+    mir::libname()
+};
+}
+
+mir::ModuleProperties const* describe_graphics_module()
+{
+    mir::assert_entry_point_signature<mg::DescribeModule>(&describe_graphics_module);
+    return &description;
+}
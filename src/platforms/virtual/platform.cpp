@@ -0,0 +1,132 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform.h"
+#include "display.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mgv = mg::virt;
+namespace geom = mir::geometry;
+
+namespace
+{
+template<typename T, typename Parse>
+auto parse_number(std::string const& str, char const* what, Parse parse) -> T
+{
+    try
+    {
+        size_t num_end = 0;
+        T const value = parse(str, &num_end);
+        if (num_end != str.size())
+            BOOST_THROW_EXCEPTION(std::runtime_error(std::string{what} + " \"" + str + "\" is not a valid number"));
+        if (value <= 0)
+            BOOST_THROW_EXCEPTION(std::runtime_error(std::string{what} + " must be greater than zero"));
+        return value;
+    }
+    catch (std::invalid_argument const&)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error(std::string{what} + " \"" + str + "\" is not a valid number"));
+    }
+    catch (std::out_of_range const&)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error(std::string{what} + " \"" + str + "\" is out of range"));
+    }
+}
+
+auto parse_dimension(std::string const& str) -> int
+{
+    return parse_number<int>(str, "Output dimension", [](auto const& s, auto* end) { return std::stoi(s, end); });
+}
+
+auto parse_mode(std::string const& str) -> mg::DisplayConfigurationMode
+{
+    auto const x = str.find('x'); // "x" between width and height
+    if (x == std::string::npos || x == 0 || x >= str.size() - 1)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Output mode \"" + str + "\" does not have two dimensions"));
+
+    auto const at = str.find('@'); // start of refresh rate
+    double refresh_rate = 60.0;
+    if (at != std::string::npos)
+    {
+        if (at >= str.size() - 1)
+            BOOST_THROW_EXCEPTION(std::runtime_error("In \"" + str + "\", '@' is not followed by a refresh rate"));
+        refresh_rate = parse_number<double>(
+            str.substr(at + 1), "Refresh rate", [](auto const& s, auto* end) { return std::stod(s, end); });
+    }
+
+    return mg::DisplayConfigurationMode{
+        geom::Size{parse_dimension(str.substr(0, x)), parse_dimension(str.substr(x + 1, at - x - 1))},
+        refresh_rate};
+}
+
+auto parse_output(std::string const& str) -> mgv::VirtualOutputConfig
+{
+    auto const scale_start = str.find('^'); // start of output scale
+    float scale = 1.0f;
+    if (scale_start != std::string::npos)
+    {
+        if (scale_start >= str.size() - 1)
+            BOOST_THROW_EXCEPTION(std::runtime_error("In \"" + str + "\", '^' is not followed by a scale"));
+        scale = parse_number<float>(
+            str.substr(scale_start + 1), "Scale", [](auto const& s, auto* end) { return std::stof(s, end); });
+    }
+
+    auto const modes = str.substr(0, scale_start);
+    std::vector<mg::DisplayConfigurationMode> result;
+    for (std::string::size_type start = 0, end; start <= modes.size(); start = end + 1)
+    {
+        end = modes.find(',', start);
+        if (end == std::string::npos)
+            end = modes.size();
+        result.push_back(parse_mode(modes.substr(start, end - start)));
+    }
+    return mgv::VirtualOutputConfig{std::move(result), scale};
+}
+}
+
+auto mgv::Platform::parse_output_configs(std::string const& outputs) -> std::vector<VirtualOutputConfig>
+{
+    std::vector<VirtualOutputConfig> configs;
+    for (std::string::size_type start = 0, end; start <= outputs.size(); start = end + 1)
+    {
+        end = outputs.find(':', start);
+        if (end == std::string::npos)
+            end = outputs.size();
+        configs.push_back(parse_output(outputs.substr(start, end - start)));
+    }
+    return configs;
+}
+
+mgv::Platform::Platform(
+    std::vector<VirtualOutputConfig> outputs,
+    FrameOptions frame_options,
+    std::shared_ptr<mg::DisplayReport> const& report)
+    : outputs{std::move(outputs)},
+      frame_options{std::move(frame_options)},
+      report{report}
+{
+}
+
+auto mgv::Platform::create_display(
+    std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+    std::shared_ptr<GLConfig> const&) -> UniqueModulePtr<mg::Display>
+{
+    return make_module_ptr<mgv::Display>(outputs, frame_options, initial_conf_policy, report);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_VIRTUAL_PLATFORM_H_
+#define MIR_GRAPHICS_VIRTUAL_PLATFORM_H_
+
+#include "mir/graphics/platform.h"
+#include "mir/graphics/display_configuration.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class DisplayReport;
+
+namespace virt
+{
+struct VirtualOutputConfig
+{
+    /// The modes the output offers; the first is the one it starts in
+    std::vector<DisplayConfigurationMode> modes;
+    float scale;
+};
+
+/// How the outputs present their frames
+struct FrameOptions
+{
+    /// Hold each post() until the output's next simulated vblank, rather than returning at once
+    bool vsync;
+    /// Where to write frames as PPM images, if anywhere
+    std::optional<std::string> dump_directory;
+    /// Dump every dump_interval-th frame of each output
+    int dump_interval;
+};
+
+class Platform : public graphics::DisplayPlatform
+{
+public:
+    /**
+     * Parses a colon separated list of outputs
+     *
+     * Each output is a comma separated list of modes in the form WIDTHxHEIGHT@HZ (@HZ is
+     * optional, and defaults to 60), optionally followed by ^SCALE.
+     */
+    static auto parse_output_configs(std::string const& outputs) -> std::vector<VirtualOutputConfig>;
+
+    Platform(
+        std::vector<VirtualOutputConfig> outputs,
+        FrameOptions frame_options,
+        std::shared_ptr<DisplayReport> const& report);
+
+    UniqueModulePtr<graphics::Display> create_display(
+        std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
+        std::shared_ptr<GLConfig> const& gl_config) override;
+
+private:
+    std::vector<VirtualOutputConfig> const outputs;
+    FrameOptions const frame_options;
+    std::shared_ptr<DisplayReport> const report;
+};
+}
+}
+}
+
+#endif // MIR_GRAPHICS_VIRTUAL_PLATFORM_H_
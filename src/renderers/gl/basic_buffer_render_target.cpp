@@ -18,26 +18,25 @@
 #include "mir/renderer/gl/context.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/graphics/egl_error.h"
+#include "mir/graphics/egl_extensions.h"
+#include "mir/graphics/dmabuf_buffer.h"
 
 #include <boost/throw_exception.hpp>
 #include <GLES2/gl2ext.h>
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 namespace mg = mir::graphics;
 namespace mrg = mir::renderer::gl;
 namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
 
-mrg::BasicBufferRenderTarget::Framebuffer::Framebuffer(geometry::Size const& size)
-    : size{size}
+namespace
+{
+void ensure_framebuffer_complete()
 {
-    glGenRenderbuffers(1, &colour_buffer);
-    glGenFramebuffers(1, &fbo);
-
-    glBindRenderbuffer(GL_RENDERBUFFER, colour_buffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8_OES, size.width.as_int(), size.height.as_int());
-
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour_buffer);
-
     auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     if (status != GL_FRAMEBUFFER_COMPLETE)
     {
@@ -69,6 +68,172 @@ mrg::BasicBufferRenderTarget::Framebuffer::Framebuffer(geometry::Size const& siz
             std::runtime_error{
                 std::string{"Unknown GL framebuffer error code: "} + std::to_string(status)}));
     }
+}
+
+struct EGLPlaneAttribs
+{
+    EGLint fd;
+    EGLint offset;
+    EGLint pitch;
+    EGLint modifier_lo;
+    EGLint modifier_hi;
+};
+
+std::array<EGLPlaneAttribs, 4> const egl_plane_attribs = {
+    EGLPlaneAttribs{
+        EGL_DMA_BUF_PLANE0_FD_EXT,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT,
+        EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT},
+    EGLPlaneAttribs{
+        EGL_DMA_BUF_PLANE1_FD_EXT,
+        EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE1_PITCH_EXT,
+        EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT},
+    EGLPlaneAttribs{
+        EGL_DMA_BUF_PLANE2_FD_EXT,
+        EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE2_PITCH_EXT,
+        EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT},
+    EGLPlaneAttribs{
+        EGL_DMA_BUF_PLANE3_FD_EXT,
+        EGL_DMA_BUF_PLANE3_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE3_PITCH_EXT,
+        EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT},
+};
+
+auto dmabuf_image_attribs(mg::DMABufBuffer const& dmabuf) -> std::vector<EGLint>
+{
+    auto const& planes = dmabuf.planes();
+    if (planes.empty() || planes.size() > egl_plane_attribs.size())
+    {
+        BOOST_THROW_EXCEPTION(std::logic_error("dmabuf has an unsupported number of planes"));
+    }
+
+    std::vector<EGLint> attribs{
+        EGL_WIDTH, dmabuf.size().width.as_int(),
+        EGL_HEIGHT, dmabuf.size().height.as_int(),
+        EGL_LINUX_DRM_FOURCC_EXT, static_cast<EGLint>(dmabuf.drm_fourcc())};
+
+    for (auto i = 0u; i != planes.size(); ++i)
+    {
+        auto const& names = egl_plane_attribs[i];
+        attribs.insert(attribs.end(), {
+            names.fd, static_cast<int>(planes[i].dma_buf),
+            names.offset, static_cast<EGLint>(planes[i].offset),
+            names.pitch, static_cast<EGLint>(planes[i].stride)});
+        if (auto const modifier = dmabuf.modifier())
+        {
+            attribs.insert(attribs.end(), {
+                names.modifier_lo, static_cast<EGLint>(modifier.value() & 0xFFFFFFFF),
+                names.modifier_hi, static_cast<EGLint>(modifier.value() >> 32)});
+        }
+    }
+    attribs.push_back(EGL_NONE);
+    return attribs;
+}
+
+/// Screencopy clients cycle through a few buffers, so keeping this many imports covers them
+auto const max_dmabuf_framebuffers = 4u;
+}
+
+class mrg::BasicBufferRenderTarget::DMABufFramebuffer
+{
+public:
+    DMABufFramebuffer(mg::EGLExtensions const& egl_extensions, mg::DMABufBuffer const& dmabuf)
+        : size{dmabuf.size()},
+          fourcc{dmabuf.drm_fourcc()},
+          modifier{dmabuf.modifier()},
+          planes{dmabuf.planes()}
+    {
+        auto const dpy = eglGetCurrentDisplay();
+        auto const& ext = egl_extensions.base(dpy);
+        auto const attribs = dmabuf_image_attribs(dmabuf);
+        auto const image = ext.eglCreateImageKHR(dpy, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attribs.data());
+        if (image == EGL_NO_IMAGE_KHR)
+        {
+            BOOST_THROW_EXCEPTION((mg::egl_error("Failed to import screencopy target dmabuf")));
+        }
+
+        glGenTextures(1, &colour_texture);
+        glBindTexture(GL_TEXTURE_2D, colour_texture);
+        ext.glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, image);
+        // The texture is now an EGLImage sibling, so keeps the dmabuf alive without the image
+        ext.eglDestroyImageKHR(dpy, image);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colour_texture, 0);
+        try
+        {
+            ensure_framebuffer_complete();
+        }
+        catch (...)
+        {
+            glDeleteFramebuffers(1, &fbo);
+            glDeleteTextures(1, &colour_texture);
+            throw;
+        }
+    }
+
+    ~DMABufFramebuffer()
+    {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteTextures(1, &colour_texture);
+    }
+
+    /// Whether dmabuf is the buffer this imported (the planes hold its fds open, so they can't have been reused)
+    auto imports(mg::DMABufBuffer const& dmabuf) const -> bool
+    {
+        auto const& other_planes = dmabuf.planes();
+        return dmabuf.size() == size &&
+               dmabuf.drm_fourcc() == fourcc &&
+               dmabuf.modifier() == modifier &&
+               std::equal(
+                   begin(planes), end(planes),
+                   begin(other_planes), end(other_planes),
+                   [](auto const& a, auto const& b)
+                   {
+                       return int{a.dma_buf} == int{b.dma_buf} && a.stride == b.stride && a.offset == b.offset;
+                   });
+    }
+
+    void bind()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    }
+
+    geom::Size const size;
+
+private:
+    DMABufFramebuffer(DMABufFramebuffer const&) = delete;
+    DMABufFramebuffer& operator=(DMABufFramebuffer const&) = delete;
+
+    uint32_t const fourcc;
+    std::optional<uint64_t> const modifier;
+    std::vector<mg::DMABufBuffer::PlaneDescriptor> const planes;
+
+    GLuint colour_texture;
+    GLuint fbo;
+};
+
+mrg::BasicBufferRenderTarget::Framebuffer::Framebuffer(geometry::Size const& size)
+    : size{size}
+{
+    glGenRenderbuffers(1, &colour_buffer);
+    glGenFramebuffers(1, &fbo);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colour_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8_OES, size.width.as_int(), size.height.as_int());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour_buffer);
+
+    ensure_framebuffer_complete();
 
     // gl::Renderer can only set glViewport if there is a current EGL surface to get the size from. Since we don't bind
     // an EGL surface when rendering to a buffer, we have to set the viewport ourselves.
@@ -113,20 +278,74 @@ mrg::BasicBufferRenderTarget::BasicBufferRenderTarget(std::shared_ptr<Context> c
 {
 }
 
+mrg::BasicBufferRenderTarget::~BasicBufferRenderTarget() = default;
+
 void mrg::BasicBufferRenderTarget::set_buffer(std::shared_ptr<software::WriteMappableBuffer> const& buffer)
 {
+    bool const was_dmabuf{dmabuf_framebuffer != nullptr};
+    dmabuf_framebuffer = nullptr;
+    dmabuf.reset();
     this->buffer = buffer;
     if (framebuffer && framebuffer->size == buffer->size())
     {
+        if (was_dmabuf)
+        {
+            // The dmabuf framebuffer set its own viewport
+            glViewport(0, 0, framebuffer->size.width.as_int(), framebuffer->size.height.as_int());
+        }
         return;
     }
     framebuffer.reset();
     framebuffer.emplace(buffer->size());
 }
 
+void mrg::BasicBufferRenderTarget::set_dmabuf(std::shared_ptr<graphics::Buffer> const& buffer)
+{
+    auto const dmabuf_buffer = dynamic_cast<mg::DMABufBuffer*>(buffer->native_buffer_base());
+    if (!dmabuf_buffer)
+    {
+        BOOST_THROW_EXCEPTION(std::logic_error("set_dmabuf() called with a buffer that is not a dmabuf"));
+    }
+
+    this->buffer.reset();
+    dmabuf_framebuffer = nullptr;
+    dmabuf.reset();
+
+    auto const imported = std::find_if(
+        begin(dmabuf_framebuffers),
+        end(dmabuf_framebuffers),
+        [&](auto const& framebuffer) { return framebuffer->imports(*dmabuf_buffer); });
+    if (imported != end(dmabuf_framebuffers))
+    {
+        // Keep the most recently used first
+        std::rotate(begin(dmabuf_framebuffers), imported, imported + 1);
+    }
+    else
+    {
+        if (!egl_extensions)
+        {
+            egl_extensions = std::make_unique<mg::EGLExtensions>();
+        }
+        auto framebuffer = std::make_unique<DMABufFramebuffer>(*egl_extensions, *dmabuf_buffer);
+        if (dmabuf_framebuffers.size() == max_dmabuf_framebuffers)
+        {
+            dmabuf_framebuffers.pop_back();
+        }
+        dmabuf_framebuffers.insert(begin(dmabuf_framebuffers), std::move(framebuffer));
+    }
+
+    dmabuf_framebuffer = dmabuf_framebuffers.front().get();
+    dmabuf = buffer;
+    glViewport(0, 0, dmabuf_framebuffer->size.width.as_int(), dmabuf_framebuffer->size.height.as_int());
+}
+
 auto mrg::BasicBufferRenderTarget::size() const -> geometry::Size
 {
-    if (framebuffer)
+    if (dmabuf_framebuffer)
+    {
+        return dmabuf_framebuffer->size;
+    }
+    else if (framebuffer)
     {
         return framebuffer.value().size;
     }
@@ -148,6 +367,13 @@ void mrg::BasicBufferRenderTarget::release_current()
 
 void mrg::BasicBufferRenderTarget::swap_buffers()
 {
+    if (dmabuf_framebuffer)
+    {
+        // The client's access to the dmabuf is implicitly synchronised with rendering, as with the client buffers
+        // we composite, so submitting the commands is enough
+        glFlush();
+        return;
+    }
     if (!framebuffer || !buffer)
     {
         BOOST_THROW_EXCEPTION(std::logic_error("swap_buffers() called when buffer unset"));
@@ -157,6 +383,11 @@ void mrg::BasicBufferRenderTarget::swap_buffers()
 
 void mrg::BasicBufferRenderTarget::bind()
 {
+    if (dmabuf_framebuffer)
+    {
+        dmabuf_framebuffer->bind();
+        return;
+    }
     if (!framebuffer)
     {
         BOOST_THROW_EXCEPTION(std::logic_error("bind() called without framebuffer"));
@@ -36,6 +36,8 @@
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
 #include <cmath>
+#include <cstddef>
+#include <limits>
 #include <sstream>
 #include <mutex>
 
@@ -71,6 +73,16 @@ void mrg::CurrentRenderTarget::bind()
     render_target->bind();
 }
 
+auto mrg::CurrentRenderTarget::buffer_age() const -> int
+{
+    return render_target->buffer_age();
+}
+
+void mrg::CurrentRenderTarget::set_damage_region(geom::Rectangles const& damage)
+{
+    render_target->set_damage_region(damage);
+}
+
 void mrg::CurrentRenderTarget::swap_buffers()
 {
     render_target->swap_buffers();
@@ -78,6 +90,12 @@ void mrg::CurrentRenderTarget::swap_buffers()
 
 namespace
 {
+/*
+ * EGL implementations rarely keep more than a handful of buffers in
+ * rotation; anything older than this is simply redrawn in full.
+ */
+std::size_t const max_tracked_buffer_age = 4;
+
 template<void (* deleter)(GLuint)>
 class GLHandle
 {
@@ -112,8 +130,34 @@ private:
     GLuint id;
 };
 
+void delete_buffer(GLuint id)
+{
+    glDeleteBuffers(1, &id);
+}
+
 using ProgramHandle = GLHandle<&glDeleteProgram>;
 using ShaderHandle = GLHandle<&glDeleteShader>;
+using BufferHandle = GLHandle<&delete_buffer>;
+
+/*
+ * Renderables' transformations and alpha are applied to their vertices on the
+ * CPU, so that drawing them needs no per-renderable uniforms.
+ */
+struct BatchVertex
+{
+    GLfloat position[4];
+    GLfloat texcoord[2];
+    GLfloat alpha;
+};
+
+struct BlendState  // Represents parameters of glBlendFuncSeparate() and glBlendColor()
+{
+    GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
+    GLfloat constant_alpha;
+
+    auto enabled() const -> bool { return dst_rgb != GL_ZERO; }
+    bool operator==(BlendState const&) const = default;
+};
 
 struct Program : public mir::graphics::gl::Program
 {
@@ -132,22 +176,107 @@ public:
 
 const GLchar* const vertex_shader_src =
 {
-    "attribute vec3 position;\n"
+    "attribute vec4 position;\n"
     "attribute vec2 texcoord;\n"
+    "attribute float alpha;\n"
     "uniform mat4 screen_to_gl_coords;\n"
     "uniform mat4 display_transform;\n"
-    "uniform mat4 transform;\n"
-    "uniform vec2 centre;\n"
     "varying vec2 v_texcoord;\n"
+    "varying float v_alpha;\n"
     "void main() {\n"
-    "   vec4 mid = vec4(centre, 0.0, 0.0);\n"
-    "   vec4 transformed = (transform * (vec4(position, 1.0) - mid)) + mid;\n"
-    "   gl_Position = display_transform * screen_to_gl_coords * transformed;\n"
+    "   gl_Position = display_transform * screen_to_gl_coords * position;\n"
     "   v_texcoord = texcoord;\n"
+    "   v_alpha = alpha;\n"
     "}\n"
 };
+
+/// Append the vertices of primitive to vertices, as the equivalent GL_TRIANGLES
+void append_triangles(
+    std::vector<BatchVertex>& vertices,
+    mgl::Primitive const& primitive,
+    glm::mat4 const& transform,
+    glm::vec4 const& mid,
+    GLfloat alpha)
+{
+    auto const append = [&](int index)
+        {
+            auto const& vertex = primitive.vertices[index];
+            auto const position = transform * (glm::vec4{
+                vertex.position[0], vertex.position[1], vertex.position[2], 1.0f} - mid) + mid;
+            vertices.push_back(BatchVertex{
+                {position.x, position.y, position.z, position.w},
+                {vertex.texcoord[0], vertex.texcoord[1]},
+                alpha});
+        };
+
+    switch (primitive.type)
+    {
+    case GL_TRIANGLE_STRIP:
+        for (auto i = 2; i < primitive.nvertices; ++i)
+        {
+            append(i - 2);
+            append(i - 1);
+            append(i);
+        }
+        break;
+
+    case GL_TRIANGLE_FAN:
+        for (auto i = 2; i < primitive.nvertices; ++i)
+        {
+            append(0);
+            append(i - 1);
+            append(i);
+        }
+        break;
+
+    default:
+        for (auto i = 0; i < primitive.nvertices; ++i)
+            append(i);
+        break;
+    }
+}
+
+auto batched_mode_of(GLenum type) -> GLenum
+{
+    switch (type)
+    {
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+        return GL_TRIANGLES;
+
+    default:
+        return type;
+    }
+}
 }
 
+class mrg::Renderer::Batch
+{
+public:
+    // NOTE: This must be called with a current GL context
+    Batch()
+        : vbo{[]{ GLuint id{0}; glGenBuffers(1, &id); return id; }()}
+    {
+    }
+
+    struct Draw
+    {
+        Program const* program;
+        mg::Renderable const* renderable;
+        std::shared_ptr<mg::Buffer> buffer;
+        mg::gl::Texture* texture;
+        BlendState blend;
+        std::optional<geom::Rectangle> scissor;
+        GLenum mode;
+        GLint first;
+        GLsizei count;
+    };
+
+    BufferHandle const vbo;
+    std::vector<BatchVertex> vertices;
+    std::vector<Draw> draws;
+};
+
 class mrg::Renderer::ProgramFactory : public mir::graphics::gl::ProgramFactory
 {
 public:
@@ -205,9 +334,9 @@ public:
             << "\n"
             <<
             "varying vec2 v_texcoord;\n"
-            "uniform float alpha;\n"
+            "varying float v_alpha;\n"
             "void main() {\n"
-            "    gl_FragColor = alpha * sample_to_rgba(v_texcoord);\n"
+            "    gl_FragColor = v_alpha * sample_to_rgba(v_texcoord);\n"
             "}\n";
 
         // GL shader compilation is *not* threadsafe, and requires external synchronisation
@@ -287,6 +416,7 @@ mrg::Renderer::Program::Program(GLuint program_id)
     id = program_id;
     position_attr = glGetAttribLocation(id, "position");
     texcoord_attr = glGetAttribLocation(id, "texcoord");
+    alpha_attr = glGetAttribLocation(id, "alpha");
     for (auto i = 0u; i < tex_uniforms.size() ; ++i)
     {
         /* You can reference uniform arrays as tex[0], tex[1], tex[2], … until you
@@ -295,18 +425,16 @@ mrg::Renderer::Program::Program(GLuint program_id)
         auto const uniform_name = std::string{"tex["} + std::to_string(i) + "]";
         tex_uniforms[i] = glGetUniformLocation(id, uniform_name.c_str());
     }
-    centre_uniform = glGetUniformLocation(id, "centre");
     display_transform_uniform = glGetUniformLocation(id, "display_transform");
-    transform_uniform = glGetUniformLocation(id, "transform");
     screen_to_gl_coords_uniform = glGetUniformLocation(id, "screen_to_gl_coords");
-    alpha_uniform = glGetUniformLocation(id, "alpha");
 }
 
 mrg::Renderer::Renderer(RenderTarget& render_target)
     : render_target(render_target),
       clear_color{0.0f, 0.0f, 0.0f, 1.0f},
       program_factory{std::make_unique<ProgramFactory>()},
-      display_transform(1)
+      display_transform(1),
+      batch{std::make_unique<Batch>()}
 {
     eglBindAPI(EGL_OPENGL_ES_API);
     EGLDisplay disp = eglGetCurrentDisplay();
@@ -374,6 +502,14 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
 {
     render_target.bind();
 
+    frame_scissor = repaint_area();
+    if (frame_scissor)
+    {
+        render_target.set_damage_region(geom::Rectangles{to_gl_window_coords(frame_scissor.value())});
+        glEnable(GL_SCISSOR_TEST);
+        scissor_to(frame_scissor.value());
+    }
+
     glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -381,40 +517,37 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
     ++frameno;
     for (auto const& r : renderables)
     {
-        draw(*r);
+        add_to_batch(*r);
+    }
+    draw_batch();
+
+    if (frame_scissor)
+    {
+        glDisable(GL_SCISSOR_TEST);
+        frame_scissor.reset();
     }
 
+    // Renderables that weren't drawn this frame have most likely gone away
+    shm_textures.drop_unused();
+
     render_target.swap_buffers();
 
     while (auto const gl_error = glGetError())
         mir::log_debug("GL error: %d", gl_error);
 }
 
-void mrg::Renderer::draw(mg::Renderable const& renderable) const
+void mrg::Renderer::add_to_batch(mg::Renderable const& renderable) const
 {
-    auto const clip_area = renderable.clip_area();
-    if (clip_area)
-    {
-        glEnable(GL_SCISSOR_TEST);
-        glScissor(
-            clip_area.value().top_left.x.as_int() -
-                viewport.top_left.x.as_int(),
-            viewport.top_left.y.as_int() +
-                viewport.size.height.as_int() -
-                clip_area.value().top_left.y.as_int() -
-                clip_area.value().size.height.as_int(),
-            clip_area.value().size.width.as_int(), 
-            clip_area.value().size.height.as_int()
-        );
-    }
-
-    auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
+    auto const buffer = renderable.buffer();
+    auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(buffer);
     if (!texture)
     {
         mir::log_error("Buffer does not support GL rendering!");
         return;
     }
 
+    auto const alpha = renderable.alpha();
+
     // All the programs are held by program_factory through its lifetime. Using pointers avoids
     // -Wdangling-reference.
     auto const* const prog =
@@ -426,34 +559,40 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
                     return &family.alpha;
                 }
                 return &family.opaque;
-        }(renderable.alpha() < 1.0f);
-
-    glUseProgram(prog->id);
-    if (prog->last_used_frameno != frameno)
-    {   // Avoid reloading the screen-global uniforms on every renderable
-        // TODO: We actually only need to bind these *once*, right? Not once per frame?
-        prog->last_used_frameno = frameno;
-        for (auto i = 0u; i < prog->tex_uniforms.size(); ++i)
-        {
-            if (prog->tex_uniforms[i] != -1)
-            {
-                glUniform1i(prog->tex_uniforms[i], i);
-            }
-        }
-        glUniformMatrix4fv(prog->display_transform_uniform, 1, GL_FALSE,
-                           glm::value_ptr(display_transform));
-        glUniformMatrix4fv(prog->screen_to_gl_coords_uniform, 1, GL_FALSE,
-                           glm::value_ptr(screen_to_gl_coords));
+        }(alpha < 1.0f);
+
+    BlendState blend;
+
+    // These renderable method names could be better (see LP: #1236224)
+    if (renderable.shaped())  // Client is RGBA:
+    {
+        blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
+                 GL_ONE, GL_ONE_MINUS_SRC_ALPHA, 0.0f};
+    }
+    else if (alpha == 1.0f)  // RGBX and no window translucency:
+    {
+        blend = {GL_ONE,  GL_ZERO,
+                 GL_ZERO, GL_ONE, 0.0f};  // Avoid using src_alpha!
+    }
+    else
+    {   // Client is RGBX but we also have window translucency.
+        // The texture alpha channel is possibly uninitialized so we must be
+        // careful and avoid using SRC_ALPHA (LP: #1423462).
+        blend = {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
+                 GL_ZERO, GL_ONE, alpha};
     }
 
-    glActiveTexture(GL_TEXTURE0);
+    auto const clip_area = renderable.clip_area();
+    auto const scissor = clip_area && frame_scissor ?
+        intersection_of(clip_area.value(), frame_scissor.value()) :
+        clip_area ? clip_area : frame_scissor;
 
     auto const& rect = renderable.screen_position();
     GLfloat centrex = rect.top_left.x.as_int() +
                       rect.size.width.as_int() / 2.0f;
     GLfloat centrey = rect.top_left.y.as_int() +
                       rect.size.height.as_int() / 2.0f;
-    glUniform2f(prog->centre_uniform, centrex, centrey);
+    glm::vec4 const mid{centrex, centrey, 0.0f, 0.0f};
 
     glm::mat4 transform = renderable.transformation();
     if (texture->layout() == mg::gl::Texture::Layout::TopRowFirst)
@@ -468,90 +607,178 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         };
     }
 
-    glUniformMatrix4fv(prog->transform_uniform, 1, GL_FALSE,
-                       glm::value_ptr(transform));
-
-    if (prog->alpha_uniform >= 0)
-        glUniform1f(prog->alpha_uniform, renderable.alpha());
-
-    glEnableVertexAttribArray(prog->position_attr);
-    glEnableVertexAttribArray(prog->texcoord_attr);
-
     primitives.clear();
     tessellate(primitives, renderable);
 
-    // if we fail to load the texture, we need to carry on (part of lp:1629275)
-    try
+    auto& vertices = batch->vertices;
+    auto& draws = batch->draws;
+    for (auto const& p : primitives)
     {
-        typedef struct  // Represents parameters of glBlendFuncSeparate()
+        GLint const first = vertices.size();
+        append_triangles(vertices, p, transform, mid, alpha);
+        GLsizei const count = vertices.size() - first;
+        auto const mode = batched_mode_of(p.type);
+
+        // The primitives of a renderable share all their state, so triangles can be drawn together
+        if (!draws.empty() && draws.back().renderable == &renderable && draws.back().mode == GL_TRIANGLES &&
+            mode == GL_TRIANGLES)
         {
-            GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
-        } BlendSeparate;
-
-        BlendSeparate client_blend;
-
-        // These renderable method names could be better (see LP: #1236224)
-        if (renderable.shaped())  // Client is RGBA:
-        {
-            client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
-                            GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
-        }
-        else if (renderable.alpha() == 1.0f)  // RGBX and no window translucency:
-        {
-            client_blend = {GL_ONE,  GL_ZERO,
-                            GL_ZERO, GL_ONE};  // Avoid using src_alpha!
+            draws.back().count += count;
         }
         else
-        {   // Client is RGBX but we also have window translucency.
-            // The texture alpha channel is possibly uninitialized so we must be
-            // careful and avoid using SRC_ALPHA (LP: #1423462).
-            client_blend = {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
-                            GL_ZERO, GL_ONE};
-            glBlendColor(0.0f, 0.0f, 0.0f, renderable.alpha());
+        {
+            draws.push_back({prog, &renderable, buffer, texture.get(), blend, scissor, mode, first, count});
         }
+    }
+}
 
-        for (auto const& p : primitives)
+void mrg::Renderer::draw_batch() const
+{
+    auto& vertices = batch->vertices;
+    auto& draws = batch->draws;
+    if (draws.empty())
+    {
+        vertices.clear();
+        return;
+    }
+
+    // One upload for the whole frame. Respecifying the store lets the driver
+    // orphan the previous frame's, rather than wait for the GPU to finish with it.
+    glBindBuffer(GL_ARRAY_BUFFER, batch->vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(BatchVertex), vertices.data(), GL_STREAM_DRAW);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    // Only touch GL state that differs from the previous draw's
+    Program const* current_program{nullptr};
+    std::optional<BlendState> current_blend;
+    auto current_scissor = frame_scissor;
+
+    auto const set_attributes_enabled =
+        [](Program const& prog, bool enabled)
         {
-            BlendSeparate blend;
+            for (auto const attr : {prog.position_attr, prog.texcoord_attr, prog.alpha_attr})
+            {
+                if (attr < 0)
+                    continue;
+                if (enabled)
+                    glEnableVertexAttribArray(attr);
+                else
+                    glDisableVertexAttribArray(attr);
+            }
+        };
 
-            blend = client_blend;
-            texture->bind();
+    for (auto const& draw : draws)
+    {
+        auto const* const prog = draw.program;
+        if (prog != current_program)
+        {
+            if (current_program)
+                set_attributes_enabled(*current_program, false);
+
+            glUseProgram(prog->id);
+            if (prog->last_used_frameno != frameno)
+            {   // Avoid reloading the screen-global uniforms on every renderable
+                // TODO: We actually only need to bind these *once*, right? Not once per frame?
+                prog->last_used_frameno = frameno;
+                for (auto i = 0u; i < prog->tex_uniforms.size(); ++i)
+                {
+                    if (prog->tex_uniforms[i] != -1)
+                    {
+                        glUniform1i(prog->tex_uniforms[i], i);
+                    }
+                }
+                glUniformMatrix4fv(prog->display_transform_uniform, 1, GL_FALSE,
+                                   glm::value_ptr(display_transform));
+                glUniformMatrix4fv(prog->screen_to_gl_coords_uniform, 1, GL_FALSE,
+                                   glm::value_ptr(screen_to_gl_coords));
+            }
+
+            glVertexAttribPointer(prog->position_attr, 4, GL_FLOAT, GL_FALSE, sizeof(BatchVertex),
+                                  reinterpret_cast<void const*>(offsetof(BatchVertex, position)));
+            glVertexAttribPointer(prog->texcoord_attr, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex),
+                                  reinterpret_cast<void const*>(offsetof(BatchVertex, texcoord)));
+            if (prog->alpha_attr >= 0)
+            {
+                glVertexAttribPointer(prog->alpha_attr, 1, GL_FLOAT, GL_FALSE, sizeof(BatchVertex),
+                                      reinterpret_cast<void const*>(offsetof(BatchVertex, alpha)));
+            }
+            set_attributes_enabled(*prog, true);
+            current_program = prog;
+        }
 
-            glVertexAttribPointer(prog->position_attr, 3, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].position);
-            glVertexAttribPointer(prog->texcoord_attr, 2, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].texcoord);
+        if (draw.scissor != current_scissor)
+        {
+            if (!draw.scissor)
+            {
+                glDisable(GL_SCISSOR_TEST);
+            }
+            else
+            {
+                if (!current_scissor)
+                    glEnable(GL_SCISSOR_TEST);
+                scissor_to(draw.scissor.value());
+            }
+            current_scissor = draw.scissor;
+        }
 
-            if (blend.dst_rgb == GL_ZERO)
+        if (draw.blend != current_blend)
+        {
+            auto const& blend = draw.blend;
+            if (!blend.enabled())
             {
-                glDisable(GL_BLEND);
+                if (!current_blend || current_blend->enabled())
+                    glDisable(GL_BLEND);
             }
             else
             {
-                glEnable(GL_BLEND);
+                if (!current_blend || !current_blend->enabled())
+                    glEnable(GL_BLEND);
                 glBlendFuncSeparate(blend.src_rgb,   blend.dst_rgb,
                                     blend.src_alpha, blend.dst_alpha);
+                if (blend.dst_rgb == GL_ONE_MINUS_CONSTANT_ALPHA)
+                    glBlendColor(0.0f, 0.0f, 0.0f, blend.constant_alpha);
             }
+            current_blend = blend;
+        }
+
+        // if we fail to load the texture, we need to carry on (part of lp:1629275)
+        try
+        {
+            if (!shm_textures.bind(*draw.renderable, *draw.buffer))
+                draw.texture->bind();
 
-            glDrawArrays(p.type, 0, p.nvertices);
+            glDrawArrays(draw.mode, draw.first, draw.count);
 
             // We're done with the texture for now
-            texture->add_syncpoint();
+            draw.texture->add_syncpoint();
+        }
+        catch (std::exception const& ex)
+        {
+            report_exception();
         }
-    }
-    catch (std::exception const& ex)
-    {
-        report_exception();
     }
 
-    glDisableVertexAttribArray(prog->texcoord_attr);
-    glDisableVertexAttribArray(prog->position_attr);
-    if (renderable.clip_area())
+    set_attributes_enabled(*current_program, false);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (current_scissor != frame_scissor)
     {
-        glDisable(GL_SCISSOR_TEST);
+        if (frame_scissor)
+        {
+            if (!current_scissor)
+                glEnable(GL_SCISSOR_TEST);
+            scissor_to(frame_scissor.value());
+        }
+        else
+        {
+            glDisable(GL_SCISSOR_TEST);
+        }
     }
+
+    // Don't hold on to the renderables' buffers beyond the frame
+    draws.clear();
+    vertices.clear();
 }
 
 void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
@@ -629,6 +856,10 @@ void mrg::Renderer::update_gl_viewport()
     GLint offset_y = (buf_height - reduced_height) / 2;
 
     glViewport(offset_x, offset_y, reduced_width, reduced_height);
+
+    // Whatever was drawn into older buffers no longer lines up with the new viewport
+    gl_viewport = {{offset_x, offset_y}, {reduced_width, reduced_height}};
+    damage_history.clear();
 }
 
 void mrg::Renderer::set_output_transform(glm::mat2 const& t)
@@ -641,6 +872,88 @@ void mrg::Renderer::set_output_transform(glm::mat2 const& t)
     }
 }
 
+void mrg::Renderer::set_damage(geom::Rectangles const& damage)
+{
+    next_damage = damage;
+}
+
+auto mrg::Renderer::repaint_area() const -> std::optional<geom::Rectangle>
+{
+    auto const frame_damage = next_damage ? next_damage.value() : geom::Rectangles{viewport};
+    auto const damage_known = next_damage.has_value();
+    next_damage.reset();
+
+    /*
+     * A buffer of age N holds the frame we rendered N frames ago, so it needs
+     * the damage of this frame plus that of the N-1 frames since.
+     */
+    std::optional<geom::Rectangle> area;
+    auto const age = render_target.buffer_age();
+    if (damage_known && age > 0 && static_cast<std::size_t>(age) <= damage_history.size())
+    {
+        auto accumulated = frame_damage;
+        for (auto i = 0; i != age - 1; ++i)
+        {
+            for (auto const& rect : damage_history[i])
+                accumulated.add(rect);
+        }
+
+        auto const bounds = intersection_of(accumulated.bounding_rectangle(), viewport);
+        if (bounds != viewport)
+            area = bounds;
+    }
+
+    damage_history.push_front(frame_damage);
+    if (damage_history.size() > max_tracked_buffer_age)
+        damage_history.pop_back();
+
+    return area;
+}
+
+auto mrg::Renderer::to_gl_window_coords(geom::Rectangle const& rect) const -> geom::Rectangle
+{
+    auto const to_gl = display_transform * screen_to_gl_coords;
+
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+
+    for (auto const& corner : {rect.top_left, rect.top_right(), rect.bottom_left(), rect.bottom_right()})
+    {
+        auto const clip = to_gl * glm::vec4{corner.x.as_int(), corner.y.as_int(), 0.0f, 1.0f};
+        auto const x = gl_viewport.top_left.x.as_int() +
+            (clip.x / clip.w + 1.0f) * gl_viewport.size.width.as_int() / 2.0f;
+        auto const y = gl_viewport.top_left.y.as_int() +
+            (clip.y / clip.w + 1.0f) * gl_viewport.size.height.as_int() / 2.0f;
+
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+    }
+
+    int const left = std::floor(min_x);
+    int const bottom = std::floor(min_y);
+    int const right = std::ceil(max_x);
+    int const top = std::ceil(max_y);
+
+    return {{left, bottom}, {right - left, top - bottom}};
+}
+
+void mrg::Renderer::scissor_to(geom::Rectangle const& rect) const
+{
+    auto const window = to_gl_window_coords(rect);
+    glScissor(
+        window.top_left.x.as_int(),
+        window.top_left.y.as_int(),
+        window.size.width.as_int(),
+        window.size.height.as_int());
+}
+
 void mrg::Renderer::suspend()
 {
+    // Nothing rendered this frame tells us what has changed since the last one we did render
+    damage_history.clear();
+    next_damage.reset();
 }
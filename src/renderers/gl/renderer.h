@@ -19,12 +19,16 @@
 
 #include <mir/renderer/renderer.h>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
 #include <mir/graphics/buffer_id.h>
 #include <mir/graphics/renderable.h>
 #include <mir/gl/primitive.h>
 #include "mir/renderer/gl/render_target.h"
+#include "texture_cache.h"
 
 #include <GLES2/gl2.h>
+#include <deque>
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -46,6 +50,8 @@ public:
     auto size() const -> geometry::Size;
     void ensure_current();
     void bind();
+    auto buffer_age() const -> int;
+    void set_damage_region(geometry::Rectangles const& damage);
     void swap_buffers();
 
 private:
@@ -62,6 +68,7 @@ public:
     // These are called with a valid GL context:
     void set_viewport(geometry::Rectangle const& rect) override;
     void set_output_transform(glm::mat2 const&) override;
+    void set_damage(geometry::Rectangles const& damage) override;
     void render(graphics::RenderableList const&) const override;
 
     // This is called _without_ a GL context:
@@ -77,11 +84,9 @@ public:
         std::array<GLint, 8> tex_uniforms;
         GLint position_attr = -1;
         GLint texcoord_attr = -1;
-        GLint centre_uniform = -1;
+        GLint alpha_attr = -1;
         GLint display_transform_uniform = -1;
-        GLint transform_uniform = -1;
         GLint screen_to_gl_coords_uniform = -1;
-        GLint alpha_uniform = -1;
         mutable long long last_used_frameno = 0;
 
         Program(GLuint program_id);
@@ -113,10 +118,17 @@ protected:
 
     mutable long long frameno = 0;
 
-    virtual void draw(graphics::Renderable const& renderable) const;
-
 private:
+    /// Tessellate renderable into the frame's vertex buffer, and queue the draws for it
+    void add_to_batch(graphics::Renderable const& renderable) const;
+    /// Upload the frame's vertex buffer and issue the queued draws, in order
+    void draw_batch() const;
+
     void update_gl_viewport();
+    /// The part of the viewport that needs repainting this frame, or nullopt for all of it
+    auto repaint_area() const -> std::optional<geometry::Rectangle>;
+    auto to_gl_window_coords(geometry::Rectangle const& rect) const -> geometry::Rectangle;
+    void scissor_to(geometry::Rectangle const& rect) const;
 
     class ProgramFactory;
     std::unique_ptr<ProgramFactory> const program_factory;
@@ -124,6 +136,17 @@ private:
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+    TextureCache mutable shm_textures;
+
+    /// The vertices and draw calls of the frame being rendered
+    class Batch;
+    std::unique_ptr<Batch> const batch;
+
+    geometry::Rectangle gl_viewport;
+    std::optional<geometry::Rectangles> mutable next_damage;
+    /// Damage of the most recently rendered frames, newest first
+    std::deque<geometry::Rectangles> mutable damage_history;
+    std::optional<geometry::Rectangle> mutable frame_scissor;
 };
 
 }
@@ -0,0 +1,199 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "texture_cache.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/gl_format.h"
+#include "mir/graphics/texture.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <GLES2/gl2ext.h>
+
+namespace mg = mir::graphics;
+namespace mrg = mir::renderer::gl;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+mrg::TextureCache::~TextureCache()
+{
+    for (auto const& [_, entry] : textures)
+        glDeleteTextures(1, &entry.id);
+    if (copy_framebuffer != 0)
+        glDeleteFramebuffers(1, &copy_framebuffer);
+}
+
+auto mrg::TextureCache::bind(mg::Renderable const& renderable, mg::Buffer& buffer) -> bool
+{
+    auto const mappable = dynamic_cast<mrs::ReadMappableBuffer*>(&buffer);
+    if (!mappable)
+        return false;
+
+    GLenum format, type;
+    if (!mg::get_gl_pixel_format(mappable->format(), format, type))
+        return false;
+
+    auto& entry = textures[renderable.id()];
+    entry.used = true;
+
+    bool const needs_initialisation = entry.id == 0;
+    if (needs_initialisation)
+    {
+        glGenTextures(1, &entry.id);
+        glBindTexture(GL_TEXTURE_2D, entry.id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D, entry.id);
+    }
+
+    if (entry.buffer == buffer.id())
+        return true;    // Already uploaded (e.g. by an earlier primitive of the same renderable)
+
+    auto const previous = entry.buffer;
+    entry.buffer.reset();   // If the upload fails, the texture content is unknown
+
+    auto const size = mappable->size();
+    bool const needs_storage = needs_initialisation || entry.size != size || entry.format != mappable->format();
+    auto const damage = previous && !needs_storage ?
+        renderable.buffer_damage_since(previous.value()) :
+        std::nullopt;
+
+    if (!damage)
+    {
+        // Everything must be uploaded. The platform may already have done that (see
+        // mg::gl::Texture::prepare()), in which case copying on the GPU is much cheaper.
+        if (auto const texture = dynamic_cast<mg::gl::Texture*>(&buffer))
+        {
+            texture->bind();
+            if (copy_from_bound_texture(entry, size, format, type, needs_storage))
+            {
+                entry.buffer = buffer.id();
+                entry.size = size;
+                entry.format = mappable->format();
+                return true;
+            }
+            glBindTexture(GL_TEXTURE_2D, entry.id);
+        }
+    }
+
+    auto const mapping = mappable->map_readable();
+    auto const stride = mapping->stride().as_int();
+    auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(mapping->format());
+    auto const pixels = mapping->data();
+
+    // As in ShmBuffer, we assume that stride is a multiple of whole pixels
+    glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, stride / bytes_per_pixel);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (needs_storage)
+    {
+        // New storage is needed, so everything must be uploaded
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, format,
+            size.width.as_int(), size.height.as_int(),
+            0, format, type, pixels);
+
+        bytes_uploaded_ += uint64_t{size.width.as_uint32_t()} * size.height.as_uint32_t() * bytes_per_pixel;
+    }
+    else
+    {
+        geom::Rectangle const buffer_area{{0, 0}, size};
+
+        for (auto const& rect : damage.value_or(geom::Rectangles{buffer_area}))
+        {
+            auto const area = intersection_of(rect, buffer_area);
+            if (area == geom::Rectangle{})
+                continue;
+
+            auto const left = area.left().as_int();
+            auto const top = area.top().as_int();
+            glTexSubImage2D(
+                GL_TEXTURE_2D, 0,
+                left, top,
+                area.size.width.as_int(), area.size.height.as_int(),
+                format, type,
+                pixels + top * stride + left * bytes_per_pixel);
+
+            bytes_uploaded_ += uint64_t{area.size.width.as_uint32_t()} * area.size.height.as_uint32_t() * bytes_per_pixel;
+        }
+    }
+
+    // Be nice to other users of the GL context by reverting our changes to shared state
+    glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    entry.buffer = buffer.id();
+    entry.size = size;
+    entry.format = mapping->format();
+    return true;
+}
+
+auto mrg::TextureCache::copy_from_bound_texture(
+    Entry& entry, geom::Size const& size, GLenum format, GLenum type, bool needs_storage) -> bool
+{
+    GLint source{0};
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &source);
+    if (source == 0)
+        return false;
+
+    GLint previous_framebuffer{0};
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    if (copy_framebuffer == 0)
+        glGenFramebuffers(1, &copy_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, copy_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source, 0);
+
+    // Not every format is colour-renderable (or copyable) everywhere; if not, the caller uploads instead
+    bool const copyable = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (copyable)
+    {
+        glBindTexture(GL_TEXTURE_2D, entry.id);
+        if (needs_storage)
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D, 0, format,
+                size.width.as_int(), size.height.as_int(),
+                0, format, type, nullptr);
+        }
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, size.width.as_int(), size.height.as_int());
+    }
+
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    return copyable;
+}
+
+void mrg::TextureCache::drop_unused()
+{
+    for (auto i = textures.begin(); i != textures.end();)
+    {
+        if (i->second.used)
+        {
+            i->second.used = false;
+            ++i;
+        }
+        else
+        {
+            glDeleteTextures(1, &i->second.id);
+            i = textures.erase(i);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_TEXTURE_CACHE_H_
+#define MIR_RENDERER_GL_TEXTURE_CACHE_H_
+
+#include <mir/graphics/buffer_id.h>
+#include <mir/graphics/renderable.h>
+#include <mir/geometry/size.h>
+#include <mir_toolkit/common.h>
+
+#include <GLES2/gl2.h>
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+namespace mir
+{
+namespace graphics { class Buffer; }
+namespace renderer
+{
+namespace gl
+{
+
+/**
+ * Persistent textures for CPU-mappable (SHM) buffers, one per renderable.
+ *
+ * Every commit of a wl_shm client produces a new buffer. Rather than giving
+ * each of those a new texture and uploading the whole image, the texture of
+ * the previous buffer is kept and only the damaged part of the new buffer is
+ * uploaded into it. When the whole buffer is needed it is copied on the GPU
+ * from the buffer's own texture, which the platform may have uploaded ahead
+ * of time.
+ *
+ * \note All methods (including the destructor) require a current GL context
+ */
+class TextureCache
+{
+public:
+    TextureCache() = default;
+    ~TextureCache();
+
+    TextureCache(TextureCache const&) = delete;
+    TextureCache& operator=(TextureCache const&) = delete;
+
+    /**
+     * Bind a texture holding the content of buffer, which is renderable's current buffer
+     *
+     * \returns false if buffer cannot be uploaded from the CPU, and should be bound by other means
+     */
+    auto bind(graphics::Renderable const& renderable, graphics::Buffer& buffer) -> bool;
+
+    /// Delete the textures of renderables that haven't been bound since the last call
+    void drop_unused();
+
+    /// Total pixel data uploaded to GL over the lifetime of the cache
+    auto bytes_uploaded() const -> uint64_t { return bytes_uploaded_; }
+
+private:
+    struct Entry
+    {
+        GLuint id{0};
+        std::optional<graphics::BufferID> buffer;
+        geometry::Size size;
+        MirPixelFormat format{mir_pixel_format_invalid};
+        bool used{false};
+    };
+
+    /**
+     * Copy the texture bound to GL_TEXTURE_2D into entry's texture, on the GPU
+     *
+     * \returns false if the GL can't do the copy
+     */
+    auto copy_from_bound_texture(
+        Entry& entry, geometry::Size const& size, GLenum format, GLenum type, bool needs_storage) -> bool;
+
+    std::unordered_map<graphics::Renderable::ID, Entry> textures;
+    GLuint copy_framebuffer{0};
+    uint64_t bytes_uploaded_{0};
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_GL_TEXTURE_CACHE_H_
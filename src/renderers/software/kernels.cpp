@@ -0,0 +1,543 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__AVX2__)
+// AVX2 versions are built regardless, and used if the CPU turns out to have it
+#define MIR_KERNELS_DISPATCH_AVX2
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace k = mir::renderer::software::kernels;
+
+namespace
+{
+uint32_t const alpha_mask = 0xFF000000;
+
+/// x / 255, correctly rounded, for x in [0, 255 * 255]
+inline auto div255(unsigned x) -> unsigned
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+inline auto scale(uint32_t pixel, unsigned alpha) -> uint32_t
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        result |= div255(((pixel >> shift) & 0xFF) * alpha) << shift;
+    }
+    return result;
+}
+
+inline auto over(uint32_t dst, uint32_t src) -> uint32_t
+{
+    unsigned const remaining = 255 - (src >> 24);
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        // Saturate rather than wrap should src not really be premultiplied
+        unsigned const channel = ((src >> shift) & 0xFF) + div255(((dst >> shift) & 0xFF) * remaining);
+        result |= std::min(channel, 255u) << shift;
+    }
+    return result;
+}
+
+inline auto swap_red_blue(uint32_t pixel) -> uint32_t
+{
+    return (pixel & 0xFF00FF00) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16);
+}
+
+inline auto lerp(uint32_t a, uint32_t b, unsigned weight_b) -> uint32_t
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        unsigned const channel = ((a >> shift) & 0xFF) * (256 - weight_b) + ((b >> shift) & 0xFF) * weight_b;
+        result |= (channel >> 8) << shift;
+    }
+    return result;
+}
+
+#if defined(__SSE2__)
+/// Each 16-bit lane / 255, correctly rounded
+inline auto div255(__m128i x) -> __m128i
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+/// The alpha of each pixel in 16-bit lanes, unpacked as for _mm_unpack*_epi8
+inline auto broadcast_alpha(__m128i unpacked) -> __m128i
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(unpacked, 0xFF), 0xFF);
+}
+
+/// Four pixels of src over dst
+inline auto over(__m128i dst, __m128i src) -> __m128i
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const full = _mm_set1_epi16(255);
+    __m128i const src_lo = _mm_unpacklo_epi8(src, zero);
+    __m128i const src_hi = _mm_unpackhi_epi8(src, zero);
+    __m128i const dst_lo = _mm_mullo_epi16(
+        _mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(full, broadcast_alpha(src_lo)));
+    __m128i const dst_hi = _mm_mullo_epi16(
+        _mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(full, broadcast_alpha(src_hi)));
+    return _mm_adds_epu8(src, _mm_packus_epi16(div255(dst_lo), div255(dst_hi)));
+}
+
+/// Four pixels scaled by alpha, held in each 16-bit lane
+inline auto scale(__m128i src, __m128i alpha) -> __m128i
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const lo = _mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), alpha);
+    __m128i const hi = _mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), alpha);
+    return _mm_packus_epi16(div255(lo), div255(hi));
+}
+
+/// Composites four pixels, skipping the arithmetic if they're all opaque or all clear
+inline void blend4(uint32_t* dst, __m128i src)
+{
+    __m128i const alpha = _mm_and_si128(src, _mm_set1_epi32(alpha_mask));
+    int const opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(alpha, _mm_set1_epi32(alpha_mask)));
+    if (opaque == 0xFFFF)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), src);
+        return;
+    }
+    int const clear = _mm_movemask_epi8(_mm_cmpeq_epi32(src, _mm_setzero_si128()));
+    if (clear == 0xFFFF)
+    {
+        return;
+    }
+    __m128i const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), over(d, src));
+}
+
+inline void transpose(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3)
+{
+    __m128i const t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i const t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i const t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i const t3 = _mm_unpackhi_epi32(r2, r3);
+    r0 = _mm_unpacklo_epi64(t0, t1);
+    r1 = _mm_unpackhi_epi64(t0, t1);
+    r2 = _mm_unpacklo_epi64(t2, t3);
+    r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+inline auto reverse(__m128i x) -> __m128i
+{
+    return _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+inline auto load(uint32_t const* src) -> __m128i
+{
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+}
+
+inline void store(uint32_t* dst, __m128i x)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), x);
+}
+#endif
+
+#if defined(__ARM_NEON)
+/// Each 16-bit lane / 255, correctly rounded, narrowed to 8 bits
+inline auto div255(uint16x8_t x) -> uint8x8_t
+{
+    return vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8);
+}
+
+/// Four pixels of src over dst
+inline auto over(uint8x16_t dst, uint8x16_t src) -> uint8x16_t
+{
+    // Each pixel's alpha copied into all four of its bytes
+    uint8x16_t const alpha = vreinterpretq_u8_u32(
+        vmulq_n_u32(vshrq_n_u32(vreinterpretq_u32_u8(src), 24), 0x01010101));
+    uint8x16_t const remaining = vmvnq_u8(alpha);
+    uint8x8_t const lo = div255(vmull_u8(vget_low_u8(dst), vget_low_u8(remaining)));
+    uint8x8_t const hi = div255(vmull_u8(vget_high_u8(dst), vget_high_u8(remaining)));
+    return vqaddq_u8(src, vcombine_u8(lo, hi));
+}
+#endif
+
+#if defined(MIR_KERNELS_DISPATCH_AVX2) || defined(__AVX2__)
+#if defined(MIR_KERNELS_DISPATCH_AVX2)
+#define MIR_KERNELS_AVX2 __attribute__((target("avx2")))
+#else
+#define MIR_KERNELS_AVX2
+#endif
+
+MIR_KERNELS_AVX2 inline auto div255_avx2(__m256i x) -> __m256i
+{
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+MIR_KERNELS_AVX2 inline auto over_avx2(__m256i dst, __m256i src) -> __m256i
+{
+    __m256i const zero = _mm256_setzero_si256();
+    __m256i const full = _mm256_set1_epi16(255);
+    __m256i const src_lo = _mm256_unpacklo_epi8(src, zero);
+    __m256i const src_hi = _mm256_unpackhi_epi8(src, zero);
+    __m256i const alpha_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src_lo, 0xFF), 0xFF);
+    __m256i const alpha_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src_hi, 0xFF), 0xFF);
+    __m256i const dst_lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), _mm256_sub_epi16(full, alpha_lo));
+    __m256i const dst_hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), _mm256_sub_epi16(full, alpha_hi));
+    return _mm256_adds_epu8(src, _mm256_packus_epi16(div255_avx2(dst_lo), div255_avx2(dst_hi)));
+}
+
+MIR_KERNELS_AVX2 inline auto scale_avx2(__m256i src, __m256i alpha) -> __m256i
+{
+    __m256i const zero = _mm256_setzero_si256();
+    __m256i const lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(src, zero), alpha);
+    __m256i const hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(src, zero), alpha);
+    return _mm256_packus_epi16(div255_avx2(lo), div255_avx2(hi));
+}
+
+MIR_KERNELS_AVX2 inline void blend8_avx2(uint32_t* dst, __m256i src)
+{
+    __m256i const mask = _mm256_set1_epi32(alpha_mask);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(src, mask), mask)) == -1)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), src);
+        return;
+    }
+    if (_mm256_testz_si256(src, src))
+    {
+        return;
+    }
+    __m256i const d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), over_avx2(d, src));
+}
+
+MIR_KERNELS_AVX2 void blend_avx2(uint32_t* dst, uint32_t const* src, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        blend8_avx2(dst + i, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i)));
+    }
+    for (; i < n; ++i)
+    {
+        dst[i] = over(dst[i], src[i]);
+    }
+}
+
+MIR_KERNELS_AVX2 void blend_with_alpha_avx2(
+    uint32_t* dst, uint32_t const* src, std::size_t n, uint8_t alpha, bool src_opaque)
+{
+    __m256i const alphas = _mm256_set1_epi16(alpha);
+    __m256i const opacity = _mm256_set1_epi32(src_opaque ? alpha_mask : 0);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i const s = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i)), opacity);
+        __m256i const d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), over_avx2(d, scale_avx2(s, alphas)));
+    }
+    uint32_t const opaque_bits = src_opaque ? alpha_mask : 0;
+    for (; i < n; ++i)
+    {
+        dst[i] = over(dst[i], scale(src[i] | opaque_bits, alpha));
+    }
+}
+
+MIR_KERNELS_AVX2 void sample_nearest_avx2(uint32_t* dst, uint32_t const* src, std::size_t n, int32_t x, int32_t step)
+{
+    __m256i const offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(step));
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8, x += 8 * step)
+    {
+        __m256i const indices = _mm256_srai_epi32(_mm256_add_epi32(_mm256_set1_epi32(x), offsets), 16);
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst + i),
+            _mm256_i32gather_epi32(reinterpret_cast<int const*>(src), indices, 4));
+    }
+    for (; i < n; ++i, x += step)
+    {
+        dst[i] = src[x >> 16];
+    }
+}
+
+auto have_avx2() -> bool
+{
+#if defined(__AVX2__)
+    return true;
+#else
+    static bool const avx2 = []
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+        }();
+    return avx2;
+#endif
+}
+#define MIR_KERNELS_HAVE_AVX2
+#endif
+}
+
+void k::fill(uint32_t* dst, std::size_t n, uint32_t color)
+{
+#if defined(__SSE2__)
+    uint32_t* const end = dst + n;
+    while (dst < end && (reinterpret_cast<uintptr_t>(dst) & 0xF))
+        *dst++ = color;
+    __m128i const colors = _mm_set1_epi32(static_cast<int>(color));
+    for (; end - dst >= 4; dst += 4)
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst), colors);
+    while (dst < end)
+        *dst++ = color;
+#elif defined(__ARM_NEON)
+    uint32x4_t const colors = vdupq_n_u32(color);
+    for (; n >= 4; n -= 4, dst += 4)
+        vst1q_u32(dst, colors);
+    while (n--)
+        *dst++ = color;
+#else
+    std::fill_n(dst, n, color);
+#endif
+}
+
+void k::copy_opaque(uint32_t* dst, uint32_t const* src, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    __m128i const mask = _mm_set1_epi32(alpha_mask);
+    for (; i + 4 <= n; i += 4)
+        store(dst + i, _mm_or_si128(load(src + i), mask));
+#elif defined(__ARM_NEON)
+    uint32x4_t const mask = vdupq_n_u32(alpha_mask);
+    for (; i + 4 <= n; i += 4)
+        vst1q_u32(dst + i, vorrq_u32(vld1q_u32(src + i), mask));
+#endif
+    for (; i < n; ++i)
+        dst[i] = src[i] | alpha_mask;
+}
+
+void k::blend(uint32_t* dst, uint32_t const* src, std::size_t n)
+{
+#if defined(MIR_KERNELS_HAVE_AVX2)
+    if (have_avx2())
+    {
+        blend_avx2(dst, src, n);
+        return;
+    }
+#endif
+
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= n; i += 4)
+        blend4(dst + i, load(src + i));
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= n; i += 4)
+    {
+        uint8x16_t const s = vld1q_u8(reinterpret_cast<uint8_t const*>(src + i));
+        uint8x16_t const d = vld1q_u8(reinterpret_cast<uint8_t const*>(dst + i));
+        vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), over(d, s));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = over(dst[i], src[i]);
+}
+
+void k::blend_with_alpha(uint32_t* dst, uint32_t const* src, std::size_t n, uint8_t alpha, bool src_opaque)
+{
+#if defined(MIR_KERNELS_HAVE_AVX2)
+    if (have_avx2())
+    {
+        blend_with_alpha_avx2(dst, src, n, alpha, src_opaque);
+        return;
+    }
+#endif
+
+    uint32_t const opaque_bits = src_opaque ? alpha_mask : 0;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    __m128i const alphas = _mm_set1_epi16(alpha);
+    __m128i const opacity = _mm_set1_epi32(opaque_bits);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i const s = scale(_mm_or_si128(load(src + i), opacity), alphas);
+        store(dst + i, over(load(dst + i), s));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = over(dst[i], scale(src[i] | opaque_bits, alpha));
+}
+
+void k::swap_red_blue(uint32_t* dst, uint32_t const* src, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    __m128i const kept = _mm_set1_epi32(0xFF00FF00);
+    __m128i const low_byte = _mm_set1_epi32(0xFF);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i const p = load(src + i);
+        __m128i const red = _mm_and_si128(_mm_srli_epi32(p, 16), low_byte);
+        __m128i const blue = _mm_slli_epi32(_mm_and_si128(p, low_byte), 16);
+        store(dst + i, _mm_or_si128(_mm_and_si128(p, kept), _mm_or_si128(red, blue)));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = ::swap_red_blue(src[i]);
+}
+
+void k::sample_nearest(uint32_t* dst, uint32_t const* src, std::size_t n, int32_t x, int32_t step)
+{
+#if defined(MIR_KERNELS_HAVE_AVX2)
+    if (have_avx2())
+    {
+        sample_nearest_avx2(dst, src, n, x, step);
+        return;
+    }
+#endif
+
+    for (std::size_t i = 0; i < n; ++i, x += step)
+        dst[i] = src[x >> 16];
+}
+
+void k::sample_bilinear(
+    uint32_t* dst,
+    uint32_t const* row0,
+    uint32_t const* row1,
+    int width,
+    std::size_t n,
+    int32_t x,
+    int32_t step,
+    unsigned fy)
+{
+    int32_t const max_x = (width - 1) << 16;
+#if defined(__SSE2__)
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const weights_y = _mm_set1_epi16(fy);
+    __m128i const weights_y_inverse = _mm_set1_epi16(256 - fy);
+#endif
+    for (std::size_t i = 0; i < n; ++i, x += step)
+    {
+        int32_t const clamped = std::clamp(x, 0, max_x);
+        int const left = clamped >> 16;
+        unsigned const fx = (clamped >> 8) & 0xFF;
+#if defined(__SSE2__)
+        if (left + 1 < width)
+        {
+            // Both pixels of each row in one register: left in the low lanes, right in the high
+            __m128i const weights_x = _mm_unpacklo_epi64(_mm_set1_epi16(256 - fx), _mm_set1_epi16(fx));
+            __m128i const top = _mm_mullo_epi16(
+                _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(row0 + left)), zero),
+                weights_x);
+            __m128i const bottom = _mm_mullo_epi16(
+                _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(row1 + left)), zero),
+                weights_x);
+            __m128i const top_sum = _mm_srli_epi16(_mm_add_epi16(top, _mm_srli_si128(top, 8)), 8);
+            __m128i const bottom_sum = _mm_srli_epi16(_mm_add_epi16(bottom, _mm_srli_si128(bottom, 8)), 8);
+            __m128i const sum = _mm_srli_epi16(
+                _mm_add_epi16(_mm_mullo_epi16(top_sum, weights_y_inverse), _mm_mullo_epi16(bottom_sum, weights_y)),
+                8);
+            dst[i] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(sum, zero)));
+            continue;
+        }
+#endif
+        int const right = std::min(left + 1, width - 1);
+        dst[i] = lerp(lerp(row0[left], row0[right], fx), lerp(row1[left], row1[right], fx), fy);
+    }
+}
+
+void k::copy_transformed(
+    uint32_t* dst,
+    std::size_t dst_stride,
+    int dst_x,
+    int dst_y,
+    int width,
+    int height,
+    uint32_t const* src,
+    std::size_t src_stride,
+    PixelTransform const& t)
+{
+    auto const src_at = [&](int x, int y) -> uint32_t const*
+        {
+            return src + (t.y0 + t.yx * x + t.yy * y) * src_stride + (t.x0 + t.xx * x + t.xy * y);
+        };
+
+    if (t.xy == 0 && t.yx == 0)
+    {
+        // Rows of dst are rows of src, possibly upside down and/or reversed
+        for (int y = dst_y; y != dst_y + height; ++y)
+        {
+            uint32_t* const row = dst + y * dst_stride + dst_x;
+            uint32_t const* const from = src_at(dst_x, y);
+            if (t.xx > 0)
+            {
+                std::memcpy(row, from, width * sizeof(uint32_t));
+                continue;
+            }
+
+            int x = 0;
+#if defined(__SSE2__)
+            for (; x + 4 <= width; x += 4)
+                store(row + x, reverse(load(from - x - 3)));
+#endif
+            for (; x < width; ++x)
+                row[x] = *(from - x);
+        }
+        return;
+    }
+
+    // Rows of dst are columns of src, so go a 4×4 block at a time to read whole vectors from each row
+    int y = dst_y;
+#if defined(__SSE2__)
+    for (; y + 4 <= dst_y + height; y += 4)
+    {
+        int x = dst_x;
+        for (; x + 4 <= dst_x + width; x += 4)
+        {
+            // Moving along a row of dst moves down (or up) src, and moving down dst moves along src rows
+            __m128i rows[4];
+            for (int i = 0; i != 4; ++i)
+            {
+                rows[i] = t.xy > 0 ? load(src_at(x + i, y)) : reverse(load(src_at(x + i, y) - 3));
+            }
+            transpose(rows[0], rows[1], rows[2], rows[3]);
+            for (int i = 0; i != 4; ++i)
+            {
+                store(dst + (y + i) * dst_stride + x, rows[i]);
+            }
+        }
+        for (; x < dst_x + width; ++x)
+        {
+            for (int i = 0; i != 4; ++i)
+                dst[(y + i) * dst_stride + x] = *src_at(x, y + i);
+        }
+    }
+#endif
+    for (; y < dst_y + height; ++y)
+    {
+        for (int x = dst_x; x != dst_x + width; ++x)
+            dst[y * dst_stride + x] = *src_at(x, y);
+    }
+}
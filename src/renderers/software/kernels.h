@@ -0,0 +1,114 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_KERNELS_H_
+#define MIR_RENDERER_SOFTWARE_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/**
+ * The pixel loops the software renderer spends its time in.
+ *
+ * All pixels are 32-bit premultiplied ARGB as laid out in memory on a little-endian machine
+ * (that is, mir_pixel_format_argb_8888: B, G, R, A bytes). Each kernel has a plain C++ version,
+ * and SSE2 (plus AVX2, where the CPU has it) and NEON versions of the ones that matter most.
+ */
+namespace kernels
+{
+/// Sets n pixels to color
+void fill(uint32_t* dst, std::size_t n, uint32_t color);
+
+/// Copies n pixels, making them opaque (the source alpha may be undefined, as in XRGB)
+void copy_opaque(uint32_t* dst, uint32_t const* src, std::size_t n);
+
+/// Composites n premultiplied pixels over dst
+void blend(uint32_t* dst, uint32_t const* src, std::size_t n);
+
+/**
+ * Composites n premultiplied pixels over dst, each first scaled by alpha
+ *
+ * \param [in] src_opaque   treat the source as opaque, whatever its alpha channel holds
+ */
+void blend_with_alpha(uint32_t* dst, uint32_t const* src, std::size_t n, uint8_t alpha, bool src_opaque);
+
+/// Swaps the red and blue channels of n pixels, as between ABGR and ARGB
+void swap_red_blue(uint32_t* dst, uint32_t const* src, std::size_t n);
+
+/**
+ * Samples n pixels from a row without filtering
+ *
+ * Pixel i is src[(x + i * step) >> 16], so x and step are 16.16 fixed point; the caller keeps
+ * these within the row.
+ */
+void sample_nearest(uint32_t* dst, uint32_t const* src, std::size_t n, int32_t x, int32_t step);
+
+/**
+ * Samples n pixels from between two rows with bilinear filtering
+ *
+ * Pixel i is taken from around (x + i * step) in 16.16 fixed point, clamped to the row's width,
+ * weighing row1 by fy/256 and row0 by the rest.
+ */
+void sample_bilinear(
+    uint32_t* dst,
+    uint32_t const* row0,
+    uint32_t const* row1,
+    int width,
+    std::size_t n,
+    int32_t x,
+    int32_t step,
+    unsigned fy);
+
+/**
+ * An axis-aligned mapping from destination to source pixels, as for an output rotated by a
+ * multiple of 90° and/or mirrored.
+ *
+ * The source of destination pixel (x, y) is (x0 + xx * x + xy * y, y0 + yx * x + yy * y),
+ * where each of xx, xy, yx and yy is -1, 0 or 1, and either xy and yx or xx and yy are zero.
+ */
+struct PixelTransform
+{
+    int x0, xx, xy;
+    int y0, yx, yy;
+};
+
+/**
+ * Fills the width × height area of dst at (dst_x, dst_y) from src, through transform
+ *
+ * Strides are in pixels; transform maps coordinates within dst to coordinates within src.
+ */
+void copy_transformed(
+    uint32_t* dst,
+    std::size_t dst_stride,
+    int dst_x,
+    int dst_y,
+    int width,
+    int height,
+    uint32_t const* src,
+    std::size_t src_stride,
+    PixelTransform const& transform);
+}
+}
+}
+}
+
+#endif // MIR_RENDERER_SOFTWARE_KERNELS_H_
@@ -0,0 +1,502 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "renderer.h"
+#include "kernels.h"
+#include "mir/graphics/buffer.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// As for the GL renderer, older buffers are simply redrawn in full
+std::size_t const max_tracked_buffer_age = 4;
+
+uint32_t const clear_color = 0xFF000000;
+
+/// Tolerance for treating a mapping as axis-aligned, unscaled and so on
+double const epsilon = 1e-6;
+
+auto is_integral(double x) -> bool
+{
+    return std::abs(x - std::round(x)) < epsilon;
+}
+
+auto to_fixed(double x) -> int32_t
+{
+    return static_cast<int32_t>(std::lround(x * 65536));
+}
+
+/// The range of x for which 0 <= a + b * x < limit, intersected with [lo, hi)
+void constrain(double a, double b, double limit, double& lo, double& hi)
+{
+    if (std::abs(b) < epsilon)
+    {
+        if (a < 0 || a >= limit)
+            hi = lo;
+        return;
+    }
+    double const at_zero = -a / b;
+    double const at_limit = (limit - a) / b;
+    lo = std::max(lo, std::min(at_zero, at_limit));
+    hi = std::min(hi, std::max(at_zero, at_limit));
+}
+
+struct Source
+{
+    uint32_t const* pixels;
+    std::size_t stride;
+    int width;
+    int height;
+
+    auto row(int y) const -> uint32_t const*
+    {
+        return pixels + std::clamp(y, 0, height - 1) * stride;
+    }
+};
+}
+
+mrs::Renderer::Renderer(RenderTarget& render_target)
+    : render_target(render_target)
+{
+}
+
+void mrs::Renderer::set_viewport(geom::Rectangle const& rect)
+{
+    if (rect == viewport)
+        return;
+
+    viewport = rect;
+    frame_geometry_valid = false;
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& t)
+{
+    if (t == output_transform)
+        return;
+
+    output_transform = t;
+    frame_geometry_valid = false;
+}
+
+void mrs::Renderer::set_damage(geom::Rectangles const& damage)
+{
+    next_damage = damage;
+}
+
+void mrs::Renderer::suspend()
+{
+    // Nothing rendered this frame tells us what has changed since the last one we did render
+    damage_history.clear();
+    next_damage.reset();
+}
+
+void mrs::Renderer::update_frame_geometry() const
+{
+    target_size = render_target.size();
+    int const target_width = target_size.width.as_int();
+    int const target_height = target_size.height.as_int();
+
+    /*
+     * The frame is the output as it would be were it not rotated or mirrored, so undo the
+     * output transform. As for the GL renderer, that's applied in GL's clip space (in which
+     * y points up) about the centre of the output.
+     */
+    auto const to_frame_orientation = glm::inverse(output_transform);
+    auto const frame_extent = to_frame_orientation * glm::vec2{static_cast<float>(target_width), static_cast<float>(target_height)};
+    frame_size = geom::Size{std::lround(std::abs(frame_extent.x)), std::lround(std::abs(frame_extent.y))};
+    int const frame_width = frame_size.width.as_int();
+    int const frame_height = frame_size.height.as_int();
+
+    // Letterbox the viewport into the frame, keeping pixels square
+    int const viewport_width = viewport.size.width.as_int();
+    int const viewport_height = viewport.size.height.as_int();
+    int reduced_width = frame_width;
+    int reduced_height = frame_height;
+    if (viewport_width > 0 && viewport_height > 0)
+    {
+        if (static_cast<long>(viewport_width) * frame_height >= static_cast<long>(frame_width) * viewport_height)
+            reduced_height = static_cast<long>(frame_width) * viewport_height / viewport_width;
+        else
+            reduced_width = static_cast<long>(frame_height) * viewport_width / viewport_height;
+    }
+    double const scale_x = viewport_width > 0 ? static_cast<double>(reduced_width) / viewport_width : 1;
+    double const scale_y = viewport_height > 0 ? static_cast<double>(reduced_height) / viewport_height : 1;
+    screen_to_frame = Affine{
+        scale_x, 0, (frame_width - reduced_width) / 2 - viewport.top_left.x.as_int() * scale_x,
+        0, scale_y, (frame_height - reduced_height) / 2 - viewport.top_left.y.as_int() * scale_y};
+
+    if (output_transform == glm::mat2{1})
+    {
+        output_to_frame.reset();
+        transformed_frame.clear();
+    }
+    else
+    {
+        // Where the centre of output pixel (x, y) lands in the frame, in pixels
+        auto const locate = [&](double x, double y)
+            {
+                glm::vec2 const clip{
+                    static_cast<float>((2 * x + 1) / target_width - 1),
+                    static_cast<float>(1 - (2 * y + 1) / target_height)};
+                auto const untransformed = to_frame_orientation * clip;
+                return glm::vec2{
+                    (untransformed.x + 1) * frame_width / 2 - 0.5f,
+                    (1 - untransformed.y) * frame_height / 2 - 0.5f};
+            };
+        auto const origin = locate(0, 0);
+        auto const along_x = locate(1, 0) - origin;
+        auto const along_y = locate(0, 1) - origin;
+        output_to_frame = Affine{
+            std::round(along_x.x), std::round(along_y.x), std::round(origin.x),
+            std::round(along_x.y), std::round(along_y.y), std::round(origin.y)};
+        transformed_frame.resize(frame_width * frame_height);
+    }
+
+    // Whatever was drawn into older buffers no longer lines up
+    damage_history.clear();
+    frame_geometry_valid = true;
+}
+
+auto mrs::Renderer::repaint_area() const -> std::optional<geom::Rectangle>
+{
+    auto const frame_damage = next_damage ? next_damage.value() : geom::Rectangles{viewport};
+    auto const damage_known = next_damage.has_value();
+    next_damage.reset();
+
+    /*
+     * A buffer of age N holds the frame we rendered N frames ago, so it needs
+     * the damage of this frame plus that of the N-1 frames since.
+     */
+    std::optional<geom::Rectangle> area;
+    auto const age = render_target.buffer_age();
+    if (damage_known && age > 0 && static_cast<std::size_t>(age) <= damage_history.size())
+    {
+        auto accumulated = frame_damage;
+        for (auto i = 0; i != age - 1; ++i)
+        {
+            for (auto const& rect : damage_history[i])
+                accumulated.add(rect);
+        }
+
+        auto const bounds = intersection_of(accumulated.bounding_rectangle(), viewport);
+        if (bounds != viewport)
+            area = bounds;
+    }
+
+    damage_history.push_front(frame_damage);
+    if (damage_history.size() > max_tracked_buffer_age)
+        damage_history.pop_back();
+
+    return area;
+}
+
+auto mrs::Renderer::to_frame(geom::Rectangle const& rect) const -> geom::Rectangle
+{
+    auto const& m = screen_to_frame;
+    int const left = std::floor(m.xx * rect.left().as_int() + m.x0);
+    int const top = std::floor(m.yy * rect.top().as_int() + m.y0);
+    int const right = std::ceil(m.xx * rect.right().as_int() + m.x0);
+    int const bottom = std::ceil(m.yy * rect.bottom().as_int() + m.y0);
+    return intersection_of(
+        geom::Rectangle{{left, top}, {std::max(right - left, 0), std::max(bottom - top, 0)}},
+        geom::Rectangle{{}, frame_size});
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    if (!frame_geometry_valid || render_target.size() != target_size)
+        update_frame_geometry();
+
+    auto const area = repaint_area();
+
+    auto mapping = render_target.map_back_buffer();
+    if (mapping->format() != mir_pixel_format_argb_8888 && mapping->format() != mir_pixel_format_xrgb_8888)
+    {
+        BOOST_THROW_EXCEPTION(std::logic_error(
+            "Software render target has unsupported pixel format " + std::to_string(mapping->format())));
+    }
+    auto* const target_pixels = reinterpret_cast<uint32_t*>(mapping->data());
+    std::size_t const target_stride = mapping->stride().as_int() / sizeof(uint32_t);
+
+    Frame const frame = output_to_frame ?
+        Frame{transformed_frame.data(), static_cast<std::size_t>(frame_size.width.as_int()), frame_size} :
+        Frame{target_pixels, target_stride, frame_size};
+
+    auto const frame_area = area ? to_frame(area.value()) : geom::Rectangle{{}, frame_size};
+    for (auto y = frame_area.top().as_int(); y < frame_area.bottom().as_int(); ++y)
+    {
+        kernels::fill(
+            frame.pixels + y * frame.stride + frame_area.left().as_int(),
+            frame_area.size.width.as_int(),
+            clear_color);
+    }
+
+    for (auto const& r : renderables)
+    {
+        draw(frame, frame_area, *r);
+    }
+
+    if (output_to_frame && frame_area.size.width.as_int() > 0 && frame_area.size.height.as_int() > 0)
+    {
+        // The output pixels showing frame_area: the output transform only permutes and mirrors, so
+        // its inverse is its transpose
+        auto const& m = output_to_frame.value();
+        auto const locate = [&m](int x, int y)
+            {
+                double const dx = x - m.x0;
+                double const dy = y - m.y0;
+                return geom::Point{std::lround(m.xx * dx + m.yx * dy), std::lround(m.xy * dx + m.yy * dy)};
+            };
+        auto const a = locate(frame_area.left().as_int(), frame_area.top().as_int());
+        auto const b = locate(frame_area.right().as_int() - 1, frame_area.bottom().as_int() - 1);
+        geom::X const left = std::min(a.x, b.x);
+        geom::Y const top = std::min(a.y, b.y);
+        int const width = std::abs((a.x - b.x).as_int()) + 1;
+        int const height = std::abs((a.y - b.y).as_int()) + 1;
+
+        kernels::copy_transformed(
+            target_pixels,
+            target_stride,
+            left.as_int(),
+            top.as_int(),
+            width,
+            height,
+            frame.pixels,
+            frame.stride,
+            kernels::PixelTransform{
+                static_cast<int>(m.x0), static_cast<int>(m.xx), static_cast<int>(m.xy),
+                static_cast<int>(m.y0), static_cast<int>(m.yx), static_cast<int>(m.yy)});
+    }
+
+    mapping.reset();
+    render_target.swap_buffers();
+}
+
+void mrs::Renderer::draw(Frame const& frame, geom::Rectangle const& area, mg::Renderable const& renderable) const
+{
+    auto const alpha = static_cast<uint8_t>(std::lround(std::clamp(renderable.alpha(), 0.0f, 1.0f) * 255));
+    if (alpha == 0)
+        return;
+
+    std::shared_ptr<ReadMappableBuffer> buffer;
+    try
+    {
+        buffer = as_read_mappable_buffer(renderable.buffer());
+    }
+    catch (std::runtime_error const&)
+    {
+        mir::log_error("Buffer does not support software rendering!");
+        return;
+    }
+
+    auto const mapping = buffer->map_readable();
+    auto const format = mapping->format();
+    int const width = mapping->size().width.as_int();
+    int const height = mapping->size().height.as_int();
+    if (width <= 0 || height <= 0)
+        return;
+
+    Source source{
+        reinterpret_cast<uint32_t const*>(mapping->data()),
+        mapping->stride().as_int() / sizeof(uint32_t),
+        width,
+        height};
+    switch (format)
+    {
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+        break;
+
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+        converted.resize(width * height);
+        for (int y = 0; y != height; ++y)
+        {
+            kernels::swap_red_blue(converted.data() + y * width, source.pixels + y * source.stride, width);
+        }
+        source.pixels = converted.data();
+        source.stride = width;
+        break;
+
+    default:
+        mir::log_error("Buffer format %d does not support software rendering!", format);
+        return;
+    }
+    bool const src_opaque =
+        !renderable.shaped() || format == mir_pixel_format_xrgb_8888 || format == mir_pixel_format_xbgr_8888;
+
+    /*
+     * Map source pixels to the frame: stretch the buffer over screen_position(), apply the
+     * transformation about the centre (in the plane of the screen) and then screen_to_frame.
+     */
+    auto const rect = renderable.screen_position();
+    auto const t = renderable.transformation();
+    double const centre_x = rect.left().as_int() + rect.size.width.as_int() / 2.0;
+    double const centre_y = rect.top().as_int() + rect.size.height.as_int() / 2.0;
+    double const stretch_x = rect.size.width.as_int() / static_cast<double>(width);
+    double const stretch_y = rect.size.height.as_int() / static_cast<double>(height);
+    Affine const to_screen{
+        t[0][0] * stretch_x, t[1][0] * stretch_y,
+        t[0][0] * (rect.left().as_int() - centre_x) + t[1][0] * (rect.top().as_int() - centre_y) + t[3][0] + centre_x,
+        t[0][1] * stretch_x, t[1][1] * stretch_y,
+        t[0][1] * (rect.left().as_int() - centre_x) + t[1][1] * (rect.top().as_int() - centre_y) + t[3][1] + centre_y};
+    auto const& s = screen_to_frame;
+    Affine const forward{
+        s.xx * to_screen.xx, s.xx * to_screen.xy, s.xx * to_screen.x0 + s.x0,
+        s.yy * to_screen.yx, s.yy * to_screen.yy, s.yy * to_screen.y0 + s.y0};
+
+    double const determinant = forward.xx * forward.yy - forward.xy * forward.yx;
+    if (std::abs(determinant) < epsilon)
+        return;
+    Affine const inverse{
+        forward.yy / determinant, -forward.xy / determinant,
+        (forward.xy * forward.y0 - forward.yy * forward.x0) / determinant,
+        -forward.yx / determinant, forward.xx / determinant,
+        (forward.yx * forward.x0 - forward.xx * forward.y0) / determinant};
+
+    // The frame pixels the source might land on
+    double min_x = std::numeric_limits<double>::max(), max_x = std::numeric_limits<double>::lowest();
+    double min_y = std::numeric_limits<double>::max(), max_y = std::numeric_limits<double>::lowest();
+    for (auto const& [u, v] : std::initializer_list<std::pair<int, int>>{{0, 0}, {width, 0}, {0, height}, {width, height}})
+    {
+        double const x = forward.xx * u + forward.xy * v + forward.x0;
+        double const y = forward.yx * u + forward.yy * v + forward.y0;
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+    }
+    int const left = std::floor(min_x);
+    int const top = std::floor(min_y);
+    auto bounds = intersection_of(
+        area,
+        geom::Rectangle{
+            {left, top},
+            {static_cast<int>(std::ceil(max_x)) - left, static_cast<int>(std::ceil(max_y)) - top}});
+    if (auto const clip = renderable.clip_area())
+        bounds = intersection_of(bounds, to_frame(clip.value()));
+    if (bounds.size.width.as_int() <= 0 || bounds.size.height.as_int() <= 0)
+        return;
+
+    auto const composite =
+        [alpha, src_opaque](uint32_t* dst, uint32_t const* src, std::size_t n)
+        {
+            if (alpha == 255 && src_opaque)
+                kernels::copy_opaque(dst, src, n);
+            else if (alpha == 255)
+                kernels::blend(dst, src, n);
+            else
+                kernels::blend_with_alpha(dst, src, n, alpha, src_opaque);
+        };
+
+    bool const axis_aligned = std::abs(inverse.xy) < epsilon && std::abs(inverse.yx) < epsilon;
+    bool const unscaled =
+        axis_aligned && std::abs(inverse.xx - 1) < epsilon && std::abs(inverse.yy - 1) < epsilon &&
+        is_integral(inverse.x0) && is_integral(inverse.y0);
+    // Upscaling by a whole number, as for buffers of a lower scale than the output, stays crisp
+    bool const replicated =
+        axis_aligned && is_integral(1 / inverse.xx) && is_integral(1 / inverse.yy);
+
+    row.resize(std::max<std::size_t>(row.size(), bounds.size.width.as_int()));
+
+    for (int y = bounds.top().as_int(); y < bounds.bottom().as_int(); ++y)
+    {
+        // Source coordinates of the centre of pixel (x, y) are u_start + x * du and v_start + x * dv
+        double const centre = y + 0.5;
+        double const u_start = inverse.xy * centre + inverse.x0 + inverse.xx * 0.5;
+        double const v_start = inverse.yy * centre + inverse.y0 + inverse.yx * 0.5;
+        double lo = bounds.left().as_int();
+        double hi = bounds.right().as_int();
+        constrain(u_start, inverse.xx, width, lo, hi);
+        constrain(v_start, inverse.yx, height, lo, hi);
+        int const first = std::ceil(lo);
+        int const end = std::min(static_cast<int>(std::ceil(hi)), bounds.right().as_int());
+        if (first >= end)
+            continue;
+
+        std::size_t const n = end - first;
+        uint32_t* const dst = frame.pixels + y * frame.stride + first;
+        double const u = u_start + inverse.xx * first;
+        double const v = v_start + inverse.yx * first;
+
+        if (unscaled)
+        {
+            // Keep the span inside the row, whatever the rounding
+            int const src_x = std::max(0, std::min(static_cast<int>(std::floor(u)), width - static_cast<int>(n)));
+            composite(dst, source.row(std::floor(v)) + src_x, std::min<std::size_t>(n, width));
+        }
+        else if (replicated)
+        {
+            int32_t const step = to_fixed(inverse.xx);
+            int32_t const span = step * static_cast<int32_t>(n - 1);
+            int32_t const min_start = std::max(0, -span);
+            int32_t const max_start = std::min((width << 16) - 1, (width << 16) - 1 - span);
+            if (min_start > max_start)
+                continue;
+            int32_t const start = std::clamp(to_fixed(u), min_start, max_start);
+            kernels::sample_nearest(row.data(), source.row(std::floor(v)), n, start, step);
+            composite(dst, row.data(), n);
+        }
+        else if (axis_aligned)
+        {
+            double const texel_y = v - 0.5;
+            int const row0 = std::floor(texel_y);
+            unsigned const fy = row0 < 0 || row0 >= height - 1 ? 0 : std::lround((texel_y - row0) * 256);
+            kernels::sample_bilinear(
+                row.data(),
+                source.row(row0),
+                source.row(row0 + 1),
+                width,
+                n,
+                to_fixed(u - 0.5),
+                to_fixed(inverse.xx),
+                std::min(fy, 255u));
+            composite(dst, row.data(), n);
+        }
+        else
+        {
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                double const texel_x = u + inverse.xx * i - 0.5;
+                double const texel_y = v + inverse.yx * i - 0.5;
+                int const row0 = std::floor(texel_y);
+                unsigned const fy = row0 < 0 || row0 >= height - 1 ? 0 : std::lround((texel_y - row0) * 256);
+                kernels::sample_bilinear(
+                    row.data() + i,
+                    source.row(row0),
+                    source.row(row0 + 1),
+                    width,
+                    1,
+                    to_fixed(texel_x),
+                    0,
+                    std::min(fy, 255u));
+            }
+            composite(dst, row.data(), n);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_RENDERER_H_
+#define MIR_RENDERER_SOFTWARE_RENDERER_H_
+
+#include <mir/renderer/renderer.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/graphics/renderable.h>
+#include "mir/renderer/sw/render_target.h"
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/**
+ * Composites renderables on the CPU into a RenderTarget, for outputs without a GPU.
+ *
+ * It follows the GL renderer in what it draws: renderables are stretched over their
+ * screen_position(), transformed about their centre and clipped to their clip_area(), and the
+ * viewport is letterboxed into the output and rotated and/or mirrored by the output transform.
+ * Only the parts of renderables' transformations that are affine in the plane of the screen are
+ * applied. Buffers have to be CPU-accessible and in one of the 8-bit RGB formats with a 32-bit
+ * pixel; others are skipped.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    /// render_target is owned externally, and must be kept alive as long as this object.
+    explicit Renderer(RenderTarget& render_target);
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const&) override;
+    void set_damage(geometry::Rectangles const& damage) override;
+    void render(graphics::RenderableList const&) const override;
+    void suspend() override;
+
+private:
+    /// A 2D affine mapping: (x, y) → (xx * x + xy * y + x0, yx * x + yy * y + y0)
+    struct Affine
+    {
+        double xx, xy, x0;
+        double yx, yy, y0;
+    };
+
+    /// Pixels the renderables are drawn into, as yet untransformed by the output transform
+    struct Frame
+    {
+        uint32_t* pixels;
+        std::size_t stride;     ///< In pixels
+        geometry::Size size;
+    };
+
+    void update_frame_geometry() const;
+    /// The part of the viewport that needs repainting this frame, or nullopt for all of it
+    auto repaint_area() const -> std::optional<geometry::Rectangle>;
+    /// The pixels of the frame covered by rect, in screen coordinates
+    auto to_frame(geometry::Rectangle const& rect) const -> geometry::Rectangle;
+    void draw(Frame const& frame, geometry::Rectangle const& area, graphics::Renderable const& renderable) const;
+
+    RenderTarget& render_target;
+    geometry::Rectangle viewport;
+    glm::mat2 output_transform{1};
+
+    /// Cleared when the viewport or output transform change, and checked against the target's size each frame
+    bool mutable frame_geometry_valid{false};
+    geometry::Size mutable target_size;
+    geometry::Size mutable frame_size;
+    /// From screen coordinates to frame pixels
+    Affine mutable screen_to_frame;
+    /// From the output's pixels to the frame's, if the output is transformed at all
+    std::optional<Affine> mutable output_to_frame;
+    /// The untransformed frame when the output is transformed; kept between frames as it's drawn incrementally
+    std::vector<uint32_t> mutable transformed_frame;
+
+    /// Source rows gathered for compositing, and sources in need of converting
+    std::vector<uint32_t> mutable row;
+    std::vector<uint32_t> mutable converted;
+
+    std::optional<geometry::Rectangles> mutable next_damage;
+    /// Damage of the most recently rendered frames, newest first
+    std::deque<geometry::Rectangles> mutable damage_history;
+};
+}
+}
+}
+
+#endif // MIR_RENDERER_SOFTWARE_RENDERER_H_
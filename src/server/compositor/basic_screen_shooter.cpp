@@ -43,7 +43,7 @@ mc::BasicScreenShooter::Self::Self(
 }
 
 auto mc::BasicScreenShooter::Self::render(
-    std::shared_ptr<mrs::WriteMappableBuffer> const& buffer,
+    TargetSetter const& set_target,
     geom::Rectangle const& area) -> time::Timestamp
 {
     std::lock_guard lock{mutex};
@@ -59,7 +59,7 @@ auto mc::BasicScreenShooter::Self::render(
     scene_elements.clear();
 
     render_target->make_current();
-    render_target->set_buffer(buffer);
+    set_target(*render_target);
 
     render_target->bind();
     renderer->set_viewport(area);
@@ -86,16 +86,39 @@ void mc::BasicScreenShooter::capture(
     std::shared_ptr<mrs::WriteMappableBuffer> const& buffer,
     geom::Rectangle const& area,
     std::function<void(std::optional<time::Timestamp>)>&& callback)
+{
+    spawn_capture(
+        [buffer](mrg::BufferRenderTarget& render_target) { render_target.set_buffer(buffer); },
+        area,
+        std::move(callback));
+}
+
+void mc::BasicScreenShooter::capture_dmabuf(
+    std::shared_ptr<mg::Buffer> const& buffer,
+    geom::Rectangle const& area,
+    std::function<void(std::optional<time::Timestamp>)>&& callback)
+{
+    spawn_capture(
+        [buffer](mrg::BufferRenderTarget& render_target) { render_target.set_dmabuf(buffer); },
+        area,
+        std::move(callback));
+}
+
+void mc::BasicScreenShooter::spawn_capture(
+    TargetSetter&& set_target,
+    geom::Rectangle const& area,
+    std::function<void(std::optional<time::Timestamp>)>&& callback)
 {
     // TODO: use an atomic to keep track of number of in-flight captures, and error if it's too many
 
-    executor.spawn([weak_self=std::weak_ptr<Self>{self}, buffer, area, callback=std::move(callback)]
+    executor.spawn(
+        [weak_self=std::weak_ptr<Self>{self}, set_target=std::move(set_target), area, callback=std::move(callback)]
         {
             if (auto const self = weak_self.lock())
             {
                 try
                 {
-                    callback(self->render(buffer, area));
+                    callback(self->render(set_target, area));
                     return;
                 }
                 catch (...)
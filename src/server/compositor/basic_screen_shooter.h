@@ -52,7 +52,20 @@ public:
         geometry::Rectangle const& area,
         std::function<void(std::optional<time::Timestamp>)>&& callback) override;
 
+    void capture_dmabuf(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangle const& area,
+        std::function<void(std::optional<time::Timestamp>)>&& callback) override;
+
 private:
+    /// Points the render target at the capture's buffer
+    using TargetSetter = std::function<void(renderer::gl::BufferRenderTarget&)>;
+
+    void spawn_capture(
+        TargetSetter&& set_target,
+        geometry::Rectangle const& area,
+        std::function<void(std::optional<time::Timestamp>)>&& callback);
+
     struct Self
     {
         Self(
@@ -61,9 +74,7 @@ private:
             std::unique_ptr<renderer::gl::BufferRenderTarget>&& render_target,
             std::unique_ptr<renderer::Renderer>&& renderer);
 
-        auto render(
-            std::shared_ptr<renderer::software::WriteMappableBuffer> const& buffer,
-            geometry::Rectangle const& area) -> time::Timestamp;
+        auto render(TargetSetter const& set_target, geometry::Rectangle const& area) -> time::Timestamp;
 
         std::mutex mutex;
         std::shared_ptr<Scene> const scene;
@@ -0,0 +1,243 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "damage_tracker.h"
+#include "mir/graphics/buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+auto mc::DamageTracker::snapshot_of(mg::Renderable const& renderable) -> Snapshot
+{
+    std::optional<mg::BufferID> buffer_id;
+    geom::Size buffer_size;
+    if (auto const buffer = renderable.buffer())
+    {
+        buffer_id = buffer->id();
+        buffer_size = buffer->size();
+    }
+
+    return Snapshot{
+        renderable.id(),
+        buffer_id,
+        buffer_size,
+        renderable.screen_position(),
+        renderable.clip_area(),
+        renderable.alpha(),
+        renderable.transformation(),
+        renderable.shaped()};
+}
+
+auto mc::DamageTracker::extents_of(Snapshot const& snapshot, geom::Rectangle const& view_area) -> geom::Rectangle
+{
+    static glm::mat4 const identity(1);
+
+    if (snapshot.transformation != identity)
+        return view_area;  // Weirdly transformed. Could be drawn anywhere.
+
+    auto const visible = snapshot.clip_area ?
+        intersection_of(snapshot.screen_position, snapshot.clip_area.value()) :
+        snapshot.screen_position;
+
+    return intersection_of(visible, view_area);
+}
+
+auto mc::DamageTracker::add_screen_damage(
+    Snapshot const& snapshot,
+    geom::Rectangles const& buffer_damage,
+    geom::Rectangle const& view_area,
+    geom::Rectangles& damage) -> bool
+{
+    static glm::mat4 const identity(1);
+
+    if (snapshot.transformation != identity ||
+        snapshot.buffer_size.width.as_int() <= 0 ||
+        snapshot.buffer_size.height.as_int() <= 0)
+    {
+        return false;
+    }
+
+    auto const extents = extents_of(snapshot, view_area);
+    auto const& position = snapshot.screen_position;
+    double const x_scale = double(position.size.width.as_int()) / snapshot.buffer_size.width.as_int();
+    double const y_scale = double(position.size.height.as_int()) / snapshot.buffer_size.height.as_int();
+
+    for (auto const& rect : buffer_damage)
+    {
+        // Round outwards, so a scaled buffer can't leave stale pixels at the edges of the damage
+        auto const left = int(std::floor(rect.left().as_int() * x_scale));
+        auto const top = int(std::floor(rect.top().as_int() * y_scale));
+        auto const right = int(std::ceil(rect.right().as_int() * x_scale));
+        auto const bottom = int(std::ceil(rect.bottom().as_int() * y_scale));
+
+        auto const on_screen = intersection_of(
+            geom::Rectangle{
+                position.top_left + geom::Displacement{left, top},
+                geom::Size{right - left, bottom - top}},
+            extents);
+
+        if (on_screen != geom::Rectangle{})
+            damage.add(on_screen);
+    }
+    return true;
+}
+
+void mc::DamageTracker::build_index(std::vector<Snapshot> const& frame, Index& index)
+{
+    index.clear();
+    for (std::size_t i = 0; i != frame.size(); ++i)
+        index.emplace_back(frame[i].id, i);
+
+    std::sort(index.begin(), index.end());
+}
+
+auto mc::DamageTracker::find(Index const& index, mg::Renderable::ID id) -> std::optional<std::size_t>
+{
+    auto const match = std::lower_bound(
+        index.begin(), index.end(), id,
+        [](auto const& entry, mg::Renderable::ID id) { return entry.first < id; });
+
+    if (match == index.end() || match->first != id)
+        return std::nullopt;
+
+    return match->second;
+}
+
+auto mc::DamageTracker::damage_for(mg::RenderableList const& renderables, geom::Rectangle const& view_area)
+    -> geom::Rectangles const&
+{
+    auto& current = current_frame;
+    current.clear();
+    for (auto const& renderable : renderables)
+        current.push_back(snapshot_of(*renderable));
+
+    damage.clear();
+    auto const add_damage = [this](geom::Rectangle const& rect)
+        {
+            if (rect != geom::Rectangle{})
+                damage.add(rect);
+        };
+
+    if (!has_previous_frame || view_area != previous_view_area)
+    {
+        add_damage(view_area);
+    }
+    else
+    {
+        auto const& previous = previous_frame;
+
+        build_index(previous, previous_index);
+        build_index(current, current_index);
+
+        /*
+         * Renderables present in both frames whose relative stacking order has
+         * changed (flagged by their index in the current frame). Only the order
+         * among the common renderables matters here; appearing and disappearing
+         * renderables are damaged separately.
+         */
+        restacked.assign(current.size(), false);
+        {
+            std::size_t prev = 0;
+            std::size_t curr = 0;
+            while (true)
+            {
+                while (prev != previous.size() && !find(current_index, previous[prev].id))
+                    ++prev;
+                while (curr != current.size() && !find(previous_index, current[curr].id))
+                    ++curr;
+
+                if (prev == previous.size() || curr == current.size())
+                    break;
+
+                if (previous[prev].id != current[curr].id)
+                {
+                    restacked[*find(current_index, previous[prev].id)] = true;
+                    restacked[curr] = true;
+                }
+
+                ++prev;
+                ++curr;
+            }
+        }
+
+        for (std::size_t i = 0; i != current.size(); ++i)
+        {
+            auto const& snapshot = current[i];
+            auto const match = find(previous_index, snapshot.id);
+            if (!match)
+            {
+                add_damage(extents_of(snapshot, view_area));
+                continue;
+            }
+
+            auto const& old = previous[*match];
+            bool const only_buffer_changed =
+                !restacked[i] &&
+                old.buffer && snapshot.buffer &&
+                old.buffer != snapshot.buffer &&
+                old.buffer_size == snapshot.buffer_size &&
+                old.screen_position == snapshot.screen_position &&
+                old.clip_area == snapshot.clip_area &&
+                old.alpha == snapshot.alpha &&
+                old.transformation == snapshot.transformation &&
+                old.shaped == snapshot.shaped;
+
+            if (only_buffer_changed)
+            {
+                if (auto const buffer_damage = renderables[i]->buffer_damage_since(old.buffer.value()))
+                {
+                    if (add_screen_damage(snapshot, buffer_damage.value(), view_area, damage))
+                        continue;
+                }
+            }
+
+            if (restacked[i] ||
+                old.buffer != snapshot.buffer ||
+                old.buffer_size != snapshot.buffer_size ||
+                old.screen_position != snapshot.screen_position ||
+                old.clip_area != snapshot.clip_area ||
+                old.alpha != snapshot.alpha ||
+                old.transformation != snapshot.transformation ||
+                old.shaped != snapshot.shaped)
+            {
+                add_damage(extents_of(old, view_area));
+                add_damage(extents_of(snapshot, view_area));
+            }
+        }
+
+        for (auto const& snapshot : previous)
+        {
+            if (!find(current_index, snapshot.id))
+                add_damage(extents_of(snapshot, view_area));
+        }
+    }
+
+    // Keep both frames' storage, so neither needs reallocating next time
+    std::swap(previous_frame, current_frame);
+    has_previous_frame = true;
+    previous_view_area = view_area;
+
+    return damage;
+}
+
+void mc::DamageTracker::invalidate()
+{
+    has_previous_frame = false;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+#define MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/geometry/size.h"
+#include "mir/graphics/renderable.h"
+#include "mir/graphics/buffer_id.h"
+
+#include <optional>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Accumulates the damage to a single output between consecutive frames.
+ *
+ * Each frame the renderables that are going to be drawn are compared with
+ * those drawn in the previous frame. Anything that has a new buffer, has moved,
+ * been resized, changed alpha/transformation/clip, appeared, disappeared or
+ * changed its position in the stacking order contributes both its old and its
+ * new extents to the damage. Where only the buffer has changed and the client
+ * told us which part of it changed, just that part is damaged.
+ */
+class DamageTracker
+{
+public:
+    DamageTracker() = default;
+
+    /**
+     * Compute the damage to view_area since the last call, and remember
+     * renderables as the new reference frame.
+     *
+     * \returns the damaged parts of view_area. An empty result means that
+     *          nothing visible has changed since the previous frame. It is
+     *          only valid until the next call.
+     */
+    auto damage_for(graphics::RenderableList const& renderables, geometry::Rectangle const& view_area)
+        -> geometry::Rectangles const&;
+
+    /// Forget the previous frame, so the next damage_for() damages the whole view area
+    void invalidate();
+
+private:
+    struct Snapshot
+    {
+        graphics::Renderable::ID id;
+        std::optional<graphics::BufferID> buffer;
+        geometry::Size buffer_size;
+        geometry::Rectangle screen_position;
+        std::optional<geometry::Rectangle> clip_area;
+        float alpha;
+        glm::mat4 transformation;
+        bool shaped;
+    };
+
+    static auto snapshot_of(graphics::Renderable const& renderable) -> Snapshot;
+    static auto extents_of(Snapshot const& snapshot, geometry::Rectangle const& view_area) -> geometry::Rectangle;
+    /**
+     * Add the part of the renderable covered by buffer_damage to damage
+     *
+     * \returns false (having added nothing) if that can't be determined
+     */
+    static auto add_screen_damage(
+        Snapshot const& snapshot,
+        geometry::Rectangles const& buffer_damage,
+        geometry::Rectangle const& view_area,
+        geometry::Rectangles& damage) -> bool;
+
+    /// Renderable IDs with their indices in a frame, sorted by ID to look them up
+    using Index = std::vector<std::pair<graphics::Renderable::ID, std::size_t>>;
+    static void build_index(std::vector<Snapshot> const& frame, Index& index);
+    static auto find(Index const& index, graphics::Renderable::ID id) -> std::optional<std::size_t>;
+
+    bool has_previous_frame{false};
+    std::vector<Snapshot> previous_frame;
+    geometry::Rectangle previous_view_area;
+
+    /// Reused every frame, so that tracking damage needn't allocate once they have grown to fit
+    /// @{
+    std::vector<Snapshot> current_frame;
+    Index previous_index;
+    Index current_index;
+    std::vector<bool> restacked;
+    geometry::Rectangles damage;
+    /// @}
+};
+
+}
+}
+
+#endif // MIR_COMPOSITOR_DAMAGE_TRACKER_H_
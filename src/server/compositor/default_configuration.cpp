@@ -20,6 +20,7 @@
 #include "buffer_stream_factory.h"
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
+#include "mir/compositor/frame_clock.h"
 #include "gl/renderer_factory.h"
 #include "basic_screen_shooter.h"
 #include "null_screen_shooter.h"
@@ -74,6 +75,8 @@ mir::DefaultServerConfiguration::the_compositor()
         {
             std::chrono::milliseconds const composite_delay(
                 the_options()->get<int>(options::composite_delay_opt));
+            std::chrono::milliseconds const composite_margin(
+                the_options()->get<int>(options::composite_margin_opt));
 
             return std::make_shared<mc::MultiThreadedCompositor>(
                 the_display(),
@@ -81,11 +84,23 @@ mir::DefaultServerConfiguration::the_compositor()
                 the_display_buffer_compositor_factory(),
                 the_shell(),
                 the_compositor_report(),
+                the_frame_clock(),
                 composite_delay,
+                composite_margin,
                 true);
         });
 }
 
+std::shared_ptr<mc::FrameClock>
+mir::DefaultServerConfiguration::the_frame_clock()
+{
+    return frame_clock(
+        []()
+        {
+            return std::make_shared<mc::FrameClock>();
+        });
+}
+
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
@@ -107,7 +122,7 @@ auto mir::DefaultServerConfiguration::the_screen_shooter() -> std::shared_ptr<co
                 return std::make_shared<compositor::BasicScreenShooter>(
                     the_scene(),
                     the_clock(),
-                    thread_pool_executor,
+                    background_executor,
                     std::move(render_target),
                     std::move(renderer));
             }
@@ -118,7 +133,7 @@ auto mir::DefaultServerConfiguration::the_screen_shooter() -> std::shared_ptr<co
                     "",
                     std::current_exception(),
                     "failed to create BasicScreenShooter");
-                return std::make_shared<compositor::NullScreenShooter>(thread_pool_executor);
+                return std::make_shared<compositor::NullScreenShooter>(background_executor);
             }
         });
 }
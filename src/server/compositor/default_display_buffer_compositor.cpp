@@ -22,10 +22,58 @@
 #include "mir/graphics/display_buffer.h"
 #include "mir/graphics/buffer.h"
 #include "mir/renderer/renderer.h"
-#include "occlusion.h"
+#include "mir/raii.h"
 
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+/// A renderable that is partly covered, so need only be drawn within visible_bounds
+class mc::DefaultDisplayBufferCompositor::PartlyOccludedRenderable : public mg::Renderable
+{
+public:
+    void wrap(std::shared_ptr<mg::Renderable> const& renderable, geom::Rectangle const& visible_bounds)
+    {
+        this->renderable = renderable;
+        this->visible_bounds = visible_bounds;
+    }
+
+    void release()
+    {
+        renderable.reset();
+    }
+
+    ID id() const override
+    { return renderable->id(); }
+
+    std::shared_ptr<mg::Buffer> buffer() const override
+    { return renderable->buffer(); }
+
+    std::optional<geom::Rectangles> buffer_damage_since(mg::BufferID previous) const override
+    { return renderable->buffer_damage_since(previous); }
+
+    geom::Rectangle screen_position() const override
+    { return renderable->screen_position(); }
+
+    std::optional<geom::Rectangle> clip_area() const override
+    { return visible_bounds; }
+
+    float alpha() const override
+    { return renderable->alpha(); }
+
+    glm::mat4 transformation() const override
+    { return renderable->transformation(); }
+
+    bool shaped() const override
+    { return renderable->shaped(); }
+
+    std::optional<geom::Rectangles> opaque_region() const override
+    { return renderable->opaque_region(); }
+
+private:
+    std::shared_ptr<mg::Renderable> renderable;
+    geom::Rectangle visible_bounds;   ///< Already within the underlying clip_area()
+};
 
 mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
     mg::DisplayBuffer& display_buffer,
@@ -37,24 +85,37 @@ mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
 {
 }
 
-void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& scene_elements)
+bool mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& scene_elements)
 {
     report->began_frame(this);
+    report->began_stage(this, CompositorReport::FrameStage::occlusion);
 
     auto const& view_area = display_buffer.view_area();
-    auto const& occlusions = mc::filter_occlusions_from(scene_elements, view_area);
+    occlusion_filter.filter(scene_elements, view_area, occluded);
 
-    for (auto const& element : occlusions)
+    for (auto const& element : occluded)
         element->occluded();
+    occluded.clear();
+
+    auto const release_clipped_at_end = raii::paired_calls([]{}, [this]{ release_clipped(); });
+    auto const& visible_bounds = occlusion_filter.visible_bounds();
 
     mg::RenderableList renderable_list;
     renderable_list.reserve(scene_elements.size());
-    for (auto const& element : scene_elements)
+    for (size_t i = 0; i != scene_elements.size(); ++i)
     {
+        auto const& element = scene_elements[i];
         element->rendered();
-        renderable_list.push_back(element->renderable());
+
+        // Don't draw what's hidden beneath other surfaces
+        if (auto const& bounds = visible_bounds[i])
+            renderable_list.push_back(clipped(element->renderable(), bounds.value()));
+        else
+            renderable_list.push_back(element->renderable());
     }
 
+    report->finished_stage(this, CompositorReport::FrameStage::occlusion);
+
     /*
      * Note: Buffer lifetimes are ensured by the two objects holding
      *       references to them; scene_elements and renderable_list.
@@ -65,16 +126,37 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      */
     scene_elements.clear();  // Those in use are still in renderable_list
 
-    if (display_buffer.overlay(renderable_list))
+    if (damage_tracker.damage_for(renderable_list, view_area).size() == 0)
+    {
+        // Nothing visible has changed, so the last frame posted is still correct
+        report->finished_frame(this);
+        return false;
+    }
+
+    report->began_stage(this, CompositorReport::FrameStage::render);
+    auto to_render = display_buffer.assign_planes(renderable_list);
+    if (!to_render)
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
+        report->finished_stage(this, CompositorReport::FrameStage::render);
+
+        // Nothing was rendered, so the next frame must be (and can't build on this one)
+        damage_tracker.invalidate();
+        rendered_damage_tracker.invalidate();
     }
     else
     {
         renderer->set_output_transform(display_buffer.transformation());
         renderer->set_viewport(view_area);
-        renderer->render(renderable_list);
+        /*
+         * Only what's rendered needs re-rendering: a renderable moving on or off a plane
+         * appears in or disappears from to_render, which damages it, but changes to
+         * what's on planes don't touch the rendered frame at all.
+         */
+        renderer->set_damage(rendered_damage_tracker.damage_for(*to_render, view_area));
+        renderer->render(*to_render);
+        report->finished_stage(this, CompositorReport::FrameStage::render);
 
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
@@ -91,7 +173,34 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
          *        acquisition calls when we composite the next frame.
          */
         renderable_list.clear();
+        to_render->clear();
     }
 
     report->finished_frame(this);
+
+    return true;
+}
+
+auto mc::DefaultDisplayBufferCompositor::clipped(
+    std::shared_ptr<mg::Renderable> const& renderable,
+    geom::Rectangle const& bounds) -> std::shared_ptr<mg::Renderable>
+{
+    if (clip_wrappers_used == clip_wrappers.size())
+        clip_wrappers.push_back(std::make_shared<PartlyOccludedRenderable>());
+
+    // Anything still holding a wrapper from an earlier frame keeps it; this one gets a new one
+    auto& wrapper = clip_wrappers[clip_wrappers_used++];
+    if (wrapper.use_count() > 1)
+        wrapper = std::make_shared<PartlyOccludedRenderable>();
+
+    wrapper->wrap(renderable, bounds);
+    return wrapper;
+}
+
+void mc::DefaultDisplayBufferCompositor::release_clipped()
+{
+    for (size_t i = 0; i != clip_wrappers_used; ++i)
+        clip_wrappers[i]->release();
+
+    clip_wrappers_used = 0;
 }
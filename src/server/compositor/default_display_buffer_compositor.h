@@ -19,7 +19,11 @@
 
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/compositor_report.h"
+#include "damage_tracker.h"
+#include "occlusion.h"
+
 #include <memory>
+#include <vector>
 
 namespace mir
 {
@@ -44,12 +48,30 @@ public:
         std::shared_ptr<renderer::Renderer> const& renderer,
         std::shared_ptr<CompositorReport> const& report);
 
-    void composite(SceneElementSequence&& scene_sequence) override;
+    bool composite(SceneElementSequence&& scene_sequence) override;
 
 private:
+    class PartlyOccludedRenderable;
+
+    /// A wrapper clipping renderable to bounds, valid until release_clipped()
+    auto clipped(std::shared_ptr<graphics::Renderable> const& renderable, geometry::Rectangle const& bounds)
+        -> std::shared_ptr<graphics::Renderable>;
+    /// Let go of the renderables wrapped by clipped(), so as not to hold their buffers
+    void release_clipped();
+
     graphics::DisplayBuffer& display_buffer;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
+    /// Changes to anything visible, to tell whether there's a new frame at all
+    DamageTracker damage_tracker;
+    /// Changes to what's rendered rather than put on overlay planes, to tell what to re-render
+    DamageTracker rendered_damage_tracker;
+    /// Kept, with its scratch space, to avoid reallocating every frame
+    OcclusionFilter occlusion_filter;
+    SceneElementSequence occluded;
+    /// The wrappers clipped() hands out, reused from frame to frame rather than reallocated
+    std::vector<std::shared_ptr<PartlyOccludedRenderable>> clip_wrappers;
+    size_t clip_wrappers_used{0};
 };
 
 }
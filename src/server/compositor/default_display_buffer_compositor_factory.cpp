@@ -19,6 +19,8 @@
 #include "mir/renderer/renderer.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
+#include "software/renderer.h"
 
 #include "default_display_buffer_compositor.h"
 
@@ -39,6 +41,15 @@ std::unique_ptr<mc::DisplayBufferCompositor>
 mc::DefaultDisplayBufferCompositorFactory::create_compositor_for(
     mg::DisplayBuffer& display_buffer)
 {
+    // Outputs without a GPU are composited on the CPU, whatever renderer the server is configured with
+    if (auto const software_target = dynamic_cast<renderer::software::RenderTarget*>(display_buffer.native_display_buffer()))
+    {
+        auto renderer = std::make_unique<renderer::software::Renderer>(*software_target);
+        renderer->set_viewport(display_buffer.view_area());
+        return std::make_unique<DefaultDisplayBufferCompositor>(
+             display_buffer, std::move(renderer), report);
+    }
+
     auto const render_target = dynamic_cast<renderer::gl::RenderTarget*>(display_buffer.native_display_buffer());
     if (!render_target)
     {
@@ -0,0 +1,125 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/frame_clock.h"
+
+#include <algorithm>
+#include <optional>
+
+namespace mc = mir::compositor;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+thread_local std::optional<mc::CompositorID> this_threads_compositor;
+}
+
+void mc::FrameClock::predict(CompositorID compositor, time::PosixTimestamp when, std::chrono::nanoseconds period)
+{
+    std::lock_guard lock{mutex};
+    predictions[compositor] = Prediction{when, period};
+}
+
+void mc::FrameClock::forget(CompositorID compositor)
+{
+    std::lock_guard lock{mutex};
+    predictions.erase(compositor);
+    posts.erase(compositor);
+
+    // Nothing more will be presented by compositor, but another may yet show the content
+    for (auto& pending : pending_presentations)
+    {
+        if (pending.compositor == compositor)
+            pending.compositor = std::nullopt;
+    }
+}
+
+auto mc::FrameClock::time_until_next_frame(std::chrono::nanoseconds fallback) const -> std::chrono::nanoseconds
+{
+    std::lock_guard lock{mutex};
+
+    std::optional<std::chrono::nanoseconds> soonest;
+    for (auto const& [_, prediction] : predictions)
+    {
+        auto until = prediction.when - time::PosixTimestamp::now(prediction.when.clock_id);
+
+        // A prediction that has passed repeats every period (the compositor may just be idle)
+        if (until < 0ns && prediction.period > 0ns)
+            until = (until % prediction.period + prediction.period) % prediction.period;
+        until = std::max(until, std::chrono::nanoseconds::zero());
+
+        if (!soonest || until < *soonest)
+            soonest = until;
+    }
+
+    return soonest.value_or(fallback);
+}
+
+void mc::FrameClock::set_compositor_on_this_thread(std::optional<CompositorID> compositor)
+{
+    this_threads_compositor = compositor;
+}
+
+auto mc::FrameClock::compositor_on_this_thread() -> std::optional<CompositorID>
+{
+    return this_threads_compositor;
+}
+
+void mc::FrameClock::posted(CompositorID compositor)
+{
+    std::lock_guard lock{mutex};
+    ++posts[compositor];
+}
+
+void mc::FrameClock::presented(
+    CompositorID compositor,
+    graphics::Frame const& frame,
+    std::chrono::nanoseconds refresh,
+    bool latest)
+{
+    std::vector<PresentationHandler> handlers;
+    {
+        std::lock_guard lock{mutex};
+
+        // How many of compositor's posts are on screen with this frame
+        auto const posted = posts[compositor];
+        auto const shown = latest || posted == 0 ? posted : posted - 1;
+
+        auto const is_shown = [&](PendingPresentation const& pending)
+            {
+                return !pending.compositor || (*pending.compositor == compositor && pending.posts < shown);
+            };
+
+        for (auto& pending : pending_presentations)
+        {
+            if (is_shown(pending))
+                handlers.push_back(std::move(pending.handler));
+        }
+        std::erase_if(pending_presentations, is_shown);
+    }
+
+    // Called without the lock held, so handlers may register for the following frame
+    for (auto const& handler : handlers)
+        handler(frame, refresh);
+}
+
+void mc::FrameClock::on_next_presentation(std::optional<CompositorID> compositor, PresentationHandler&& handler)
+{
+    std::lock_guard lock{mutex};
+    auto const posted = compositor ? posts[*compositor] : 0;
+    pending_presentations.push_back(PendingPresentation{compositor, posted, std::move(handler)});
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_scheduler.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+/// How many frames the estimates look back over
+size_t const history_length = 32;
+
+/// Intervals longer than this are gaps in presentation (idling, DPMS) rather than refreshes
+auto const longest_plausible_period = 100ms;
+
+template<typename T>
+void remember(std::deque<T>& history, T value)
+{
+    history.push_back(value);
+    if (history.size() > history_length)
+        history.pop_front();
+}
+}
+
+mc::FrameScheduler::FrameScheduler(std::chrono::nanoseconds headroom)
+    : headroom{headroom}
+{
+}
+
+void mc::FrameScheduler::presented(mg::Frame const& frame)
+{
+    if (last_presented)
+    {
+        if (frame.msc == last_presented->msc && frame.ust == last_presented->ust)
+            return;
+
+        if (frame.msc > last_presented->msc && frame.ust.clock_id == last_presented->ust.clock_id)
+        {
+            auto const interval = (frame.ust - last_presented->ust) / (frame.msc - last_presented->msc);
+            if (0ns < interval && interval <= longest_plausible_period)
+                remember(frame_intervals, interval);
+        }
+        else
+        {
+            // A different clock or a reset counter: nothing measured so far relates to this frame
+            frame_intervals.clear();
+        }
+    }
+
+    last_presented = frame;
+}
+
+void mc::FrameScheduler::rendered(std::chrono::nanoseconds render_time)
+{
+    remember(render_times, render_time);
+}
+
+auto mc::FrameScheduler::refresh_period() const -> std::optional<std::chrono::nanoseconds>
+{
+    if (frame_intervals.empty())
+        return std::nullopt;
+
+    return *std::min_element(frame_intervals.begin(), frame_intervals.end());
+}
+
+auto mc::FrameScheduler::margin() const -> std::chrono::nanoseconds
+{
+    if (render_times.empty())
+        return headroom;
+
+    return headroom + *std::max_element(render_times.begin(), render_times.end());
+}
+
+auto mc::FrameScheduler::composite_time(time::PosixTimestamp const& now) const
+    -> std::optional<time::PosixTimestamp>
+{
+    auto const period = refresh_period();
+    if (!period || now.clock_id != last_presented->ust.clock_id)
+        return std::nullopt;
+
+    auto const lead = margin();
+
+    // The earliest vblank after the last one presented that we can still start rendering for...
+    auto const since_presented = now + lead - last_presented->ust;
+    auto const vblanks = std::max<int64_t>(1, (since_presented + *period - 1ns) / *period);
+
+    return last_presented->ust + vblanks * *period - lead;
+}
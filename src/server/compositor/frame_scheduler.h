@@ -0,0 +1,83 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_FRAME_SCHEDULER_H_
+#define MIR_COMPOSITOR_FRAME_SCHEDULER_H_
+
+#include "mir/graphics/frame.h"
+#include "mir/time/posix_timestamp.h"
+
+#include <chrono>
+#include <deque>
+#include <optional>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Decides when the compositor of a display sync group should next sample the scene.
+ *
+ * The refresh period is estimated from the timestamps of successive page flips, and
+ * compositing is started a margin ahead of the predicted vblank: as late as possible,
+ * so the frame shows the freshest client content, but early enough for rendering to
+ * finish in time. The margin is the configured headroom plus the longest recently
+ * measured render time, so it follows the speed of the GPU and the complexity of the
+ * scene.
+ *
+ * The shortest recent frame interval is taken as the period. On variable refresh rate
+ * outputs that is the fastest the panel has been driven, so a frame is never deliberately
+ * started later than the panel could show it.
+ */
+class FrameScheduler
+{
+public:
+    explicit FrameScheduler(std::chrono::nanoseconds headroom);
+
+    /// Note that frame has been presented (its page flip completed)
+    void presented(graphics::Frame const& frame);
+
+    /// Note that the last frame took render_time from sampling the scene to being ready to post
+    void rendered(std::chrono::nanoseconds render_time);
+
+    /// The estimated refresh period, or std::nullopt until two frames have been presented
+    auto refresh_period() const -> std::optional<std::chrono::nanoseconds>;
+
+    /// How long before the predicted vblank compositing is started
+    auto margin() const -> std::chrono::nanoseconds;
+
+    /**
+     * When to start compositing a frame requested at now, so that it catches the earliest
+     * vblank it can.
+     *
+     * \returns std::nullopt if vblanks can't be predicted (yet), in which case compositing
+     *          should start straight away
+     */
+    auto composite_time(time::PosixTimestamp const& now) const -> std::optional<time::PosixTimestamp>;
+
+private:
+    std::chrono::nanoseconds const headroom;
+
+    std::optional<graphics::Frame> last_presented;
+    std::deque<std::chrono::nanoseconds> frame_intervals;
+    std::deque<std::chrono::nanoseconds> render_times;
+};
+
+}
+}
+
+#endif // MIR_COMPOSITOR_FRAME_SCHEDULER_H_
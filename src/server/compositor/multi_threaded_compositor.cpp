@@ -15,6 +15,7 @@
  */
 
 #include "multi_threaded_compositor.h"
+#include "frame_scheduler.h"
 #include "mir/graphics/display.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/compositor/display_buffer_compositor.h"
@@ -22,6 +23,7 @@
 #include "mir/compositor/display_listener.h"
 #include "mir/compositor/scene.h"
 #include "mir/compositor/compositor_report.h"
+#include "mir/compositor/frame_clock.h"
 #include "mir/scene/scene_change_notification.h"
 #include "mir/scene/surface_observer.h"
 #include "mir/scene/surface.h"
@@ -34,6 +36,7 @@
 #include <thread>
 #include <chrono>
 #include <condition_variable>
+#include <optional>
 #include <boost/throw_exception.hpp>
 
 using namespace std::literals::chrono_literals;
@@ -56,15 +59,19 @@ public:
         std::shared_ptr<mc::Scene> const& scene,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::chrono::milliseconds fixed_composite_delay,
-        std::shared_ptr<CompositorReport> const& report) :
+        std::chrono::milliseconds composite_margin,
+        std::shared_ptr<CompositorReport> const& report,
+        std::shared_ptr<FrameClock> const& frame_clock) :
         compositor_factory{db_compositor_factory},
         group(group),
         scene(scene),
         running{true},
         frames_scheduled{0},
         force_sleep{fixed_composite_delay},
+        scheduler{composite_margin},
         display_listener{display_listener},
         report{report},
+        frame_clock{frame_clock},
         started_future{started.get_future()},
         stopped_future{stopped.get_future()}
     {
@@ -80,6 +87,17 @@ public:
             {
                 stopped.set_value();
             });
+        auto const forget_prediction = mir::raii::paired_calls(
+            [this]()
+            {
+                // So that buffers consumed here are presented by this compositor's frames
+                FrameClock::set_compositor_on_this_thread(this);
+            },
+            [this]()
+            {
+                FrameClock::set_compositor_on_this_thread(std::nullopt);
+                frame_clock->forget(this);
+            });
 
         std::vector<std::tuple<mg::DisplayBuffer*, std::unique_ptr<mc::DisplayBufferCompositor>>> compositors;
         group.for_each_display_buffer(
@@ -116,6 +134,22 @@ public:
 
         started.set_value();
 
+        // Reused every frame, so that sampling the scene needn't reallocate it
+        mc::SceneElementSequence scene_elements;
+
+        // Stages of the frame shared by all the compositors on this thread
+        using Stage = CompositorReport::FrameStage;
+        auto const began_stage = [&](Stage stage)
+            {
+                for (auto& compositor : compositors)
+                    report->began_stage(std::get<1>(compositor).get(), stage);
+            };
+        auto const finished_stage = [&](Stage stage)
+            {
+                for (auto& compositor : compositors)
+                    report->finished_stage(std::get<1>(compositor).get(), stage);
+            };
+
         try
         {
             std::unique_lock lock{run_mutex};
@@ -124,6 +158,19 @@ public:
                 /* Wait until compositing has been scheduled or we are stopped */
                 run_cv.wait(lock, [&]{ return (frames_scheduled > 0) || !running; });
 
+                /*
+                 * Once we know when the outputs will next refresh, sample the
+                 * scene as late as we can while still rendering in time for that
+                 * vblank. Anything clients commit meanwhile makes it into this
+                 * frame rather than waiting a whole refresh period for the next.
+                 */
+                if (auto const deadline = next_composite_time())
+                {
+                    began_stage(Stage::delay);
+                    run_cv.wait_until(lock, *deadline, [&]{ return !running; });
+                    finished_stage(Stage::delay);
+                }
+
                 /*
                  * Check if we are running before compositing, since we may have
                  * been stopped while waiting for the run_cv above.
@@ -141,23 +188,57 @@ public:
                     not_posted_yet = false;
                     lock.unlock();
 
+                    auto const render_start = std::chrono::steady_clock::now();
+                    bool needs_post = false;
                     for (auto& tuple : compositors)
                     {
                         auto& compositor = std::get<1>(tuple);
-                        compositor->composite(scene->scene_elements_for(compositor.get()));
+                        report->began_stage(compositor.get(), Stage::scene_snapshot);
+                        scene->collect_scene_elements_for(compositor.get(), scene_elements);
+                        report->finished_stage(compositor.get(), Stage::scene_snapshot);
+                        if (compositor->composite(std::move(scene_elements)))
+                            needs_post = true;
                     }
-                    group.post();
 
-                    /*
-                     * "Predictive bypass" optimization: If the last frame was
-                     * bypassed/overlayed or you simply have a fast GPU, it is
-                     * beneficial to sleep for most of the next frame. This reduces
-                     * the latency between snapshotting the scene and post()
-                     * completing by almost a whole frame.
-                     */
-                    auto delay = force_sleep >= std::chrono::milliseconds::zero() ?
-                                 force_sleep : group.recommended_sleep();
-                    std::this_thread::sleep_for(delay);
+                    // If nothing visible changed there's no new frame to show
+                    if (needs_post)
+                    {
+                        scheduler.rendered(std::chrono::steady_clock::now() - render_start);
+                        began_stage(Stage::post);
+                        group.post();
+                        frame_clock->posted(this);
+                        finished_stage(Stage::post);
+
+                        if (auto const frame = group.last_frame())
+                        {
+                            scheduler.presented(*frame);
+                            predict_next_frame();
+                            report_presented(*frame);
+                        }
+
+                        /*
+                         * "Predictive bypass" optimization: If the last frame was
+                         * bypassed/overlayed or you simply have a fast GPU, it is
+                         * beneficial to sleep for most of the next frame. This reduces
+                         * the latency between snapshotting the scene and post()
+                         * completing by almost a whole frame.
+                         *
+                         * Only needed if the platform can't tell us when frames are
+                         * presented, otherwise next_composite_time() does better.
+                         */
+                        if (force_sleep >= std::chrono::milliseconds::zero())
+                        {
+                            began_stage(Stage::sleep);
+                            std::this_thread::sleep_for(force_sleep);
+                            finished_stage(Stage::sleep);
+                        }
+                        else if (!scheduler.refresh_period())
+                        {
+                            began_stage(Stage::sleep);
+                            std::this_thread::sleep_for(group.recommended_sleep());
+                            finished_stage(Stage::sleep);
+                        }
+                    }
 
                     lock.lock();
 
@@ -246,16 +327,58 @@ public:
     }
 
 private:
+    /// When to wake up to composite the next frame, if the vblank can be predicted
+    auto next_composite_time() const -> std::optional<std::chrono::steady_clock::time_point>
+    {
+        if (force_sleep >= std::chrono::milliseconds::zero())
+            return std::nullopt;
+
+        auto const now = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC);
+        if (auto const when = scheduler.composite_time(now))
+            return std::chrono::steady_clock::now() + (*when - now);
+
+        return std::nullopt;
+    }
+
+    /// Let anyone waiting on the frame clock know when we expect to next sample the scene
+    void predict_next_frame()
+    {
+        auto const now = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC);
+        auto const when = scheduler.composite_time(now);
+        auto const period = scheduler.refresh_period();
+
+        if (when && period)
+            frame_clock->predict(this, *when, *period);
+    }
+
+    /// Let anyone waiting for presentation feedback know frame is on screen
+    void report_presented(mg::Frame const& frame)
+    {
+        // The platform may not have flipped since the last post (e.g. if it set the CRTC instead)
+        if (last_reported && last_reported->msc == frame.msc && last_reported->ust == frame.ust)
+            return;
+
+        last_reported = frame;
+        frame_clock->presented(
+            this,
+            frame,
+            scheduler.refresh_period().value_or(std::chrono::nanoseconds::zero()),
+            group.last_frame_is_latest_post());
+    }
+
     std::shared_ptr<mc::DisplayBufferCompositorFactory> const compositor_factory;
     mg::DisplaySyncGroup& group;
     std::shared_ptr<mc::Scene> const scene;
     bool running;
     int frames_scheduled;
     std::chrono::milliseconds force_sleep{-1};
+    FrameScheduler scheduler;
+    std::optional<mg::Frame> last_reported;
     std::mutex run_mutex;
     std::condition_variable run_cv;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<FrameClock> const frame_clock;
     std::promise<void> started;
     std::future<void> started_future;
     std::promise<void> stopped;
@@ -272,15 +395,19 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
     std::shared_ptr<DisplayBufferCompositorFactory> const& db_compositor_factory,
     std::shared_ptr<DisplayListener> const& display_listener,
     std::shared_ptr<CompositorReport> const& compositor_report,
+    std::shared_ptr<FrameClock> const& frame_clock,
     std::chrono::milliseconds fixed_composite_delay,
+    std::chrono::milliseconds composite_margin,
     bool compose_on_start)
     : display{display},
       scene{scene},
       display_buffer_compositor_factory{db_compositor_factory},
       display_listener{display_listener},
       report{compositor_report},
+      frame_clock{frame_clock},
       state{CompositorState::stopped},
       fixed_composite_delay{fixed_composite_delay},
+      composite_margin{composite_margin},
       compose_on_start{compose_on_start}
 {
     observer = std::make_shared<ms::SceneChangeNotification>(
@@ -375,7 +502,7 @@ void mc::MultiThreadedCompositor::create_compositing_threads()
     {
         auto thread_functor = std::make_unique<mc::CompositingFunctor>(
             display_buffer_compositor_factory, group, scene, display_listener,
-            fixed_composite_delay, report);
+            fixed_composite_delay, composite_margin, report, frame_clock);
 
         mir::thread_pool_executor.spawn(std::ref(*thread_functor));
         thread_functors.push_back(std::move(thread_functor));
@@ -46,6 +46,7 @@ class DisplayListener;
 class CompositingFunctor;
 class Scene;
 class CompositorReport;
+class FrameClock;
 
 enum class CompositorState
 {
@@ -64,7 +65,9 @@ public:
         std::shared_ptr<DisplayBufferCompositorFactory> const& db_compositor_factory,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::shared_ptr<CompositorReport> const& compositor_report,
+        std::shared_ptr<FrameClock> const& frame_clock,
         std::chrono::milliseconds fixed_composite_delay,  // -1 = automatic
+        std::chrono::milliseconds composite_margin,       // used when automatic
         bool compose_on_start);
     ~MultiThreadedCompositor();
 
@@ -80,11 +83,13 @@ private:
     std::shared_ptr<DisplayBufferCompositorFactory> const display_buffer_compositor_factory;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<FrameClock> const frame_clock;
 
     std::vector<std::unique_ptr<CompositingFunctor>> thread_functors;
 
     std::atomic<CompositorState> state;
     std::chrono::milliseconds fixed_composite_delay;
+    std::chrono::milliseconds composite_margin;
     bool compose_on_start;
 
     void schedule_compositing(int number_composites);
@@ -36,7 +36,14 @@ public:
         geometry::Rectangle const& area,
         std::function<void(std::optional<time::Timestamp>)>&& callback) override;
 
+    void capture_dmabuf(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangle const& area,
+        std::function<void(std::optional<time::Timestamp>)>&& callback) override;
+
 private:
+    void fail(std::function<void(std::optional<time::Timestamp>)>&& callback);
+
     Executor& executor;
 };
 }
@@ -19,6 +19,8 @@
 #include "mir/graphics/renderable.h"
 #include "occlusion.h"
 
+#include <algorithm>
+#include <iterator>
 #include <vector>
 
 using namespace mir::geometry;
@@ -27,61 +29,184 @@ using namespace mir::compositor;
 
 namespace
 {
-bool renderable_is_occluded(
-    Renderable const& renderable, 
-    Rectangle const& area,
-    std::vector<Rectangle>& coverage)
+/// Past this many pieces, tracking exactly what's visible of a renderable costs more than it saves
+size_t const max_visible_fragments = 64;
+
+bool is_empty(Rectangle const& rect)
 {
-    static glm::mat4 const identity(1);
-    static Rectangle const empty{};
+    return rect.size.width.as_int() <= 0 || rect.size.height.as_int() <= 0;
+}
+
+auto bounding_rectangle_of(std::vector<Rectangle> const& rects) -> Rectangle
+{
+    auto left = rects.front().left().as_int();
+    auto top = rects.front().top().as_int();
+    auto right = rects.front().right().as_int();
+    auto bottom = rects.front().bottom().as_int();
+    for (auto const& rect : rects)
+    {
+        left = std::min(left, rect.left().as_int());
+        top = std::min(top, rect.top().as_int());
+        right = std::max(right, rect.right().as_int());
+        bottom = std::max(bottom, rect.bottom().as_int());
+    }
+    return {{left, top}, {right - left, bottom - top}};
+}
+
+struct Visibility
+{
+    bool hidden;
+    std::optional<Rectangle> visible_bounds;  ///< Only set if some of the renderable is covered
+};
+
+class OcclusionTracker
+{
+public:
+    /// Works in the storage given, which needn't be empty
+    OcclusionTracker(
+        Rectangle const& area,
+        std::vector<Rectangle>& coverage,
+        std::vector<Rectangle>& fragments,
+        std::vector<Rectangle>& scratch)
+        : area{area},
+          coverage{coverage},
+          fragments{fragments},
+          scratch{scratch}
+    {
+        coverage.clear();
+    }
+
+    /// Account for renderable, which is below all those seen so far
+    auto visibility_of(Renderable const& renderable) -> Visibility
+    {
+        static glm::mat4 const identity(1);
+
+        if (renderable.transformation() != identity)
+            return {false, std::nullopt};  // Weirdly transformed. Assume never occluded, and occluding nothing.
+
+        auto drawn = intersection_of(renderable.screen_position(), area);
+        if (auto const clip = renderable.clip_area())
+            drawn = intersection_of(drawn, clip.value());
+
+        if (is_empty(drawn))
+            return {true, std::nullopt};  // Not in the area; definitely occluded.
+
+        auto const visible = visible_bounds_of(drawn);
+        if (is_empty(visible))
+            return {true, std::nullopt};
+
+        if (renderable.alpha() == 1.0f)
+            add_opaque_parts_of(renderable, drawn);
+
+        if (visible == drawn)
+            return {false, std::nullopt};
+
+        return {false, visible};
+    }
+
+private:
+    auto visible_bounds_of(Rectangle const& drawn) -> Rectangle
+    {
+        fragments.assign(1, drawn);
+        for (auto const& opaque : coverage)
+        {
+            scratch.clear();
+            for (auto const& fragment : fragments)
+                difference_of(fragment, opaque, std::back_inserter(scratch));
+            std::swap(fragments, scratch);
 
-    if (renderable.transformation() != identity)
-        return false;  // Weirdly transformed. Assume never occluded.
+            if (fragments.empty())
+                return {};
 
-    auto const& window = renderable.screen_position();
-    auto const& clipped_window = intersection_of(window, area);
+            if (fragments.size() > max_visible_fragments)
+                return drawn;
+        }
 
-    if (clipped_window == empty)
-        return true;  // Not in the area; definitely occluded.
+        return bounding_rectangle_of(fragments);
+    }
 
-    bool occluded = false;
-    for (auto const& r : coverage)
+    void add_opaque_parts_of(Renderable const& renderable, Rectangle const& drawn)
     {
-        if (r.contains(clipped_window))
+        // Without alpha every pixel is opaque, whatever the client says its opaque region is
+        if (!renderable.shaped())
         {
-            occluded = true;
-            break;
+            coverage.push_back(drawn);
+        }
+        else if (auto const opaque_region = renderable.opaque_region())
+        {
+            for (auto const& opaque : opaque_region.value())
+            {
+                auto const covered = intersection_of(opaque, drawn);
+                if (!is_empty(covered))
+                    coverage.push_back(covered);
+            }
         }
     }
 
-    if (!occluded && renderable.alpha() == 1.0f && !renderable.shaped())
-        coverage.push_back(clipped_window);
+    Rectangle const area;
+    std::vector<Rectangle>& coverage;  ///< Union of the opaque parts of the renderables seen so far
+    std::vector<Rectangle>& fragments;
+    std::vector<Rectangle>& scratch;
+};
+}
 
+SceneElementSequence mir::compositor::filter_occlusions_from(
+    SceneElementSequence& elements,
+    Rectangle const& area)
+{
+    SceneElementSequence occluded;
+    OcclusionFilter{}.filter(elements, area, occluded);
     return occluded;
 }
-}
 
 SceneElementSequence mir::compositor::filter_occlusions_from(
     SceneElementSequence& elements,
-    Rectangle const& area)
+    Rectangle const& area,
+    std::vector<std::optional<Rectangle>>& visible_bounds)
 {
     SceneElementSequence occluded;
-    std::vector<Rectangle> coverage;
+    OcclusionFilter filter;
+    filter.filter(elements, area, occluded);
+    visible_bounds = filter.visible_bounds();
+    return occluded;
+}
+
+void mir::compositor::OcclusionFilter::filter(
+    SceneElementSequence& elements,
+    Rectangle const& area,
+    SceneElementSequence& occluded)
+{
+    OcclusionTracker tracker{area, coverage, fragments, spare_fragments};
 
-    auto it = elements.rbegin();
-    while (it != elements.rend())
+    hidden.resize(elements.size());
+    bounds.resize(elements.size());
+    for (auto i = elements.size(); i-- != 0;)
     {
-        auto const renderable = (*it)->renderable();
-        if (renderable_is_occluded(*renderable, area, coverage))
+        auto const visibility = tracker.visibility_of(*elements[i]->renderable());
+        hidden[i] = visibility.hidden;
+        bounds[i] = visibility.visible_bounds;
+    }
+
+    // Partition in a single pass, keeping the order of both parts
+    occluded.clear();
+    visible_bounds_.clear();
+    size_t kept = 0;
+    for (size_t i = 0; i != elements.size(); ++i)
+    {
+        if (hidden[i])
         {
-            occluded.insert(occluded.begin(), *it);
-            it = SceneElementSequence::reverse_iterator(elements.erase(std::prev(it.base())));
+            occluded.push_back(std::move(elements[i]));
         }
         else
         {
-            it++;
+            elements[kept++] = std::move(elements[i]);
+            visible_bounds_.push_back(bounds[i]);
         }
     }
+    elements.erase(elements.begin() + kept, elements.end());
+}
 
-    return occluded;
+auto mir::compositor::OcclusionFilter::visible_bounds() const -> std::vector<std::optional<Rectangle>> const&
+{
+    return visible_bounds_;
 }
@@ -18,14 +18,63 @@
 #define MIR_COMPOSITOR_OCCLUSION_H_
 
 #include "mir/compositor/scene.h"
+#include "mir/geometry/rectangle.h"
+
+#include <optional>
+#include <vector>
 
 namespace mir
 {
 namespace compositor
 {
 
+/**
+ * Remove from list (bottom to top) the elements that can't be seen in area,
+ * because they are outside it or covered by the opaque parts of the elements
+ * above them, and return them.
+ */
 SceneElementSequence filter_occlusions_from(SceneElementSequence& list, geometry::Rectangle const& area);
 
+/**
+ * As above, also setting visible_bounds to the bounds of what can still be seen
+ * of each element left in list, or std::nullopt where none of it is covered.
+ */
+SceneElementSequence filter_occlusions_from(
+    SceneElementSequence& list,
+    geometry::Rectangle const& area,
+    std::vector<std::optional<geometry::Rectangle>>& visible_bounds);
+
+/**
+ * filter_occlusions_from(), keeping its working storage from one call to the next, so that
+ * a compositor filtering every frame needn't reallocate it each time.
+ */
+class OcclusionFilter
+{
+public:
+    /**
+     * As filter_occlusions_from(), moving the elements that can't be seen into occluded
+     * (which is cleared first) rather than returning them.
+     */
+    void filter(SceneElementSequence& list, geometry::Rectangle const& area, SceneElementSequence& occluded);
+
+    /**
+     * The bounds of what can be seen of each element left in the list by the last filter(), or
+     * std::nullopt where none of it is covered.
+     */
+    auto visible_bounds() const -> std::vector<std::optional<geometry::Rectangle>> const&;
+
+private:
+    /// The union of the opaque parts of the elements above the one being considered
+    std::vector<geometry::Rectangle> coverage;
+    /// The pieces of the element being considered not (yet) found to be covered
+    std::vector<geometry::Rectangle> fragments;
+    std::vector<geometry::Rectangle> spare_fragments;
+
+    std::vector<bool> hidden;
+    std::vector<std::optional<geometry::Rectangle>> bounds;
+    std::vector<std::optional<geometry::Rectangle>> visible_bounds_;
+};
+
 } // namespace compositor
 } // namespace mir
 
@@ -18,7 +18,9 @@
 #include "queueing_schedule.h"
 #include "dropping_schedule.h"
 #include "mir/graphics/buffer.h"
+#include "mir/graphics/texture.h"
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 #include <math.h>
 
 #include <cmath>
@@ -45,15 +47,58 @@ mc::Stream::Stream(
 {
 }
 
+namespace
+{
+// Enough to cover a compositor that falls a few frames behind a client, without growing unboundedly
+std::size_t const max_tracked_submissions = 16;
+
+/// Whether damage covers all of a buffer of size (as, e.g., wl_surface.damage_buffer(0, 0, INT32_MAX, INT32_MAX) does)
+auto covers_all_of(geom::Rectangles const& damage, geom::Size size) -> bool
+{
+    geom::Rectangle const buffer_area{{0, 0}, size};
+    return std::any_of(
+        damage.begin(), damage.end(),
+        [&](geom::Rectangle const& rect) { return intersection_of(rect, buffer_area) == buffer_area; });
+}
+}
+
 mc::Stream::~Stream() = default;
 
 void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    submit(buffer, std::nullopt);
+}
+
+void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangles const& damage)
+{
+    submit(buffer, damage);
+}
+
+void mc::Stream::submit(std::shared_ptr<mg::Buffer> const& buffer, std::optional<geom::Rectangles> damage)
 {
     if (!buffer)
         BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
 
     {
         std::lock_guard lk(mutex);
+        if (buffer->size() != latest_buffer_size)
+            damage = std::nullopt; // A resize invalidates everything, whatever the client says
+
+        // Damage to everything is no more use than unknown damage, and is uploaded the same way
+        if (damage && covers_all_of(damage.value(), buffer->size()))
+            damage = std::nullopt;
+
+        if (!damage || submissions.empty())
+        {
+            // The whole buffer will need uploading, so give the platform a head start
+            if (auto const texture = dynamic_cast<mg::gl::Texture*>(buffer.get()))
+                texture->prepare();
+        }
+
+        submissions.push_back({buffer->id(), std::move(damage)});
+        if (submissions.size() > max_tracked_submissions)
+            submissions.pop_front();
+
         pf = buffer->pixel_format();
         latest_buffer_size = buffer->size();
         schedule->schedule(buffer);
@@ -89,6 +134,38 @@ std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
     return arbiter->compositor_acquire(id);
 }
 
+auto mc::Stream::damage_between(mg::BufferID older, mg::BufferID newer) const
+    -> std::optional<geom::Rectangles>
+{
+    if (older == newer)
+        return geom::Rectangles{};
+
+    std::lock_guard lk(mutex);
+
+    auto const find = [this](mg::BufferID id)
+        {
+            return std::find_if(
+                submissions.begin(), submissions.end(),
+                [id](Submission const& submission) { return submission.buffer == id; });
+        };
+
+    auto const from = find(older);
+    auto const to = find(newer);
+    if (from == submissions.end() || to == submissions.end() || to < from)
+        return std::nullopt;
+
+    geom::Rectangles damage;
+    for (auto submission = std::next(from); submission != std::next(to); ++submission)
+    {
+        if (!submission->damage)
+            return std::nullopt;
+
+        for (auto const& rect : submission->damage.value())
+            damage.add(rect);
+    }
+    return damage;
+}
+
 geom::Size mc::Stream::stream_size()
 {
     std::lock_guard lk(mutex);
@@ -22,8 +22,10 @@
 #include "multi_monitor_arbiter.h"
 
 #include <atomic>
+#include <deque>
 #include <mutex>
 #include <memory>
+#include <optional>
 #include <set>
 #include <atomic>
 
@@ -39,12 +41,17 @@ public:
     ~Stream();
 
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) override;
+    void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) override;
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec) override;
     MirPixelFormat pixel_format() const override;
     void set_frame_posted_callback(
         std::function<void(geometry::Size const&)> const& callback) override;
     std::shared_ptr<graphics::Buffer>
         lock_compositor_buffer(void const* user_id) override;
+    auto damage_between(graphics::BufferID older, graphics::BufferID newer) const
+        -> std::optional<geometry::Rectangles> override;
     geometry::Size stream_size() override;
     void allow_framedropping(bool) override;
     bool framedropping() const override;
@@ -56,6 +63,14 @@ public:
 private:
     enum class ScheduleMode;
     void transition_schedule(std::shared_ptr<Schedule>&& new_schedule, std::lock_guard<std::mutex> const&);
+    void submit(std::shared_ptr<graphics::Buffer> const& buffer, std::optional<geometry::Rectangles> damage);
+
+    struct Submission
+    {
+        graphics::BufferID buffer;
+        /// Damage relative to the previous submission (std::nullopt means everything)
+        std::optional<geometry::Rectangles> damage;
+    };
 
     std::mutex mutable mutex;
     ScheduleMode schedule_mode;
@@ -65,6 +80,7 @@ private:
     float scale_{1.0f};
     MirPixelFormat pf;
     std::atomic<bool> first_frame_posted;
+    std::deque<Submission> submissions;
 
     std::mutex callback_mutex;
     std::function<void(geometry::Size const&)> frame_callback;
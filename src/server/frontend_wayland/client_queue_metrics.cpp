@@ -0,0 +1,70 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_queue_metrics.h"
+#include "wayland_frontend.tp.h"
+
+namespace mf = mir::frontend;
+
+mf::ClientQueueMetrics::ClientQueueMetrics(wl_display* display)
+    : loop{wl_display_get_event_loop(display)},
+      logger{wl_display_add_protocol_logger(display, &count, this)}
+{
+}
+
+mf::ClientQueueMetrics::~ClientQueueMetrics()
+{
+    wl_protocol_logger_destroy(logger);
+    if (pending_report)
+    {
+        wl_event_source_remove(pending_report);
+    }
+}
+
+void mf::ClientQueueMetrics::count(
+    void* self,
+    wl_protocol_logger_type direction,
+    wl_protocol_logger_message const* message)
+{
+    auto const me = static_cast<ClientQueueMetrics*>(self);
+    auto& depth = me->depths[wl_resource_get_client(message->resource)];
+    if (direction == WL_PROTOCOL_LOGGER_REQUEST)
+    {
+        ++depth.requests;
+    }
+    else
+    {
+        ++depth.events;
+    }
+
+    if (!me->pending_report)
+    {
+        me->pending_report = wl_event_loop_add_idle(me->loop, &report, me);
+    }
+}
+
+void mf::ClientQueueMetrics::report(void* self)
+{
+    auto const me = static_cast<ClientQueueMetrics*>(self);
+    // Idle sources are removed by the event loop once they have been dispatched
+    me->pending_report = nullptr;
+
+    for (auto const& [client, depth] : me->depths)
+    {
+        tracepoint(mir_server_wayland, client_queue_depth, client, depth.requests, depth.events);
+    }
+    me->depths.clear();
+}
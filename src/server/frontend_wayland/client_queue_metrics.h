@@ -0,0 +1,63 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_CLIENT_QUEUE_METRICS_H_
+#define MIR_FRONTEND_CLIENT_QUEUE_METRICS_H_
+
+#include <wayland-server-core.h>
+
+#include <unordered_map>
+
+namespace mir
+{
+namespace frontend
+{
+
+/// Measures how much traffic each client has queued each time the Wayland thread wakes up.
+/// The requests a client has queued are all dispatched in the same wakeup, so counting the requests dispatched
+/// (and events sent) for each client per wakeup gives its queue depth. Each count is emitted as the
+/// mir_server_wayland:client_queue_depth tracepoint. Must be created and destroyed on the Wayland thread, or
+/// before it runs.
+class ClientQueueMetrics
+{
+public:
+    explicit ClientQueueMetrics(wl_display* display);
+    ~ClientQueueMetrics();
+
+private:
+    ClientQueueMetrics(ClientQueueMetrics const&) = delete;
+    ClientQueueMetrics& operator=(ClientQueueMetrics const&) = delete;
+
+    static void count(void* self, wl_protocol_logger_type direction, wl_protocol_logger_message const* message);
+    static void report(void* self);
+
+    struct Depth
+    {
+        int requests{0};
+        int events{0};
+    };
+
+    wl_event_loop* const loop;
+    wl_protocol_logger* const logger;
+    /// The clients with traffic since the last report
+    std::unordered_map<wl_client*, Depth> depths;
+    /// Idle source that reports once this wakeup's dispatch is done, if there's been traffic
+    wl_event_source* pending_report{nullptr};
+};
+}
+}
+
+#endif // MIR_FRONTEND_CLIENT_QUEUE_METRICS_H_
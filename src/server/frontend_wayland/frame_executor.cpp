@@ -17,6 +17,7 @@
 #include "frame_executor.h"
 
 #include <mir/main_loop.h>
+#include <mir/compositor/frame_clock.h>
 
 #include <mutex>
 #include <vector>
@@ -25,7 +26,8 @@ namespace mf = mir::frontend;
 
 namespace
 {
-auto const delay = std::chrono::milliseconds{16};
+/// Used until the compositor can predict its frames (or if it never can)
+auto const default_delay = std::chrono::milliseconds{16};
 }
 
 struct mf::FrameExecutor::Callbacks
@@ -34,8 +36,11 @@ struct mf::FrameExecutor::Callbacks
     std::vector<std::function<void()>> queued;
 };
 
-mf::FrameExecutor::FrameExecutor(time::AlarmFactory& alarm_factory)
+mf::FrameExecutor::FrameExecutor(
+    time::AlarmFactory& alarm_factory,
+    std::shared_ptr<compositor::FrameClock> const& frame_clock)
     : callbacks{std::make_shared<Callbacks>()},
+      frame_clock{frame_clock},
       alarm{alarm_factory.create_alarm([weak_callbacks = std::weak_ptr<Callbacks>{callbacks}]()
           {
               fire_callbacks(weak_callbacks);
@@ -52,7 +57,8 @@ void mf::FrameExecutor::spawn(std::function<void()>&& work)
 
     if (needs_alarm)
     {
-        alarm->reschedule_in(delay);
+        auto const delay = frame_clock->time_until_next_frame(default_delay);
+        alarm->reschedule_in(std::chrono::ceil<std::chrono::milliseconds>(delay));
     }
 }
 
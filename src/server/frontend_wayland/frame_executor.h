@@ -29,14 +29,20 @@ class Alarm;
 class AlarmFactory;
 }
 
+namespace compositor
+{
+class FrameClock;
+}
+
 namespace frontend
 {
 
 /// Runs frame callbacks that do not have a buffer to be attached to.
+/// They are run when the compositor is next due to sample the scene, as predicted by the frame clock.
 class FrameExecutor : public Executor
 {
 public:
-    explicit FrameExecutor(time::AlarmFactory& alarm_factory);
+    FrameExecutor(time::AlarmFactory& alarm_factory, std::shared_ptr<compositor::FrameClock> const& frame_clock);
 
     // This can be called from any thread. Given callback is run on the main loop thread. The wayland executor is NOT
     // automatically used.
@@ -46,6 +52,7 @@ private:
     struct Callbacks;
 
     std::shared_ptr<Callbacks> const callbacks; // shared_ptr so it can potentially outlive this object
+    std::shared_ptr<compositor::FrameClock> const frame_clock;
     std::unique_ptr<time::Alarm> const alarm;
 
     static void fire_callbacks(std::weak_ptr<Callbacks> const& weak_callbacks);
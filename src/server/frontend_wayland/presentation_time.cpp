@@ -0,0 +1,203 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "presentation_time.h"
+
+#include "wl_surface.h"
+
+#include "mir/compositor/frame_clock.h"
+#include "mir/executor.h"
+#include "mir/graphics/frame.h"
+
+#include <memory>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+namespace
+{
+/// The clock presentation timestamps are given in
+clockid_t const presentation_clock = CLOCK_MONOTONIC;
+
+struct PresentationCtx
+{
+    std::shared_ptr<mir::Executor> const wayland_executor;
+    std::shared_ptr<mc::FrameClock> const frame_clock;
+};
+
+class PresentationGlobal : public mw::Presentation::Global
+{
+public:
+    PresentationGlobal(wl_display* display, std::shared_ptr<PresentationCtx> ctx);
+
+private:
+    void bind(wl_resource* new_resource) override;
+
+    std::shared_ptr<PresentationCtx> const ctx;
+};
+
+class Presentation : public mw::Presentation
+{
+public:
+    Presentation(wl_resource* resource, std::shared_ptr<PresentationCtx> ctx);
+
+private:
+    void feedback(wl_resource* surface, wl_resource* callback) override;
+
+    std::shared_ptr<PresentationCtx> const ctx;
+};
+
+class PresentationFeedback : public mw::PresentationFeedback
+{
+public:
+    PresentationFeedback(wl_resource* resource, std::shared_ptr<PresentationCtx> const& ctx, mf::WlSurface* surface);
+    ~PresentationFeedback();
+
+    void presented(mg::Frame const& frame, std::chrono::nanoseconds refresh);
+    void discarded();
+
+private:
+    mw::Weak<mf::WlSurface> const wl_surface;
+    mw::DestroyListenerId const surface_destroyed_listener_id;
+};
+
+auto in_presentation_clock(mir::time::PosixTimestamp const& ust) -> mir::time::PosixTimestamp
+{
+    if (ust.clock_id == presentation_clock)
+        return ust;
+
+    // Some drivers timestamp flips with CLOCK_REALTIME. Translate to the presentation clock via "now"
+    auto const age = mir::time::PosixTimestamp::now(ust.clock_id) - ust;
+    return mir::time::PosixTimestamp::now(presentation_clock) - age;
+}
+}
+
+auto mf::create_presentation_time(
+    wl_display* display,
+    std::shared_ptr<Executor> wayland_executor,
+    std::shared_ptr<mc::FrameClock> frame_clock)
+-> std::shared_ptr<mw::Presentation::Global>
+{
+    auto ctx = std::make_shared<PresentationCtx>(PresentationCtx{
+        std::move(wayland_executor),
+        std::move(frame_clock)});
+    return std::make_shared<PresentationGlobal>(display, std::move(ctx));
+}
+
+PresentationGlobal::PresentationGlobal(wl_display* display, std::shared_ptr<PresentationCtx> ctx)
+    : Global{display, Version<1>()},
+      ctx{std::move(ctx)}
+{
+}
+
+void PresentationGlobal::bind(wl_resource* new_resource)
+{
+    auto const presentation = new Presentation{new_resource, ctx};
+    presentation->send_clock_id_event(presentation_clock);
+}
+
+Presentation::Presentation(wl_resource* resource, std::shared_ptr<PresentationCtx> ctx)
+    : mw::Presentation{resource, Version<1>()},
+      ctx{std::move(ctx)}
+{
+}
+
+void Presentation::feedback(wl_resource* surface, wl_resource* callback)
+{
+    new PresentationFeedback{callback, ctx, mf::WlSurface::from(surface)};
+}
+
+PresentationFeedback::PresentationFeedback(
+    wl_resource* resource,
+    std::shared_ptr<PresentationCtx> const& ctx,
+    mf::WlSurface* surface)
+    : mw::PresentationFeedback{resource, Version<1>()},
+      wl_surface{surface},
+      surface_destroyed_listener_id{surface->add_destroy_listener([this]() { discarded(); })}
+{
+    surface->add_pending_presentation_callback(
+        [ctx, weak_self = mw::make_weak(this)](bool consumed)
+        {
+            if (consumed)
+            {
+                // The content is shown by the frame the consuming compositor (on this thread) posts next
+                ctx->frame_clock->on_next_presentation(
+                    mc::FrameClock::compositor_on_this_thread(),
+                    [executor = ctx->wayland_executor, weak_self](mg::Frame const& frame, std::chrono::nanoseconds refresh)
+                    {
+                        executor->spawn([weak_self, frame, refresh]()
+                            {
+                                if (weak_self)
+                                {
+                                    weak_self.value().presented(frame, refresh);
+                                }
+                            });
+                    });
+            }
+            else
+            {
+                ctx->wayland_executor->spawn([weak_self]()
+                    {
+                        if (weak_self)
+                        {
+                            weak_self.value().discarded();
+                        }
+                    });
+            }
+        });
+}
+
+PresentationFeedback::~PresentationFeedback()
+{
+    if (wl_surface)
+    {
+        wl_surface.value().remove_destroy_listener(surface_destroyed_listener_id);
+    }
+}
+
+void PresentationFeedback::presented(mg::Frame const& frame, std::chrono::nanoseconds refresh)
+{
+    auto const ust = in_presentation_clock(frame.ust).nanoseconds.count();
+    uint64_t const seconds = ust / 1000000000;
+    uint32_t const nanoseconds = ust % 1000000000;
+    uint64_t const msc = frame.msc;
+
+    uint32_t flags = 0;
+    if (frame.vsync)
+        flags |= Kind::vsync;
+    if (frame.hw_clock && frame.ust.clock_id == presentation_clock)
+        flags |= Kind::hw_clock;
+    if (frame.hw_completion)
+        flags |= Kind::hw_completion;
+    if (frame.zero_copy)
+        flags |= Kind::zero_copy;
+
+    send_presented_event(
+        seconds >> 32, seconds & 0xffffffff,
+        nanoseconds,
+        refresh.count(),
+        msc >> 32, msc & 0xffffffff,
+        flags);
+    destroy_and_delete();
+}
+
+void PresentationFeedback::discarded()
+{
+    send_discarded_event();
+    destroy_and_delete();
+}
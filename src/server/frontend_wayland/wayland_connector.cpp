@@ -17,6 +17,7 @@
 #include "wayland_connector.h"
 
 #include "wl_client.h"
+#include "client_queue_metrics.h"
 #include "wl_data_device_manager.h"
 #include "wayland_utils.h"
 #include "wl_subcompositor.h"
@@ -231,6 +232,8 @@ mf::WaylandConnector::WaylandConnector(
     std::shared_ptr<ms::TextInputHub> const& text_input_hub,
     std::shared_ptr<ms::IdleHub> const& idle_hub,
     std::shared_ptr<mc::ScreenShooter> const& screen_shooter,
+    std::shared_ptr<mc::FrameClock> const& frame_clock,
+    std::shared_ptr<mi::InputLatency> const& input_latency,
     std::shared_ptr<MainLoop> const& main_loop,
     bool arw_socket,
     std::unique_ptr<WaylandExtensions> extensions_,
@@ -239,6 +242,7 @@ mf::WaylandConnector::WaylandConnector(
     : extension_filter{extension_filter},
       display{wl_display_create(), &cleanup_display},
       pause_signal{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE)},
+      client_queue_metrics{std::make_unique<ClientQueueMetrics>(display.get())},
       executor{std::make_shared<WaylandExecutor>(wl_display_get_event_loop(display.get()))},
       allocator{allocator_for_display(allocator, display.get(), executor)},
       shell{shell},
@@ -276,7 +280,7 @@ mf::WaylandConnector::WaylandConnector(
     compositor_global = std::make_unique<mf::WlCompositor>(
         display.get(),
         executor,
-        std::make_shared<FrameExecutor>(*main_loop),
+        std::make_shared<FrameExecutor>(*main_loop, frame_clock),
         this->allocator);
     subcompositor_global = std::make_unique<mf::WlSubcompositor>(display.get());
     seat_global = std::make_unique<mf::WlSeat>(
@@ -286,6 +290,7 @@ mf::WaylandConnector::WaylandConnector(
         input_hub,
         keyboard_observer_registrar,
         seat,
+        input_latency,
         enable_key_repeat);
     output_manager = std::make_unique<mf::OutputManager>(
         display.get(),
@@ -308,7 +313,8 @@ mf::WaylandConnector::WaylandConnector(
         input_device_registry,
         composite_event_filter,
         allocator,
-        screen_shooter});
+        screen_shooter,
+        frame_clock});
 
     shm_global = std::make_unique<WlShm>(display.get(), executor);
 
@@ -41,6 +41,7 @@ class InputDeviceHub;
 class InputDeviceRegistry;
 class Seat;
 class CompositeEventFilter;
+class InputLatency;
 class KeyboardObserver;
 }
 namespace graphics
@@ -48,6 +49,10 @@ namespace graphics
 class GraphicBufferAllocator;
 class DisplayConfigurationObserver;
 }
+namespace compositor
+{
+class FrameClock;
+}
 namespace shell
 {
 class Shell;
@@ -72,6 +77,7 @@ class WlDataDeviceManager;
 class WlSurface;
 class SurfaceStack;
 class WlShm;
+class ClientQueueMetrics;
 
 class WaylandExtensions
 {
@@ -93,6 +99,7 @@ public:
         std::shared_ptr<input::CompositeEventFilter> composite_event_filter;
         std::shared_ptr<graphics::GraphicBufferAllocator> graphic_buffer_allocator;
         std::shared_ptr<compositor::ScreenShooter> screen_shooter;
+        std::shared_ptr<compositor::FrameClock> frame_clock;
     };
 
     WaylandExtensions() = default;
@@ -137,6 +144,8 @@ public:
         std::shared_ptr<scene::TextInputHub> const& text_input_hub,
         std::shared_ptr<scene::IdleHub> const& idle_hub,
         std::shared_ptr<compositor::ScreenShooter> const& screen_shooter,
+        std::shared_ptr<compositor::FrameClock> const& frame_clock,
+        std::shared_ptr<input::InputLatency> const& input_latency,
         std::shared_ptr<MainLoop> const& main_loop,
         bool arw_socket,
         std::unique_ptr<WaylandExtensions> extensions,
@@ -180,6 +189,7 @@ private:
 
     std::unique_ptr<wl_display, void(*)(wl_display*)> const display;
     mir::Fd const pause_signal;
+    std::unique_ptr<ClientQueueMetrics> const client_queue_metrics;
     std::unique_ptr<WlCompositor> compositor_global;
     std::unique_ptr<WlSubcompositor> subcompositor_global;
     std::unique_ptr<WlSeat> seat_global;
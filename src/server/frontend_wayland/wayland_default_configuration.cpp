@@ -37,6 +37,7 @@
 #include "idle_inhibit_v1.h"
 #include "wlr_screencopy_v1.h"
 #include "primary_selection_v1.h"
+#include "presentation_time.h"
 
 #include "mir/graphics/platform.h"
 #include "mir/options/default_configuration.h"
@@ -173,6 +174,10 @@ std::vector<ExtensionBuilder> const internal_extension_builders = {
         {
             return mf::create_primary_selection_device_manager_v1(ctx.display, ctx.wayland_executor, ctx.primary_selection_clipboard);
         }),
+    make_extension_builder<mw::Presentation>([](auto const& ctx)
+        {
+            return mf::create_presentation_time(ctx.display, ctx.wayland_executor, ctx.frame_clock);
+        }),
 };
 
 ExtensionBuilder const xwayland_builder {
@@ -270,7 +275,8 @@ auto mf::get_standard_extensions() -> std::vector<std::string>
         mw::XdgOutputManagerV1::interface_name,
         mw::TextInputManagerV1::interface_name,
         mw::TextInputManagerV2::interface_name,
-        mw::TextInputManagerV3::interface_name};
+        mw::TextInputManagerV3::interface_name,
+        mw::Presentation::interface_name};
 }
 
 auto mf::get_supported_extensions() -> std::vector<std::string>
@@ -315,6 +321,8 @@ std::shared_ptr<mf::Connector>
                 the_text_input_hub(),
                 the_idle_hub(),
                 the_screen_shooter(),
+                the_frame_clock(),
+                the_input_latency(),
                 the_main_loop(),
                 arw_socket,
                 configure_wayland_extensions(
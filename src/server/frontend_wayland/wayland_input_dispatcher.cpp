@@ -52,19 +52,31 @@ void mf::WaylandInputDispatcher::handle_event(std::shared_ptr<MirInputEvent cons
     case mir_input_event_type_pointer:
     {
         auto const pointer_event = dynamic_pointer_cast<MirPointerEvent const>(event);
+        bool sent{false};
         seat->for_each_listener(wl_surface.value().client, [&](WlPointer* pointer)
             {
                 pointer->event(pointer_event, wl_surface.value());
+                sent = true;
             });
+        if (sent)
+        {
+            seat->trace_response(*event, wl_surface.value());
+        }
     }   break;
 
     case mir_input_event_type_touch:
     {
         auto const touch_event = dynamic_pointer_cast<MirTouchEvent const>(event);
+        bool sent{false};
         seat->for_each_listener(wl_surface.value().client, [&](WlTouch* touch)
             {
                 touch->event(touch_event, wl_surface.value());
+                sent = true;
             });
+        if (sent)
+        {
+            seat->trace_response(*event, wl_surface.value());
+        }
     }   break;
 
     // Keyboard events are sent to the WlSeat via it's KeyboardObserver
@@ -16,7 +16,7 @@
 
 #include "wl_region.h"
 
-#include <mir/log.h>
+#include <iterator>
 
 namespace mf = mir::frontend;
 namespace geom = mir::geometry;
@@ -47,9 +47,10 @@ void mf::WlRegion::add(int32_t x, int32_t y, int32_t width, int32_t height)
 
 void mf::WlRegion::subtract(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    log_warning("WlRegion::subtract not implemented. ignoring.");
+    geom::Rectangle const hole{{x, y}, {width, height}};
+
+    std::vector<geom::Rectangle> remaining;
+    for (auto const& rect : rects)
+        geom::difference_of(rect, hole, std::back_inserter(remaining));
+    rects = std::move(remaining);
 }
@@ -33,6 +33,8 @@
 #include "mir/input/parameter_keymap.h"
 #include "mir/input/mir_keyboard_config.h"
 #include "mir/input/keyboard_observer.h"
+#include "mir/input/input_latency.h"
+#include "mir/events/pointer_event.h"
 #include "mir/scene/surface.h"
 
 #include <mutex>
@@ -149,10 +151,17 @@ public:
     {
         if (seat.focused_surface)
         {
+            bool sent{false};
             seat.for_each_listener(seat.focused_surface.value().client, [&](WlKeyboard* keyboard)
                 {
                     keyboard->handle_event(event);
+                    sent = true;
                 });
+
+            if (sent && mir_event_get_type(event.get()) == mir_event_type_input)
+            {
+                seat.trace_response(*event->to_input(), seat.focused_surface.value());
+            }
         }
     }
 
@@ -192,6 +201,7 @@ mf::WlSeat::WlSeat(
     std::shared_ptr<mi::InputDeviceHub> const& input_hub,
     std::shared_ptr<ObserverRegistrar<input::KeyboardObserver>> const& keyboard_observer_registrar,
     std::shared_ptr<mi::Seat> const& seat,
+    std::shared_ptr<mi::InputLatency> const& input_latency,
     bool enable_key_repeat)
     :   Global(display, Version<8>()),
         keymap{std::make_shared<input::ParameterKeymap>()},
@@ -211,6 +221,7 @@ mf::WlSeat::WlSeat(
         clock{clock},
         input_hub{input_hub},
         seat{seat},
+        input_latency{input_latency},
         enable_key_repeat{enable_key_repeat}
 {
     input_hub->add_observer(config_observer);
@@ -360,3 +371,22 @@ void mf::WlSeat::remove_focus_listener(mw::Client* client, FocusListener* listen
 {
     focus_listeners->unregister_listener(client, listener);
 }
+
+void mf::WlSeat::trace_response(MirInputEvent const& event, WlSurface& surface)
+{
+    if (auto const trace_id = event.trace_id())
+    {
+        // Coalesced motion is a response to the oldest sample merged into it
+        auto event_time = event.event_time();
+        if (event.input_type() == mir_input_event_type_pointer)
+        {
+            auto const coalesced = event.to_pointer()->coalesced_event_times();
+            if (!coalesced.empty())
+                event_time = std::min(event_time, coalesced.front());
+        }
+
+        mi::InputLatency::Trace const trace{trace_id, event_time};
+        input_latency->sent(trace);
+        surface.trace_input_response(input_latency, trace);
+    }
+}
@@ -32,6 +32,7 @@ class ObserverRegistrar;
 namespace input
 {
 class InputDeviceHub;
+class InputLatency;
 class Seat;
 class Keymap;
 class KeyboardObserver;
@@ -59,6 +60,7 @@ public:
         std::shared_ptr<mir::input::InputDeviceHub> const& input_hub,
         std::shared_ptr<ObserverRegistrar<input::KeyboardObserver>> const& keyboard_observer_registrar,
         std::shared_ptr<mir::input::Seat> const& seat,
+        std::shared_ptr<mir::input::InputLatency> const& input_latency,
         bool enable_key_repeat);
 
     ~WlSeat();
@@ -88,6 +90,9 @@ public:
     void add_focus_listener(wayland::Client* client, FocusListener* listener);
     void remove_focus_listener(wayland::Client* client, FocusListener* listener);
 
+    /// Follow the response to event, if it is traced, from the client of the surface it was sent to
+    void trace_response(MirInputEvent const& event, WlSurface& surface);
+
 private:
     void set_focus_to(WlSurface* surface);
 
@@ -116,6 +121,7 @@ private:
     std::shared_ptr<time::Clock> const clock;
     std::shared_ptr<input::InputDeviceHub> const input_hub;
     std::shared_ptr<input::Seat> const seat;
+    std::shared_ptr<input::InputLatency> const input_latency;
     bool const enable_key_repeat;
 
     void bind(wl_resource* new_wl_seat) override;
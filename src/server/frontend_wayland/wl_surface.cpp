@@ -39,7 +39,9 @@
 #include "mir/shell/surface_specification.h"
 #include "mir/log.h"
 
+#include <algorithm>
 #include <chrono>
+#include <mutex>
 #include <boost/throw_exception.hpp>
 #include <wayland-server-protocol.h>
 
@@ -48,6 +50,35 @@ namespace geom = mir::geometry;
 namespace mw = mir::wayland;
 namespace msh = mir::shell;
 
+namespace
+{
+/// Tells the presentation callbacks of a commit whether it was used, exactly once
+class PresentationNotifier
+{
+public:
+    explicit PresentationNotifier(std::vector<mf::WlSurfaceState::PresentationCallback> callbacks)
+        : callbacks{std::move(callbacks)}
+    {
+    }
+
+    void notify(bool consumed)
+    {
+        decltype(callbacks) to_notify;
+        {
+            std::lock_guard lock{mutex};
+            to_notify.swap(callbacks);
+        }
+
+        for (auto const& callback : to_notify)
+            callback(consumed);
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<mf::WlSurfaceState::PresentationCallback> callbacks;
+};
+}
+
 mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource)
     : mw::Callback{new_resource, Version<1>()}
 {
@@ -67,10 +98,20 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.opaque_region)
+        opaque_region = source.opaque_region;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
 
+    presentation_callbacks.insert(end(presentation_callbacks),
+                                  begin(source.presentation_callbacks),
+                                  end(source.presentation_callbacks));
+
+    surface_damage.insert(end(surface_damage), begin(source.surface_damage), end(source.surface_damage));
+    buffer_damage.insert(end(buffer_damage), begin(source.buffer_damage), end(source.buffer_damage));
+
     if (source.surface_data_invalidated)
         surface_data_invalidated = true;
 }
@@ -79,6 +120,7 @@ bool mf::WlSurfaceState::surface_data_needs_refresh() const
 {
     return offset ||
            input_shape ||
+           opaque_region ||
            surface_data_invalidated;
 }
 
@@ -179,6 +221,21 @@ void mf::WlSurface::set_pending_offset(std::optional<geom::Displacement> const&
     pending.offset = offset;
 }
 
+void mf::WlSurface::add_pending_presentation_callback(WlSurfaceState::PresentationCallback&& callback)
+{
+    pending.presentation_callbacks.push_back(std::move(callback));
+}
+
+void mf::WlSurface::trace_input_response(
+    std::shared_ptr<input::InputLatency> const& latency,
+    input::InputLatency::Trace const& trace)
+{
+    if (!input_response_trace)
+    {
+        input_response_trace = InputResponseTrace{latency, trace};
+    }
+}
+
 void mf::WlSurface::add_subsurface(WlSubsurface* child)
 {
     if (std::find(children.begin(), children.end(), child) != children.end())
@@ -211,7 +268,7 @@ void mf::WlSurface::populate_surface_data(std::vector<shell::StreamSpecification
 {
     geometry::Displacement offset = parent_offset + offset_;
 
-    buffer_streams.push_back(msh::StreamSpecification{stream, offset, {}});
+    buffer_streams.push_back(msh::StreamSpecification{stream, offset, {}, opaque_region});
     geom::Rectangle surface_rect = {geom::Point{} + offset, buffer_size_.value_or(geom::Size{})};
     if (input_shape)
     {
@@ -275,20 +332,14 @@ void mf::WlSurface::attach(std::optional<wl_resource*> const& buffer, int32_t x,
 
 void mf::WlSurface::damage(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    if (width > 0 && height > 0)
+        pending.surface_damage.emplace_back(geom::Point{x, y}, geom::Size{width, height});
 }
 
 void mf::WlSurface::damage_buffer(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    if (width > 0 && height > 0)
+        pending.buffer_damage.emplace_back(geom::Point{x, y}, geom::Size{width, height});
 }
 
 void mf::WlSurface::frame(wl_resource* new_callback)
@@ -299,8 +350,11 @@ void mf::WlSurface::frame(wl_resource* new_callback)
 
 void mf::WlSurface::set_opaque_region(std::optional<wl_resource*> const& region)
 {
-    (void)region;
-    // This isn't essential, but could enable optimizations
+    // Lets the compositor skip drawing whatever this hides. Like pending.input_shape, this is an optional optional
+    if (region)
+        pending.opaque_region = decltype(pending.opaque_region)::value_type{WlRegion::from(region.value())->rectangle_vector()};
+    else
+        pending.opaque_region = decltype(pending.opaque_region)::value_type{};
 }
 
 void mf::WlSurface::set_input_region(std::optional<wl_resource*> const& region)
@@ -331,8 +385,14 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     if (state.input_shape)
         input_shape = state.input_shape.value();
 
+    if (state.opaque_region)
+        opaque_region = state.opaque_region.value();
+
     if (state.scale)
+    {
+        scale_ = state.scale.value();
         stream->set_scale(state.scale.value());
+    }
 
     auto const executor_send_frame_callbacks = [executor = wayland_executor, weak_self = mw::make_weak(this)]()
         {
@@ -345,6 +405,8 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                 });
         };
 
+    auto const presentation = std::make_shared<PresentationNotifier>(state.presentation_callbacks);
+
     if (state.buffer)
     {
         wl_resource * buffer = *state.buffer;
@@ -354,23 +416,31 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
             // TODO: unmap surface, and unmap all subsurfaces
             buffer_size_ = std::nullopt;
             send_frame_callbacks();
+            presentation->notify(false);
         }
         else
         {
             std::shared_ptr<bool> buffer_destroyed = deleted_flag_for_resource(buffer);
-            auto release_buffer = [executor = wayland_executor, buffer = buffer, destroyed = buffer_destroyed]()
+            auto release_buffer = [executor = wayland_executor, buffer = buffer, destroyed = buffer_destroyed, presentation]()
                 {
+                    // A buffer released without being used has been superseded
+                    presentation->notify(false);
                     executor->spawn(run_unless(
                         destroyed,
                         [buffer](){ wl_resource_post_event(buffer, wayland::Buffer::Opcode::release); }));
                 };
+            auto on_consumed = [executor_send_frame_callbacks, presentation]()
+                {
+                    presentation->notify(true);
+                    executor_send_frame_callbacks();
+                };
             std::shared_ptr<graphics::Buffer> mir_buffer;
 
             if (auto const shm_buffer = ShmBuffer::from(buffer))
             {
                 mir_buffer = allocator->buffer_from_shm(
                     shm_buffer->data(),
-                    std::move(executor_send_frame_callbacks),
+                    std::move(on_consumed),
                     std::move(release_buffer));
                 tracepoint(
                     mir_server_wayland,
@@ -382,7 +452,7 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
             {
                 mir_buffer = allocator->buffer_from_resource(
                     buffer,
-                    std::move(executor_send_frame_callbacks),
+                    std::move(on_consumed),
                     std::move(release_buffer));
                 tracepoint(
                     mir_server_wayland,
@@ -391,7 +461,10 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     mir_buffer->id().as_value());
             }
 
-            stream->submit_buffer(mir_buffer);
+            if (auto const damage = damage_in_buffer(state, mir_buffer->size()))
+                stream->submit_buffer(mir_buffer, damage.value());
+            else
+                stream->submit_buffer(mir_buffer);
             auto const new_buffer_size = stream->stream_size();
 
             if (!input_shape && std::make_optional(new_buffer_size) != buffer_size_)
@@ -404,6 +477,8 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     }
     else
     {
+        // Without a new buffer there's no new content to present, and maybe no new frame to show it
+        presentation->notify(false);
         frame_callback_executor->spawn(std::move(executor_send_frame_callbacks));
     }
 
@@ -413,6 +488,52 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     }
 }
 
+auto mf::WlSurface::damage_in_buffer(WlSurfaceState const& state, geom::Size const& buffer_size) const
+    -> std::optional<geom::Rectangles>
+{
+    // Clients are not obliged to send damage; treat that as "everything", not "nothing"
+    if (state.surface_damage.empty() && state.buffer_damage.empty())
+        return std::nullopt;
+
+    geom::Rectangles damage;
+
+    // Clients commonly damage {0, 0, INT32_MAX, INT32_MAX}, so do the arithmetic in 64 bits before clipping
+    auto const add_clipped = [&](int64_t left, int64_t top, int64_t right, int64_t bottom)
+        {
+            left = std::max<int64_t>(left, 0);
+            top = std::max<int64_t>(top, 0);
+            right = std::min<int64_t>(right, buffer_size.width.as_int());
+            bottom = std::min<int64_t>(bottom, buffer_size.height.as_int());
+
+            if (left < right && top < bottom)
+            {
+                damage.add({
+                    geom::Point{static_cast<int>(left), static_cast<int>(top)},
+                    geom::Size{static_cast<int>(right - left), static_cast<int>(bottom - top)}});
+            }
+        };
+
+    for (auto const& rect : state.buffer_damage)
+    {
+        add_clipped(
+            rect.left().as_int(),
+            rect.top().as_int(),
+            int64_t{rect.left().as_int()} + rect.size.width.as_int(),
+            int64_t{rect.top().as_int()} + rect.size.height.as_int());
+    }
+
+    for (auto const& rect : state.surface_damage)
+    {
+        add_clipped(
+            int64_t{rect.left().as_int()} * scale_,
+            int64_t{rect.top().as_int()} * scale_,
+            (int64_t{rect.left().as_int()} + rect.size.width.as_int()) * scale_,
+            (int64_t{rect.top().as_int()} + rect.size.height.as_int()) * scale_);
+    }
+
+    return damage;
+}
+
 void mf::WlSurface::commit()
 {
     if (pending.offset && *pending.offset == offset_)
@@ -424,6 +545,21 @@ void mf::WlSurface::commit()
     if (pending.input_shape && *pending.input_shape == input_shape)
         pending.input_shape = std::nullopt;
 
+    if (pending.opaque_region && *pending.opaque_region == opaque_region)
+        pending.opaque_region = std::nullopt;
+
+    // Commits without a new buffer have no response to show, so the trace waits for one that does
+    if (input_response_trace && pending.buffer && pending.buffer.value())
+    {
+        auto const latency = input_response_trace->latency;
+        auto const trace = input_response_trace->trace;
+        input_response_trace.reset();
+
+        latency->committed(trace);
+        pending.presentation_callbacks.push_back(
+            [latency, trace](bool consumed) { latency->composited(trace, consumed); });
+    }
+
     // order is important
     auto const state = std::move(pending);
     pending = WlSurfaceState();
@@ -26,7 +26,10 @@
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/input/input_latency.h"
 
+#include <functional>
 #include <vector>
 #include <map>
 
@@ -78,8 +81,19 @@ struct WlSurfaceState
     std::optional<int> scale;
     std::optional<geometry::Displacement> offset;
     std::optional<std::optional<std::vector<geometry::Rectangle>>> input_shape;
+    std::optional<std::optional<std::vector<geometry::Rectangle>>> opaque_region;
     std::vector<wayland::Weak<Callback>> frame_callbacks;
 
+    /// Called with true once the committed content has been used by the compositor, or false if it never will be.
+    /// May be called on any thread.
+    using PresentationCallback = std::function<void(bool consumed)>;
+    std::vector<PresentationCallback> presentation_callbacks;
+
+    // Damage accumulated since the last commit, in surface-local and buffer coordinates respectively. Rectangles are
+    // exactly as the client sent them, so may extend beyond (or be entirely outside) the buffer
+    std::vector<geometry::Rectangle> surface_damage;
+    std::vector<geometry::Rectangle> buffer_damage;
+
 private:
     // only set to true if invalidate_surface_data() is called
     // surface_data_needs_refresh() returns true if this is true, or if other things are changed which mandate a refresh
@@ -131,6 +145,11 @@ public:
     void remove_subsurface(WlSubsurface* child);
     void refresh_surface_data_now();
     void pending_invalidate_surface_data() { pending.invalidate_surface_data(); }
+    /// Callback is told whether the content of the next commit was used by the compositor
+    void add_pending_presentation_callback(WlSurfaceState::PresentationCallback&& callback);
+    /// Follow the client's response to a traced input event through its next commit that attaches a buffer. Only
+    /// the first event sent since the last such commit is followed, as the response to it is the slowest.
+    void trace_input_response(std::shared_ptr<input::InputLatency> const& latency, input::InputLatency::Trace const& trace);
     void populate_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
                                std::vector<mir::geometry::Rectangle>& input_shape_accumulator,
                                geometry::Displacement const& parent_offset) const;
@@ -154,11 +173,22 @@ private:
     WlSurfaceState pending;
     geometry::Displacement offset_;
     std::optional<geometry::Size> buffer_size_;
+    int scale_{1};
     std::vector<wayland::Weak<WlSurfaceState::Callback>> frame_callbacks;
     std::optional<std::vector<mir::geometry::Rectangle>> input_shape;
+    std::optional<std::vector<mir::geometry::Rectangle>> opaque_region;
     std::vector<SceneSurfaceCreatedCallback> scene_surface_created_callbacks;
 
+    struct InputResponseTrace
+    {
+        std::shared_ptr<input::InputLatency> latency;
+        input::InputLatency::Trace trace;
+    };
+    std::optional<InputResponseTrace> input_response_trace;
+
     void send_frame_callbacks();
+    auto damage_in_buffer(WlSurfaceState const& state, geometry::Size const& buffer_size) const
+        -> std::optional<geometry::Rectangles>;
 
     void attach(std::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
     void damage(int32_t x, int32_t y, int32_t width, int32_t height) override;
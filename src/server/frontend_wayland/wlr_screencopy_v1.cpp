@@ -20,6 +20,7 @@
 #include "mir/graphics/graphic_buffer_allocator.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/graphics/buffer.h"
+#include "mir/graphics/dmabuf_buffer.h"
 #include "mir/scene/scene_change_notification.h"
 #include "mir/frontend/surface_stack.h"
 #include "mir/geometry/rectangles.h"
@@ -30,8 +31,11 @@
 #include "wayland_timespec.h"
 #include "output_manager.h"
 #include "shm.h"
+#include "deleted_for_resource.h"
+#include "wayland_utils.h"
 
 #include <boost/throw_exception.hpp>
+#include <drm_fourcc.h>
 #include <mutex>
 #include <optional>
 
@@ -156,6 +160,7 @@ public:
 
 private:
     void prepare_target(wl_resource* buffer);
+    void prepare_dmabuf_target(wl_resource* buffer);
     void report_result(std::optional<time::Timestamp> captured_time, geom::Rectangle buffer_space_damage);
 
     /// From wayland::WlrScreencopyFrameV1
@@ -174,6 +179,7 @@ private:
     bool copy_has_been_called{false};
     bool should_send_damage{false};
     std::shared_ptr<renderer::software::WriteMappableBuffer> target;
+    std::shared_ptr<graphics::Buffer> dmabuf_target;
     /// @}
 };
 }
@@ -414,18 +420,22 @@ mf::WlrScreencopyFrameV1::WlrScreencopyFrameV1(
         params.buffer_size.width.as_uint32_t(),
         params.buffer_size.height.as_uint32_t(),
         stride.as_uint32_t());
+    send_linux_dmabuf_event_if_supported(
+        DRM_FORMAT_ARGB8888,
+        params.buffer_size.width.as_uint32_t(),
+        params.buffer_size.height.as_uint32_t());
     send_buffer_done_event_if_supported();
 }
 
 void mf::WlrScreencopyFrameV1::capture(geom::Rectangle buffer_space_damage)
 {
-    if (!target)
+    if (!target && !dmabuf_target)
     {
         fatal_error(
             "WlrScreencopyFrameV1::capture() called without a target, copy %s been called",
             copy_has_been_called ? "has" : "has not");
     }
-    ctx->screen_shooter->capture(std::move(target), params.output_space_area,
+    auto on_captured =
         [wayland_executor=ctx->wayland_executor, buffer_space_damage, self=mw::make_weak(this)]
             (std::optional<time::Timestamp> captured_time)
         {
@@ -436,7 +446,17 @@ void mf::WlrScreencopyFrameV1::capture(geom::Rectangle buffer_space_damage)
                         self.value().report_result(captured_time, buffer_space_damage);
                     }
                 });
-        });
+        };
+
+    // The client may have written to a wl_shm buffer since any earlier capture into it, so it's always copied whole
+    if (dmabuf_target)
+    {
+        ctx->screen_shooter->capture_dmabuf(std::move(dmabuf_target), params.output_space_area, std::move(on_captured));
+    }
+    else
+    {
+        ctx->screen_shooter->capture(std::move(target), params.output_space_area, std::move(on_captured));
+    }
 }
 
 void mf::WlrScreencopyFrameV1::prepare_target(wl_resource* buffer)
@@ -452,10 +472,8 @@ void mf::WlrScreencopyFrameV1::prepare_target(wl_resource* buffer)
     auto shm_buffer = mf::ShmBuffer::from(buffer);
     if (!shm_buffer)
     {
-        BOOST_THROW_EXCEPTION(mw::ProtocolError(
-            resource,
-            Error::invalid_buffer,
-            "Copy target is not a wl_shm buffer"));
+        prepare_dmabuf_target(buffer);
+        return;
     }
     auto shm_data = shm_buffer->data();
     if (shm_data->format() != mir_pixel_format_argb_8888)
@@ -504,6 +522,50 @@ void mf::WlrScreencopyFrameV1::prepare_target(wl_resource* buffer)
     };
 }
 
+void mf::WlrScreencopyFrameV1::prepare_dmabuf_target(wl_resource* buffer)
+{
+    auto const buffer_destroyed = deleted_flag_for_resource(buffer);
+    auto const imported = ctx->allocator->buffer_from_resource(
+        buffer,
+        [](){},
+        [executor = ctx->wayland_executor, buffer, buffer_destroyed]()
+        {
+            executor->spawn(run_unless(
+                buffer_destroyed,
+                [buffer](){ wl_resource_post_event(buffer, wayland::Buffer::Opcode::release); }));
+        });
+    auto const dmabuf = imported ? dynamic_cast<mg::DMABufBuffer*>(imported->native_buffer_base()) : nullptr;
+    if (!dmabuf)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_buffer,
+            "Copy target is neither a wl_shm nor a linux-dmabuf buffer"));
+    }
+    if (dmabuf->drm_fourcc() != DRM_FORMAT_ARGB8888)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_buffer,
+            "Invalid dmabuf format 0x%x, should be 0x%x",
+            dmabuf->drm_fourcc(),
+            DRM_FORMAT_ARGB8888));
+    }
+    if (dmabuf->size() != params.buffer_size)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_buffer,
+            "Invalid buffer size %dx%d, should be %dx%d",
+            dmabuf->size().width.as_int(),
+            dmabuf->size().height.as_int(),
+            params.buffer_size.width.as_int(),
+            params.buffer_size.height.as_int()));
+    }
+
+    dmabuf_target = imported;
+}
+
 void mf::WlrScreencopyFrameV1::report_result(
     std::optional<time::Timestamp> captured_time,
     geom::Rectangle buffer_space_damage)
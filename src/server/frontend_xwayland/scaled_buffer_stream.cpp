@@ -30,6 +30,13 @@ void mf::ScaledBufferStream::submit_buffer(std::shared_ptr<graphics::Buffer> con
     inner->submit_buffer(buffer);
 }
 
+void mf::ScaledBufferStream::submit_buffer(
+    std::shared_ptr<graphics::Buffer> const& buffer,
+    geometry::Rectangles const& damage)
+{
+    inner->submit_buffer(buffer, damage);
+}
+
 void mf::ScaledBufferStream::set_frame_posted_callback(std::function<void(geometry::Size const&)> const& callback)
 {
     // Does this need to be scaled? I don't ? think ? so? compositor::Stream seems to leave it unscaled.
@@ -62,6 +69,13 @@ auto mf::ScaledBufferStream::lock_compositor_buffer(void const* user_id) -> std:
     return inner->lock_compositor_buffer(user_id);
 }
 
+auto mf::ScaledBufferStream::damage_between(graphics::BufferID older, graphics::BufferID newer) const
+    -> std::optional<geometry::Rectangles>
+{
+    // Damage is in buffer coordinates, so is unaffected by our scale
+    return inner->damage_between(older, newer);
+}
+
 auto mf::ScaledBufferStream::stream_size() -> geometry::Size
 {
     // This is it. This is what the whole class is for.
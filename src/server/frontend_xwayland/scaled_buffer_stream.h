@@ -36,6 +36,7 @@ public:
     /// Overrides from frontend::BufferStream
     /// @{
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer);
+    void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer, geometry::Rectangles const& damage);
     void set_frame_posted_callback(std::function<void(geometry::Size const&)> const& callback);
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec);
     MirPixelFormat pixel_format() const;
@@ -46,6 +47,8 @@ public:
     /// Overrides from compositor::BufferStream
     /// @{
     auto lock_compositor_buffer(void const* user_id) -> std::shared_ptr<graphics::Buffer>;
+    auto damage_between(graphics::BufferID older, graphics::BufferID newer) const
+        -> std::optional<geometry::Rectangles>;
     auto stream_size() -> geometry::Size;
     auto buffers_ready_for_compositor(void const* user_id) const -> int;
     void drop_old_buffers();
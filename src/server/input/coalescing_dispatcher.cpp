@@ -0,0 +1,194 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "coalescing_dispatcher.h"
+
+#include "mir/events/event_private.h"
+#include "mir/lockable_callback.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+
+namespace mi = mir::input;
+
+namespace
+{
+/// The event as pointer motion (which includes scrolling), or nullptr if it's something else
+auto as_pointer_motion(MirEvent const& event) -> MirPointerEvent const*
+{
+    if (event.type() != mir_event_type_input)
+        return nullptr;
+
+    auto const input_event = event.to_input();
+    if (input_event->input_type() != mir_input_event_type_pointer)
+        return nullptr;
+
+    auto const pointer_event = input_event->to_pointer();
+    return pointer_event->action() == mir_pointer_action_motion ? pointer_event : nullptr;
+}
+
+/// Whether next can be folded into pending without losing anything a client would act on
+auto can_merge(MirPointerEvent const& pending, MirPointerEvent const& next) -> bool
+{
+    return pending.device_id() == next.device_id() &&
+           pending.modifiers() == next.modifiers() &&
+           pending.buttons() == next.buttons() &&
+           pending.axis_source() == next.axis_source() &&
+           pending.position().has_value() == next.position().has_value() &&
+           // A scroll stop ends a scroll sequence; nothing is merged after one
+           !pending.h_scroll().stop &&
+           !pending.v_scroll().stop;
+}
+
+template<typename Axis>
+auto sum(Axis const& earlier, Axis const& later) -> Axis
+{
+    return {
+        earlier.precise + later.precise,
+        earlier.discrete + later.discrete,
+        earlier.value120 + later.value120,
+        later.stop};
+}
+
+auto merge(MirPointerEvent const& pending, MirPointerEvent const& next) -> std::shared_ptr<MirEvent const>
+{
+    std::shared_ptr<MirPointerEvent> merged{next.clone()};
+
+    merged->set_motion(pending.motion() + next.motion());
+    merged->set_h_scroll(sum(pending.h_scroll(), next.h_scroll()));
+    merged->set_v_scroll(sum(pending.v_scroll(), next.v_scroll()));
+
+    auto times = pending.coalesced_event_times();
+    times.push_back(pending.event_time());
+    merged->set_coalesced_event_times(times);
+
+    // Follow the oldest traced sample, as the response to it is the slowest
+    if (pending.trace_id())
+        merged->set_trace_id(pending.trace_id());
+
+    return merged;
+}
+}
+
+class mi::CoalescingDispatcher::AlarmCallback : public mir::LockableCallback
+{
+public:
+    explicit AlarmCallback(CoalescingDispatcher& self)
+        : self{self}
+    {
+    }
+
+    void operator()() override
+    {
+        self.interval_elapsed();
+    }
+
+    void lock() override
+    {
+        self.mutex.lock();
+    }
+
+    void unlock() override
+    {
+        self.mutex.unlock();
+    }
+
+private:
+    CoalescingDispatcher& self;
+};
+
+mi::CoalescingDispatcher::CoalescingDispatcher(
+    std::shared_ptr<InputDispatcher> const& next_dispatcher,
+    std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+    std::chrono::milliseconds interval)
+    : next_dispatcher{next_dispatcher},
+      interval{interval},
+      alarm{alarm_factory->create_alarm(std::make_unique<AlarmCallback>(*this))}
+{
+}
+
+mi::CoalescingDispatcher::~CoalescingDispatcher() = default;
+
+bool mi::CoalescingDispatcher::dispatch(std::shared_ptr<MirEvent const> const& event)
+{
+    std::lock_guard lock{mutex};
+
+    if (auto const motion = as_pointer_motion(*event))
+    {
+        if (pending)
+        {
+            auto const pending_motion = pending->to_input()->to_pointer();
+            if (can_merge(*pending_motion, *motion))
+            {
+                pending = merge(*pending_motion, *motion);
+                return true;
+            }
+            flush_pending();
+        }
+
+        if (in_interval)
+        {
+            pending = event;
+            return true;
+        }
+
+        // Nothing delivered lately, so there's no reason to hold this back
+        in_interval = true;
+        alarm->reschedule_in(interval);
+        return next_dispatcher->dispatch(event);
+    }
+
+    flush_pending();
+    return next_dispatcher->dispatch(event);
+}
+
+void mi::CoalescingDispatcher::start()
+{
+    next_dispatcher->start();
+}
+
+void mi::CoalescingDispatcher::stop()
+{
+    {
+        std::lock_guard lock{mutex};
+        flush_pending();
+        alarm->cancel();
+        in_interval = false;
+    }
+    next_dispatcher->stop();
+}
+
+void mi::CoalescingDispatcher::flush_pending()
+{
+    if (pending)
+    {
+        auto const event = std::move(pending);
+        pending.reset();
+        next_dispatcher->dispatch(event);
+    }
+}
+
+void mi::CoalescingDispatcher::interval_elapsed()
+{
+    if (pending)
+    {
+        flush_pending();
+        alarm->reschedule_in(interval);
+    }
+    else
+    {
+        in_interval = false;
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_INPUT_COALESCING_DISPATCHER_H_
+#define MIR_INPUT_COALESCING_DISPATCHER_H_
+
+#include "mir/input/input_dispatcher.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+struct MirPointerEvent;
+
+namespace mir
+{
+namespace time
+{
+class AlarmFactory;
+class Alarm;
+}
+namespace input
+{
+/**
+ * Limits pointer motion and scroll to one event per interval, merging what arrives in between.
+ *
+ * A high-rate mouse reports motion far more often than clients redraw. The first motion
+ * after a quiet interval is passed on at once; further motion (and scrolling) from the same
+ * device with the same buttons held is merged into a single pending event, delivered when
+ * the interval is up. Merged events carry the summed relative motion and scroll, the latest
+ * position, and the times of the samples merged into them.
+ *
+ * Anything that can't be merged (button changes, keys, touches, other devices...) delivers the
+ * pending motion first, so the order of events is preserved.
+ */
+class CoalescingDispatcher : public InputDispatcher
+{
+public:
+    CoalescingDispatcher(
+        std::shared_ptr<InputDispatcher> const& next_dispatcher,
+        std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+        std::chrono::milliseconds interval);
+    ~CoalescingDispatcher();
+
+    /// InputDispatcher overrides
+    /// @{
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override;
+    void start() override;
+    void stop() override;
+    /// @}
+
+private:
+    class AlarmCallback;
+
+    /// Called with mutex held
+    /// @{
+    void flush_pending();
+    void interval_elapsed();
+    /// @}
+
+    std::shared_ptr<InputDispatcher> const next_dispatcher;
+    std::chrono::milliseconds const interval;
+
+    /// Held while passing events on, so that those delivered by the alarm stay in order
+    std::mutex mutex;
+    std::shared_ptr<MirEvent const> pending;
+    bool in_interval{false};
+    std::unique_ptr<time::Alarm> const alarm;
+};
+}
+}
+
+#endif // MIR_INPUT_COALESCING_DISPATCHER_H_
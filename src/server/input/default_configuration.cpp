@@ -17,6 +17,7 @@
 #include "mir/default_server_configuration.h"
 
 #include "key_repeat_dispatcher.h"
+#include "coalescing_dispatcher.h"
 #include "keyboard_resync_dispatcher.h"
 #include "event_filter_chain_dispatcher.h"
 #include "config_changer.h"
@@ -34,6 +35,7 @@
 #include "idle_poking_dispatcher.h"
 
 #include "mir/input/touch_visualizer.h"
+#include "mir/input/input_latency.h"
 #include "mir/input/input_probe.h"
 #include "mir/input/platform.h"
 #include "mir/input/xkb_mapper.h"
@@ -151,8 +153,19 @@ mir::DefaultServerConfiguration::the_input_dispatcher()
             auto const keyboard_resync_dispatcher =
                 std::make_shared<mi::KeyboardResyncDispatcher>(idle_poking_dispatcher);
 
+            std::chrono::milliseconds const coalescing_interval{
+                options->get<int>(options::coalesce_pointer_motion_opt)};
+
+            // Coalescing sits inside key repeat so that repeated keys, too, deliver pending motion first
+            std::shared_ptr<mi::InputDispatcher> repeated_dispatcher = keyboard_resync_dispatcher;
+            if (coalescing_interval.count() > 0)
+            {
+                repeated_dispatcher = std::make_shared<mi::CoalescingDispatcher>(
+                    keyboard_resync_dispatcher, the_main_loop(), coalescing_interval);
+            }
+
             return std::make_shared<mi::KeyRepeatDispatcher>(
-                keyboard_resync_dispatcher, the_main_loop(), the_cookie_authority(),
+                repeated_dispatcher, the_main_loop(), the_cookie_authority(),
                 enable_repeat, key_repeat_timeout, key_repeat_delay, false);
         });
 }
@@ -303,6 +316,18 @@ std::shared_ptr<mi::Seat> mir::DefaultServerConfiguration::the_seat()
         });
 }
 
+std::shared_ptr<mi::InputLatency> mir::DefaultServerConfiguration::the_input_latency()
+{
+    return input_latency(
+        [this]()
+        {
+            return std::make_shared<mi::InputLatency>(
+                the_frame_clock(),
+                the_input_report(),
+                the_compositor_report());
+        });
+}
+
 std::shared_ptr<mi::InputDeviceRegistry> mir::DefaultServerConfiguration::the_input_device_registry()
 {
     return the_default_input_device_hub();
@@ -0,0 +1,131 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/input/input_latency.h"
+
+#include "mir/compositor/compositor_report.h"
+#include "mir/compositor/frame_clock.h"
+#include "mir/graphics/frame.h"
+#include "mir/input/input_report.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mi = mir::input;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+namespace
+{
+/// Input event times are in CLOCK_MONOTONIC, but some drivers timestamp flips with CLOCK_REALTIME
+auto monotonic_time_of(mir::time::PosixTimestamp const& ust) -> std::chrono::nanoseconds
+{
+    if (ust.clock_id == CLOCK_MONOTONIC)
+        return ust.nanoseconds;
+
+    auto const age = mir::time::PosixTimestamp::now(ust.clock_id) - ust;
+    return mir::time::PosixTimestamp::now(CLOCK_MONOTONIC).nanoseconds - age;
+}
+}
+
+auto mi::InputLatency::Histogram::mean() const -> std::chrono::nanoseconds
+{
+    return samples ? total / static_cast<int64_t>(samples) : std::chrono::nanoseconds::zero();
+}
+
+auto mi::InputLatency::Histogram::percentile(double fraction) const -> std::chrono::nanoseconds
+{
+    if (!samples)
+        return std::chrono::nanoseconds::zero();
+
+    auto const rank = std::max<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * samples), 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i != bucket_count - 1; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(static_cast<int64_t>(i + 1) * bucket_width, max);
+    }
+    return max;
+}
+
+mi::InputLatency::InputLatency(
+    std::shared_ptr<mc::FrameClock> const& frame_clock,
+    std::shared_ptr<InputReport> const& input_report,
+    std::shared_ptr<mc::CompositorReport> const& compositor_report)
+    : frame_clock{frame_clock},
+      input_report{input_report},
+      compositor_report{compositor_report}
+{
+}
+
+void mi::InputLatency::sent(Trace const& trace)
+{
+    input_report->sent_traced_event(trace.id, trace.event_time.count());
+}
+
+void mi::InputLatency::committed(Trace const& trace)
+{
+    compositor_report->traced_input_committed(trace.id);
+}
+
+void mi::InputLatency::composited(Trace const& trace, bool consumed)
+{
+    if (!consumed)
+    {
+        compositor_report->traced_input_discarded(trace.id);
+        std::lock_guard lock{mutex};
+        ++histogram_.discarded;
+        return;
+    }
+
+    compositor_report->traced_input_composited(trace.id);
+    frame_clock->on_next_presentation(
+        mc::FrameClock::compositor_on_this_thread(),
+        [weak_self = weak_from_this(), trace](mg::Frame const& frame, std::chrono::nanoseconds)
+        {
+            if (auto const self = weak_self.lock())
+            {
+                self->presented(trace, frame);
+            }
+        });
+}
+
+void mi::InputLatency::presented(Trace const& trace, mg::Frame const& frame)
+{
+    auto const latency = std::max(monotonic_time_of(frame.ust) - trace.event_time, std::chrono::nanoseconds::zero());
+    compositor_report->traced_input_presented(trace.id, frame.msc, latency.count());
+
+    auto const bucket = std::min<size_t>(latency / Histogram::bucket_width, Histogram::bucket_count - 1);
+
+    std::lock_guard lock{mutex};
+    ++histogram_.counts[bucket];
+    ++histogram_.samples;
+    histogram_.total += latency;
+    histogram_.max = std::max(histogram_.max, latency);
+}
+
+auto mi::InputLatency::histogram() const -> Histogram
+{
+    std::lock_guard lock{mutex};
+    return histogram_;
+}
+
+void mi::InputLatency::reset_histogram()
+{
+    std::lock_guard lock{mutex};
+    histogram_ = Histogram{};
+}
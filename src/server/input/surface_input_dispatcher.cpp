@@ -125,6 +125,7 @@ void deliver_without_relative_motion(
     mev::transform_positions(*to_deliver, geom::Displacement{bounds.top_left.x.as_int(), bounds.top_left.y.as_int()});
     if (!drag_and_drop_handle.empty())
         mev::set_drag_and_drop_handle(*to_deliver, drag_and_drop_handle);
+    to_deliver->to_input()->set_trace_id(input_ev->trace_id());
     surface->consume(std::move(to_deliver));
 }
 
@@ -21,8 +21,14 @@
 #include "lttng_report_factory.h"
 #include "logging_report_factory.h"
 #include "null_report_factory.h"
+#include "logging/frame_timeline_report.h"
 
 #include "mir/abnormal_exit.h"
+#include "mir/log.h"
+#include "mir/main_loop.h"
+
+#include <csignal>
+#include <fstream>
 
 namespace mg = mir::graphics;
 namespace mf = mir::frontend;
@@ -30,6 +36,38 @@ namespace mc = mir::compositor;
 namespace mi = mir::input;
 namespace ms = mir::scene;
 
+namespace
+{
+/// Enough for a few seconds of frames on several displays
+size_t const frame_timeline_capacity = 1 << 16;
+
+auto make_frame_timeline_report(
+    std::shared_ptr<mir::time::Clock> const& clock,
+    mir::MainLoop& main_loop,
+    std::string const& file) -> std::shared_ptr<mc::CompositorReport>
+{
+    auto const report = std::make_shared<mir::report::logging::FrameTimelineReport>(clock, frame_timeline_capacity);
+
+    main_loop.register_signal_handler(
+        {SIGUSR2},
+        [weak_report = std::weak_ptr{report}, file](int)
+        {
+            if (auto const report = weak_report.lock())
+            {
+                std::ofstream out{file};
+                report->dump(out);
+
+                if (out)
+                    mir::log_info("Wrote compositor timeline to %s", file.c_str());
+                else
+                    mir::log_error("Failed to write compositor timeline to %s", file.c_str());
+            }
+        });
+
+    return report;
+}
+}
+
 std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::report_factory(char const* report_opt)
 {
     auto opt = the_options()->get<std::string>(report_opt);
@@ -64,6 +102,14 @@ auto mir::DefaultServerConfiguration::the_compositor_report() -> std::shared_ptr
     return compositor_report(
         [this]()->std::shared_ptr<mc::CompositorReport>
         {
+            if (the_options()->get<std::string>(options::compositor_report_opt) == options::timeline_opt_value)
+            {
+                return make_frame_timeline_report(
+                    the_clock(),
+                    *the_main_loop(),
+                    the_options()->get<std::string>(options::compositor_timeline_file_opt));
+            }
+
             return report_factory(options::compositor_report_opt)->create_compositor_report();
         });
 }
@@ -182,3 +182,34 @@ void mrl::CompositorReport::scheduled()
     std::lock_guard lock(mutex);
     last_scheduled = now();
 }
+
+void mrl::CompositorReport::began_stage(SubCompositorId, FrameStage)
+{
+}
+
+void mrl::CompositorReport::finished_stage(SubCompositorId, FrameStage)
+{
+}
+
+void mrl::CompositorReport::traced_input_committed(uint64_t)
+{
+}
+
+void mrl::CompositorReport::traced_input_composited(uint64_t)
+{
+}
+
+void mrl::CompositorReport::traced_input_discarded(uint64_t trace_id)
+{
+    char msg[128];
+    snprintf(msg, sizeof msg, "Input %llu: response discarded", static_cast<unsigned long long>(trace_id));
+    logger->log(ml::Severity::debug, msg, component);
+}
+
+void mrl::CompositorReport::traced_input_presented(uint64_t trace_id, int64_t msc, int64_t latency)
+{
+    char msg[128];
+    snprintf(msg, sizeof msg, "Input %llu: response presented in frame %lld, %.3fms after the event",
+             static_cast<unsigned long long>(trace_id), static_cast<long long>(msc), latency / 1000000.0);
+    logger->log(ml::Severity::debug, msg, component);
+}
@@ -48,6 +48,12 @@ public:
     void started() override;
     void stopped() override;
     void scheduled() override;
+    void began_stage(SubCompositorId id, FrameStage stage) override;
+    void finished_stage(SubCompositorId id, FrameStage stage) override;
+    void traced_input_committed(uint64_t trace_id) override;
+    void traced_input_composited(uint64_t trace_id) override;
+    void traced_input_discarded(uint64_t trace_id) override;
+    void traced_input_presented(uint64_t trace_id, int64_t msc, int64_t latency) override;
 
 private:
     std::shared_ptr<mir::logging::Logger> const logger;
@@ -0,0 +1,292 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_timeline_report.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+namespace mrl = mir::report::logging;
+
+/// An event, as read back out of the buffer
+struct mrl::FrameTimelineReport::Record
+{
+    int64_t time;
+    SubCompositorId id;
+    Phase phase;
+    uint32_t what;
+    int64_t arg0;
+    int64_t arg1;
+};
+
+/**
+ * A seqlock per slot: sequence is zero while the slot is being written, and n+1 once it holds
+ * event n. A reader that sees the same sequence before and after reading got a consistent event.
+ */
+struct mrl::FrameTimelineReport::Slot
+{
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<int64_t> time{0};
+    std::atomic<SubCompositorId> id{nullptr};
+    std::atomic<uint32_t> phase{0};
+    std::atomic<uint32_t> what{0};
+    std::atomic<int64_t> arg0{0};
+    std::atomic<int64_t> arg1{0};
+};
+
+namespace
+{
+auto name_of(uint32_t what) -> char const*
+{
+    using Stage = mir::compositor::CompositorReport::FrameStage;
+
+    static_assert(static_cast<uint32_t>(Stage::delay) == 0);
+    static char const* const names[] = {
+        "delay",
+        "scene snapshot",
+        "occlusion",
+        "render",
+        "post",
+        "sleep",
+        "frame",
+        "added display",
+        "scheduled",
+        "input discarded",
+        "input presented"
+    };
+
+    return what < std::size(names) ? names[what] : "unknown";
+}
+}
+
+mrl::FrameTimelineReport::FrameTimelineReport(std::shared_ptr<time::Clock> const& clock, size_t capacity)
+    : clock{clock},
+      epoch{clock->now()},
+      capacity{capacity},
+      slots{std::make_unique<Slot[]>(capacity)}
+{
+    if (capacity == 0)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Frame timeline needs room for at least one event"));
+}
+
+mrl::FrameTimelineReport::~FrameTimelineReport() = default;
+
+void mrl::FrameTimelineReport::record(SubCompositorId id, Phase phase, uint32_t what, int64_t arg0, int64_t arg1)
+{
+    auto const time = std::chrono::duration_cast<std::chrono::nanoseconds>(clock->now() - epoch).count();
+    auto const n = next.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = slots[n % capacity];
+
+    // Releasing each field means a reader that sees any of them will then see sequence cleared
+    slot.sequence.store(0, std::memory_order_relaxed);
+    slot.time.store(time, std::memory_order_release);
+    slot.id.store(id, std::memory_order_release);
+    slot.phase.store(static_cast<uint32_t>(phase), std::memory_order_release);
+    slot.what.store(what, std::memory_order_release);
+    slot.arg0.store(arg0, std::memory_order_release);
+    slot.arg1.store(arg1, std::memory_order_release);
+    slot.sequence.store(n + 1, std::memory_order_release);
+}
+
+void mrl::FrameTimelineReport::added_display(int width, int height, int, int, SubCompositorId id)
+{
+    record(id, Phase::instant, static_cast<uint32_t>(Event::added_display), width, height);
+}
+
+void mrl::FrameTimelineReport::began_frame(SubCompositorId id)
+{
+    record(id, Phase::begin, static_cast<uint32_t>(Event::frame));
+}
+
+void mrl::FrameTimelineReport::renderables_in_frame(SubCompositorId, graphics::RenderableList const&)
+{
+}
+
+void mrl::FrameTimelineReport::rendered_frame(SubCompositorId)
+{
+}
+
+void mrl::FrameTimelineReport::finished_frame(SubCompositorId id)
+{
+    record(id, Phase::end, static_cast<uint32_t>(Event::frame));
+}
+
+void mrl::FrameTimelineReport::started()
+{
+}
+
+void mrl::FrameTimelineReport::stopped()
+{
+}
+
+void mrl::FrameTimelineReport::scheduled()
+{
+    record(nullptr, Phase::instant, static_cast<uint32_t>(Event::scheduled));
+}
+
+void mrl::FrameTimelineReport::began_stage(SubCompositorId id, FrameStage stage)
+{
+    record(id, Phase::begin, static_cast<uint32_t>(stage));
+}
+
+void mrl::FrameTimelineReport::finished_stage(SubCompositorId id, FrameStage stage)
+{
+    record(id, Phase::end, static_cast<uint32_t>(stage));
+}
+
+void mrl::FrameTimelineReport::traced_input_committed(uint64_t)
+{
+}
+
+void mrl::FrameTimelineReport::traced_input_composited(uint64_t)
+{
+}
+
+void mrl::FrameTimelineReport::traced_input_discarded(uint64_t trace_id)
+{
+    record(nullptr, Phase::instant, static_cast<uint32_t>(Event::input_discarded), trace_id);
+}
+
+void mrl::FrameTimelineReport::traced_input_presented(uint64_t trace_id, int64_t, int64_t latency)
+{
+    record(nullptr, Phase::instant, static_cast<uint32_t>(Event::input_presented), trace_id, latency);
+}
+
+void mrl::FrameTimelineReport::dump(std::ostream& out) const
+{
+    auto const end = next.load(std::memory_order_acquire);
+    auto const begin = end > capacity ? end - capacity : 0;
+
+    std::vector<Record> records;
+    records.reserve(end - begin);
+    for (auto n = begin; n != end; ++n)
+    {
+        auto const& slot = slots[n % capacity];
+
+        // Skip events still being written, or already overwritten by newer ones
+        if (slot.sequence.load(std::memory_order_acquire) != n + 1)
+            continue;
+
+        Record const record{
+            slot.time.load(std::memory_order_acquire),
+            slot.id.load(std::memory_order_acquire),
+            static_cast<Phase>(slot.phase.load(std::memory_order_acquire)),
+            slot.what.load(std::memory_order_acquire),
+            slot.arg0.load(std::memory_order_acquire),
+            slot.arg1.load(std::memory_order_acquire)};
+
+        if (slot.sequence.load(std::memory_order_relaxed) == n + 1)
+            records.push_back(record);
+    }
+
+    auto const pid = getpid();
+    char buffer[256];
+    auto separator = "\n";
+    auto const write = [&](int length)
+        {
+            out << separator;
+            out.write(buffer, std::min<int>(length, sizeof buffer - 1));
+            separator = ",\n";
+        };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    // Each display gets a track of its own, and anything not specific to one shares track 0
+    struct Track
+    {
+        int tid;
+        std::vector<uint32_t> open;
+    };
+    std::map<SubCompositorId, Track> tracks;
+    auto const track_for = [&](SubCompositorId id) -> Track&
+        {
+            auto const [track, inserted] = tracks.emplace(id, Track{static_cast<int>(tracks.size()), {}});
+            if (inserted)
+            {
+                write(id ?
+                    snprintf(buffer, sizeof buffer,
+                        R"({"name":"thread_name","ph":"M","pid":%d,"tid":%d,"args":{"name":"Display %p"}})",
+                        pid, track->second.tid, id) :
+                    snprintf(buffer, sizeof buffer,
+                        R"({"name":"thread_name","ph":"M","pid":%d,"tid":%d,"args":{"name":"Scheduling and input"}})",
+                        pid, track->second.tid));
+            }
+            return track->second;
+        };
+    track_for(nullptr);
+
+    for (auto const& record : records)
+    {
+        auto& track = track_for(record.id);
+        auto const name = name_of(record.what);
+        auto const us = static_cast<long long>(record.time / 1000);
+        auto const ns = static_cast<int>(record.time % 1000);
+
+        switch (record.phase)
+        {
+        case Phase::begin:
+            track.open.push_back(record.what);
+            write(snprintf(buffer, sizeof buffer,
+                R"({"name":"%s","cat":"frame","ph":"B","ts":%lld.%03d,"pid":%d,"tid":%d})",
+                name, us, ns, pid, track.tid));
+            break;
+
+        case Phase::end:
+            // The beginning may have been overwritten, and unmatched ends confuse the viewers
+            if (track.open.empty() || track.open.back() != record.what)
+                break;
+            track.open.pop_back();
+            write(snprintf(buffer, sizeof buffer,
+                R"({"name":"%s","cat":"frame","ph":"E","ts":%lld.%03d,"pid":%d,"tid":%d})",
+                name, us, ns, pid, track.tid));
+            break;
+
+        case Phase::instant:
+            if (record.what == static_cast<uint32_t>(Event::added_display))
+            {
+                write(snprintf(buffer, sizeof buffer,
+                    R"({"name":"%s","cat":"display","ph":"i","s":"t","ts":%lld.%03d,"pid":%d,"tid":%d,)"
+                    R"("args":{"width":%lld,"height":%lld}})",
+                    name, us, ns, pid, track.tid,
+                    static_cast<long long>(record.arg0), static_cast<long long>(record.arg1)));
+            }
+            else if (record.what == static_cast<uint32_t>(Event::scheduled))
+            {
+                write(snprintf(buffer, sizeof buffer,
+                    R"({"name":"%s","cat":"frame","ph":"i","s":"t","ts":%lld.%03d,"pid":%d,"tid":%d})",
+                    name, us, ns, pid, track.tid));
+            }
+            else
+            {
+                write(snprintf(buffer, sizeof buffer,
+                    R"({"name":"%s","cat":"input","ph":"i","s":"t","ts":%lld.%03d,"pid":%d,"tid":%d,)"
+                    R"("args":{"trace_id":%llu,"latency_us":%lld}})",
+                    name, us, ns, pid, track.tid,
+                    static_cast<unsigned long long>(record.arg0), static_cast<long long>(record.arg1 / 1000)));
+            }
+            break;
+        }
+    }
+
+    out << "\n]}\n";
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_LOGGING_FRAME_TIMELINE_REPORT_H_
+#define MIR_REPORT_LOGGING_FRAME_TIMELINE_REPORT_H_
+
+#include "mir/compositor/compositor_report.h"
+#include "mir/time/clock.h"
+
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+
+namespace mir
+{
+namespace report
+{
+namespace logging
+{
+
+/**
+ * Records the timeline of each frame for each display, to look for frame pacing problems.
+ *
+ * The stages of the latest frames are kept in a ring buffer, which the compositor threads write to
+ * without locking, and dump() writes them out in the Chrome trace event format (which Perfetto,
+ * chrome://tracing and similar tools load) with microsecond resolution.
+ */
+class FrameTimelineReport : public mir::compositor::CompositorReport
+{
+public:
+    /// \param capacity  how many events to keep (the oldest are overwritten by newer ones)
+    FrameTimelineReport(std::shared_ptr<time::Clock> const& clock, size_t capacity);
+    ~FrameTimelineReport();
+
+    void added_display(int width, int height, int x, int y, SubCompositorId id) override;
+    void began_frame(SubCompositorId id) override;
+    void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
+    void rendered_frame(SubCompositorId id) override;
+    void finished_frame(SubCompositorId id) override;
+    void started() override;
+    void stopped() override;
+    void scheduled() override;
+    void began_stage(SubCompositorId id, FrameStage stage) override;
+    void finished_stage(SubCompositorId id, FrameStage stage) override;
+    void traced_input_committed(uint64_t trace_id) override;
+    void traced_input_composited(uint64_t trace_id) override;
+    void traced_input_discarded(uint64_t trace_id) override;
+    void traced_input_presented(uint64_t trace_id, int64_t msc, int64_t latency) override;
+
+    /// Write the events in the buffer as a Chrome trace event JSON object
+    void dump(std::ostream& out) const;
+
+private:
+    enum class Phase : uint32_t { begin, end, instant };
+
+    /// Stages are recorded as themselves; these follow them
+    enum class Event : uint32_t
+    {
+        frame = static_cast<uint32_t>(FrameStage::sleep) + 1,
+        added_display,
+        scheduled,
+        input_discarded,
+        input_presented
+    };
+
+    struct Record;
+    struct Slot;
+
+    void record(SubCompositorId id, Phase phase, uint32_t what, int64_t arg0 = 0, int64_t arg1 = 0);
+
+    std::shared_ptr<time::Clock> const clock;
+    time::Timestamp const epoch;
+    size_t const capacity;
+    std::unique_ptr<Slot[]> const slots;
+
+    /// The number of events ever recorded, so the next one goes in slots[next % capacity]
+    std::atomic<uint64_t> next{0};
+};
+
+}
+}
+}
+
+#endif // MIR_REPORT_LOGGING_FRAME_TIMELINE_REPORT_H_
@@ -169,3 +169,25 @@ void mrl::InputReport::failed_to_open_input_device(char const* device_name, char
 
     logger->log(ml::Severity::informational, ss.str(), component());
 }
+
+void mrl::InputReport::received_traced_event(uint64_t trace_id, int64_t event_time)
+{
+    std::stringstream ss;
+
+    ss << "Tracing event"
+       << " trace_id=" << trace_id
+       << " time=" << ml::input_timestamp(std::chrono::nanoseconds(event_time));
+
+    logger->log(ml::Severity::debug, ss.str(), component());
+}
+
+void mrl::InputReport::sent_traced_event(uint64_t trace_id, int64_t event_time)
+{
+    std::stringstream ss;
+
+    ss << "Sent traced event"
+       << " trace_id=" << trace_id
+       << " time=" << ml::input_timestamp(std::chrono::nanoseconds(event_time));
+
+    logger->log(ml::Severity::debug, ss.str(), component());
+}
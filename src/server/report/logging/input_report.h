@@ -45,6 +45,9 @@ public:
 
     void opened_input_device(char const* device_name, char const* input_platform) override;
     void failed_to_open_input_device(char const* device_name, char const* input_platform) override;
+
+    void received_traced_event(uint64_t trace_id, int64_t event_time) override;
+    void sent_traced_event(uint64_t trace_id, int64_t event_time) override;
 private:
     char const* component();
     std::shared_ptr<mir::logging::Logger> const logger;
@@ -60,3 +60,33 @@ void mir::report::lttng::CompositorReport::finished_frame(SubCompositorId id)
 {
     mir_tracepoint(mir_server_compositor, finished_frame, id);
 }
+
+void mir::report::lttng::CompositorReport::began_stage(SubCompositorId id, FrameStage stage)
+{
+    mir_tracepoint(mir_server_compositor, began_stage, id, static_cast<int>(stage));
+}
+
+void mir::report::lttng::CompositorReport::finished_stage(SubCompositorId id, FrameStage stage)
+{
+    mir_tracepoint(mir_server_compositor, finished_stage, id, static_cast<int>(stage));
+}
+
+void mir::report::lttng::CompositorReport::traced_input_committed(uint64_t trace_id)
+{
+    mir_tracepoint(mir_server_compositor, traced_input_committed, trace_id);
+}
+
+void mir::report::lttng::CompositorReport::traced_input_composited(uint64_t trace_id)
+{
+    mir_tracepoint(mir_server_compositor, traced_input_composited, trace_id);
+}
+
+void mir::report::lttng::CompositorReport::traced_input_discarded(uint64_t trace_id)
+{
+    mir_tracepoint(mir_server_compositor, traced_input_discarded, trace_id);
+}
+
+void mir::report::lttng::CompositorReport::traced_input_presented(uint64_t trace_id, int64_t msc, int64_t latency)
+{
+    mir_tracepoint(mir_server_compositor, traced_input_presented, trace_id, msc, latency);
+}
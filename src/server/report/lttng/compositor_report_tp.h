@@ -88,6 +88,71 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT_CLASS(
+    mir_server_compositor,
+    frame_stage,
+    TP_ARGS(void const*, id, int, stage),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(int, stage, stage)
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_compositor,
+    frame_stage,
+    began_stage,
+    TP_ARGS(void const*, id, int, stage)
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_compositor,
+    frame_stage,
+    finished_stage,
+    TP_ARGS(void const*, id, int, stage)
+)
+
+TRACEPOINT_EVENT_CLASS(
+    mir_server_compositor,
+    traced_input_event,
+    TP_ARGS(uint64_t, trace_id),
+    TP_FIELDS(
+        ctf_integer(uint64_t, trace_id, trace_id)
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_compositor,
+    traced_input_event,
+    traced_input_committed,
+    TP_ARGS(uint64_t, trace_id)
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_compositor,
+    traced_input_event,
+    traced_input_composited,
+    TP_ARGS(uint64_t, trace_id)
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_compositor,
+    traced_input_event,
+    traced_input_discarded,
+    TP_ARGS(uint64_t, trace_id)
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    traced_input_presented,
+    TP_ARGS(uint64_t, trace_id, int64_t, msc, int64_t, latency),
+    TP_FIELDS(
+        ctf_integer(uint64_t, trace_id, trace_id)
+        ctf_integer(int64_t, msc, msc)
+        ctf_integer(int64_t, latency, latency)
+    )
+)
+
 #endif /* MIR_LTTNG_COMPOSITOR_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
@@ -46,3 +46,13 @@ void mir::report::lttng::InputReport::failed_to_open_input_device(char const* na
 {
     mir_tracepoint(mir_server_input, failed_to_open_input_device, name, platform);
 }
+
+void mir::report::lttng::InputReport::received_traced_event(uint64_t trace_id, int64_t event_time)
+{
+    mir_tracepoint(mir_server_input, received_traced_event, trace_id, event_time);
+}
+
+void mir::report::lttng::InputReport::sent_traced_event(uint64_t trace_id, int64_t event_time)
+{
+    mir_tracepoint(mir_server_input, sent_traced_event, trace_id, event_time);
+}
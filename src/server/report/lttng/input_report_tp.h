@@ -86,6 +86,30 @@ TRACEPOINT_EVENT_INSTANCE(
     TP_ARGS(const char*, device, const char*, platform)
 )
 
+TRACEPOINT_EVENT_CLASS(
+    mir_server_input,
+    traced_event,
+    TP_ARGS(uint64_t, trace_id, int64_t, event_time),
+    TP_FIELDS(
+        ctf_integer(uint64_t, trace_id, trace_id)
+        ctf_integer(int64_t, event_time, event_time)
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_input,
+    traced_event,
+    received_traced_event,
+    TP_ARGS(uint64_t, trace_id, int64_t, event_time)
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_input,
+    traced_event,
+    sent_traced_event,
+    TP_ARGS(uint64_t, trace_id, int64_t, event_time)
+)
+
 #endif /* MIR_LTTNG_DISPLAY_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
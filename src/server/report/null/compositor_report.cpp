@@ -49,3 +49,27 @@ void mrn::CompositorReport::stopped()
 void mrn::CompositorReport::scheduled()
 {
 }
+
+void mrn::CompositorReport::began_stage(SubCompositorId, FrameStage)
+{
+}
+
+void mrn::CompositorReport::finished_stage(SubCompositorId, FrameStage)
+{
+}
+
+void mrn::CompositorReport::traced_input_committed(uint64_t)
+{
+}
+
+void mrn::CompositorReport::traced_input_composited(uint64_t)
+{
+}
+
+void mrn::CompositorReport::traced_input_discarded(uint64_t)
+{
+}
+
+void mrn::CompositorReport::traced_input_presented(uint64_t, int64_t, int64_t)
+{
+}
@@ -37,3 +37,11 @@ void mrn::InputReport::opened_input_device(char const* /* name */, char const* /
 void mrn::InputReport::failed_to_open_input_device(char const* /* name */, char const* /* platform */)
 {
 }
+
+void mrn::InputReport::received_traced_event(uint64_t /* trace_id */, int64_t /* event_time */)
+{
+}
+
+void mrn::InputReport::sent_traced_event(uint64_t /* trace_id */, int64_t /* event_time */)
+{
+}
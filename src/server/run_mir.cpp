@@ -276,10 +276,12 @@ void mir::run_mir(
         });
 
     mir::ThreadPoolExecutor::set_unhandled_exception_handler(&terminate_with_current_exception);
+    mir::WorkStealingExecutor::set_unhandled_exception_handler(&terminate_with_current_exception);
 
     init(server);
     server.run();
 
+    mir::WorkStealingExecutor::quiesce();
     mir::ThreadPoolExecutor::quiesce();
     check_for_termination_exception();
 }
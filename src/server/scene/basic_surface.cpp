@@ -15,12 +15,14 @@
  */
 
 #include "basic_surface.h"
+#include "recycling_pool.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/frontend/event_sink.h"
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/cursor_image.h"
 #include "mir/graphics/pixel_format_utils.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/observer_multiplexer.h"
 
@@ -139,6 +141,11 @@ public:
     {
         for_each_observer(&SurfaceObserver::application_id_set_to, surf, application_id);
     }
+
+    void input_region_set_to(Surface const* surf, std::vector<geom::Rectangle> const& region) override
+    {
+        for_each_observer(&SurfaceObserver::input_region_set_to, surf, region);
+    }
 };
 
 namespace
@@ -183,7 +190,8 @@ ms::BasicSurface::BasicSurface(
     surface_buffer_stream(default_stream(layers)),
     report(report),
     parent_(parent),
-    wayland_surface_{wayland_surface}
+    wayland_surface_{wayland_surface},
+    snapshot_pool{std::make_shared<RecyclingPool>()}
 {
     auto state = synchronised_state.lock();
     update_frame_posted_callbacks(*state);
@@ -275,7 +283,15 @@ std::shared_ptr<mf::BufferStream> ms::BasicSurface::primary_buffer_stream() cons
 
 void ms::BasicSurface::set_input_region(std::vector<geom::Rectangle> const& input_rectangles)
 {
-    synchronised_state.lock()->custom_input_rectangles = input_rectangles;
+    {
+        auto state = synchronised_state.lock();
+        if (state->custom_input_rectangles == input_rectangles)
+            return;
+
+        state->custom_input_rectangles = input_rectangles;
+    }
+
+    observers->input_region_set_to(this, input_rectangles);
 }
 
 void ms::BasicSurface::resize(geom::Size const& desired_size)
@@ -308,6 +324,21 @@ geom::Rectangle ms::BasicSurface::input_bounds() const
     return geom::Rectangle{content_top_left(*state), content_size(*state)};
 }
 
+auto ms::BasicSurface::input_area_bounds() const -> std::optional<geom::Rectangle>
+{
+    auto state = synchronised_state.lock();
+    geom::Rectangle const content{content_top_left(*state), content_size(*state)};
+
+    if (state->custom_input_rectangles.empty())
+        return content;
+
+    // The custom input region isn't clipped to the content
+    geom::Rectangles region;
+    for (auto const& rectangle : state->custom_input_rectangles)
+        region.add({content.top_left + as_displacement(rectangle.top_left), rectangle.size});
+    return region.bounding_rectangle();
+}
+
 // TODO: Does not account for transformation().
 bool ms::BasicSurface::input_area_contains(geom::Point const& point) const
 {
@@ -678,14 +709,16 @@ public:
         std::optional<geom::Rectangle> const& clip_area,
         glm::mat4 const& transform,
         float alpha,
-        mg::Renderable::ID id)
+        mg::Renderable::ID id,
+        std::optional<geom::Rectangles>&& opaque_region)
     : underlying_buffer_stream{stream},
       compositor_id{compositor_id},
       alpha_{alpha},
       screen_position_(position),
       clip_area_(clip_area),
       transformation_(transform),
-      id_(id)
+      id_(id),
+      opaque_region_{std::move(opaque_region)}
     {
     }
 
@@ -700,6 +733,11 @@ public:
         return compositor_buffer;
     }
 
+    std::optional<geom::Rectangles> buffer_damage_since(mg::BufferID previous) const override
+    {
+        return underlying_buffer_stream->damage_between(previous, buffer()->id());
+    }
+
     geom::Rectangle screen_position() const override
     { return screen_position_; }
 
@@ -717,6 +755,9 @@ public:
 
     mg::Renderable::ID id() const override
     { return id_; }
+
+    std::optional<geom::Rectangles> opaque_region() const override
+    { return opaque_region_; }
 private:
     std::shared_ptr<mc::BufferStream> const underlying_buffer_stream;
     std::shared_ptr<mg::Buffer> mutable compositor_buffer;
@@ -726,6 +767,7 @@ private:
     std::optional<geom::Rectangle> const clip_area_;
     glm::mat4 const transformation_;
     mg::Renderable::ID const id_;
+    std::optional<geom::Rectangles> const opaque_region_;
 };
 }
 
@@ -771,13 +813,19 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
 
 mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) const
 {
-    auto state = synchronised_state.lock();
     mg::RenderableList list;
+    append_renderables(id, list);
+    return list;
+}
+
+void ms::BasicSurface::append_renderables(mc::CompositorID id, mg::RenderableList& renderables) const
+{
+    auto state = synchronised_state.lock();
     
     if (state->clip_area)
     {
         if (!state->surface_rect.overlaps(state->clip_area.value()))
-            return list;
+            return;
     }
 
     auto const content_top_left_ = content_top_left(*state);
@@ -792,14 +840,25 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
-            list.emplace_back(std::make_shared<SurfaceSnapshot>(
+            auto const stream_top_left = content_top_left_ + info.displacement;
+
+            std::optional<geom::Rectangles> opaque_region;
+            if (info.opaque_region)
+            {
+                opaque_region.emplace();
+                for (auto const& rect : info.opaque_region.value())
+                    opaque_region->add({stream_top_left + as_displacement(rect.top_left), rect.size});
+            }
+
+            renderables.emplace_back(std::allocate_shared<SurfaceSnapshot>(
+                ms::RecyclingAllocator<SurfaceSnapshot>{snapshot_pool},
                 info.stream, id,
-                geom::Rectangle{content_top_left_ + info.displacement, std::move(size)},
+                geom::Rectangle{stream_top_left, std::move(size)},
                 state->clip_area,
-                state->transformation_matrix, state->surface_alpha, info.stream.get()));
+                state->transformation_matrix, state->surface_alpha, info.stream.get(),
+                std::move(opaque_region)));
         }
     }
-    return list;
 }
 
 void ms::BasicSurface::set_confine_pointer_state(MirPointerConfinementState state)
@@ -50,6 +50,7 @@ namespace scene
 {
 class SceneReport;
 class CursorStreamImageAdapter;
+class RecyclingPool;
 
 class BasicSurface : public Surface
 {
@@ -103,6 +104,7 @@ public:
     geometry::Point top_left() const override;
     geometry::Rectangle input_bounds() const override;
     bool input_area_contains(geometry::Point const& point) const override;
+    auto input_area_bounds() const -> std::optional<geometry::Rectangle> override;
     void consume(std::shared_ptr<MirEvent const> const& event) override;
     void set_alpha(float alpha) override;
     void set_orientation(MirOrientation orientation) override;
@@ -111,6 +113,7 @@ public:
     bool visible() const override;
 
     graphics::RenderableList generate_renderables(compositor::CompositorID id) const override;
+    void append_renderables(compositor::CompositorID id, graphics::RenderableList& renderables) const override;
     int buffers_ready_for_compositor(void const* compositor_id) const override;
 
     MirWindowType type() const override;
@@ -224,6 +227,8 @@ private:
     std::shared_ptr<SceneReport> const report;
     std::weak_ptr<Surface> const parent_;
     wayland::Weak<frontend::WlSurface> const wayland_surface_;
+    /// Backs the snapshots handed to compositors, which are recreated every frame
+    std::shared_ptr<RecyclingPool> const snapshot_pool;
 };
 
 }
@@ -0,0 +1,241 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_region_index.h"
+#include "mir/scene/surface.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// Surfaces covering more cells than this are cheaper to treat as unbounded
+int const max_cells_per_surface = 4096;
+
+auto floor_div(int value, int divisor) -> int
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+}
+
+auto ms::InputRegionIndex::CellHash::operator()(Cell const& cell) const -> size_t
+{
+    return std::hash<long long>{}((static_cast<long long>(cell.x) << 32) ^ static_cast<unsigned>(cell.y));
+}
+
+ms::InputRegionIndex::InputRegionIndex(int cell_size)
+    : cell_size{cell_size},
+      unbounded{std::make_shared<EntryList const>()}
+{
+}
+
+void ms::InputRegionIndex::restack(std::vector<std::shared_ptr<Surface>> const& surfaces)
+{
+    decltype(entries) restacked;
+    for (size_t rank = 0; rank != surfaces.size(); ++rank)
+    {
+        auto const& surface = surfaces[rank];
+        if (auto const duplicate = restacked.find(surface.get()); duplicate != restacked.end())
+        {
+            // A surface that's in the stack twice is hit at its topmost position
+            duplicate->second = std::make_shared<Entry const>(Entry{surface, rank, duplicate->second->bounds});
+        }
+        else if (auto const existing = entries.find(surface.get()); existing != entries.end())
+        {
+            auto const& entry = existing->second;
+            restacked.emplace(
+                surface.get(),
+                entry->rank == rank ? entry : std::make_shared<Entry const>(Entry{surface, rank, entry->bounds}));
+        }
+        else
+        {
+            restacked.emplace(
+                surface.get(),
+                std::make_shared<Entry const>(Entry{surface, rank, surface->input_area_bounds()}));
+        }
+    }
+
+    // Build every list afresh (rather than sharing any with copies)
+    std::unordered_map<Cell, EntryList, CellHash> restacked_cells;
+    EntryList restacked_unbounded;
+
+    // Visiting topmost first appends to each list
+    for (auto rank = surfaces.size(); rank-- != 0;)
+    {
+        auto const& entry = *restacked.at(surfaces[rank].get());
+        if (entry.rank != rank)
+            continue;
+
+        auto const covered = entry.bounds ? cells_covering(*entry.bounds) : std::nullopt;
+        if (!covered)
+        {
+            restacked_unbounded.push_back(&entry);
+            continue;
+        }
+
+        for (auto const& cell : *covered)
+            restacked_cells[cell].push_back(&entry);
+    }
+
+    entries = std::move(restacked);
+    cells.clear();
+    for (auto& [cell, list] : restacked_cells)
+        cells.emplace(cell, std::make_shared<EntryList const>(std::move(list)));
+    unbounded = std::make_shared<EntryList const>(std::move(restacked_unbounded));
+}
+
+void ms::InputRegionIndex::update(Surface const* surface)
+{
+    auto const existing = entries.find(surface);
+    if (existing == entries.end())
+        return;
+
+    auto const& entry = *existing->second;
+    auto const bounds = surface->input_area_bounds();
+    if (bounds == entry.bounds)
+        return;
+
+    // The entry may be shared with copies, so replace it rather than change it
+    auto const updated = std::make_shared<Entry const>(Entry{entry.surface, entry.rank, bounds});
+    erase(entry);
+    existing->second = updated;
+    insert(*updated);
+}
+
+auto ms::InputRegionIndex::is_stale(Surface const* surface) const -> bool
+{
+    auto const existing = entries.find(surface);
+    return existing != entries.end() && surface->input_area_bounds() != existing->second->bounds;
+}
+
+auto ms::InputRegionIndex::surface_at(geom::Point point) const -> std::shared_ptr<Surface>
+{
+    static EntryList const no_entries;
+    auto const cell = cells.find(Cell{
+        floor_div(point.x.as_int(), cell_size),
+        floor_div(point.y.as_int(), cell_size)});
+    auto const& bounded = cell != cells.end() ? *cell->second : no_entries;
+
+    // Visit the surfaces listed for the cell and those without bounds, topmost first
+    auto b = bounded.begin();
+    auto u = unbounded->begin();
+    while (b != bounded.end() || u != unbounded->end())
+    {
+        Entry const* candidate;
+        if (u == unbounded->end() || (b != bounded.end() && (*b)->rank > (*u)->rank))
+            candidate = *b++;
+        else
+            candidate = *u++;
+
+        if (candidate->bounds && !candidate->bounds->contains(point))
+            continue;
+
+        if (candidate->surface->input_area_contains(point))
+            return candidate->surface;
+    }
+
+    return {};
+}
+
+auto ms::InputRegionIndex::cells_covering(geom::Rectangle const& bounds) const -> std::optional<std::vector<Cell>>
+{
+    std::vector<Cell> result;
+    if (bounds.size.width.as_int() <= 0 || bounds.size.height.as_int() <= 0)
+        return result;
+
+    auto const left = floor_div(bounds.left().as_int(), cell_size);
+    auto const right = floor_div(bounds.right().as_int() - 1, cell_size);
+    auto const top = floor_div(bounds.top().as_int(), cell_size);
+    auto const bottom = floor_div(bounds.bottom().as_int() - 1, cell_size);
+
+    if (static_cast<long long>(right - left + 1) * (bottom - top + 1) > max_cells_per_surface)
+        return std::nullopt;
+
+    result.reserve((right - left + 1) * (bottom - top + 1));
+    for (auto y = top; y <= bottom; ++y)
+    {
+        for (auto x = left; x <= right; ++x)
+            result.push_back(Cell{x, y});
+    }
+    return result;
+}
+
+void ms::InputRegionIndex::insert(Entry const& entry)
+{
+    auto const covered = entry.bounds ? cells_covering(*entry.bounds) : std::nullopt;
+    if (!covered)
+    {
+        unbounded = inserted_by_rank(*unbounded, entry);
+        return;
+    }
+
+    static EntryList const no_entries;
+    for (auto const& cell : *covered)
+    {
+        auto& list = cells[cell];
+        list = inserted_by_rank(list ? *list : no_entries, entry);
+    }
+}
+
+void ms::InputRegionIndex::erase(Entry const& entry)
+{
+    auto const without_entry = [&entry](EntryList const& list)
+        {
+            EntryList result;
+            result.reserve(list.size());
+            std::remove_copy(list.begin(), list.end(), std::back_inserter(result), &entry);
+            return result;
+        };
+
+    auto const covered = entry.bounds ? cells_covering(*entry.bounds) : std::nullopt;
+    if (!covered)
+    {
+        unbounded = std::make_shared<EntryList const>(without_entry(*unbounded));
+        return;
+    }
+
+    for (auto const& cell : *covered)
+    {
+        auto const list = cells.find(cell);
+        if (list == cells.end())
+            continue;
+
+        auto remaining = without_entry(*list->second);
+        if (remaining.empty())
+            cells.erase(list);
+        else
+            list->second = std::make_shared<EntryList const>(std::move(remaining));
+    }
+}
+
+auto ms::InputRegionIndex::inserted_by_rank(EntryList const& list, Entry const& entry)
+    -> std::shared_ptr<EntryList const>
+{
+    auto const position = std::lower_bound(
+        list.begin(), list.end(), &entry,
+        [](Entry const* a, Entry const* b) { return a->rank > b->rank; });
+
+    EntryList result;
+    result.reserve(list.size() + 1);
+    result.insert(result.end(), list.begin(), position);
+    result.push_back(&entry);
+    result.insert(result.end(), position, list.end());
+    return std::make_shared<EntryList const>(std::move(result));
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_INPUT_REGION_INDEX_H_
+#define MIR_SCENE_INPUT_REGION_INDEX_H_
+
+#include "mir/geometry/point.h"
+#include "mir/geometry/rectangle.h"
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+class Surface;
+
+/**
+ * A spatial index of surfaces' input areas, for hit-testing input without visiting every surface.
+ *
+ * The index divides the plane into a grid of square cells, each listing (topmost first) the surfaces
+ * whose Surface::input_area_bounds() overlap it. Looking up a point only asks the surfaces listed for
+ * its cell whether their input area contains it.
+ *
+ * Not thread-safe to change: the owner must serialize changes, or (as SurfaceStack does) change a copy
+ * and share it unchanged from then on. Copies share their entries and cell lists, which are never
+ * changed once made, so a copy costs a pointer per cell and an update only rebuilds the cells it touches.
+ */
+class InputRegionIndex
+{
+public:
+    explicit InputRegionIndex(int cell_size = 256);
+    InputRegionIndex(InputRegionIndex const& other) = default;
+    InputRegionIndex& operator=(InputRegionIndex const&) = delete;
+
+    /// Replace the indexed surfaces with surfaces (in stacking order, bottom to top)
+    void restack(std::vector<std::shared_ptr<Surface>> const& surfaces);
+
+    /// Re-read the input area bounds of surface, which may have moved, resized or changed its input region
+    void update(Surface const* surface);
+
+    /// Whether update() would change anything for surface
+    auto is_stale(Surface const* surface) const -> bool;
+
+    /// The topmost surface whose input area contains point (if any)
+    auto surface_at(geometry::Point point) const -> std::shared_ptr<Surface>;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<Surface> surface;
+        size_t rank;    ///< Position in the stacking order (higher is on top)
+        std::optional<geometry::Rectangle> bounds;  ///< Unbounded if not set
+    };
+
+    struct Cell
+    {
+        int x, y;
+        bool operator==(Cell const& other) const { return x == other.x && y == other.y; }
+    };
+
+    struct CellHash
+    {
+        auto operator()(Cell const& cell) const -> size_t;
+    };
+
+    /// Entries topmost first. The entries are owned by (and shared between copies through) entries
+    using EntryList = std::vector<Entry const*>;
+
+    auto cells_covering(geometry::Rectangle const& bounds) const -> std::optional<std::vector<Cell>>;
+    void insert(Entry const& entry);
+    void erase(Entry const& entry);
+    static auto inserted_by_rank(EntryList const& list, Entry const& entry) -> std::shared_ptr<EntryList const>;
+
+    int const cell_size;
+    std::unordered_map<Surface const*, std::shared_ptr<Entry const>> entries;
+    std::unordered_map<Cell, std::shared_ptr<EntryList const>, CellHash> cells;
+    std::shared_ptr<EntryList const> unbounded;
+};
+}
+}
+
+#endif /* MIR_SCENE_INPUT_REGION_INDEX_H_ */
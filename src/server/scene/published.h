@@ -0,0 +1,89 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_PUBLISHED_H_
+#define MIR_SCENE_PUBLISHED_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * An immutable value that readers share while a writer replaces it.
+ *
+ * Reading never takes a lock: std::atomic_load() of a shared_ptr would, as libstdc++ guards it
+ * with a process-wide pool of mutexes. Instead the value lives in a box, the current box is an
+ * atomic pointer, and readers announce themselves in an atomic count while they copy from it.
+ * A replaced box is freed by a later publish() that sees no readers, so it (and its value) may
+ * outlive its replacement for a while if there are always readers about.
+ *
+ * publish() calls must be serialised by the owner.
+ */
+template<typename T>
+class Published
+{
+public:
+    explicit Published(std::shared_ptr<T const> initial)
+        : current{new Box{std::move(initial)}}
+    {
+    }
+
+    ~Published()
+    {
+        delete current.load();
+    }
+
+    auto get() const -> std::shared_ptr<T const>
+    {
+        readers.fetch_add(1);
+        auto result = current.load()->value;
+        readers.fetch_sub(1);
+        return result;
+    }
+
+    void publish(std::shared_ptr<T const> next)
+    {
+        retired.emplace_back(current.exchange(new Box{std::move(next)}));
+
+        // Any reader still looking at a retired box announced itself before the exchange above
+        if (readers.load() == 0)
+        {
+            retired.clear();
+        }
+    }
+
+private:
+    Published(Published const&) = delete;
+    Published& operator=(Published const&) = delete;
+
+    struct Box
+    {
+        std::shared_ptr<T const> const value;
+    };
+
+    mutable std::atomic<unsigned> readers{0};
+    std::atomic<Box*> current;
+    /// Replaced boxes that readers may still be copying from. Only accessed by publish()
+    std::vector<std::unique_ptr<Box>> retired;
+};
+}
+}
+
+#endif /* MIR_SCENE_PUBLISHED_H_ */
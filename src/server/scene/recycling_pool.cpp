@@ -0,0 +1,77 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recycling_pool.h"
+
+#include <algorithm>
+#include <new>
+
+namespace ms = mir::scene;
+
+ms::RecyclingPool::~RecyclingPool()
+{
+    while (free_list)
+    {
+        auto const block = free_list;
+        free_list = block->next;
+        ::operator delete(block);
+    }
+}
+
+auto ms::RecyclingPool::allocate(std::size_t size) -> void*
+{
+    {
+        std::lock_guard lock{mutex};
+
+        if (block_size == 0)
+            block_size = std::max(size, sizeof(FreeBlock));
+
+        if (size <= block_size)
+        {
+            if (auto const block = free_list)
+            {
+                free_list = block->next;
+                return block;
+            }
+
+            ++blocks;
+            size = block_size;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void ms::RecyclingPool::deallocate(void* block, std::size_t size) noexcept
+{
+    {
+        std::lock_guard lock{mutex};
+
+        if (size <= block_size)
+        {
+            free_list = new (block) FreeBlock{free_list};
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
+
+auto ms::RecyclingPool::blocks_allocated() const -> std::size_t
+{
+    std::lock_guard lock{mutex};
+    return blocks;
+}
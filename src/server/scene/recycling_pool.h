@@ -0,0 +1,119 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_RECYCLING_POOL_H_
+#define MIR_SCENE_RECYCLING_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * A free list of equally sized memory blocks.
+ *
+ * The compositor snapshots the scene every frame, creating (and shortly afterwards
+ * destroying) an object for every surface it draws. Allocating these from a
+ * RecyclingPool means that once the scene is in a steady state, a frame reuses the
+ * memory released by the previous one instead of going to the heap.
+ *
+ * The first allocation fixes the block size; requests of any other size are passed
+ * through to the heap. Blocks may be released from any thread.
+ */
+class RecyclingPool
+{
+public:
+    RecyclingPool() = default;
+    ~RecyclingPool();
+
+    auto allocate(std::size_t size) -> void*;
+    void deallocate(void* block, std::size_t size) noexcept;
+
+    /// The number of blocks ever taken from the heap (for diagnostics)
+    auto blocks_allocated() const -> std::size_t;
+
+private:
+    RecyclingPool(RecyclingPool const&) = delete;
+    RecyclingPool& operator=(RecyclingPool const&) = delete;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    std::mutex mutable mutex;
+    std::size_t block_size{0};
+    std::size_t blocks{0};
+    FreeBlock* free_list{nullptr};
+};
+
+/**
+ * An allocator drawing from a RecyclingPool, intended for std::allocate_shared().
+ *
+ * Each copy shares ownership of the pool, so a pool outlives every object
+ * allocated from it.
+ */
+template<typename T>
+class RecyclingAllocator
+{
+public:
+    using value_type = T;
+
+    explicit RecyclingAllocator(std::shared_ptr<RecyclingPool> pool) noexcept
+        : pool{std::move(pool)}
+    {
+    }
+
+    template<typename U>
+    RecyclingAllocator(RecyclingAllocator<U> const& other) noexcept
+        : pool{other.pool}
+    {
+    }
+
+    auto allocate(std::size_t n) -> T*
+    {
+        return static_cast<T*>(pool->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        pool->deallocate(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(RecyclingAllocator<U> const& other) const noexcept
+    {
+        return pool == other.pool;
+    }
+
+    template<typename U>
+    bool operator!=(RecyclingAllocator<U> const& other) const noexcept
+    {
+        return pool != other.pool;
+    }
+
+private:
+    template<typename U> friend class RecyclingAllocator;
+
+    std::shared_ptr<RecyclingPool> pool;
+};
+}
+}
+
+#endif /* MIR_SCENE_RECYCLING_POOL_H_ */
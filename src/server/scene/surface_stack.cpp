@@ -15,7 +15,9 @@
  */
 
 #include "surface_stack.h"
+#include "input_region_index.h"
 #include "rendering_tracker.h"
+#include "recycling_pool.h"
 #include "mir/scene/surface.h"
 #include "mir/scene/null_surface_observer.h"
 #include "mir/scene/scene_report.h"
@@ -30,6 +32,7 @@
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 
 namespace ms = mir::scene;
@@ -45,14 +48,12 @@ class SurfaceSceneElement : public mc::SceneElement
 {
 public:
     SurfaceSceneElement(
-        std::string name,
         std::shared_ptr<mg::Renderable> const& renderable,
         std::shared_ptr<ms::RenderingTracker> const& tracker,
         mc::CompositorID id)
         : renderable_{renderable},
           tracker{tracker},
-          cid{id},
-          surface_name(name)
+          cid{id}
     {
     }
 
@@ -75,7 +76,6 @@ private:
     std::shared_ptr<mg::Renderable> const renderable_;
     std::shared_ptr<ms::RenderingTracker> const tracker;
     mc::CompositorID cid;
-    std::string const surface_name;
 };
 
 //note: something different than a 2D/HWC overlay
@@ -106,11 +106,11 @@ private:
 };
 
 /**
- * A SurfaceDepthLayerObserver must not outlive the SurfaceStack it was created for
+ * A StackedSurfaceObserver must not outlive the SurfaceStack it was created for
  */
-struct SurfaceDepthLayerObserver : ms::NullSurfaceObserver
+struct StackedSurfaceObserver : ms::NullSurfaceObserver
 {
-    SurfaceDepthLayerObserver(ms::SurfaceStack* stack)
+    StackedSurfaceObserver(ms::SurfaceStack* stack)
         : stack{stack}
     {
     }
@@ -121,24 +121,74 @@ struct SurfaceDepthLayerObserver : ms::NullSurfaceObserver
         stack->raise(surface);
     }
 
+    void moved_to(ms::Surface const* surface, geom::Point const& /*top_left*/) override
+    {
+        stack->input_area_changed(surface);
+    }
+
+    void window_resized_to(ms::Surface const* surface, geom::Size const& /*window_size*/) override
+    {
+        stack->input_area_changed(surface);
+    }
+
+    void content_resized_to(ms::Surface const* surface, geom::Size const& /*content_size*/) override
+    {
+        stack->input_area_changed(surface);
+    }
+
+    void input_region_set_to(ms::Surface const* surface, std::vector<geom::Rectangle> const& /*region*/) override
+    {
+        stack->input_area_changed(surface);
+    }
+
 private:
     ms::SurfaceStack* stack;
 };
 
 }
 
+/// The per-compositor storage scene_elements_for() reuses from frame to frame
+struct ms::SurfaceStack::FrameStorage
+{
+    std::shared_ptr<RecyclingPool> const surface_elements{std::make_shared<RecyclingPool>()};
+    std::shared_ptr<RecyclingPool> const overlay_elements{std::make_shared<RecyclingPool>()};
+    mg::RenderableList renderables;
+};
+
+/**
+ * The contents of the stack at some moment.
+ *
+ * A published Snapshot is never modified: writers copy the current one, change
+ * the copy and publish that in its place. Readers holding the previous one keep
+ * it (and the surfaces in it) alive until they are done.
+ */
+struct ms::SurfaceStack::Snapshot
+{
+    /**
+     * Each depth layer is mapped to an index of the outer vector by mir_depth_layer_to_index()
+     * The outer vector starts out empty, and is expanded as needed to contain the highest layer encountered
+     * The inner vectors contain the list of surfaces on each layer (bottom to top)
+     */
+    std::vector<std::vector<std::shared_ptr<Surface>>> surface_layers;
+    std::map<Surface*, std::shared_ptr<RenderingTracker>> rendering_trackers;
+    std::map<compositor::CompositorID, std::shared_ptr<FrameStorage>> frame_storage;
+    std::vector<std::shared_ptr<graphics::Renderable>> overlays;
+};
+
 ms::SurfaceStack::SurfaceStack(
     std::shared_ptr<SceneReport> const& report) :
     report{report},
+    snapshot{std::make_shared<Snapshot const>()},
+    input_index{std::make_shared<InputRegionIndex const>()},
     scene_changed{false},
-    surface_observer{std::make_shared<SurfaceDepthLayerObserver>(this)}
+    surface_observer{std::make_shared<StackedSurfaceObserver>(this)}
 {
 }
 
 ms::SurfaceStack::~SurfaceStack() noexcept(true)
 {
-    RecursiveWriteLock lg(guard);
-    for (auto const& layer : surface_layers)
+    std::lock_guard lock{writer_mutex};
+    for (auto const& layer : current_snapshot()->surface_layers)
     {
         for (auto const& surface : layer)
         {
@@ -149,48 +199,71 @@ ms::SurfaceStack::~SurfaceStack() noexcept(true)
 
 mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id)
 {
-    RecursiveReadLock lg(guard);
+    mc::SceneElementSequence elements;
+    collect_scene_elements_for(id, elements);
+    return elements;
+}
 
+void ms::SurfaceStack::collect_scene_elements_for(mc::CompositorID id, mc::SceneElementSequence& elements)
+{
+    elements.clear();
+
+    // Clear this first so that a change published while we're sampling is not missed
     scene_changed = false;
-    mc::SceneElementSequence elements;
-    for (auto const& layer : surface_layers)
+
+    auto const current = current_snapshot();
+
+    // Compositors that haven't registered (e.g. screenshots) don't get to reuse anything
+    std::optional<FrameStorage> unregistered;
+    auto const registered = current->frame_storage.find(id);
+    auto& storage = registered != current->frame_storage.end() ? *registered->second : unregistered.emplace();
+
+    for (auto const& layer : current->surface_layers)
     {
         for (auto const& surface : layer)
         {
             if (surface->visible())
             {
-                for (auto& renderable : surface->generate_renderables(id))
+                surface->append_renderables(id, storage.renderables);
+                if (storage.renderables.empty())
+                    continue;
+
+                auto const& tracker = current->rendering_trackers.at(surface.get());
+                for (auto const& renderable : storage.renderables)
                 {
                     elements.emplace_back(
-                        std::make_shared<SurfaceSceneElement>(
-                            surface->name(),
+                        std::allocate_shared<SurfaceSceneElement>(
+                            RecyclingAllocator<SurfaceSceneElement>{storage.surface_elements},
                             renderable,
-                            rendering_trackers[surface.get()],
+                            tracker,
                             id));
                 }
+                storage.renderables.clear();
             }
         }
     }
-    for (auto const& renderable : overlays)
+    for (auto const& renderable : current->overlays)
     {
-        elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
+        elements.emplace_back(
+            std::allocate_shared<OverlaySceneElement>(
+                RecyclingAllocator<OverlaySceneElement>{storage.overlay_elements},
+                renderable));
     }
-    return elements;
 }
 
 int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
 {
-    RecursiveReadLock lg(guard);
-
     int result = scene_changed ? 1 : 0;
-    for (auto const& layer : surface_layers)
+
+    auto const current = current_snapshot();
+    for (auto const& layer : current->surface_layers)
     {
         for (auto const& surface : layer)
         {
             if (surface->visible())
             {
-                auto const tracker = rendering_trackers.find(surface.get());
-                if (tracker != rendering_trackers.end() && tracker->second->is_exposed_in(id))
+                auto const tracker = current->rendering_trackers.find(surface.get());
+                if (tracker != current->rendering_trackers.end() && tracker->second->is_exposed_in(id))
                 {
                     // Note that we ask the surface and not a Renderable.
                     // This is because we don't want to waste time and resources
@@ -207,28 +280,36 @@ int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
 
 void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
 {
-    RecursiveWriteLock lg(guard);
+    std::lock_guard lock{writer_mutex};
 
     registered_compositors.insert(cid);
 
-    update_rendering_tracker_compositors();
+    auto next = std::make_shared<Snapshot>(*current_snapshot());
+    next->frame_storage.emplace(cid, std::make_shared<FrameStorage>());
+    update_rendering_tracker_compositors(*next);
+    publish(std::move(next));
 }
 
 void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
 {
-    RecursiveWriteLock lg(guard);
+    std::lock_guard lock{writer_mutex};
 
     registered_compositors.erase(cid);
 
-    update_rendering_tracker_compositors();
+    auto next = std::make_shared<Snapshot>(*current_snapshot());
+    next->frame_storage.erase(cid);
+    update_rendering_tracker_compositors(*next);
+    publish(std::move(next));
 }
 
 void ms::SurfaceStack::add_input_visualization(
     std::shared_ptr<mg::Renderable> const& overlay)
 {
     {
-        RecursiveWriteLock lg(guard);
-        overlays.push_back(overlay);
+        std::lock_guard lock{writer_mutex};
+        auto next = std::make_shared<Snapshot>(*current_snapshot());
+        next->overlays.push_back(overlay);
+        publish(std::move(next));
     }
     emit_scene_changed();
 }
@@ -238,13 +319,15 @@ void ms::SurfaceStack::remove_input_visualization(
 {
     auto overlay = weak_overlay.lock();
     {
-        RecursiveWriteLock lg(guard);
-        auto const p = std::find(overlays.begin(), overlays.end(), overlay);
-        if (p == overlays.end())
+        std::lock_guard lock{writer_mutex};
+        auto next = std::make_shared<Snapshot>(*current_snapshot());
+        auto const p = std::find(next->overlays.begin(), next->overlays.end(), overlay);
+        if (p == next->overlays.end())
         {
             BOOST_THROW_EXCEPTION(std::runtime_error("Attempt to remove an overlay which was never added or which has been previously removed"));
         }
-        overlays.erase(p);
+        next->overlays.erase(p);
+        publish(std::move(next));
     }
     
     emit_scene_changed();
@@ -252,10 +335,7 @@ void ms::SurfaceStack::remove_input_visualization(
 
 void ms::SurfaceStack::emit_scene_changed()
 {
-    {
-        RecursiveWriteLock lg(guard);
-        scene_changed = true;
-    }
+    scene_changed = true;
     observers.scene_changed();
 }
 
@@ -264,10 +344,16 @@ void ms::SurfaceStack::add_surface(
     mi::InputReceptionMode input_mode)
 {
     {
-        RecursiveWriteLock lg(guard);
-        insert_surface_at_top_of_depth_layer(surface);
-        create_rendering_tracker_for(surface);
+        std::lock_guard lock{writer_mutex};
+        auto next = std::make_shared<Snapshot>(*current_snapshot());
+        insert_surface_at_top_of_depth_layer(*next, surface);
+        create_rendering_tracker_for(*next, surface);
+        update_input_index(*next);
+        publish(std::move(next));
         surface->register_interest(surface_observer, immediate_executor);
+
+        // In case it moved before we were watching
+        update_input_area(surface.get());
     }
     surface->set_reception_mode(input_mode);
     observers.surface_added(surface);
@@ -281,16 +367,19 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
 
     bool found_surface = false;
     {
-        RecursiveWriteLock lg(guard);
+        std::lock_guard lock{writer_mutex};
+        auto next = std::make_shared<Snapshot>(*current_snapshot());
 
-        for (auto& layer : surface_layers)
+        for (auto& layer : next->surface_layers)
         {
             auto const surface = std::find(layer.begin(), layer.end(), keep_alive);
 
             if (surface != layer.end())
             {
                 layer.erase(surface);
-                rendering_trackers.erase(keep_alive.get());
+                next->rendering_trackers.erase(keep_alive.get());
+                update_input_index(*next);
+                publish(std::move(next));
                 keep_alive->unregister_interest(*surface_observer);
                 found_surface = true;
                 break;
@@ -306,37 +395,14 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
     // TODO: error logging when surface not found
 }
 
-namespace
-{
-template <typename Container>
-struct InReverse {
-    Container& container;
-    auto begin() -> decltype(container.rbegin()) { return container.rbegin(); }
-    auto end() -> decltype(container.rend()) { return container.rend(); }
-};
-
-template <typename Container>
-InReverse<Container> in_reverse(Container& container) { return InReverse<Container>{container}; }
-}
-
 auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
 -> std::shared_ptr<Surface>
 {
-    RecursiveReadLock lg(guard);
-    for (auto const& layer : in_reverse(surface_layers))
-    {
-        for (auto const& surface : in_reverse(layer))
-        {
-            // TODO There's a lack of clarity about how the input area will
-            // TODO be maintained and whether this test will detect clicks on
-            // TODO decorations (it should) as these may be outside the area
-            // TODO known to the client.  But it works for now.
-            if (surface->input_area_contains(cursor))
-                    return surface;
-        }
-    }
-
-    return {};
+    // TODO There's a lack of clarity about how the input area will
+    // TODO be maintained and whether this test will detect clicks on
+    // TODO decorations (it should) as these may be outside the area
+    // TODO known to the client.  But it works for now.
+    return input_index.get()->surface_at(cursor);
 }
 
 auto ms::SurfaceStack::input_surface_at(geometry::Point point) const -> std::shared_ptr<input::Surface>
@@ -349,8 +415,10 @@ void ms::SurfaceStack::raise(Surface const* surface)
     SurfaceSet affected_surfaces;
 
     {
-        RecursiveWriteLock ul(guard);
-        for (auto& layer : surface_layers)
+        std::lock_guard lock{writer_mutex};
+        auto next = std::make_shared<Snapshot>(*current_snapshot());
+
+        for (auto& layer : next->surface_layers)
         {
             auto const p = std::find_if(
                 layer.begin(),
@@ -364,7 +432,9 @@ void ms::SurfaceStack::raise(Surface const* surface)
             {
                 std::shared_ptr<Surface> surface_shared = *p;
                 layer.erase(p);
-                insert_surface_at_top_of_depth_layer(surface_shared);
+                insert_surface_at_top_of_depth_layer(*next, surface_shared);
+                update_input_index(*next);
+                publish(std::move(next));
                 affected_surfaces.insert(surface_shared);
                 break;
             }
@@ -391,8 +461,10 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
 {
     bool surfaces_reordered{false};
     {
-        RecursiveWriteLock ul(guard);
-        for (auto& layer : surface_layers)
+        std::lock_guard lock{writer_mutex};
+        auto next = std::make_shared<Snapshot>(*current_snapshot());
+
+        for (auto& layer : next->surface_layers)
         {
             auto const old_layer = layer;
 
@@ -410,12 +482,18 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
             // One by one insert to_raise surfaces into the surfaces vector at the correct position
             // It is important that to_raise is still in the original order
             for (auto const& surface : to_raise)
-                insert_surface_at_top_of_depth_layer(surface);
+                insert_surface_at_top_of_depth_layer(*next, surface);
 
             // Only set surfaces_reordered if the end result is different than before
             if (old_layer != layer)
                 surfaces_reordered = true;
         }
+
+        if (surfaces_reordered)
+        {
+            update_input_index(*next);
+            publish(std::move(next));
+        }
     }
 
     if (surfaces_reordered)
@@ -424,29 +502,63 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
     }
 }
 
-void ms::SurfaceStack::create_rendering_tracker_for(std::shared_ptr<Surface> const& surface)
+auto ms::SurfaceStack::current_snapshot() const -> std::shared_ptr<Snapshot const>
 {
-    auto const tracker = std::make_shared<RenderingTracker>(surface);
+    return snapshot.get();
+}
 
-    RecursiveWriteLock ul(guard);
-    tracker->active_compositors(registered_compositors);
-    rendering_trackers[surface.get()] = tracker;
+void ms::SurfaceStack::publish(std::shared_ptr<Snapshot const> next)
+{
+    snapshot.publish(std::move(next));
 }
 
-void ms::SurfaceStack::update_rendering_tracker_compositors()
+void ms::SurfaceStack::create_rendering_tracker_for(Snapshot& next, std::shared_ptr<Surface> const& surface)
 {
-    RecursiveReadLock ul(guard);
+    auto const tracker = std::make_shared<RenderingTracker>(surface);
+    tracker->active_compositors(registered_compositors);
+    next.rendering_trackers[surface.get()] = tracker;
+}
 
-    for (auto const& pair : rendering_trackers)
+void ms::SurfaceStack::update_rendering_tracker_compositors(Snapshot const& next)
+{
+    for (auto const& pair : next.rendering_trackers)
         pair.second->active_compositors(registered_compositors);
 }
 
-void ms::SurfaceStack::insert_surface_at_top_of_depth_layer(std::shared_ptr<Surface> const& surface)
+void ms::SurfaceStack::insert_surface_at_top_of_depth_layer(Snapshot& next, std::shared_ptr<Surface> const& surface)
 {
     unsigned int depth_index = mir_depth_layer_get_index(surface->depth_layer());
-    if (surface_layers.size() <= depth_index)
-        surface_layers.resize(depth_index + 1);
-    surface_layers[depth_index].push_back(surface);
+    if (next.surface_layers.size() <= depth_index)
+        next.surface_layers.resize(depth_index + 1);
+    next.surface_layers[depth_index].push_back(surface);
+}
+
+void ms::SurfaceStack::update_input_index(Snapshot const& next)
+{
+    std::vector<std::shared_ptr<Surface>> stacking_order;
+    for (auto const& layer : next.surface_layers)
+        stacking_order.insert(stacking_order.end(), layer.begin(), layer.end());
+
+    auto index = std::make_shared<InputRegionIndex>(*input_index.get());
+    index->restack(stacking_order);
+    input_index.publish(std::move(index));
+}
+
+void ms::SurfaceStack::update_input_area(Surface const* surface)
+{
+    auto const current = input_index.get();
+    if (!current->is_stale(surface))
+        return;
+
+    auto index = std::make_shared<InputRegionIndex>(*current);
+    index->update(surface);
+    input_index.publish(std::move(index));
+}
+
+void ms::SurfaceStack::input_area_changed(Surface const* surface)
+{
+    std::lock_guard lock{writer_mutex};
+    update_input_area(surface);
 }
 
 void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observer)
@@ -454,8 +566,7 @@ void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observe
     observers.add(observer);
 
     // Notify observer of existing surfaces
-    RecursiveReadLock lk(guard);
-    for (auto const& layer : surface_layers)
+    for (auto const& layer : current_snapshot()->surface_layers)
     {
         for (auto const& surface : layer)
         {
@@ -479,8 +590,7 @@ auto ms::SurfaceStack::stacking_order_of(SurfaceSet const& surfaces) const -> Su
 {
     SurfaceList result;
 
-    RecursiveReadLock lk(guard);
-    for (auto const& layer : surface_layers)
+    for (auto const& layer : current_snapshot()->surface_layers)
     {
         for (auto const& surface : layer)
         {
@@ -23,10 +23,10 @@
 #include "mir/compositor/scene.h"
 #include "mir/scene/observer.h"
 #include "mir/input/scene.h"
-#include "mir/recursive_read_write_mutex.h"
 
 #include "mir/basic_observers.h"
 #include "mir/scene/surface_observer.h"
+#include "published.h"
 
 #include <atomic>
 #include <map>
@@ -48,6 +48,7 @@ namespace scene
 class BasicSurface;
 class SceneReport;
 class RenderingTracker;
+class InputRegionIndex;
 
 class Observers : public Observer, BasicObservers<Observer>
 {
@@ -77,6 +78,9 @@ public:
 
     // From Scene
     compositor::SceneElementSequence scene_elements_for(compositor::CompositorID id) override;
+    void collect_scene_elements_for(
+        compositor::CompositorID id,
+        compositor::SceneElementSequence& elements) override;
     int frames_pending(compositor::CompositorID) const override;
     void register_compositor(compositor::CompositorID id) override;
     void unregister_compositor(compositor::CompositorID id) override;
@@ -87,6 +91,8 @@ public:
     virtual void remove_surface(std::weak_ptr<Surface> const& surface) override;
 
     void raise(Surface const* surface);
+    /// The surface's input area may have moved, resized or changed shape
+    void input_area_changed(Surface const* surface);
     virtual void raise(std::weak_ptr<Surface> const& surface) override;
     void raise(SurfaceSet const& surfaces) override;
 
@@ -110,26 +116,35 @@ public:
 private:
     SurfaceStack(const SurfaceStack&) = delete;
     SurfaceStack& operator=(const SurfaceStack&) = delete;
-    void create_rendering_tracker_for(std::shared_ptr<Surface> const&);
-    void update_rendering_tracker_compositors();
-    void insert_surface_at_top_of_depth_layer(std::shared_ptr<Surface> const& surface);
+    struct Snapshot;
+    struct FrameStorage;
 
-    RecursiveReadWriteMutex mutable guard;
+    auto current_snapshot() const -> std::shared_ptr<Snapshot const>;
+    void publish(std::shared_ptr<Snapshot const> next);
+    void create_rendering_tracker_for(Snapshot& next, std::shared_ptr<Surface> const& surface);
+    void update_rendering_tracker_compositors(Snapshot const& next);
+    void insert_surface_at_top_of_depth_layer(Snapshot& next, std::shared_ptr<Surface> const& surface);
+    void update_input_index(Snapshot const& next);
+    void update_input_area(Surface const* surface);
 
     std::shared_ptr<SceneReport> const report;
 
+    /// Serialises changes to the stack: each copies the current snapshot and publishes the result
+    std::mutex writer_mutex;
+
+    /// The current contents of the stack
+    Published<Snapshot> snapshot;
+
     /**
-     * All surfaces managed by this class
+     * Answers surface_at()
      *
-     * Each depth layer is mapped to an index of the outer vector by mir_depth_layer_to_index()
-     * The outer vector starts out empty, and is expanded as needed to contain the highest layer encountered
-     * The inner vectors contain the list of surfaces on each layer (bottom to top)
+     * Kept apart from the snapshot, so that an input area changing (as it does each step of a
+     * drag) only copies the index, and the index's copies share all but the cells that change.
      */
-    std::vector<std::vector<std::shared_ptr<Surface>>> surface_layers;
-    std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
+    Published<InputRegionIndex> input_index;
+
+    /// Only accessed with writer_mutex held
     std::set<compositor::CompositorID> registered_compositors;
-    
-    std::vector<std::shared_ptr<graphics::Renderable>> overlays;
 
     Observers observers;
     std::atomic<bool> scene_changed;
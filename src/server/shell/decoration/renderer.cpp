@@ -31,6 +31,13 @@
 
 #include <locale>
 #include <codecvt>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace ms = mir::scene;
 namespace mg = mir::graphics;
@@ -123,6 +130,29 @@ inline auto area(geom::Size size) -> size_t
         : 0;
 }
 
+/// Sets count pixels to color, several pixels per store where the CPU allows
+inline void fill_pixels(uint32_t* start, size_t count, uint32_t color)
+{
+#if defined(__SSE2__)
+    uint32_t* const end = start + count;
+    while (start < end && (reinterpret_cast<uintptr_t>(start) & 0xF))
+        *start++ = color;
+    __m128i const colors = _mm_set1_epi32(static_cast<int>(color));
+    for (; end - start >= 4; start += 4)
+        _mm_store_si128(reinterpret_cast<__m128i*>(start), colors);
+    while (start < end)
+        *start++ = color;
+#elif defined(__ARM_NEON)
+    uint32x4_t const colors = vdupq_n_u32(color);
+    for (; count >= 4; count -= 4, start += 4)
+        vst1q_u32(start, colors);
+    while (count--)
+        *start++ = color;
+#else
+    std::fill_n(start, count, color);
+#endif
+}
+
 inline void render_row(
     uint32_t* const data,
     geom::Size buf_size,
@@ -134,10 +164,10 @@ inline void render_row(
         return;
     geom::X const right = std::min(left.x + as_delta(length), as_x(buf_size.width));
     left.x = std::max(left.x, geom::X{});
+    if (right <= left.x)
+        return;
     uint32_t* const start = data + (left.y.as_int() * buf_size.width.as_int()) + left.x.as_int();
-    uint32_t* const end = start + right.as_int() - left.x.as_int();
-    for (uint32_t* i = start; i < end; i++)
-        *i = color;
+    fill_pixels(start, right.as_int() - left.x.as_int(), color);
 }
 
 inline void render_close_icon(
@@ -212,17 +242,35 @@ public:
         geom::Height height_pixels,
         Pixel color) override;
 
+    auto width(std::string const& text, geom::Height height_pixels) -> geom::Width override;
+
 private:
+    /// A rasterized glyph, kept so that drawing the same text again doesn't go through FreeType
+    struct Glyph
+    {
+        geom::Displacement offset;  ///< From the pen position to the top left of the bitmap
+        geom::Displacement advance;
+        geom::Size size;
+        std::vector<unsigned char> alpha; ///< One coverage value per pixel, with no padding between rows
+    };
+
+    /// There is only the one face, so glyphs are cached by pixel height and code point
+    using GlyphKey = std::pair<int, char32_t>;
+    static size_t const max_cached_glyphs{1024};
+
     std::mutex mutex;
     FT_Library library;
     FT_Face face;
+    std::optional<geom::Height> char_size;
+    std::map<GlyphKey, Glyph> glyphs;
 
+    auto glyph(char32_t code_point, geom::Height height) -> Glyph const&;
     void set_char_size(geom::Height height);
     void rasterize_glyph(char32_t glyph);
     void render_glyph(
         Pixel* buf,
         geom::Size buf_size,
-        FT_Bitmap const* glyph,
+        Glyph const& glyph,
         geom::Point top_left,
         Pixel color);
 
@@ -244,6 +292,11 @@ public:
     {
     }
 
+    auto width(std::string const&, geom::Height) -> geom::Width override
+    {
+        return {};
+    }
+
 private:
 };
 
@@ -318,47 +371,93 @@ void msd::Renderer::Text::Impl::render(
         return;
     }
 
-    try
-    {
-        set_char_size(height_pixels);
-    }
-    catch (std::runtime_error const& error)
+    auto const utf32 = utf8_to_utf32(text);
+
+    for (char32_t const code_point : utf32)
     {
-        log_warning("%s", error.what());
-        return;
+        try
+        {
+            auto const& cached = glyph(code_point, height_pixels);
+            render_glyph(buf, buf_size, cached, top_left + cached.offset, color);
+            top_left += cached.advance;
+        }
+        catch (std::runtime_error const& error)
+        {
+            log_warning("%s", error.what());
+        }
     }
+}
 
-    auto const utf32 = utf8_to_utf32(text);
+auto msd::Renderer::Text::Impl::width(std::string const& text, geom::Height height_pixels) -> geom::Width
+{
+    if (height_pixels <= geom::Height{})
+        return {};
+
+    std::lock_guard lock{mutex};
+
+    if (!library || !face)
+        return {};
 
-    for (char32_t const glyph : utf32)
+    geom::X pen{};
+    geom::X right{};
+    for (char32_t const code_point : utf8_to_utf32(text))
     {
         try
         {
-            rasterize_glyph(glyph);
-
-            geom::Point glyph_top_left =
-                top_left +
-                geom::Displacement{
-                    face->glyph->bitmap_left,
-                    height_pixels.as_int() - face->glyph->bitmap_top};
-            render_glyph(buf, buf_size, &face->glyph->bitmap, glyph_top_left, color);
-
-            top_left += geom::Displacement{
-                face->glyph->advance.x / 64,
-                face->glyph->advance.y / 64};
+            auto const& cached = glyph(code_point, height_pixels);
+            right = std::max(right, pen + cached.offset.dx + as_delta(cached.size.width));
+            pen += cached.advance.dx;
         }
         catch (std::runtime_error const& error)
         {
             log_warning("%s", error.what());
         }
     }
+
+    return as_width(std::max(right, pen));
+}
+
+auto msd::Renderer::Text::Impl::glyph(char32_t code_point, geom::Height height) -> Glyph const&
+{
+    GlyphKey const key{height.as_int(), code_point};
+    if (auto const found = glyphs.find(key); found != glyphs.end())
+        return found->second;
+
+    set_char_size(height);
+    rasterize_glyph(code_point);
+
+    auto const slot = face->glyph;
+    auto const& bitmap = slot->bitmap;
+    Glyph cached{
+        {slot->bitmap_left, height.as_int() - slot->bitmap_top},
+        {slot->advance.x / 64, slot->advance.y / 64},
+        {bitmap.width, bitmap.rows},
+        std::vector<unsigned char>(bitmap.width * bitmap.rows)};
+    for (unsigned row = 0; row < bitmap.rows; row++)
+    {
+        std::memcpy(
+            cached.alpha.data() + row * bitmap.width,
+            bitmap.buffer + static_cast<int>(row) * bitmap.pitch,
+            bitmap.width);
+    }
+
+    // Titles rarely use more than a few hundred glyphs, so starting over is simpler than tracking use
+    if (glyphs.size() >= max_cached_glyphs)
+        glyphs.clear();
+
+    return glyphs.emplace(key, std::move(cached)).first->second;
 }
 
 void msd::Renderer::Text::Impl::set_char_size(geom::Height height)
 {
+    if (char_size == height)
+        return;
+
     if (auto const error = FT_Set_Pixel_Sizes(face, 0, height.as_int()))
         BOOST_THROW_EXCEPTION(std::runtime_error(
             "Setting char size failed with error " + std::to_string(error)));
+
+    char_size = height;
 }
 
 void msd::Renderer::Text::Impl::rasterize_glyph(char32_t glyph)
@@ -377,15 +476,15 @@ void msd::Renderer::Text::Impl::rasterize_glyph(char32_t glyph)
 void msd::Renderer::Text::Impl::render_glyph(
     Pixel* buf,
     geom::Size buf_size,
-    FT_Bitmap const* glyph,
+    Glyph const& glyph,
     geom::Point top_left,
     Pixel color)
 {
     geom::X const buffer_left = std::max(top_left.x, geom::X{});
-    geom::X const buffer_right = std::min(top_left.x + geom::DeltaX{glyph->width}, as_x(buf_size.width));
+    geom::X const buffer_right = std::min(top_left.x + as_delta(glyph.size.width), as_x(buf_size.width));
 
     geom::Y const buffer_top = std::max(top_left.y, geom::Y{});
-    geom::Y const buffer_bottom = std::min(top_left.y + geom::DeltaY{glyph->rows}, as_y(buf_size.height));
+    geom::Y const buffer_bottom = std::min(top_left.y + as_delta(glyph.size.height), as_y(buf_size.height));
 
     geom::Displacement const glyph_offset = as_displacement(top_left);
 
@@ -395,7 +494,7 @@ void msd::Renderer::Text::Impl::render_glyph(
     for (geom::Y buffer_y = buffer_top; buffer_y < buffer_bottom; buffer_y += geom::DeltaY{1})
     {
         geom::Y const glyph_y = buffer_y - glyph_offset.dy;
-        unsigned char* const glyph_row = glyph->buffer + glyph_y.as_int() * glyph->pitch;
+        unsigned char const* const glyph_row = glyph.alpha.data() + glyph_y.as_int() * glyph.size.width.as_int();
         Pixel* const buffer_row = buf + buffer_y.as_int() * buf_size.width.as_int();
 
         for (geom::X buffer_x = buffer_left; buffer_x < buffer_right; buffer_x += geom::DeltaX{1})
@@ -514,6 +613,7 @@ void msd::Renderer::update_state(WindowState const& window_state, InputState con
     if (window_state.window_name() != name)
     {
         name = window_state.window_name();
+        title_layers.clear();
         needs_titlebar_redraw = true;
     }
 
@@ -551,21 +651,17 @@ auto msd::Renderer::render_titlebar() -> std::optional<std::shared_ptr<mg::Buffe
 
     if (needs_titlebar_redraw)
     {
+        auto const& title = title_layer();
+        copy_layer(title, titlebar_pixels.get(), titlebar_size, {});
+
+        // Right of the title is only background
         for (geom::Y y{0}; y < as_y(titlebar_size.height); y += geom::DeltaY{1})
         {
             render_row(
                 titlebar_pixels.get(), titlebar_size,
-                {0, y}, titlebar_size.width,
+                {as_x(title.size.width), y}, titlebar_size.width,
                 current_theme->background_color);
         }
-
-        text->render(
-            titlebar_pixels.get(),
-            titlebar_size,
-            name,
-            static_geometry->title_font_top_left,
-            static_geometry->title_font_height,
-            current_theme->text_color);
     }
 
     if (needs_titlebar_redraw || needs_titlebar_buttons_redraw)
@@ -575,28 +671,11 @@ auto msd::Renderer::render_titlebar() -> std::optional<std::shared_ptr<mg::Buffe
             auto const icon = button_icons.find(button.function);
             if (icon != button_icons.end())
             {
-                Pixel button_color = icon->second.normal_color;
-                if (button.state == ButtonState::Hovered)
-                    button_color = icon->second.active_color;
-                for (geom::Y y{button.rect.top()}; y < button.rect.bottom(); y += geom::DeltaY{1})
-                {
-                    render_row(
-                        titlebar_pixels.get(),
-                        titlebar_size,
-                        {button.rect.left(), y},
-                        button.rect.size.width,
-                        button_color);
-                }
-                geom::Rectangle const icon_rect = {
-                button.rect.top_left + static_geometry->icon_padding, {
-                    button.rect.size.width - static_geometry->icon_padding.dx * 2,
-                    button.rect.size.height - static_geometry->icon_padding.dy * 2}};
-                icon->second.render_icon(
+                copy_layer(
+                    button_layer(button, icon->second),
                     titlebar_pixels.get(),
                     titlebar_size,
-                    icon_rect,
-                    static_geometry->icon_line_width,
-                    icon->second.icon_color);
+                    button.rect.top_left);
             }
             else
             {
@@ -645,15 +724,96 @@ void msd::Renderer::update_solid_color_pixels()
 
     if (needs_solid_color_redraw)
     {
-        render_row(
-            solid_color_pixels.get(), geom::Size{solid_color_pixels_length, 1},
-            geom::Point{}, geom::Width{solid_color_pixels_length},
-            current_theme->background_color);
+        fill_pixels(solid_color_pixels.get(), solid_color_pixels_length, current_theme->background_color);
     }
 
     needs_solid_color_redraw = false;
 }
 
+auto msd::Renderer::title_layer() -> Layer const&
+{
+    auto const found = title_layers.find(current_theme);
+    if (found != title_layers.end() && found->second.size.height == titlebar_size.height)
+        return found->second;
+
+    auto const title_right =
+        static_geometry->title_font_top_left.x +
+        as_delta(text->width(name, static_geometry->title_font_height));
+    geom::Size const size{std::max(title_right, geom::X{}).as_int(), titlebar_size.height};
+
+    Layer layer{size, alloc_pixels(size)};
+    if (layer.pixels)
+    {
+        fill_pixels(layer.pixels.get(), area(size), current_theme->background_color);
+        text->render(
+            layer.pixels.get(),
+            size,
+            name,
+            static_geometry->title_font_top_left,
+            static_geometry->title_font_height,
+            current_theme->text_color);
+    }
+
+    return title_layers.insert_or_assign(current_theme, std::move(layer)).first->second;
+}
+
+auto msd::Renderer::button_layer(ButtonInfo const& button, Icon const& icon) -> Layer const&
+{
+    bool const hovered = button.state == ButtonState::Hovered;
+    auto const key = std::make_tuple(
+        button.function,
+        hovered,
+        button.rect.size.width.as_int(),
+        button.rect.size.height.as_int());
+    if (auto const found = button_layers.find(key); found != button_layers.end())
+        return found->second;
+
+    // Each button size stays the same for as long as the static geometry does
+    if (button_layers.size() >= 2 * button_icons.size())
+        button_layers.clear();
+
+    Layer layer{button.rect.size, alloc_pixels(button.rect.size)};
+    if (layer.pixels)
+    {
+        fill_pixels(layer.pixels.get(), area(layer.size), hovered ? icon.active_color : icon.normal_color);
+        geom::Rectangle const icon_rect = {
+            geom::Point{} + static_geometry->icon_padding, {
+                button.rect.size.width - static_geometry->icon_padding.dx * 2,
+                button.rect.size.height - static_geometry->icon_padding.dy * 2}};
+        icon.render_icon(
+            layer.pixels.get(),
+            layer.size,
+            icon_rect,
+            static_geometry->icon_line_width,
+            icon.icon_color);
+    }
+
+    return button_layers.emplace(key, std::move(layer)).first->second;
+}
+
+void msd::Renderer::copy_layer(Layer const& layer, Pixel* buf, geom::Size buf_size, geom::Point top_left)
+{
+    if (!layer.pixels)
+        return;
+
+    geom::X const left = std::max(top_left.x, geom::X{});
+    geom::X const right = std::min(top_left.x + as_delta(layer.size.width), as_x(buf_size.width));
+    geom::Y const top = std::max(top_left.y, geom::Y{});
+    geom::Y const bottom = std::min(top_left.y + as_delta(layer.size.height), as_y(buf_size.height));
+    if (right <= left)
+        return;
+
+    for (geom::Y y = top; y < bottom; y += geom::DeltaY{1})
+    {
+        std::memcpy(
+            buf + y.as_int() * buf_size.width.as_int() + left.as_int(),
+            layer.pixels.get() +
+                (y - top_left.y).as_int() * layer.size.width.as_int() +
+                (left - top_left.x).as_int(),
+            (right - left).as_int() * sizeof(Pixel));
+    }
+}
+
 auto msd::Renderer::make_buffer(
     uint32_t const* pixels,
     geometry::Size size) -> std::optional<std::shared_ptr<mg::Buffer>>
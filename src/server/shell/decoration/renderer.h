@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <map>
+#include <tuple>
 
 namespace mir
 {
@@ -73,6 +74,9 @@ private:
             geometry::Height height_pixels,
             Pixel color) = 0;
 
+        /// How far right of where it starts the text reaches when rendered
+        virtual auto width(std::string const& text, geometry::Height height_pixels) -> geometry::Width = 0;
+
     private:
         class Impl;
         class Null;
@@ -103,6 +107,13 @@ private:
             Pixel color)> const render_icon; ///< Draws button's icon to the given buffer
     };
 
+    /// Pixels drawn once and copied into place whenever the titlebar is redrawn
+    struct Layer
+    {
+        geometry::Size size;
+        std::unique_ptr<Pixel[]> pixels; // can be nullptr
+    };
+
     std::shared_ptr<graphics::GraphicBufferAllocator> buffer_allocator;
     Theme const focused_theme;
     Theme const unfocused_theme;
@@ -125,9 +136,17 @@ private:
     std::string name;
     std::vector<ButtonInfo> buttons;
 
+    /// The titlebar background and window title in each theme, only as wide as the title
+    std::map<Theme const*, Layer> title_layers;
+    /// Buttons by function, whether they're hovered and their width and height
+    std::map<std::tuple<ButtonFunction, bool, int, int>, Layer> button_layers;
+
     std::shared_ptr<Text> const text;
 
     void update_solid_color_pixels();
+    auto title_layer() -> Layer const&;
+    auto button_layer(ButtonInfo const& button, Icon const& icon) -> Layer const&;
+    static void copy_layer(Layer const& layer, Pixel* buf, geometry::Size buf_size, geometry::Point top_left);
     auto make_buffer(
         Pixel const* pixels,
         geometry::Size size) -> std::optional<std::shared_ptr<graphics::Buffer>>;
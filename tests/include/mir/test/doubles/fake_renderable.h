@@ -98,11 +98,22 @@ public:
         return std::optional<geometry::Rectangle>();
     }
 
+    std::optional<geometry::Rectangles> opaque_region() const override
+    {
+        return opaque;
+    }
+
+    void set_opaque_region(geometry::Rectangles const& region)
+    {
+        opaque = region;
+    }
+
 private:
     std::shared_ptr<graphics::Buffer> buf;
     mir::geometry::Rectangle rect;
     float opacity;
     bool rectangular;
+    std::optional<geometry::Rectangles> opaque;
 };
 
 } // namespace doubles
@@ -44,6 +44,14 @@ public:
     MOCK_METHOD0(started, void());
     MOCK_METHOD0(stopped, void());
     MOCK_METHOD0(scheduled, void());
+    MOCK_METHOD2(began_stage,
+                 void(compositor::CompositorReport::SubCompositorId, compositor::CompositorReport::FrameStage));
+    MOCK_METHOD2(finished_stage,
+                 void(compositor::CompositorReport::SubCompositorId, compositor::CompositorReport::FrameStage));
+    MOCK_METHOD1(traced_input_committed, void(uint64_t));
+    MOCK_METHOD1(traced_input_composited, void(uint64_t));
+    MOCK_METHOD1(traced_input_discarded, void(uint64_t));
+    MOCK_METHOD3(traced_input_presented, void(uint64_t, int64_t, int64_t));
 };
 
 } // namespace doubles
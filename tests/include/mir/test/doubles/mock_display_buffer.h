@@ -39,9 +39,16 @@ public:
             .WillByDefault(Return(geometry::Rectangle{{0,0},{0,0}}));
         ON_CALL(*this, native_display_buffer())
             .WillByDefault(Return(this));
+        ON_CALL(*this, assign_planes(_))
+            .WillByDefault(Invoke(
+                [this](graphics::RenderableList const& renderlist)
+                {
+                    return graphics::DisplayBuffer::assign_planes(renderlist);
+                }));
     }
     MOCK_CONST_METHOD0(view_area, geometry::Rectangle());
     MOCK_METHOD1(overlay, bool(graphics::RenderableList const&));
+    MOCK_METHOD1(assign_planes, std::optional<graphics::RenderableList>(graphics::RenderableList const&));
     MOCK_CONST_METHOD0(transformation, glm::mat2());
     MOCK_METHOD0(native_display_buffer, graphics::NativeDisplayBuffer*());
 };
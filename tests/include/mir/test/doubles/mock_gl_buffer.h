@@ -38,6 +38,7 @@ public:
     MOCK_METHOD(graphics::gl::Program const&, shader, (graphics::gl::ProgramFactory&), (const override));
     MOCK_METHOD(Layout, layout, (), (const override));
     MOCK_METHOD(void, bind, (), (override));
+    MOCK_METHOD(void, prepare, (), (override));
     MOCK_METHOD(void, add_syncpoint, (), (override));
 };
 }
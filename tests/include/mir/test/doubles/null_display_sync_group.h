@@ -18,6 +18,7 @@
 #define MIR_TEST_DOUBLES_NULL_DISPLAY_SYNC_GROUP_H_
 
 #include "mir/graphics/display.h"
+#include "mir/graphics/frame.h"
 #include "mir/geometry/size.h"
 #include "mir/test/doubles/stub_gl_display_buffer.h"
 #include <thread>
@@ -50,6 +51,10 @@ public:
     {
         /* yield() is needed to ensure reasonable runtime under valgrind for some tests */
         std::this_thread::yield();
+
+        // Presented as soon as it's posted, timed by software
+        frame.msc++;
+        frame.ust = time::PosixTimestamp::now(CLOCK_MONOTONIC);
     }
 
     std::chrono::milliseconds recommended_sleep() const override
@@ -57,9 +62,18 @@ public:
         return std::chrono::milliseconds::zero();
     }
 
+    auto last_frame() const -> std::optional<graphics::Frame> override
+    {
+        if (frame.msc == 0)
+            return std::nullopt;
+
+        return frame;
+    }
+
 private:
     std::vector<geometry::Rectangle> const output_rects;
     std::vector<StubGLDisplayBuffer> display_buffers;
+    graphics::Frame frame;
 };
 
 struct NullDisplaySyncGroup : graphics::DisplaySyncGroup
@@ -589,6 +589,26 @@ drmModePropertyPtr drmModeGetProperty(int fd, uint32_t propertyId)
     return global_mock->drmModeGetProperty(fd, propertyId);
 }
 
+drmModePropertyBlobPtr drmModeGetPropertyBlob(int fd, uint32_t blob_id)
+{
+    return global_mock->drmModeGetPropertyBlob(fd, blob_id);
+}
+
+void drmModeFreePropertyBlob(drmModePropertyBlobPtr ptr)
+{
+    global_mock->drmModeFreePropertyBlob(ptr);
+}
+
+int drmModeCreatePropertyBlob(int fd, void const* data, size_t size, uint32_t* id)
+{
+    return global_mock->drmModeCreatePropertyBlob(fd, data, size, id);
+}
+
+int drmModeDestroyPropertyBlob(int fd, uint32_t id)
+{
+    return global_mock->drmModeDestroyPropertyBlob(fd, id);
+}
+
 int drmModeConnectorSetProperty(int fd, uint32_t connector_id, uint32_t property_id, uint64_t value)
 {
     return global_mock->drmModeConnectorSetProperty(fd, connector_id, property_id, value);
@@ -672,6 +692,11 @@ int drmModePageFlip(int fd, uint32_t crtc_id, uint32_t fb_id,
                                         flags, user_data);
 }
 
+int drmModeAtomicCommit(int fd, drmModeAtomicReqPtr req, uint32_t flags, void* user_data)
+{
+    return global_mock->drmModeAtomicCommit(fd, req, flags, user_data);
+}
+
 int drmHandleEvent(int fd, drmEventContextPtr evctx)
 {
     return global_mock->drmHandleEvent(fd, evctx);
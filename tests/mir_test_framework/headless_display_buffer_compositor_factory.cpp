@@ -83,14 +83,14 @@ mtf::HeadlessDisplayBufferCompositorFactory::create_compositor_for(mg::DisplayBu
             return renderables;
         }
 
-        void composite(mir::compositor::SceneElementSequence&& seq) override
+        bool composite(mir::compositor::SceneElementSequence&& seq) override
         {
             auto renderlist = filter(seq, db.view_area());
             if (db.overlay(renderlist))
             {
                 if (tracker)
                     tracker->note_passthrough();
-                return;
+                return true;
             }
 
             // Invoke GL renderer specific functions if the DisplayBuffer supports them
@@ -110,6 +110,7 @@ mtf::HeadlessDisplayBufferCompositorFactory::create_compositor_for(mg::DisplayBu
 
             if (render_target)
                 render_target->swap_buffers();
+            return true;
         }
         mg::DisplayBuffer& db;
         std::shared_ptr<PassthroughTracker> const tracker;
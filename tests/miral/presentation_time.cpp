@@ -0,0 +1,387 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <miral/test_server.h>
+#include "presentation_time.h"
+
+#include <miral/internal_client.h>
+
+#include <wayland-client.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+template<typename Type>
+auto make_scoped(Type* owned, void(*deleter)(Type*)) -> std::unique_ptr<Type, void(*)(Type*)>
+{
+    return {owned, deleter};
+}
+
+struct Presented
+{
+    std::chrono::nanoseconds timestamp;
+    std::chrono::nanoseconds refresh;
+    uint64_t msc;
+    uint32_t flags;
+};
+
+/// A wl_shell client with a single window that asks for presentation feedback
+class PresentationClient
+{
+public:
+    static int const width = 64;
+    static int const height = 48;
+
+    explicit PresentationClient(wl_display* display)
+        : display{display},
+          registry{wl_display_get_registry(display), &wl_registry_destroy}
+    {
+        wl_registry_add_listener(registry.get(), &registry_listener, this);
+        wl_display_roundtrip(display);
+        wl_display_roundtrip(display);
+    }
+
+    ~PresentationClient()
+    {
+        if (feedback) wp_presentation_feedback_destroy(feedback);
+        if (buffer) wl_buffer_destroy(buffer);
+        if (shell_surface) wl_shell_surface_destroy(shell_surface);
+        if (surface) wl_surface_destroy(surface);
+        if (presentation) wp_presentation_destroy(presentation);
+        if (shell) wl_shell_destroy(shell);
+        if (shm) wl_shm_destroy(shm);
+        if (compositor) wl_compositor_destroy(compositor);
+    }
+
+    void create_window()
+    {
+        surface = wl_compositor_create_surface(compositor);
+        shell_surface = wl_shell_get_shell_surface(shell, surface);
+        wl_shell_surface_set_toplevel(shell_surface);
+        wl_display_roundtrip(display);
+    }
+
+    void attach_buffer()
+    {
+        auto const stride = width * 4;
+        auto const size = stride * height;
+
+        auto const fd = memfd_create("presentation-time-test", MFD_CLOEXEC);
+        ASSERT_THAT(fd, Ge(0));
+        ASSERT_THAT(ftruncate(fd, size), Eq(0));
+
+        auto const pixels = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ASSERT_THAT(pixels, Ne(MAP_FAILED));
+        memset(pixels, 0xff, size);
+        munmap(pixels, size);
+
+        auto const pool = make_scoped(wl_shm_create_pool(shm, fd, size), &wl_shm_pool_destroy);
+        buffer = wl_shm_pool_create_buffer(pool.get(), 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+        close(fd);
+
+        wl_surface_attach(surface, buffer, 0, 0);
+        wl_surface_damage(surface, 0, 0, width, height);
+    }
+
+    void request_feedback()
+    {
+        feedback = wp_presentation_feedback(presentation, surface);
+        wp_presentation_feedback_add_listener(feedback, &feedback_listener, this);
+    }
+
+    /// Dispatch events until the feedback has been presented or discarded, or timeout elapses
+    void wait_for_feedback(std::chrono::milliseconds timeout = 5s)
+    {
+        auto const deadline = std::chrono::steady_clock::now() + timeout;
+        while (!presented && !discarded && std::chrono::steady_clock::now() < deadline)
+        {
+            if (wl_display_roundtrip(display) == -1)
+                break;
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    wl_display* const display;
+    wl_compositor* compositor = nullptr;
+    wl_shm* shm = nullptr;
+    wl_shell* shell = nullptr;
+    wp_presentation* presentation = nullptr;
+
+    wl_surface* surface = nullptr;
+    wl_shell_surface* shell_surface = nullptr;
+    wl_buffer* buffer = nullptr;
+    wp_presentation_feedback* feedback = nullptr;
+
+    std::optional<uint32_t> clock_id;
+    std::optional<Presented> presented;
+    bool discarded = false;
+
+private:
+    static void new_global(
+        void* data,
+        struct wl_registry* registry,
+        uint32_t id,
+        char const* interface,
+        uint32_t /*version*/)
+    {
+        auto const self = static_cast<PresentationClient*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+        {
+            self->compositor = static_cast<wl_compositor*>(wl_registry_bind(registry, id, &wl_compositor_interface, 1));
+        }
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+        {
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        }
+        else if (strcmp(interface, wl_shell_interface.name) == 0)
+        {
+            self->shell = static_cast<wl_shell*>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
+        }
+        else if (strcmp(interface, wp_presentation_interface.name) == 0)
+        {
+            self->presentation = static_cast<wp_presentation*>(
+                wl_registry_bind(registry, id, &wp_presentation_interface, 1));
+            wp_presentation_add_listener(self->presentation, &presentation_listener, self);
+        }
+    }
+
+    static void global_remove(void* /*data*/, struct wl_registry* /*registry*/, uint32_t /*name*/)
+    {
+    }
+
+    static void clock_id_event(void* data, struct wp_presentation* /*presentation*/, uint32_t clk_id)
+    {
+        static_cast<PresentationClient*>(data)->clock_id = clk_id;
+    }
+
+    static void sync_output(void* /*data*/, struct wp_presentation_feedback* /*feedback*/, struct wl_output* /*output*/)
+    {
+    }
+
+    static void presented_event(
+        void* data,
+        struct wp_presentation_feedback* feedback,
+        uint32_t tv_sec_hi,
+        uint32_t tv_sec_lo,
+        uint32_t tv_nsec,
+        uint32_t refresh,
+        uint32_t seq_hi,
+        uint32_t seq_lo,
+        uint32_t flags)
+    {
+        auto const self = static_cast<PresentationClient*>(data);
+        auto const seconds = (uint64_t{tv_sec_hi} << 32) | tv_sec_lo;
+
+        self->presented = Presented{
+            std::chrono::seconds{static_cast<int64_t>(seconds)} + std::chrono::nanoseconds{tv_nsec},
+            std::chrono::nanoseconds{refresh},
+            (uint64_t{seq_hi} << 32) | seq_lo,
+            flags};
+
+        wp_presentation_feedback_destroy(feedback);
+        self->feedback = nullptr;
+    }
+
+    static void discarded_event(void* data, struct wp_presentation_feedback* feedback)
+    {
+        auto const self = static_cast<PresentationClient*>(data);
+        self->discarded = true;
+
+        wp_presentation_feedback_destroy(feedback);
+        self->feedback = nullptr;
+    }
+
+    static wl_registry_listener constexpr registry_listener = {new_global, global_remove};
+    static wp_presentation_listener constexpr presentation_listener = {clock_id_event};
+    static wp_presentation_feedback_listener constexpr feedback_listener = {sync_output, presented_event, discarded_event};
+
+    std::unique_ptr<wl_registry, void(*)(wl_registry*)> const registry;
+};
+
+wl_registry_listener constexpr PresentationClient::registry_listener;
+wp_presentation_listener constexpr PresentationClient::presentation_listener;
+wp_presentation_feedback_listener constexpr PresentationClient::feedback_listener;
+
+struct PresentationTime : miral::TestServer
+{
+    PresentationTime()
+    {
+        add_server_init(launcher);
+    }
+
+    void run_as_client(std::function<void(PresentationClient&)>&& code)
+    {
+        bool client_run = false;
+        std::condition_variable cv;
+        std::mutex mutex;
+
+        auto const client = [&](wl_display* display)
+            {
+                {
+                    std::lock_guard lock{mutex};
+                    PresentationClient presentation_client{display};
+                    code(presentation_client);
+                    client_run = true;
+                }
+                cv.notify_one();
+            };
+
+        std::unique_lock lock{mutex};
+        launcher.launch(client);
+        cv.wait(lock, [&]{ return client_run; });
+    }
+
+private:
+    miral::InternalClientLauncher launcher;
+};
+
+auto now() -> std::chrono::nanoseconds
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+}
+
+TEST_F(PresentationTime, presentation_clock_is_monotonic)
+{
+    run_as_client([](PresentationClient& client)
+        {
+            ASSERT_THAT(client.presentation, NotNull());
+            EXPECT_THAT(client.clock_id, Eq(std::make_optional<uint32_t>(CLOCK_MONOTONIC)));
+        });
+}
+
+TEST_F(PresentationTime, committed_buffer_is_presented)
+{
+    run_as_client([](PresentationClient& client)
+        {
+            ASSERT_THAT(client.presentation, NotNull());
+            client.create_window();
+
+            auto const committed = now();
+            client.attach_buffer();
+            client.request_feedback();
+            wl_surface_commit(client.surface);
+            client.wait_for_feedback();
+
+            ASSERT_THAT(client.presented, Ne(std::nullopt));
+            EXPECT_THAT(client.discarded, Eq(false));
+            EXPECT_THAT(client.presented->timestamp, Gt(committed));
+            EXPECT_THAT(client.presented->timestamp, Le(now()));
+            EXPECT_THAT(client.presented->msc, Gt(0u));
+        });
+}
+
+TEST_F(PresentationTime, successive_presentations_have_increasing_msc)
+{
+    run_as_client([](PresentationClient& client)
+        {
+            ASSERT_THAT(client.presentation, NotNull());
+            client.create_window();
+
+            client.attach_buffer();
+            client.request_feedback();
+            wl_surface_commit(client.surface);
+            client.wait_for_feedback();
+            ASSERT_THAT(client.presented, Ne(std::nullopt));
+            auto const first = *client.presented;
+
+            wl_buffer_destroy(client.buffer);
+            client.presented = std::nullopt;
+            client.attach_buffer();
+            client.request_feedback();
+            wl_surface_commit(client.surface);
+            client.wait_for_feedback();
+
+            ASSERT_THAT(client.presented, Ne(std::nullopt));
+            EXPECT_THAT(client.presented->msc, Gt(first.msc));
+            EXPECT_THAT(client.presented->timestamp, Gt(first.timestamp));
+        });
+}
+
+TEST_F(PresentationTime, commit_of_null_buffer_is_discarded)
+{
+    run_as_client([](PresentationClient& client)
+        {
+            ASSERT_THAT(client.presentation, NotNull());
+            client.create_window();
+
+            wl_surface_attach(client.surface, nullptr, 0, 0);
+            client.request_feedback();
+            wl_surface_commit(client.surface);
+            client.wait_for_feedback();
+
+            EXPECT_THAT(client.discarded, Eq(true));
+            EXPECT_THAT(client.presented, Eq(std::nullopt));
+        });
+}
+
+TEST_F(PresentationTime, commit_without_buffer_is_discarded)
+{
+    run_as_client([](PresentationClient& client)
+        {
+            ASSERT_THAT(client.presentation, NotNull());
+            client.create_window();
+
+            client.attach_buffer();
+            wl_surface_commit(client.surface);
+
+            client.request_feedback();
+            wl_surface_commit(client.surface);
+            client.wait_for_feedback();
+
+            EXPECT_THAT(client.discarded, Eq(true));
+            EXPECT_THAT(client.presented, Eq(std::nullopt));
+        });
+}
+
+TEST_F(PresentationTime, feedback_is_discarded_when_surface_is_destroyed)
+{
+    run_as_client([](PresentationClient& client)
+        {
+            ASSERT_THAT(client.presentation, NotNull());
+            client.create_window();
+
+            client.request_feedback();
+            wl_shell_surface_destroy(client.shell_surface);
+            client.shell_surface = nullptr;
+            wl_surface_destroy(client.surface);
+            client.surface = nullptr;
+            client.wait_for_feedback();
+
+            EXPECT_THAT(client.discarded, Eq(true));
+            EXPECT_THAT(client.presented, Eq(std::nullopt));
+        });
+}
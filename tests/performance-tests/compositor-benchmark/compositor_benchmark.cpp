@@ -0,0 +1,352 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compositor_probe.h"
+#include "statistics.h"
+#include "synthetic_client.h"
+
+#include "mir_test_framework/executable_path.h"
+#include "mir_test_framework/fake_input_device.h"
+#include "mir_test_framework/stub_server_platform_factory.h"
+#include "mir/test/event_factory.h"
+
+#include "mir/input/input_device_info.h"
+#include "mir/scene/surface.h"
+#include "mir/server.h"
+#include "mir/shell/focus_controller.h"
+
+#include <miral/minimal_window_manager.h>
+#include <miral/runner.h>
+#include <miral/set_window_management_policy.h>
+
+#include <boost/program_options.hpp>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace mb = mir::benchmark;
+namespace geom = mir::geometry;
+namespace mi = mir::input;
+namespace mis = mir::input::synthesis;
+namespace mtf = mir_test_framework;
+namespace po = boost::program_options;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct BenchmarkOptions
+{
+    std::string output;
+    bool vsync;
+    int clients;
+    mb::ClientOptions client;
+    double input_rate;
+    std::chrono::duration<double> warmup;
+    std::chrono::duration<double> duration;
+    std::string json;
+};
+
+auto parse_size(std::string const& size) -> geom::Size
+{
+    int width, height;
+    char trailing;
+    if (sscanf(size.c_str(), "%dx%d%c", &width, &height, &trailing) != 2 || width <= 0 || height <= 0)
+        throw po::error{"\"" + size + "\" is not a size of the form WIDTHxHEIGHT"};
+    return {width, height};
+}
+
+/// Returns nullopt if the benchmark shouldn't run (after --help)
+auto parse_options(int argc, char const* argv[]) -> std::optional<BenchmarkOptions>
+{
+    std::string client_size;
+    double duration, warmup;
+    BenchmarkOptions options;
+
+    po::options_description description{
+        "Runs a Mir server on virtual outputs, with synthetic wl_shm clients, and reports how it performs as JSON.\n"
+        "Options"};
+    description.add_options()
+        ("help", "Show this help")
+        ("output", po::value(&options.output)->default_value("1920x1080@60"),
+            "Virtual outputs to composite to, as for --virtual-output")
+        ("vsync", po::value(&options.vsync)->default_value(true),
+            "Present at the outputs' refresh rate. When false, the compositor runs flat out")
+        ("clients", po::value(&options.clients)->default_value(4), "Number of clients")
+        ("client-size", po::value(&client_size)->default_value("640x480"), "Size of each client's window")
+        ("update-rate", po::value(&options.client.update_rate)->default_value(60.0),
+            "Frames per second each client commits. 0 commits a new frame as each is presented")
+        ("subsurfaces", po::value(&options.client.subsurfaces)->default_value(0),
+            "Number of subsurfaces on each client's window")
+        ("alpha", po::bool_switch(&options.client.alpha), "Clients draw translucent rather than opaque windows")
+        ("input-rate", po::value(&options.input_rate)->default_value(10.0),
+            "Pointer motions per second to inject, to measure input-to-commit latency. 0 injects none")
+        ("warmup", po::value(&warmup)->default_value(2.0), "Seconds to run before measuring")
+        ("duration", po::value(&duration)->default_value(10.0), "Seconds to measure for")
+        ("json", po::value(&options.json)->default_value("-"), "File to write results to (- for stdout)");
+
+    try
+    {
+        po::variables_map variables;
+        po::store(po::parse_command_line(argc, argv, description), variables);
+
+        if (variables.count("help"))
+        {
+            std::cout << description << std::endl;
+            return std::nullopt;
+        }
+
+        po::notify(variables);
+        options.client.size = parse_size(client_size);
+        if (options.clients < 1 || options.client.subsurfaces < 0 || duration <= 0 || warmup < 0)
+            throw po::error{"--clients must be at least 1, --duration positive and the rest non-negative"};
+    }
+    catch (po::error const& error)
+    {
+        std::ostringstream message;
+        message << error.what() << "\n\n" << description;
+        throw std::runtime_error{message.str()};
+    }
+
+    options.duration = std::chrono::duration<double>{duration};
+    options.warmup = std::chrono::duration<double>{warmup};
+    return options;
+}
+
+/// A Mir server on the virtual platform, running on a thread of its own
+class BenchmarkServer
+{
+public:
+    BenchmarkServer(mb::Statistics& statistics)
+    {
+        runner.add_start_callback([this]
+            {
+                std::lock_guard lock{mutex};
+                started = true;
+                changed.notify_all();
+            });
+
+        thread = std::thread{[this, &statistics]
+            {
+                runner.run_with({
+                    miral::set_window_management_policy<miral::MinimalWindowManager>(),
+                    [this, &statistics](mir::Server& server)
+                    {
+                        server.wrap_display_buffer_compositor_factory([&statistics](auto const& wrapped)
+                            {
+                                return std::make_shared<mb::ProbedCompositorFactory>(wrapped, statistics);
+                            });
+                        the_server = &server;
+                    }});
+
+                std::lock_guard lock{mutex};
+                exited = true;
+                changed.notify_all();
+            }};
+
+        std::unique_lock lock{mutex};
+        if (!changed.wait_for(lock, 30s, [this] { return started || exited; }) || !started)
+        {
+            lock.unlock();
+            stop();
+            throw std::runtime_error{"Server failed to start"};
+        }
+    }
+
+    ~BenchmarkServer()
+    {
+        stop();
+    }
+
+    /// Where the focused window is, if there is one
+    auto focused_window() const -> std::optional<geom::Rectangle>
+    {
+        if (auto const surface = the_server->the_focus_controller()->focused_surface())
+            return surface->input_bounds();
+        return std::nullopt;
+    }
+
+private:
+    void stop()
+    {
+        if (thread.joinable())
+        {
+            runner.stop();
+            thread.join();
+        }
+    }
+
+    static char const* argv[];
+    miral::MirRunner runner{1, argv};
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool started{false};
+    bool exited{false};
+    mir::Server* the_server{nullptr};
+    std::thread thread;
+};
+
+char const* BenchmarkServer::argv[] = {"mir_compositor_benchmark", nullptr};
+
+void configure_environment(BenchmarkOptions const& options, std::string const& wayland_display)
+{
+    // Server options are read from MIR_SERVER_* when there's no command line for them
+    setenv("MIR_SERVER_PLATFORM_PATH", mtf::server_platform_path().c_str(), true);
+    setenv("MIR_SERVER_PLATFORM_DISPLAY_LIBS", "mir:virtual", true);
+    setenv("MIR_SERVER_PLATFORM_RENDERING_LIBS", "mir:egl-generic", true);
+    setenv("MIR_SERVER_PLATFORM_INPUT_LIB", mtf::server_platform("input-stub.so").c_str(), true);
+    setenv("MIR_SERVER_VIRTUAL_OUTPUT", options.output.c_str(), true);
+    setenv("MIR_SERVER_VIRTUAL_VSYNC", options.vsync ? "true" : "false", true);
+    setenv("MIR_SERVER_CONSOLE_PROVIDER", "none", true);
+    setenv("MIR_SERVER_ENABLE_KEY_REPEAT", "false", true);
+    setenv("WAYLAND_DISPLAY", wayland_display.c_str(), true);
+}
+
+void write_results(std::ostream& out, BenchmarkOptions const& options, mb::Statistics const& statistics)
+{
+    auto const& client = options.client;
+    out << "{\n"
+        << "  \"config\": {\"output\": \"" << options.output << "\""
+        << ", \"vsync\": " << std::boolalpha << options.vsync
+        << ", \"clients\": " << options.clients
+        << ", \"client_size\": \"" << client.size.width << "x" << client.size.height << "\""
+        << ", \"update_rate\": " << client.update_rate
+        << ", \"subsurfaces\": " << client.subsurfaces
+        << ", \"alpha\": " << client.alpha
+        << ", \"buffer\": \"shm\""
+        << ", \"input_rate\": " << options.input_rate
+        << ", \"warmup_s\": " << options.warmup.count()
+        << ", \"duration_s\": " << options.duration.count() << "},\n";
+    statistics.write_json(out);
+    out << "\n}" << std::endl;
+}
+
+auto wait_for(std::function<bool()> const& condition, std::chrono::seconds timeout) -> bool
+{
+    auto const deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(10ms);
+    }
+    return true;
+}
+}
+
+int main(int argc, char const* argv[])
+try
+{
+    auto const options = parse_options(argc, argv);
+    if (!options)
+        return EXIT_SUCCESS;
+
+    auto const wayland_display = "mir-compositor-benchmark-" + std::to_string(getpid());
+    configure_environment(*options, wayland_display);
+
+    mb::Statistics statistics;
+
+    // Fake devices are picked up by the stub input platform when the server starts
+    auto const pointer = mtf::add_fake_input_device(
+        mi::InputDeviceInfo{"mouse", "mir-compositor-benchmark-mouse", mi::DeviceCapability::pointer});
+
+    BenchmarkServer server{statistics};
+
+    std::vector<std::unique_ptr<mb::SyntheticClient>> clients;
+    for (int i = 0; i != options->clients; ++i)
+    {
+        clients.push_back(std::make_unique<mb::SyntheticClient>(wayland_display, options->client, statistics));
+    }
+
+    auto const all_mapped = wait_for(
+        [&]
+        {
+            return std::all_of(clients.begin(), clients.end(), [](auto const& c) { return c->mapped() || c->failed(); });
+        },
+        30s);
+    if (!all_mapped || std::any_of(clients.begin(), clients.end(), [](auto const& c) { return c->failed(); }))
+    {
+        std::cerr << "mir_compositor_benchmark: not all clients could connect and map a window" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The pointer starts at the origin: move it to the middle of the focused (topmost) window
+    if (auto const window = server.focused_window())
+    {
+        pointer->emit_event(mis::a_pointer_event().with_movement(
+            window->top_left.x.as_int() + window->size.width.as_int() / 2,
+            window->top_left.y.as_int() + window->size.height.as_int() / 2));
+    }
+    else if (options->input_rate > 0)
+    {
+        std::cerr << "mir_compositor_benchmark: no focused window, so input will be missed" << std::endl;
+    }
+
+    std::this_thread::sleep_for(options->warmup);
+
+    statistics.start();
+    auto const end = std::chrono::steady_clock::now() + options->duration;
+    if (options->input_rate > 0)
+    {
+        auto const interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>{1.0 / options->input_rate});
+        int direction = 1;
+        for (auto next = std::chrono::steady_clock::now(); next < end; next += interval)
+        {
+            std::this_thread::sleep_until(next);
+            statistics.input_injected(mb::now());
+            pointer->emit_event(mis::a_pointer_event().with_movement(direction, 0));
+            direction = -direction;
+        }
+    }
+    std::this_thread::sleep_until(end);
+    statistics.stop();
+
+    clients.clear();
+
+    if (options->json == "-")
+    {
+        write_results(std::cout, *options, statistics);
+    }
+    else
+    {
+        std::ofstream out{options->json};
+        write_results(out, *options, statistics);
+        if (!out)
+        {
+            std::cerr << "mir_compositor_benchmark: failed to write " << options->json << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "mir_compositor_benchmark: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
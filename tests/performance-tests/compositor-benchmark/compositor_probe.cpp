@@ -0,0 +1,106 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compositor_probe.h"
+#include "statistics.h"
+
+#include "mir/compositor/display_buffer_compositor.h"
+
+#include <cstdlib>
+#include <new>
+
+#include <time.h>
+
+namespace mb = mir::benchmark;
+namespace mc = mir::compositor;
+
+namespace
+{
+thread_local uint64_t thread_allocations{0};
+}
+
+// Count the heap allocations made by each thread
+void* operator new(std::size_t size)
+{
+    ++thread_allocations;
+    if (auto const p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+auto thread_cpu_time() -> std::chrono::nanoseconds
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+class ProbedCompositor : public mc::DisplayBufferCompositor
+{
+public:
+    ProbedCompositor(std::unique_ptr<mc::DisplayBufferCompositor> wrapped, mb::Statistics& statistics)
+        : wrapped{std::move(wrapped)},
+          statistics{statistics}
+    {
+    }
+
+    bool composite(mc::SceneElementSequence&& scene_sequence) override
+    {
+        auto const allocations_before = thread_allocations;
+        auto const cpu_before = thread_cpu_time();
+        auto const wall_before = mb::now();
+
+        auto const posted = wrapped->composite(std::move(scene_sequence));
+
+        auto const wall_time = mb::now() - wall_before;
+        auto const cpu_time = thread_cpu_time() - cpu_before;
+        auto const allocations = thread_allocations - allocations_before;
+
+        statistics.record_composite(cpu_time, wall_time, allocations, posted);
+        return posted;
+    }
+
+private:
+    std::unique_ptr<mc::DisplayBufferCompositor> const wrapped;
+    mb::Statistics& statistics;
+};
+}
+
+mb::ProbedCompositorFactory::ProbedCompositorFactory(
+    std::shared_ptr<mc::DisplayBufferCompositorFactory> const& wrapped,
+    Statistics& statistics)
+    : wrapped{wrapped},
+      statistics{statistics}
+{
+}
+
+auto mb::ProbedCompositorFactory::create_compositor_for(graphics::DisplayBuffer& display_buffer)
+    -> std::unique_ptr<mc::DisplayBufferCompositor>
+{
+    return std::make_unique<ProbedCompositor>(wrapped->create_compositor_for(display_buffer), statistics);
+}
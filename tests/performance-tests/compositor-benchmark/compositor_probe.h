@@ -0,0 +1,53 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_COMPOSITOR_PROBE_H_
+#define MIR_BENCHMARK_COMPOSITOR_PROBE_H_
+
+#include "mir/compositor/display_buffer_compositor_factory.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace benchmark
+{
+class Statistics;
+
+/**
+ * Wraps the server's display buffer compositors to time each frame
+ *
+ * Each composite() is measured in CPU time of the compositor thread, in wall time, and in
+ * heap allocations made by the thread.
+ */
+class ProbedCompositorFactory : public compositor::DisplayBufferCompositorFactory
+{
+public:
+    ProbedCompositorFactory(
+        std::shared_ptr<compositor::DisplayBufferCompositorFactory> const& wrapped,
+        Statistics& statistics);
+
+    auto create_compositor_for(graphics::DisplayBuffer& display_buffer)
+        -> std::unique_ptr<compositor::DisplayBufferCompositor> override;
+
+private:
+    std::shared_ptr<compositor::DisplayBufferCompositorFactory> const wrapped;
+    Statistics& statistics;
+};
+}
+}
+
+#endif // MIR_BENCHMARK_COMPOSITOR_PROBE_H_
@@ -0,0 +1,183 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+
+#include <time.h>
+
+namespace mb = mir::benchmark;
+
+namespace
+{
+auto to_us(std::chrono::nanoseconds ns) -> double
+{
+    return std::chrono::duration<double, std::micro>{ns}.count();
+}
+
+/// Nearest-rank percentile of sorted samples
+auto percentile(std::vector<double> const& sorted, double p) -> double
+{
+    auto const rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void write_distribution(std::ostream& out, std::vector<double> samples, std::string const& extra = {})
+{
+    out << "{\"samples\": " << samples.size();
+    if (!samples.empty())
+    {
+        std::sort(samples.begin(), samples.end());
+        out << ", \"mean\": " << std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size()
+            << ", \"p50\": " << percentile(samples, 50)
+            << ", \"p90\": " << percentile(samples, 90)
+            << ", \"p99\": " << percentile(samples, 99)
+            << ", \"max\": " << samples.back();
+    }
+    out << extra << "}";
+}
+}
+
+auto mb::now() -> std::chrono::nanoseconds
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+void mb::Statistics::start()
+{
+    std::lock_guard lock{mutex};
+    started = now();
+    measuring = true;
+}
+
+void mb::Statistics::stop()
+{
+    std::lock_guard lock{mutex};
+    measuring = false;
+    stopped = now();
+}
+
+void mb::Statistics::record_composite(
+    std::chrono::nanoseconds cpu_time,
+    std::chrono::nanoseconds wall_time,
+    uint64_t allocations,
+    bool posted)
+{
+    if (!measuring)
+        return;
+
+    std::lock_guard lock{mutex};
+    if (!posted)
+    {
+        ++skipped_frames;
+        return;
+    }
+    composite_cpu_us.push_back(to_us(cpu_time));
+    composite_wall_us.push_back(to_us(wall_time));
+    composite_allocations.push_back(allocations);
+}
+
+void mb::Statistics::record_commit()
+{
+    if (!measuring)
+        return;
+
+    std::lock_guard lock{mutex};
+    ++commits;
+}
+
+void mb::Statistics::record_stall()
+{
+    if (!measuring)
+        return;
+
+    std::lock_guard lock{mutex};
+    ++stalls;
+}
+
+void mb::Statistics::record_presentation(std::chrono::nanoseconds latency)
+{
+    if (!measuring)
+        return;
+
+    std::lock_guard lock{mutex};
+    present_latency_us.push_back(to_us(latency));
+}
+
+void mb::Statistics::record_discard()
+{
+    if (!measuring)
+        return;
+
+    std::lock_guard lock{mutex};
+    ++discarded;
+}
+
+void mb::Statistics::input_injected(std::chrono::nanoseconds time)
+{
+    auto const unanswered = pending_input_ns.exchange(time.count());
+    if (unanswered && measuring)
+    {
+        std::lock_guard lock{mutex};
+        ++input_missed;
+    }
+}
+
+void mb::Statistics::input_committed(std::chrono::nanoseconds time)
+{
+    // Only the first commit after each injection answers it
+    auto const injected = pending_input_ns.exchange(0);
+    if (!injected || !measuring)
+        return;
+
+    std::lock_guard lock{mutex};
+    input_latency_us.push_back(to_us(time - std::chrono::nanoseconds{injected}));
+}
+
+void mb::Statistics::write_json(std::ostream& out) const
+{
+    std::lock_guard lock{mutex};
+
+    auto const seconds = std::chrono::duration<double>{(measuring ? now() : stopped) - started}.count();
+
+    out << "  \"measured_s\": " << seconds << ",\n";
+
+    out << "  \"compositor\": {\"frames\": " << composite_cpu_us.size()
+        << ", \"skipped_frames\": " << skipped_frames
+        << ", \"fps\": " << (seconds > 0 ? composite_cpu_us.size() / seconds : 0.0)
+        << ",\n    \"cpu_time_us\": ";
+    write_distribution(out, composite_cpu_us);
+    out << ",\n    \"wall_time_us\": ";
+    write_distribution(out, composite_wall_us);
+    out << ",\n    \"allocations_per_frame\": ";
+    write_distribution(out, composite_allocations);
+    out << "},\n";
+
+    out << "  \"clients\": {\"commits\": " << commits << ", \"stalled_frames\": " << stalls << "},\n";
+
+    out << "  \"buffer_to_present_us\": ";
+    write_distribution(out, present_latency_us, ", \"discarded\": " + std::to_string(discarded));
+    out << ",\n";
+
+    out << "  \"input_to_commit_us\": ";
+    write_distribution(out, input_latency_us, ", \"missed\": " + std::to_string(input_missed));
+}
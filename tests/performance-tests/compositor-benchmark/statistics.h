@@ -0,0 +1,91 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_STATISTICS_H_
+#define MIR_BENCHMARK_STATISTICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace mir
+{
+namespace benchmark
+{
+/// CLOCK_MONOTONIC, which is also the clock wp_presentation and input events use
+auto now() -> std::chrono::nanoseconds;
+
+/**
+ * Everything measured during a benchmark run
+ *
+ * Samples are recorded from the compositor and client threads concurrently, and only
+ * between start() and stop(), so that start-up and warm-up don't skew the figures.
+ */
+class Statistics
+{
+public:
+    void start();
+    void stop();
+
+    /// One call of DisplayBufferCompositor::composite()
+    void record_composite(
+        std::chrono::nanoseconds cpu_time,
+        std::chrono::nanoseconds wall_time,
+        uint64_t allocations,
+        bool posted);
+
+    /// A client committed a frame
+    void record_commit();
+    /// A client wanted to draw, but all its buffers were still held by the compositor
+    void record_stall();
+    /// A committed frame was presented, latency after it was committed
+    void record_presentation(std::chrono::nanoseconds latency);
+    /// A committed frame was never presented
+    void record_discard();
+
+    /// Input was injected at time; any previous injection not yet answered is counted as missed
+    void input_injected(std::chrono::nanoseconds time);
+    /// A client committed a frame in response to input, at time
+    void input_committed(std::chrono::nanoseconds time);
+
+    /// Writes the figures as the members "measured_s", "compositor", "buffer_to_present_us" etc. of a JSON object
+    void write_json(std::ostream& out) const;
+
+private:
+    std::atomic<bool> measuring{false};
+    std::atomic<int64_t> pending_input_ns{0};
+
+    std::mutex mutable mutex;
+    std::vector<double> composite_cpu_us;
+    std::vector<double> composite_wall_us;
+    std::vector<double> composite_allocations;
+    uint64_t skipped_frames{0};
+    uint64_t commits{0};
+    uint64_t stalls{0};
+    std::vector<double> present_latency_us;
+    uint64_t discarded{0};
+    std::vector<double> input_latency_us;
+    uint64_t input_missed{0};
+    std::chrono::nanoseconds started{0};
+    std::chrono::nanoseconds stopped{0};
+};
+}
+}
+
+#endif // MIR_BENCHMARK_STATISTICS_H_
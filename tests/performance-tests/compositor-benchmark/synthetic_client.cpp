@@ -0,0 +1,584 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synthetic_client.h"
+#include "statistics.h"
+
+#include "presentation_time.h"
+
+#include <wayland-client.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace mb = mir::benchmark;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// A few wl_shm buffers for one surface, and which of them the compositor still holds
+class BufferPool
+{
+public:
+    struct Buffer
+    {
+        wl_buffer* buffer;
+        uint32_t* pixels;
+        bool busy;
+    };
+
+    BufferPool(wl_shm* shm, geom::Size size, bool alpha)
+        : size{size},
+          pixels_per_buffer{static_cast<size_t>(size.width.as_int()) * size.height.as_int()},
+          bytes{buffer_count * pixels_per_buffer * sizeof(uint32_t)}
+    {
+        auto const fd = memfd_create("mir-benchmark-client", MFD_CLOEXEC);
+        if (fd < 0)
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create shm buffers"));
+
+        if (ftruncate(fd, bytes) < 0 ||
+            (memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+        {
+            auto const error = errno;
+            close(fd);
+            BOOST_THROW_EXCEPTION(std::system_error(error, std::system_category(), "Failed to map shm buffers"));
+        }
+
+        auto const pool = wl_shm_create_pool(shm, fd, bytes);
+        close(fd);
+
+        auto const stride = size.width.as_int() * sizeof(uint32_t);
+        for (size_t i = 0; i != buffer_count; ++i)
+        {
+            auto& buffer = buffers[i];
+            buffer.pixels = static_cast<uint32_t*>(memory) + i * pixels_per_buffer;
+            buffer.busy = false;
+            buffer.buffer = wl_shm_pool_create_buffer(
+                pool,
+                i * pixels_per_buffer * sizeof(uint32_t),
+                size.width.as_int(),
+                size.height.as_int(),
+                stride,
+                alpha ? WL_SHM_FORMAT_ARGB8888 : WL_SHM_FORMAT_XRGB8888);
+            wl_buffer_add_listener(buffer.buffer, &buffer_listener, &buffer);
+        }
+        wl_shm_pool_destroy(pool);
+    }
+
+    ~BufferPool()
+    {
+        for (auto const& buffer : buffers)
+        {
+            wl_buffer_destroy(buffer.buffer);
+        }
+        munmap(memory, bytes);
+    }
+
+    /// A buffer the compositor isn't using, or nullptr if it holds them all
+    auto acquire() -> Buffer*
+    {
+        auto const idle = std::find_if(buffers.begin(), buffers.end(), [](auto const& b) { return !b.busy; });
+        return idle != buffers.end() ? &*idle : nullptr;
+    }
+
+    void fill(Buffer& buffer, uint32_t pixel) const
+    {
+        std::fill_n(buffer.pixels, pixels_per_buffer, pixel);
+    }
+
+    geom::Size const size;
+
+private:
+    static size_t const buffer_count = 3;
+
+    static void release(void* data, wl_buffer* /*buffer*/)
+    {
+        static_cast<Buffer*>(data)->busy = false;
+    }
+
+    static wl_buffer_listener constexpr buffer_listener = {release};
+
+    size_t const pixels_per_buffer;
+    size_t const bytes;
+    void* memory{MAP_FAILED};
+    std::array<Buffer, buffer_count> buffers;
+
+    BufferPool(BufferPool const&) = delete;
+    BufferPool& operator=(BufferPool const&) = delete;
+};
+
+wl_buffer_listener constexpr BufferPool::buffer_listener;
+
+struct Surface
+{
+    wl_surface* surface{nullptr};
+    wl_subsurface* subsurface{nullptr};
+    std::unique_ptr<BufferPool> pool;
+};
+}
+
+/// The client's Wayland objects, which live and die on the client's thread
+class mb::SyntheticClient::Connection
+{
+public:
+    Connection(std::string const& wayland_display, ClientOptions const& options, Statistics& statistics)
+        : options{options},
+          statistics{statistics},
+          display{wl_display_connect(wayland_display.c_str())}
+    {
+        if (!display)
+            BOOST_THROW_EXCEPTION(std::runtime_error("Failed to connect to " + wayland_display));
+
+        registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        wl_display_roundtrip(display);
+        wl_display_roundtrip(display);
+
+        if (!compositor || !shm || !shell || (options.subsurfaces > 0 && !subcompositor))
+            BOOST_THROW_EXCEPTION(std::runtime_error("Server lacks a global the client needs"));
+
+        surfaces.reserve(1 + options.subsurfaces);
+        auto& window = surfaces.emplace_back();
+        window.surface = wl_compositor_create_surface(compositor);
+        window.pool = std::make_unique<BufferPool>(shm, options.size, options.alpha);
+        shell_surface = wl_shell_get_shell_surface(shell, window.surface);
+        wl_shell_surface_add_listener(shell_surface, &shell_surface_listener, this);
+        wl_shell_surface_set_toplevel(shell_surface);
+
+        geom::Size const subsurface_size{
+            std::max(options.size.width.as_int() / 2, 1),
+            std::max(options.size.height.as_int() / 2, 1)};
+        for (int i = 0; i != options.subsurfaces; ++i)
+        {
+            auto& child = surfaces.emplace_back();
+            child.surface = wl_compositor_create_surface(compositor);
+            child.subsurface = wl_subcompositor_get_subsurface(subcompositor, child.surface, window.surface);
+            wl_subsurface_set_position(child.subsurface, 16 * (i + 1), 16 * (i + 1));
+            child.pool = std::make_unique<BufferPool>(shm, subsurface_size, options.alpha);
+        }
+    }
+
+    ~Connection()
+    {
+        for (auto const& pending : pending_feedback)
+        {
+            wp_presentation_feedback_destroy(pending.feedback);
+        }
+        if (frame_callback) wl_callback_destroy(frame_callback);
+        if (pointer) wl_pointer_destroy(pointer);
+        if (seat) wl_seat_destroy(seat);
+        if (shell_surface) wl_shell_surface_destroy(shell_surface);
+        for (auto surface = surfaces.rbegin(); surface != surfaces.rend(); ++surface)
+        {
+            if (surface->subsurface) wl_subsurface_destroy(surface->subsurface);
+            wl_surface_destroy(surface->surface);
+            surface->pool.reset();
+        }
+        if (presentation) wp_presentation_destroy(presentation);
+        if (shell) wl_shell_destroy(shell);
+        if (shm) wl_shm_destroy(shm);
+        if (subcompositor) wl_subcompositor_destroy(subcompositor);
+        if (compositor) wl_compositor_destroy(compositor);
+        if (registry) wl_registry_destroy(registry);
+        wl_display_disconnect(display);
+    }
+
+    void map()
+    {
+        draw_frame(false);
+        wl_display_roundtrip(display);
+    }
+
+    /// Draws frames as options and input demand, until stop_fd is readable
+    void run_until(int stop_fd)
+    {
+        auto const period = options.update_rate > 0 ?
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>{1.0 / options.update_rate}) :
+            std::chrono::nanoseconds::zero();
+        auto next_frame = now() + period;
+
+        for (;;)
+        {
+            auto const time = now();
+            if (input_pending)
+            {
+                input_pending = false;
+                draw_frame(true);
+            }
+            else if (options.update_rate > 0 && time >= next_frame)
+            {
+                draw_frame(false);
+                // A client that falls behind drops frames, rather than trying to catch up
+                next_frame = std::max(next_frame + period, time);
+            }
+            else if (options.update_rate <= 0 && frame_done)
+            {
+                draw_frame(false);
+            }
+
+            while (wl_display_prepare_read(display) != 0)
+            {
+                wl_display_dispatch_pending(display);
+            }
+            wl_display_flush(display);
+
+            std::array<pollfd, 2> fds{{{wl_display_get_fd(display), POLLIN, 0}, {stop_fd, POLLIN, 0}}};
+            timespec timeout{};
+            if (period.count())
+            {
+                auto const wait = std::max(next_frame - now(), std::chrono::nanoseconds::zero());
+                timeout.tv_sec = wait.count() / 1'000'000'000;
+                timeout.tv_nsec = wait.count() % 1'000'000'000;
+            }
+
+            if (ppoll(fds.data(), fds.size(), period.count() ? &timeout : nullptr, nullptr) > 0 &&
+                (fds[0].revents & POLLIN))
+            {
+                if (wl_display_read_events(display) < 0)
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Lost connection to the server"));
+            }
+            else
+            {
+                wl_display_cancel_read(display);
+            }
+
+            if (wl_display_dispatch_pending(display) < 0)
+                BOOST_THROW_EXCEPTION(std::runtime_error("Lost connection to the server"));
+
+            if (fds[1].revents & POLLIN)
+                return;
+        }
+    }
+
+private:
+    struct PendingFeedback
+    {
+        Connection* self;
+        struct wp_presentation_feedback* feedback;
+        std::chrono::nanoseconds committed;
+    };
+
+    void draw_frame(bool for_input)
+    {
+        // Find a free buffer for every surface before touching any, so each frame is complete
+        std::vector<BufferPool::Buffer*> buffers;
+        for (auto const& surface : surfaces)
+        {
+            auto const buffer = surface.pool->acquire();
+            if (!buffer)
+            {
+                statistics.record_stall();
+                return;
+            }
+            buffers.push_back(buffer);
+        }
+
+        ++frame_count;
+        uint32_t const pixel = options.alpha ?
+            0x80000000 | ((frame_count * 0x010101) & 0x7f7f7f) :   // premultiplied half-transparent
+            0xff000000 | ((frame_count * 0x030507) & 0xffffff);
+
+        // Subsurfaces are synchronized, so their commits take effect with the window's
+        for (size_t i = surfaces.size(); i-- != 0;)
+        {
+            auto const& surface = surfaces[i];
+            auto& buffer = *buffers[i];
+            surface.pool->fill(buffer, pixel);
+            buffer.busy = true;
+            wl_surface_attach(surface.surface, buffer.buffer, 0, 0);
+            wl_surface_damage(surface.surface, 0, 0, surface.pool->size.width.as_int(), surface.pool->size.height.as_int());
+            if (i != 0)
+            {
+                wl_surface_commit(surface.surface);
+            }
+        }
+
+        auto const window = surfaces.front().surface;
+        PendingFeedback* pending = nullptr;
+        if (presentation)
+        {
+            pending = &pending_feedback.emplace_back(PendingFeedback{this, wp_presentation_feedback(presentation, window), {}});
+            wp_presentation_feedback_add_listener(pending->feedback, &feedback_listener, pending);
+        }
+        if (options.update_rate <= 0)
+        {
+            frame_done = false;
+            frame_callback = wl_surface_frame(window);
+            wl_callback_add_listener(frame_callback, &frame_listener, this);
+        }
+        wl_surface_commit(window);
+        wl_display_flush(display);
+
+        auto const committed = now();
+        if (pending)
+        {
+            pending->committed = committed;
+        }
+        statistics.record_commit();
+        if (for_input)
+        {
+            statistics.input_committed(committed);
+        }
+    }
+
+    void feedback_done(PendingFeedback* pending)
+    {
+        wp_presentation_feedback_destroy(pending->feedback);
+        pending_feedback.remove_if([pending](auto const& candidate) { return &candidate == pending; });
+    }
+
+    static void new_global(
+        void* data,
+        struct wl_registry* registry,
+        uint32_t id,
+        char const* interface,
+        uint32_t /*version*/)
+    {
+        auto const self = static_cast<Connection*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+        {
+            self->compositor = static_cast<wl_compositor*>(wl_registry_bind(registry, id, &wl_compositor_interface, 1));
+        }
+        else if (strcmp(interface, wl_subcompositor_interface.name) == 0)
+        {
+            self->subcompositor = static_cast<wl_subcompositor*>(
+                wl_registry_bind(registry, id, &wl_subcompositor_interface, 1));
+        }
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+        {
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        }
+        else if (strcmp(interface, wl_shell_interface.name) == 0)
+        {
+            self->shell = static_cast<wl_shell*>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
+        }
+        else if (strcmp(interface, wl_seat_interface.name) == 0 && !self->seat)
+        {
+            self->seat = static_cast<wl_seat*>(wl_registry_bind(registry, id, &wl_seat_interface, 1));
+            wl_seat_add_listener(self->seat, &seat_listener, self);
+        }
+        else if (strcmp(interface, wp_presentation_interface.name) == 0)
+        {
+            self->presentation = static_cast<wp_presentation*>(
+                wl_registry_bind(registry, id, &wp_presentation_interface, 1));
+        }
+    }
+
+    static void global_remove(void* /*data*/, struct wl_registry* /*registry*/, uint32_t /*name*/)
+    {
+    }
+
+    static void seat_capabilities(void* data, struct wl_seat* seat, uint32_t capabilities)
+    {
+        auto const self = static_cast<Connection*>(data);
+        if ((capabilities & WL_SEAT_CAPABILITY_POINTER) && !self->pointer)
+        {
+            self->pointer = wl_seat_get_pointer(seat);
+            wl_pointer_add_listener(self->pointer, &pointer_listener, self);
+        }
+    }
+
+    static void pointer_enter(
+        void* data, struct wl_pointer* /*pointer*/, uint32_t /*serial*/, struct wl_surface* /*surface*/,
+        wl_fixed_t /*x*/, wl_fixed_t /*y*/)
+    {
+        static_cast<Connection*>(data)->input_pending = true;
+    }
+
+    static void pointer_leave(void* /*data*/, struct wl_pointer* /*pointer*/, uint32_t /*serial*/, struct wl_surface* /*surface*/)
+    {
+    }
+
+    static void pointer_motion(void* data, struct wl_pointer* /*pointer*/, uint32_t /*time*/, wl_fixed_t /*x*/, wl_fixed_t /*y*/)
+    {
+        static_cast<Connection*>(data)->input_pending = true;
+    }
+
+    static void pointer_button(
+        void* /*data*/, struct wl_pointer* /*pointer*/, uint32_t /*serial*/, uint32_t /*time*/,
+        uint32_t /*button*/, uint32_t /*state*/)
+    {
+    }
+
+    static void pointer_axis(void* /*data*/, struct wl_pointer* /*pointer*/, uint32_t /*time*/, uint32_t /*axis*/, wl_fixed_t /*value*/)
+    {
+    }
+
+    /// We bind wl_seat version 1, so its pointer only ever sends the version 1 events
+    static auto make_pointer_listener() -> wl_pointer_listener
+    {
+        wl_pointer_listener listener{};
+        listener.enter = pointer_enter;
+        listener.leave = pointer_leave;
+        listener.motion = pointer_motion;
+        listener.button = pointer_button;
+        listener.axis = pointer_axis;
+        return listener;
+    }
+
+    static void ping(void* /*data*/, struct wl_shell_surface* shell_surface, uint32_t serial)
+    {
+        wl_shell_surface_pong(shell_surface, serial);
+    }
+
+    static void configure(
+        void* /*data*/, struct wl_shell_surface* /*shell_surface*/, uint32_t /*edges*/, int32_t /*width*/, int32_t /*height*/)
+    {
+    }
+
+    static void popup_done(void* /*data*/, struct wl_shell_surface* /*shell_surface*/)
+    {
+    }
+
+    static void frame_done_event(void* data, struct wl_callback* callback, uint32_t /*time*/)
+    {
+        auto const self = static_cast<Connection*>(data);
+        wl_callback_destroy(callback);
+        self->frame_callback = nullptr;
+        self->frame_done = true;
+    }
+
+    static void sync_output(void* /*data*/, struct wp_presentation_feedback* /*feedback*/, struct wl_output* /*output*/)
+    {
+    }
+
+    static void presented(
+        void* data,
+        struct wp_presentation_feedback* /*feedback*/,
+        uint32_t tv_sec_hi,
+        uint32_t tv_sec_lo,
+        uint32_t tv_nsec,
+        uint32_t /*refresh*/,
+        uint32_t /*seq_hi*/,
+        uint32_t /*seq_lo*/,
+        uint32_t /*flags*/)
+    {
+        auto const pending = static_cast<PendingFeedback*>(data);
+        auto const seconds = (uint64_t{tv_sec_hi} << 32) | tv_sec_lo;
+        auto const timestamp = std::chrono::seconds{static_cast<int64_t>(seconds)} + std::chrono::nanoseconds{tv_nsec};
+
+        pending->self->statistics.record_presentation(timestamp - pending->committed);
+        pending->self->feedback_done(pending);
+    }
+
+    static void discarded(void* data, struct wp_presentation_feedback* /*feedback*/)
+    {
+        auto const pending = static_cast<PendingFeedback*>(data);
+        pending->self->statistics.record_discard();
+        pending->self->feedback_done(pending);
+    }
+
+    static wl_registry_listener constexpr registry_listener = {new_global, global_remove};
+    static wl_seat_listener constexpr seat_listener = {seat_capabilities, nullptr};
+    static wl_shell_surface_listener constexpr shell_surface_listener = {ping, configure, popup_done};
+    static wl_callback_listener constexpr frame_listener = {frame_done_event};
+    static wp_presentation_feedback_listener constexpr feedback_listener = {sync_output, presented, discarded};
+    static wl_pointer_listener const pointer_listener;
+
+    ClientOptions const options;
+    Statistics& statistics;
+
+    wl_display* const display;
+    wl_registry* registry{nullptr};
+    wl_compositor* compositor{nullptr};
+    wl_subcompositor* subcompositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shell* shell{nullptr};
+    wl_seat* seat{nullptr};
+    wp_presentation* presentation{nullptr};
+
+    wl_pointer* pointer{nullptr};
+    wl_shell_surface* shell_surface{nullptr};
+    /// The window first, then its subsurfaces
+    std::vector<Surface> surfaces;
+    wl_callback* frame_callback{nullptr};
+    std::list<PendingFeedback> pending_feedback;
+
+    uint32_t frame_count{0};
+    bool frame_done{true};
+    bool input_pending{false};
+};
+
+wl_registry_listener constexpr mb::SyntheticClient::Connection::registry_listener;
+wl_seat_listener constexpr mb::SyntheticClient::Connection::seat_listener;
+wl_shell_surface_listener constexpr mb::SyntheticClient::Connection::shell_surface_listener;
+wl_callback_listener constexpr mb::SyntheticClient::Connection::frame_listener;
+wp_presentation_feedback_listener constexpr mb::SyntheticClient::Connection::feedback_listener;
+wl_pointer_listener const mb::SyntheticClient::Connection::pointer_listener =
+    mb::SyntheticClient::Connection::make_pointer_listener();
+
+mb::SyntheticClient::SyntheticClient(
+    std::string const& wayland_display,
+    ClientOptions const& options,
+    Statistics& statistics)
+    : options{options},
+      statistics{statistics},
+      stop_fd{eventfd(0, EFD_CLOEXEC)},
+      thread{[this, wayland_display] { run(wayland_display); }}
+{
+}
+
+mb::SyntheticClient::~SyntheticClient()
+{
+    uint64_t const one{1};
+    if (write(stop_fd, &one, sizeof one) != sizeof one)
+    {
+        std::cerr << "Failed to stop synthetic client: " << strerror(errno) << std::endl;
+    }
+    thread.join();
+}
+
+auto mb::SyntheticClient::mapped() const -> bool
+{
+    return mapped_;
+}
+
+auto mb::SyntheticClient::failed() const -> bool
+{
+    return failed_;
+}
+
+void mb::SyntheticClient::run(std::string const& wayland_display)
+{
+    try
+    {
+        Connection connection{wayland_display, options, statistics};
+        connection.map();
+        mapped_ = true;
+        connection.run_until(stop_fd);
+    }
+    catch (std::exception const& error)
+    {
+        std::cerr << "Synthetic client failed: " << error.what() << std::endl;
+        failed_ = true;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_SYNTHETIC_CLIENT_H_
+#define MIR_BENCHMARK_SYNTHETIC_CLIENT_H_
+
+#include "mir/fd.h"
+#include "mir/geometry/size.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace mir
+{
+namespace benchmark
+{
+class Statistics;
+
+/// What each synthetic client draws, and how often
+struct ClientOptions
+{
+    geometry::Size size;
+    /// Frames per second to commit; zero commits whenever the last frame's callback is done
+    double update_rate;
+    /// Half-size subsurfaces over the window, updated along with it
+    int subsurfaces;
+    /// Draw translucent (ARGB) rather than opaque (XRGB) pixels
+    bool alpha;
+};
+
+/**
+ * A wl_shm client, on a thread of its own, that keeps redrawing a wl_shell window
+ *
+ * Every commit of the window asks for presentation feedback, to measure how long the
+ * compositor takes to show it. The client also redraws at once in response to pointer
+ * events, to measure input-to-commit latency.
+ */
+class SyntheticClient
+{
+public:
+    SyntheticClient(std::string const& wayland_display, ClientOptions const& options, Statistics& statistics);
+    ~SyntheticClient();
+
+    /// Whether the first frame has been committed and round-tripped
+    auto mapped() const -> bool;
+    /// Whether the client has failed (e.g. to connect, or to find a global it needs)
+    auto failed() const -> bool;
+
+    SyntheticClient(SyntheticClient const&) = delete;
+    SyntheticClient& operator=(SyntheticClient const&) = delete;
+
+private:
+    class Connection;
+    void run(std::string const& wayland_display);
+
+    ClientOptions const options;
+    Statistics& statistics;
+    Fd const stop_fd;
+    std::atomic<bool> mapped_{false};
+    std::atomic<bool> failed_{false};
+    std::thread thread;
+};
+}
+}
+
+#endif // MIR_BENCHMARK_SYNTHETIC_CLIENT_H_
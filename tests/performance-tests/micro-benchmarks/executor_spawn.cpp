@@ -0,0 +1,146 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/executor.h"
+
+#include "mir/test/signal.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace mt = mir::test;
+
+namespace
+{
+/// From spawn() to the work starting, in nanoseconds
+struct Latencies
+{
+    uint64_t median;
+    uint64_t p99;
+};
+
+/// Spawn one item at a time, as a frame's worth of background work trickles in
+auto measure_latency(mir::Executor& executor) -> Latencies
+{
+    int const spawns = 2000;
+    std::vector<uint64_t> latencies;
+    latencies.reserve(spawns);
+
+    for (auto i = 0; i != spawns; ++i)
+    {
+        auto const started = std::make_shared<mt::Signal>();
+        std::chrono::steady_clock::time_point start_time;
+        auto const spawn_time = std::chrono::steady_clock::now();
+        executor.spawn(
+            [started, &start_time]()
+            {
+                start_time = std::chrono::steady_clock::now();
+                started->raise();
+            });
+        EXPECT_TRUE(started->wait_for(10s));
+        latencies.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(start_time - spawn_time).count());
+
+        std::this_thread::sleep_for(50us);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    return {latencies[spawns / 2], latencies[spawns * 99 / 100]};
+}
+
+/// Spawn a burst of small items, half of which each spawn another, and wait for them all
+auto measure_throughput(mir::Executor& executor) -> double
+{
+    int const bursts = 20;
+    int const items = 5000;
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto burst = 0; burst != bursts; ++burst)
+    {
+        std::atomic<int> remaining{items + items / 2};
+        auto const done = std::make_shared<mt::Signal>();
+        auto const finish_one = [&remaining, done]()
+            {
+                if (--remaining == 0)
+                {
+                    done->raise();
+                }
+            };
+
+        for (auto i = 0; i != items; ++i)
+        {
+            if (i % 2)
+            {
+                executor.spawn(finish_one);
+            }
+            else
+            {
+                executor.spawn([&executor, finish_one]()
+                    {
+                        executor.spawn(finish_one);
+                        finish_one();
+                    });
+            }
+        }
+        EXPECT_TRUE(done->wait_for(60s));
+    }
+
+    auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return bursts * (items + items / 2) / seconds;
+}
+
+void report(char const* name, Latencies const& latencies, double throughput)
+{
+    std::cout << "    " << name << ": spawn latency median " << latencies.median << "ns, 99th percentile "
+              << latencies.p99 << "ns; throughput " << static_cast<uint64_t>(throughput) << " items/s"
+              << std::endl;
+}
+}
+
+// Compare the work-stealing pool against the thread-per-item executor for short, non-blocking work
+TEST(ExecutorSpawn, work_stealing_pool_against_thread_pool_executor)
+{
+    auto const thread_pool_latency = measure_latency(mir::thread_pool_executor);
+    auto const thread_pool_throughput = measure_throughput(mir::thread_pool_executor);
+    mir::ThreadPoolExecutor::quiesce();
+
+    auto const background_latency = measure_latency(mir::background_executor);
+    auto const background_throughput = measure_throughput(mir::background_executor);
+    auto const latency_critical_latency = measure_latency(mir::latency_critical_executor);
+    auto const latency_critical_throughput = measure_throughput(mir::latency_critical_executor);
+    mir::WorkStealingExecutor::quiesce();
+
+    report("thread_pool_executor", thread_pool_latency, thread_pool_throughput);
+    report("background_executor", background_latency, background_throughput);
+    report("latency_critical_executor", latency_critical_latency, latency_critical_throughput);
+
+    RecordProperty("thread_pool_median_ns", std::to_string(thread_pool_latency.median));
+    RecordProperty("thread_pool_items_per_second", std::to_string(static_cast<uint64_t>(thread_pool_throughput)));
+    RecordProperty("work_stealing_median_ns", std::to_string(background_latency.median));
+    RecordProperty("work_stealing_items_per_second", std::to_string(static_cast<uint64_t>(background_throughput)));
+
+    EXPECT_THAT(background_throughput, Gt(thread_pool_throughput));
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/events/event_builders.h"
+#include "mir/input/input_device_info.h"
+#include "mir/input/seat_observer.h"
+#include "mir/observer_registrar.h"
+#include "mir/server.h"
+
+#include "mir_test_framework/fake_input_device.h"
+#include "mir_test_framework/headless_in_process_server.h"
+#include "mir_test_framework/stub_server_platform_factory.h"
+#include "mir/test/event_factory.h"
+#include "mir/test/signal.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace mev = mir::events;
+namespace mi = mir::input;
+namespace mis = mir::input::synthesis;
+namespace mt = mir::test;
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// Raises done once the seat has dispatched the expected number of events
+class CountingSeatObserver : public mi::SeatObserver
+{
+public:
+    explicit CountingSeatObserver(int expected)
+        : expected{expected}
+    {
+    }
+
+    void seat_dispatch_event(std::shared_ptr<MirEvent const> const& /*event*/) override
+    {
+        if (++seen == expected)
+            done.raise();
+    }
+
+    void seat_add_device(uint64_t /*id*/) override {}
+    void seat_remove_device(uint64_t /*id*/) override {}
+    void seat_set_key_state(uint64_t /*id*/, std::vector<uint32_t> const& /*scan_codes*/) override {}
+    void seat_set_pointer_state(uint64_t /*id*/, unsigned /*buttons*/) override {}
+    void seat_set_cursor_position(float /*cursor_x*/, float /*cursor_y*/) override {}
+    void seat_set_confinement_region_called(geom::Rectangles const& /*regions*/) override {}
+    void seat_reset_confinement_regions() override {}
+
+    int const expected;
+    std::atomic<int> seen{0};
+    mt::Signal done;
+};
+
+void report(char const* name, int events, std::chrono::steady_clock::duration elapsed)
+{
+    auto const seconds = std::chrono::duration<double>(elapsed).count();
+    std::cout << "    " << name << ": " << events << " events in " << seconds * 1000 << "ms, "
+              << static_cast<uint64_t>(events / seconds) << " events/s, "
+              << static_cast<uint64_t>(seconds * 1e9 / events) << "ns/event" << std::endl;
+}
+
+using InputPipeline = mtf::HeadlessInProcessServer;
+}
+
+// A high-rate pointer floods the input thread; time the events' way through the
+// input dispatch to the seat
+TEST_F(InputPipeline, fake_pointer_motion_throughput)
+{
+    int const events = 20000;
+
+    auto const fake_pointer = mtf::add_fake_input_device(
+        mi::InputDeviceInfo{"mouse", "mouse-uid", mi::DeviceCapability::pointer});
+
+    // Let the device settle in before timing anything
+    auto const warm_up = std::make_shared<CountingSeatObserver>(1);
+    server.the_seat_observer_registrar()->register_interest(warm_up);
+    fake_pointer->emit_event(mis::a_pointer_event().with_movement(1, 0));
+    ASSERT_TRUE(warm_up->done.wait_for(30s));
+    server.the_seat_observer_registrar()->unregister_interest(*warm_up);
+
+    auto const observer = std::make_shared<CountingSeatObserver>(events);
+    server.the_seat_observer_registrar()->register_interest(observer);
+
+    auto const start = std::chrono::steady_clock::now();
+    for (auto i = 0; i != events; ++i)
+    {
+        fake_pointer->emit_event(mis::a_pointer_event().with_movement(i % 2 ? 1 : -1, 1));
+    }
+    ASSERT_TRUE(observer->done.wait_for(60s));
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    report("pointer motion", events, elapsed);
+    RecordProperty("events_per_second", std::to_string(static_cast<uint64_t>(
+        events / std::chrono::duration<double>(elapsed).count())));
+
+    EXPECT_THAT(observer->seen.load(), Eq(events));
+}
+
+// The input thread builds events while another thread (as dispatch does) releases
+// them; this is the allocation pattern the input event pool serves
+TEST(InputEventAllocation, events_built_on_one_thread_and_released_on_another)
+{
+    int const events = 1000000;
+    std::size_t const batch_size = 64;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<mir::EventUPtr> queue;
+    bool finished{false};
+
+    std::thread releaser{
+        [&]
+        {
+            std::unique_lock lock{mutex};
+            for (;;)
+            {
+                ready.wait(lock, [&] { return finished || !queue.empty(); });
+                if (queue.empty())
+                    return;
+
+                std::deque<mir::EventUPtr> batch;
+                batch.swap(queue);
+                lock.unlock();
+                batch.clear();
+                lock.lock();
+            }
+        }};
+
+    std::vector<mir::EventUPtr> pending;
+    auto const start = std::chrono::steady_clock::now();
+    for (auto i = 0; i != events; ++i)
+    {
+        pending.push_back(mev::make_pointer_event(
+            0, std::chrono::nanoseconds{i}, {}, mir_input_event_modifier_none,
+            mir_pointer_action_motion, 0, i, i, 0, 0, 1, 1));
+
+        // Hand events over in batches, so the handover doesn't swamp the allocation costs
+        if (pending.size() == batch_size)
+        {
+            {
+                std::lock_guard lock{mutex};
+                std::move(pending.begin(), pending.end(), std::back_inserter(queue));
+            }
+            pending.clear();
+            ready.notify_one();
+        }
+    }
+    {
+        std::lock_guard lock{mutex};
+        finished = true;
+    }
+    ready.notify_one();
+    releaser.join();
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    report("build and release", events, elapsed);
+}
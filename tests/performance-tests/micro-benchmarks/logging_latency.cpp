@@ -0,0 +1,102 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/logging/file_logger.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace ml = mir::logging;
+
+namespace
+{
+/// How long logging keeps the calling thread busy, in nanoseconds
+struct Latencies
+{
+    uint64_t median;
+    uint64_t p99;
+    uint64_t max;
+};
+
+/// Log a compositor-report-sized message each 100µs or so (several per frame), timing each call
+auto measure(ml::Logger& logger) -> Latencies
+{
+    int const messages = 5000;
+    std::vector<uint64_t> latencies;
+    latencies.reserve(messages);
+
+    for (auto i = 0; i != messages; ++i)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        logger.log(
+            "compositor", ml::Severity::informational,
+            "Display %d averaged %.3f FPS, %.3f ms/frame, latency %.3f ms, %d frames over %.3f sec, %.0f%% frames "
+            "bypassed",
+            i % 4, 59.94, 16.68, 4.2, 60, 1.001, 0.0);
+        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+        std::this_thread::sleep_for(100us);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    return {latencies[messages / 2], latencies[messages * 99 / 100], latencies.back()};
+}
+
+void report(char const* name, Latencies const& latencies)
+{
+    std::cout << "    " << name << ": median " << latencies.median << "ns, 99th percentile "
+              << latencies.p99 << "ns, worst " << latencies.max << "ns" << std::endl;
+}
+
+auto file_logger() -> std::shared_ptr<ml::Logger>
+{
+    return std::make_shared<ml::FileLogger>(std::ofstream{"/dev/null"});
+}
+}
+
+// Compare how long a thread (like the compositor's) is held up by logging each message
+TEST(LoggingLatency, async_logger_returns_sooner_than_writing_synchronously)
+{
+    auto const sync_logger = file_logger();
+    auto const sync = measure(*sync_logger);
+
+    ml::AsyncLogger async_logger{file_logger()};
+    auto const async = measure(async_logger);
+    async_logger.flush();
+
+    report("synchronous", sync);
+    report("asynchronous", async);
+
+    RecordProperty("sync_median_ns", std::to_string(sync.median));
+    RecordProperty("sync_p99_ns", std::to_string(sync.p99));
+    RecordProperty("async_median_ns", std::to_string(async.median));
+    RecordProperty("async_p99_ns", std::to_string(async.p99));
+    RecordProperty("async_dropped", std::to_string(async_logger.dropped_messages()));
+
+    EXPECT_THAT(async.median, Lt(sync.median));
+    EXPECT_THAT(async_logger.dropped_messages(), Eq(0u));
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/test/doubles/stub_buffer_stream.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace testing;
+namespace mc = mir::compositor;
+namespace mi = mir::input;
+namespace mr = mir::report;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+std::atomic<uint64_t> heap_allocations{0};
+}
+
+// Count every heap allocation made by the process
+void* operator new(std::size_t size)
+{
+    ++heap_allocations;
+    if (auto const p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+struct SceneAllocations : Test
+{
+    SceneAllocations()
+    {
+        for (auto i = 0; i != surface_count; ++i)
+        {
+            auto const surface = std::make_shared<ms::BasicSurface>(
+                nullptr /* session */,
+                mir::wayland::Weak<mir::frontend::WlSurface>{},
+                "window",
+                mir::geometry::Rectangle{{10 * i, 10 * i}, {640, 480}},
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo>{{std::make_shared<mtd::StubBufferStream>(), {}, {}}},
+                nullptr /* cursor_image */,
+                mr::null_scene_report());
+            stack.add_surface(surface, mi::InputReceptionMode::normal);
+        }
+    }
+
+    /// Sample the scene as the compositor does each frame, and return the average heap allocations per frame
+    template<typename SampleScene>
+    auto allocations_per_frame(SampleScene const& sample_scene) -> uint64_t
+    {
+        mc::SceneElementSequence elements;
+
+        // The first frame populates the pools
+        sample_scene(elements);
+        elements.clear();
+
+        auto const initial = heap_allocations.load();
+        auto const start = std::chrono::steady_clock::now();
+        for (auto frame = 0; frame != frames; ++frame)
+        {
+            sample_scene(elements);
+            elements.clear();   // As the compositor does once it has rendered them
+        }
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+
+        auto const result = (heap_allocations.load() - initial) / frames;
+        std::cout << "    " << result << " heap allocations per frame for " << surface_count << " surfaces, "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / frames
+                  << "ns CPU per frame" << std::endl;
+        return result;
+    }
+
+    int const surface_count{20};
+    int const frames{600};
+    ms::SurfaceStack stack{mr::null_scene_report()};
+    mc::CompositorID const compositor_id{this};
+};
+}
+
+TEST_F(SceneAllocations, allocations_per_frame_when_compositor_is_registered)
+{
+    stack.register_compositor(compositor_id);
+
+    auto const allocations = allocations_per_frame(
+        [this](mc::SceneElementSequence& elements)
+        {
+            stack.collect_scene_elements_for(compositor_id, elements);
+        });
+
+    RecordProperty("allocations_per_frame", std::to_string(allocations));
+    EXPECT_THAT(allocations, Eq(0u));
+
+    stack.unregister_compositor(compositor_id);
+}
+
+TEST_F(SceneAllocations, allocations_per_frame_for_unregistered_compositor)
+{
+    // Such as a screenshot: nothing is kept for reuse between calls
+    auto const allocations = allocations_per_frame(
+        [this](mc::SceneElementSequence& elements)
+        {
+            elements = stack.scene_elements_for(compositor_id);
+        });
+
+    RecordProperty("allocations_per_frame", std::to_string(allocations));
+    EXPECT_THAT(allocations, Gt(0u));
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/test/doubles/stub_buffer_stream.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace mc = mir::compositor;
+namespace mi = mir::input;
+namespace mr = mir::report;
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+auto make_surface(int i) -> std::shared_ptr<ms::Surface>
+{
+    return std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        mir::wayland::Weak<mir::frontend::WlSurface>{},
+        "window",
+        mir::geometry::Rectangle{{10 * i, 10 * i}, {640, 480}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo>{{std::make_shared<mtd::StubBufferStream>(), {}, {}}},
+        nullptr /* cursor_image */,
+        mr::null_scene_report());
+}
+
+struct SceneContention : TestWithParam<int>
+{
+    SceneContention()
+    {
+        for (auto i = 0; i != surface_count; ++i)
+        {
+            surfaces.push_back(make_surface(i));
+            stack.add_surface(surfaces.back(), mi::InputReceptionMode::normal);
+        }
+    }
+
+    int const surface_count{20};
+    std::chrono::milliseconds const duration{500ms};
+    std::vector<std::shared_ptr<ms::Surface>> surfaces;
+    ms::SurfaceStack stack{mr::null_scene_report()};
+};
+}
+
+// Compositor threads sample the scene as fast as they can while a "shell" thread
+// keeps adding, raising and removing surfaces
+TEST_P(SceneContention, compositor_frames_while_surfaces_churn)
+{
+    auto const compositor_count = GetParam();
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> changes{0};
+
+    std::vector<std::thread> compositors;
+    for (auto i = 0; i != compositor_count; ++i)
+    {
+        compositors.emplace_back(
+            [&, id = std::make_unique<int>(i)]
+            {
+                mc::CompositorID const compositor_id{id.get()};
+                stack.register_compositor(compositor_id);
+
+                mc::SceneElementSequence elements;
+                uint64_t local_frames{0};
+                while (running)
+                {
+                    stack.frames_pending(compositor_id);
+                    stack.collect_scene_elements_for(compositor_id, elements);
+                    elements.clear();
+                    ++local_frames;
+                }
+                frames += local_frames;
+
+                stack.unregister_compositor(compositor_id);
+            });
+    }
+
+    std::thread shell{
+        [&]
+        {
+            uint64_t local_changes{0};
+            for (auto i = 0; running; ++i)
+            {
+                auto const surface = make_surface(i);
+                stack.add_surface(surface, mi::InputReceptionMode::normal);
+                stack.raise(surfaces[i % surfaces.size()]);
+                stack.surface_at({10 * (i % surface_count), 10});
+                stack.remove_surface(surface);
+                local_changes += 3;
+            }
+            changes += local_changes;
+        }};
+
+    std::this_thread::sleep_for(duration);
+    running = false;
+
+    shell.join();
+    for (auto& compositor : compositors)
+        compositor.join();
+
+    auto const seconds = std::chrono::duration<double>(duration).count();
+    auto const frames_per_second = static_cast<uint64_t>(frames / seconds);
+    auto const changes_per_second = static_cast<uint64_t>(changes / seconds);
+
+    std::cout << "    " << compositor_count << " compositors: "
+              << frames_per_second / compositor_count << " frames/s each, "
+              << changes_per_second << " stack changes/s" << std::endl;
+
+    RecordProperty("frames_per_second_per_compositor", std::to_string(frames_per_second / compositor_count));
+    RecordProperty("stack_changes_per_second", std::to_string(changes_per_second));
+
+    EXPECT_THAT(frames.load(), Gt(0u));
+    EXPECT_THAT(changes.load(), Gt(0u));
+}
+
+INSTANTIATE_TEST_SUITE_P(SceneContention, SceneContention, Values(1, 2, 4, 8));
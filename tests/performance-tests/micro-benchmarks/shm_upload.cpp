@@ -0,0 +1,118 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/gl/texture_cache.h"
+#include "mir/graphics/buffer_properties.h"
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace testing;
+namespace geom = mir::geometry;
+namespace mg = mir::graphics;
+namespace mrg = mir::renderer::gl;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+/// A renderable whose client damages the same small band of its buffer each frame, like a terminal printing a line
+class TerminalRenderable : public mtd::FakeRenderable
+{
+public:
+    TerminalRenderable(geom::Size size, std::optional<geom::Rectangles> damage)
+        : FakeRenderable{geom::Rectangle{{0, 0}, size}},
+          damage{std::move(damage)}
+    {
+    }
+
+    std::optional<geom::Rectangles> buffer_damage_since(mg::BufferID) const override
+    {
+        return damage;
+    }
+
+private:
+    std::optional<geom::Rectangles> const damage;
+};
+
+struct ShmUpload : Test
+{
+    ShmUpload()
+    {
+        ON_CALL(mock_gl, glGenTextures(1, _))
+            .WillByDefault(SetArgPointee<1>(1));
+    }
+
+    auto buffer() -> std::shared_ptr<mtd::StubBuffer>
+    {
+        return std::make_shared<mtd::StubBuffer>(
+            nullptr,
+            mg::BufferProperties{size, mir_pixel_format_abgr_8888, mg::BufferUsage::software},
+            geom::Stride{size.width.as_int() * 4});
+    }
+
+    /// Bind a new buffer each frame, and return the average bytes uploaded per frame (excluding the first)
+    auto bytes_per_frame(std::optional<geom::Rectangles> const& damage) -> uint64_t
+    {
+        TerminalRenderable const renderable{size, damage};
+        mrg::TextureCache cache;
+
+        // Clients typically alternate between two buffers
+        std::vector<std::shared_ptr<mtd::StubBuffer>> const buffers{buffer(), buffer()};
+        cache.bind(renderable, *buffers[0]);
+        auto const initial = cache.bytes_uploaded();
+
+        auto const start = std::chrono::steady_clock::now();
+        for (auto frame = 1; frame <= frames; ++frame)
+        {
+            cache.bind(renderable, *buffers[frame % buffers.size()]);
+        }
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+
+        auto const result = (cache.bytes_uploaded() - initial) / frames;
+        std::cout << "    " << result << " bytes uploaded per frame, "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / frames
+                  << "µs CPU per frame (GL mocked)" << std::endl;
+        return result;
+    }
+
+    NiceMock<mtd::MockGL> mock_gl;
+    geom::Size const size{3840, 2160};
+    int const frames{60};
+    geom::Rectangle const one_line{{0, 1000}, {3840, 20}};
+};
+}
+
+TEST_F(ShmUpload, bytes_per_frame_without_damage)
+{
+    auto const bytes = bytes_per_frame(std::nullopt);
+
+    RecordProperty("bytes_per_frame", std::to_string(bytes));
+    EXPECT_THAT(bytes, Eq(3840u * 2160u * 4u));
+}
+
+TEST_F(ShmUpload, bytes_per_frame_with_one_damaged_line)
+{
+    auto const bytes = bytes_per_frame(geom::Rectangles{one_line});
+
+    RecordProperty("bytes_per_frame", std::to_string(bytes));
+    EXPECT_THAT(bytes, Eq(3840u * 20u * 4u));
+}
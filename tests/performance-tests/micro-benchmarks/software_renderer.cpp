@@ -0,0 +1,194 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/graphics/buffer_properties.h"
+#include "mir/graphics/transformation.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace testing;
+namespace geom = mir::geometry;
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+class MemoryRenderTarget : public mrs::RenderTarget
+{
+public:
+    explicit MemoryRenderTarget(geom::Size size)
+        : buffer{std::make_shared<mtd::StubBuffer>(
+              mg::BufferProperties{size, mir_pixel_format_xrgb_8888, mg::BufferUsage::software})}
+    {
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return buffer->size();
+    }
+
+    auto map_back_buffer() -> std::unique_ptr<mrs::Mapping<unsigned char>> override
+    {
+        return buffer->map_rw();
+    }
+
+    auto buffer_age() const -> int override
+    {
+        return age;
+    }
+
+    void swap_buffers() override
+    {
+    }
+
+    int age{0};
+
+private:
+    std::shared_ptr<mtd::StubBuffer> const buffer;
+};
+
+/// A client buffer of the given size, filled with premultiplied translucent (or opaque) content
+auto client_buffer(geom::Size size, uint32_t pixel) -> std::shared_ptr<mtd::StubBuffer>
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{size, mir_pixel_format_argb_8888, mg::BufferUsage::software});
+    for (std::size_t i = 0; i + 4 <= buffer->written_pixels.size(); i += 4)
+    {
+        std::memcpy(buffer->written_pixels.data() + i, &pixel, 4);
+    }
+    return buffer;
+}
+
+struct SoftwareRendererPerformance : Test
+{
+    auto window(geom::Rectangle rect, uint32_t pixel, bool shaped, float alpha = 1.0f,
+                std::optional<geom::Size> buffer_size = std::nullopt) -> std::shared_ptr<mg::Renderable>
+    {
+        auto const result = std::make_shared<mtd::FakeRenderable>(rect, alpha, !shaped);
+        result->set_buffer(client_buffer(buffer_size.value_or(rect.size), pixel));
+        return result;
+    }
+
+    /// Render frames of the scene, and return the average milliseconds per frame
+    auto ms_per_frame(mg::RenderableList const& scene, std::optional<geom::Rectangles> const& damage = std::nullopt)
+        -> double
+    {
+        renderer.render(scene);
+
+        auto const start = std::chrono::steady_clock::now();
+        for (auto frame = 0; frame != frames; ++frame)
+        {
+            if (damage)
+                renderer.set_damage(damage.value());
+            renderer.render(scene);
+        }
+        std::chrono::duration<double, std::milli> const elapsed = std::chrono::steady_clock::now() - start;
+
+        auto const result = elapsed.count() / frames;
+        std::cout << "    " << result << "ms per " << output.width << "x" << output.height << " frame" << std::endl;
+        return result;
+    }
+
+    /// Like the scene of the CompositorPerformance system test: a background and a stack of overlapping clients
+    auto desktop() -> mg::RenderableList
+    {
+        mg::RenderableList scene{window({{0, 0}, output}, 0xFF304050, false)};
+        for (int i = 0; i != 6; ++i)
+        {
+            scene.push_back(window({{100 + 150 * i, 80 + 100 * i}, {640, 480}}, 0xC0402010, true));
+        }
+        return scene;
+    }
+
+    geom::Size const output{1920, 1080};
+    MemoryRenderTarget target{output};
+    mrs::Renderer renderer{target};
+    int const frames{30};
+
+    SoftwareRendererPerformance()
+    {
+        renderer.set_viewport({{0, 0}, output});
+    }
+};
+}
+
+TEST_F(SoftwareRendererPerformance, fullscreen_opaque_client)
+{
+    auto const ms = ms_per_frame({window({{0, 0}, output}, 0xFF102030, false)});
+    RecordProperty("ms_per_frame", std::to_string(ms));
+}
+
+TEST_F(SoftwareRendererPerformance, overlapping_translucent_clients)
+{
+    auto const ms = ms_per_frame(desktop());
+    RecordProperty("ms_per_frame", std::to_string(ms));
+}
+
+TEST_F(SoftwareRendererPerformance, client_with_alpha)
+{
+    auto const ms = ms_per_frame({
+        window({{0, 0}, output}, 0xFF102030, false),
+        window({{200, 200}, {1280, 720}}, 0xFF405060, false, 0.7f)});
+    RecordProperty("ms_per_frame", std::to_string(ms));
+}
+
+TEST_F(SoftwareRendererPerformance, clients_on_rotated_output)
+{
+    MemoryRenderTarget rotated_target{{output.height.as_int(), output.width.as_int()}};
+    mrs::Renderer rotated{rotated_target};
+    rotated.set_viewport({{0, 0}, output});
+    rotated.set_output_transform(mg::transformation(mir_orientation_left));
+    auto const scene = desktop();
+    rotated.render(scene);
+
+    auto const start = std::chrono::steady_clock::now();
+    for (auto frame = 0; frame != frames; ++frame)
+        rotated.render(scene);
+    std::chrono::duration<double, std::milli> const elapsed = std::chrono::steady_clock::now() - start;
+
+    auto const ms = elapsed.count() / frames;
+    std::cout << "    " << ms << "ms per rotated frame" << std::endl;
+    RecordProperty("ms_per_frame", std::to_string(ms));
+}
+
+TEST_F(SoftwareRendererPerformance, client_scaled_by_two)
+{
+    auto const ms = ms_per_frame({window({{0, 0}, output}, 0xFF102030, false, 1.0f, geom::Size{960, 540})});
+    RecordProperty("ms_per_frame", std::to_string(ms));
+}
+
+TEST_F(SoftwareRendererPerformance, client_scaled_fractionally)
+{
+    auto const ms = ms_per_frame({window({{0, 0}, output}, 0xFF102030, false, 1.0f, geom::Size{1280, 720})});
+    RecordProperty("ms_per_frame", std::to_string(ms));
+}
+
+TEST_F(SoftwareRendererPerformance, small_damage_into_aged_buffer)
+{
+    target.age = 1;
+    auto const ms = ms_per_frame(desktop(), geom::Rectangles{{{400, 400}, {200, 20}}});
+    RecordProperty("ms_per_frame", std::to_string(ms));
+}
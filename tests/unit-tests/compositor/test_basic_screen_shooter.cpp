@@ -47,6 +47,7 @@ class MockBufferRenderTarget: public mrg::BufferRenderTarget
 {
 public:
     MOCK_METHOD(void, set_buffer, (std::shared_ptr<mrs::WriteMappableBuffer> const& buffer), (override));
+    MOCK_METHOD(void, set_dmabuf, (std::shared_ptr<mg::Buffer> const& buffer), (override));
     MOCK_METHOD(geom::Size, size, (), (const, override));
     MOCK_METHOD(void, make_current, (), (override));
     MOCK_METHOD(void, release_current, (), (override));
@@ -152,6 +153,38 @@ TEST_F(BasicScreenShooter, sets_buffer_before_render)
     executor.execute();
 }
 
+TEST_F(BasicScreenShooter, renders_directly_into_dmabuf)
+{
+    std::shared_ptr<mg::Buffer> const dmabuf = mt::fake_shared(buffer);
+    shooter.capture_dmabuf(dmabuf, viewport_rect, [&](auto time)
+        {
+            callback.Call(time);
+        });
+    InSequence seq;
+    EXPECT_CALL(render_target, make_current());
+    EXPECT_CALL(render_target, set_dmabuf(Eq(dmabuf)));
+    EXPECT_CALL(render_target, bind());
+    EXPECT_CALL(renderer, set_viewport(Eq(viewport_rect)));
+    EXPECT_CALL(renderer, render(_));
+    EXPECT_CALL(render_target, release_current());
+    EXPECT_CALL(callback, Call(std::make_optional(clock.now())));
+    executor.execute();
+}
+
+TEST_F(BasicScreenShooter, dmabuf_import_failure_causes_graceful_failure)
+{
+    ON_CALL(render_target, set_dmabuf(_)).WillByDefault(Invoke([](auto)
+        {
+            throw std::runtime_error{"throw in set_dmabuf()!"};
+        }));
+    shooter.capture_dmabuf(mt::fake_shared(buffer), viewport_rect, [&](auto time)
+        {
+            callback.Call(time);
+        });
+    EXPECT_CALL(callback, Call(nullopt_time));
+    executor.execute();
+}
+
 TEST_F(BasicScreenShooter, throw_in_scene_elements_for_causes_graceful_failure)
 {
     ON_CALL(scene, scene_elements_for(_)).WillByDefault(Invoke([](auto) -> mc::SceneElementSequence
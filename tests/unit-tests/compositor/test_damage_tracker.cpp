@@ -0,0 +1,191 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/damage_tracker.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+namespace geom = mir::geometry;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+class MovableRenderable : public mtd::FakeRenderable
+{
+public:
+    MovableRenderable(geom::Rectangle const& position)
+        : FakeRenderable{position},
+          position{position}
+    {
+    }
+
+    geom::Rectangle screen_position() const override
+    {
+        return position;
+    }
+
+    std::optional<geom::Rectangles> buffer_damage_since(mg::BufferID) const override
+    {
+        return buffer_damage;
+    }
+
+    geom::Rectangle position;
+    std::optional<geom::Rectangles> buffer_damage;
+};
+
+struct DamageTracker : Test
+{
+    geom::Rectangle const view_area{{0, 0}, {1920, 1080}};
+    std::shared_ptr<MovableRenderable> const bottom =
+        std::make_shared<MovableRenderable>(geom::Rectangle{{10, 10}, {100, 100}});
+    std::shared_ptr<MovableRenderable> const top =
+        std::make_shared<MovableRenderable>(geom::Rectangle{{500, 500}, {20, 30}});
+
+    mc::DamageTracker tracker;
+};
+
+auto rectangles_of(geom::Rectangles const& rectangles) -> std::vector<geom::Rectangle>
+{
+    return {rectangles.begin(), rectangles.end()};
+}
+}
+
+TEST_F(DamageTracker, first_frame_damages_whole_view_area)
+{
+    auto const damage = tracker.damage_for({bottom, top}, view_area);
+
+    EXPECT_THAT(rectangles_of(damage), ElementsAre(view_area));
+}
+
+TEST_F(DamageTracker, unchanged_frame_has_no_damage)
+{
+    tracker.damage_for({bottom, top}, view_area);
+
+    auto const damage = tracker.damage_for({bottom, top}, view_area);
+
+    EXPECT_THAT(damage.size(), Eq(0u));
+}
+
+TEST_F(DamageTracker, new_buffer_damages_renderable)
+{
+    tracker.damage_for({bottom, top}, view_area);
+
+    top->set_buffer(std::make_shared<mtd::StubBuffer>());
+    auto const damage = tracker.damage_for({bottom, top}, view_area);
+
+    EXPECT_THAT(damage.bounding_rectangle(), Eq(top->position));
+}
+
+TEST_F(DamageTracker, moved_renderable_damages_old_and_new_position)
+{
+    tracker.damage_for({bottom, top}, view_area);
+
+    auto const old_position = top->position;
+    top->position = geom::Rectangle{{600, 700}, {20, 30}};
+    auto const damage = tracker.damage_for({bottom, top}, view_area);
+
+    EXPECT_THAT(rectangles_of(damage), UnorderedElementsAre(old_position, top->position));
+}
+
+TEST_F(DamageTracker, removed_renderable_damages_old_position)
+{
+    tracker.damage_for({bottom, top}, view_area);
+
+    auto const damage = tracker.damage_for({bottom}, view_area);
+
+    EXPECT_THAT(rectangles_of(damage), ElementsAre(top->position));
+}
+
+TEST_F(DamageTracker, added_renderable_damages_new_position)
+{
+    tracker.damage_for({bottom}, view_area);
+
+    auto const damage = tracker.damage_for({bottom, top}, view_area);
+
+    EXPECT_THAT(rectangles_of(damage), ElementsAre(top->position));
+}
+
+TEST_F(DamageTracker, restacking_damages_restacked_renderables)
+{
+    tracker.damage_for({bottom, top}, view_area);
+
+    auto const damage = tracker.damage_for({top, bottom}, view_area);
+
+    EXPECT_THAT(damage.bounding_rectangle(), Eq(geom::Rectangle{{10, 10}, {510, 520}}));
+}
+
+TEST_F(DamageTracker, damage_is_clipped_to_view_area)
+{
+    tracker.damage_for({bottom}, view_area);
+
+    auto const partly_visible =
+        std::make_shared<MovableRenderable>(geom::Rectangle{{1900, 1000}, {100, 100}});
+    auto const damage = tracker.damage_for({bottom, partly_visible}, view_area);
+
+    EXPECT_THAT(rectangles_of(damage), ElementsAre(geom::Rectangle{{1900, 1000}, {20, 80}}));
+}
+
+TEST_F(DamageTracker, changed_view_area_damages_everything)
+{
+    tracker.damage_for({bottom, top}, view_area);
+
+    geom::Rectangle const new_view_area{{0, 0}, {1280, 720}};
+    auto const damage = tracker.damage_for({bottom, top}, new_view_area);
+
+    EXPECT_THAT(rectangles_of(damage), ElementsAre(new_view_area));
+}
+
+TEST_F(DamageTracker, invalidate_damages_everything)
+{
+    tracker.damage_for({bottom, top}, view_area);
+
+    tracker.invalidate();
+    auto const damage = tracker.damage_for({bottom, top}, view_area);
+
+    EXPECT_THAT(rectangles_of(damage), ElementsAre(view_area));
+}
+
+TEST_F(DamageTracker, new_buffer_with_damage_damages_only_scaled_damage)
+{
+    geom::Size const buffer_size{10, 15};
+    top->set_buffer(std::make_shared<mtd::StubBuffer>(buffer_size));
+    tracker.damage_for({bottom, top}, view_area);
+
+    top->set_buffer(std::make_shared<mtd::StubBuffer>(buffer_size));
+    top->buffer_damage = geom::Rectangles{geom::Rectangle{{1, 1}, {2, 2}}};
+    auto const damage = tracker.damage_for({bottom, top}, view_area);
+
+    EXPECT_THAT(rectangles_of(damage), ElementsAre(geom::Rectangle{{502, 502}, {4, 4}}));
+}
+
+TEST_F(DamageTracker, buffer_damage_is_ignored_when_renderable_also_moved)
+{
+    tracker.damage_for({bottom, top}, view_area);
+
+    auto const old_position = top->position;
+    top->position = geom::Rectangle{{600, 700}, {20, 30}};
+    top->set_buffer(std::make_shared<mtd::StubBuffer>());
+    top->buffer_damage = geom::Rectangles{geom::Rectangle{{1, 1}, {2, 2}}};
+    auto const damage = tracker.damage_for({bottom, top}, view_area);
+
+    EXPECT_THAT(rectangles_of(damage), UnorderedElementsAre(old_position, top->position));
+}
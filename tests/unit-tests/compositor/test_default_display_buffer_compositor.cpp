@@ -116,6 +116,40 @@ TEST_F(DefaultDisplayBufferCompositor, render)
     compositor.composite(make_scene_elements({}));
 }
 
+TEST_F(DefaultDisplayBufferCompositor, skips_frame_when_nothing_has_changed)
+{
+    using namespace testing;
+    EXPECT_CALL(mock_renderer, render(_))
+        .Times(1);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    EXPECT_TRUE(compositor.composite(make_scene_elements({big, small})));
+    EXPECT_FALSE(compositor.composite(make_scene_elements({big, small})));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, renders_only_damage_after_first_frame)
+{
+    using namespace testing;
+    InSequence seq;
+    EXPECT_CALL(mock_renderer, set_damage(Property(&geom::Rectangles::bounding_rectangle, screen)));
+    EXPECT_CALL(mock_renderer, render(_));
+    EXPECT_CALL(mock_renderer, set_damage(Property(&geom::Rectangles::bounding_rectangle, small->screen_position())));
+    EXPECT_CALL(mock_renderer, render(_));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+    small->set_buffer(std::make_shared<mtd::StubBuffer>());
+    compositor.composite(make_scene_elements({big, small}));
+}
+
 TEST_F(DefaultDisplayBufferCompositor, optimization_skips_composition)
 {
     using namespace testing;
@@ -146,6 +180,68 @@ TEST_F(DefaultDisplayBufferCompositor, optimization_skips_composition)
     compositor.composite(make_scene_elements({}));
 }
 
+TEST_F(DefaultDisplayBufferCompositor, renders_only_what_is_not_on_planes)
+{
+    using namespace testing;
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .WillOnce(Return(mg::RenderableList{big}));
+    EXPECT_CALL(mock_renderer, set_damage(Property(&geom::Rectangles::bounding_rectangle, screen)));
+    EXPECT_CALL(mock_renderer, render(ContainerEq(mg::RenderableList{big})));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    EXPECT_TRUE(compositor.composite(make_scene_elements({big, small})));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, damages_what_moves_off_a_plane)
+{
+    using namespace testing;
+    InSequence seq;
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .WillOnce(Return(mg::RenderableList{big}));
+    EXPECT_CALL(mock_renderer, set_damage(_));
+    EXPECT_CALL(mock_renderer, render(_));
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .WillOnce(Return(mg::RenderableList{big, small}));
+    EXPECT_CALL(mock_renderer, set_damage(Property(&geom::Rectangles::bounding_rectangle, small->screen_position())));
+    EXPECT_CALL(mock_renderer, render(ContainerEq(mg::RenderableList{big, small})));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+    small->set_buffer(std::make_shared<mtd::StubBuffer>());
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, changes_on_planes_do_not_damage_what_is_rendered)
+{
+    using namespace testing;
+    InSequence seq;
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .WillOnce(Return(mg::RenderableList{big}));
+    EXPECT_CALL(mock_renderer, set_damage(_));
+    EXPECT_CALL(mock_renderer, render(_));
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .WillOnce(Return(mg::RenderableList{big}));
+    EXPECT_CALL(mock_renderer, set_damage(Property(&geom::Rectangles::size, 0u)));
+    EXPECT_CALL(mock_renderer, render(ContainerEq(mg::RenderableList{big})));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+    small->set_buffer(std::make_shared<mtd::StubBuffer>());
+    EXPECT_TRUE(compositor.composite(make_scene_elements({big, small})));
+}
+
 TEST_F(DefaultDisplayBufferCompositor, rendering_reports_everything)
 {
     using namespace testing;
@@ -273,7 +369,7 @@ TEST_F(DefaultDisplayBufferCompositor, optimization_toggles_seamlessly)
         .InSequence(seq);
     EXPECT_CALL(mock_renderer, set_viewport(screen))
         .InSequence(seq);
-    EXPECT_CALL(mock_renderer, render(IsEmpty()))
+    EXPECT_CALL(mock_renderer, render(ElementsAre(small)))
         .InSequence(seq);
 
     mc::DefaultDisplayBufferCompositor compositor(
@@ -281,9 +377,11 @@ TEST_F(DefaultDisplayBufferCompositor, optimization_toggles_seamlessly)
         mt::fake_shared(mock_renderer),
         mr::null_compositor_report());
 
+    // The scene has to change for the second frame to be composited at all...
     compositor.composite(make_scene_elements({}));
-    compositor.composite(make_scene_elements({}));
-    compositor.composite(make_scene_elements({}));
+    compositor.composite(make_scene_elements({small}));
+    // ...but after an overlaid frame an unchanged scene still needs rendering
+    compositor.composite(make_scene_elements({small}));
 
     fullscreen->set_buffer({});  // Avoid GMock complaining about false leaks
 }
@@ -319,6 +417,53 @@ TEST_F(DefaultDisplayBufferCompositor, occluded_surfaces_are_not_rendered)
     }));
 }
 
+TEST_F(DefaultDisplayBufferCompositor, partly_occluded_surfaces_are_clipped_to_what_is_visible)
+{
+    using namespace testing;
+
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0,0},{200,100}});
+    auto const top = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{50,0},{150,100}});
+
+    EXPECT_CALL(mock_renderer, render(ElementsAre(
+        Pointee(AllOf(
+            Property(&mg::Renderable::id, Eq(bottom->id())),
+            Property(&mg::Renderable::screen_position, Eq(bottom->screen_position())),
+            Property(&mg::Renderable::clip_area, Optional(geom::Rectangle{{0,0},{50,100}})))),
+        Eq(top))));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+    compositor.composite(make_scene_elements({bottom, top}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, clipping_does_not_hold_surfaces_after_the_frame)
+{
+    using namespace testing;
+
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0,0},{200,100}});
+    auto const top = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{50,0},{150,100}});
+    auto const moved_top = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{100,0},{100,100}});
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+    compositor.composite(make_scene_elements({bottom, top}));
+
+    EXPECT_THAT(bottom.use_count(), Eq(1));
+
+    // The next frame clips by what covers it then
+    EXPECT_CALL(mock_renderer, render(ElementsAre(
+        Pointee(AllOf(
+            Property(&mg::Renderable::id, Eq(bottom->id())),
+            Property(&mg::Renderable::clip_area, Optional(geom::Rectangle{{0,0},{100,100}})))),
+        Eq(moved_top))));
+
+    compositor.composite(make_scene_elements({bottom, moved_top}));
+}
+
 namespace
 {
 struct MockSceneElement : mc::SceneElement
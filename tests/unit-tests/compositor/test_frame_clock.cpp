@@ -0,0 +1,200 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/frame_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mt = mir::time;
+
+namespace
+{
+struct FrameClock : Test
+{
+    mc::FrameClock clock;
+    int const compositor_a{0}, compositor_b{0};
+    std::chrono::nanoseconds const fallback{1h};
+
+    static auto in(std::chrono::nanoseconds time) -> mt::PosixTimestamp
+    {
+        return mt::PosixTimestamp::now(CLOCK_MONOTONIC) + time;
+    }
+};
+}
+
+TEST_F(FrameClock, without_predictions_uses_fallback)
+{
+    EXPECT_THAT(clock.time_until_next_frame(fallback), Eq(fallback));
+}
+
+TEST_F(FrameClock, follows_prediction)
+{
+    clock.predict(&compositor_a, in(10ms), 16ms);
+
+    auto const until = clock.time_until_next_frame(fallback);
+
+    EXPECT_THAT(until, Le(10ms));
+    EXPECT_THAT(until, Gt(5ms));
+}
+
+TEST_F(FrameClock, takes_soonest_prediction)
+{
+    clock.predict(&compositor_a, in(10ms), 16ms);
+    clock.predict(&compositor_b, in(3ms), 16ms);
+
+    EXPECT_THAT(clock.time_until_next_frame(fallback), Le(3ms));
+}
+
+TEST_F(FrameClock, repeats_past_prediction_every_period)
+{
+    clock.predict(&compositor_a, in(-1s - 6ms), 10ms);
+
+    auto const until = clock.time_until_next_frame(fallback);
+
+    EXPECT_THAT(until, Le(4ms));
+    EXPECT_THAT(until, Ge(0ms));
+}
+
+TEST_F(FrameClock, forgotten_prediction_is_not_used)
+{
+    clock.predict(&compositor_a, in(10ms), 16ms);
+    clock.forget(&compositor_a);
+
+    EXPECT_THAT(clock.time_until_next_frame(fallback), Eq(fallback));
+}
+
+TEST_F(FrameClock, presentation_handler_is_told_of_next_frame)
+{
+    std::optional<mg::Frame> presented;
+    std::chrono::nanoseconds refresh{0};
+    clock.on_next_presentation(std::nullopt, [&](mg::Frame const& frame, std::chrono::nanoseconds period)
+        {
+            presented = frame;
+            refresh = period;
+        });
+
+    mg::Frame frame;
+    frame.msc = 42;
+    frame.ust = in(0ms);
+    frame.vsync = true;
+    clock.presented(&compositor_a, frame, 16ms);
+
+    ASSERT_THAT(presented, Ne(std::nullopt));
+    EXPECT_THAT(presented->msc, Eq(42));
+    EXPECT_THAT(presented->vsync, Eq(true));
+    EXPECT_THAT(refresh, Eq(16ms));
+}
+
+TEST_F(FrameClock, presentation_handler_is_called_only_once)
+{
+    int calls{0};
+    clock.on_next_presentation(std::nullopt, [&](auto const&, auto) { ++calls; });
+
+    clock.presented(&compositor_a, mg::Frame{}, 16ms);
+    clock.presented(&compositor_b, mg::Frame{}, 16ms);
+
+    EXPECT_THAT(calls, Eq(1));
+}
+
+TEST_F(FrameClock, presentation_handler_can_wait_for_following_frame)
+{
+    std::vector<int64_t> mscs;
+    clock.on_next_presentation(std::nullopt, [&](mg::Frame const& first, auto)
+        {
+            mscs.push_back(first.msc);
+            clock.on_next_presentation(std::nullopt, [&](mg::Frame const& second, auto) { mscs.push_back(second.msc); });
+        });
+
+    mg::Frame frame;
+    frame.msc = 1;
+    clock.presented(&compositor_a, frame, 16ms);
+    frame.msc = 2;
+    clock.presented(&compositor_a, frame, 16ms);
+
+    EXPECT_THAT(mscs, ElementsAre(1, 2));
+}
+
+TEST_F(FrameClock, compositors_presentation_handler_ignores_other_compositors)
+{
+    int calls{0};
+    clock.on_next_presentation(&compositor_a, [&](auto const&, auto) { ++calls; });
+    clock.posted(&compositor_a);
+    clock.posted(&compositor_b);
+
+    clock.presented(&compositor_b, mg::Frame{}, 16ms);
+    EXPECT_THAT(calls, Eq(0));
+
+    clock.presented(&compositor_a, mg::Frame{}, 16ms);
+    EXPECT_THAT(calls, Eq(1));
+}
+
+TEST_F(FrameClock, compositors_presentation_handler_waits_for_its_post)
+{
+    int calls{0};
+    clock.on_next_presentation(&compositor_a, [&](auto const&, auto) { ++calls; });
+
+    // A frame posted before the content was consumed
+    clock.presented(&compositor_a, mg::Frame{}, 16ms);
+    EXPECT_THAT(calls, Eq(0));
+
+    clock.posted(&compositor_a);
+    clock.presented(&compositor_a, mg::Frame{}, 16ms);
+    EXPECT_THAT(calls, Eq(1));
+}
+
+TEST_F(FrameClock, compositors_presentation_handler_is_not_called_for_the_post_before)
+{
+    int calls{0};
+    clock.posted(&compositor_a);
+    clock.on_next_presentation(&compositor_a, [&](auto const&, auto) { ++calls; });
+    clock.posted(&compositor_a);
+
+    // The platform hasn't waited for the latest flip yet, so the frame is of the post before
+    clock.presented(&compositor_a, mg::Frame{}, 16ms, false);
+    EXPECT_THAT(calls, Eq(0));
+
+    clock.posted(&compositor_a);
+    clock.presented(&compositor_a, mg::Frame{}, 16ms, false);
+    EXPECT_THAT(calls, Eq(1));
+}
+
+TEST_F(FrameClock, forgotten_compositors_presentation_handler_takes_any_frame)
+{
+    int calls{0};
+    clock.on_next_presentation(&compositor_a, [&](auto const&, auto) { ++calls; });
+    clock.forget(&compositor_a);
+
+    clock.posted(&compositor_b);
+    clock.presented(&compositor_b, mg::Frame{}, 16ms);
+
+    EXPECT_THAT(calls, Eq(1));
+}
+
+TEST_F(FrameClock, knows_the_compositor_on_this_thread)
+{
+    EXPECT_THAT(mc::FrameClock::compositor_on_this_thread(), Eq(std::nullopt));
+
+    mc::FrameClock::set_compositor_on_this_thread(&compositor_a);
+    EXPECT_THAT(mc::FrameClock::compositor_on_this_thread(), Eq(std::make_optional<mc::CompositorID>(&compositor_a)));
+
+    mc::FrameClock::set_compositor_on_this_thread(std::nullopt);
+    EXPECT_THAT(mc::FrameClock::compositor_on_this_thread(), Eq(std::nullopt));
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/frame_scheduler.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mt = mir::time;
+
+namespace
+{
+auto at(std::chrono::nanoseconds time) -> mt::PosixTimestamp
+{
+    return mt::PosixTimestamp{CLOCK_MONOTONIC, time};
+}
+
+auto frame(int64_t msc, std::chrono::nanoseconds ust) -> mg::Frame
+{
+    return mg::Frame{msc, at(ust)};
+}
+
+struct FrameScheduler : Test
+{
+    std::chrono::nanoseconds const headroom{2ms};
+    mc::FrameScheduler scheduler{headroom};
+};
+}
+
+TEST_F(FrameScheduler, cannot_predict_before_two_frames_are_presented)
+{
+    EXPECT_THAT(scheduler.composite_time(at(1s)), Eq(std::nullopt));
+
+    scheduler.presented(frame(1, 1s));
+
+    EXPECT_THAT(scheduler.refresh_period(), Eq(std::nullopt));
+    EXPECT_THAT(scheduler.composite_time(at(1s + 1ms)), Eq(std::nullopt));
+}
+
+TEST_F(FrameScheduler, estimates_refresh_period_from_presentation_timestamps)
+{
+    scheduler.presented(frame(1, 1s));
+    scheduler.presented(frame(2, 1s + 6944us));
+
+    EXPECT_THAT(scheduler.refresh_period(), Eq(6944us));
+}
+
+TEST_F(FrameScheduler, accounts_for_skipped_vblanks)
+{
+    scheduler.presented(frame(1, 1s));
+    scheduler.presented(frame(3, 1s + 32ms));
+
+    EXPECT_THAT(scheduler.refresh_period(), Eq(16ms));
+}
+
+TEST_F(FrameScheduler, takes_shortest_recent_interval_as_refresh_period)
+{
+    scheduler.presented(frame(1, 1s));
+    scheduler.presented(frame(2, 1s + 10ms));
+    scheduler.presented(frame(3, 1s + 17ms));
+    scheduler.presented(frame(4, 1s + 30ms));
+
+    EXPECT_THAT(scheduler.refresh_period(), Eq(7ms));
+}
+
+TEST_F(FrameScheduler, gaps_in_presentation_are_not_taken_as_refreshes)
+{
+    scheduler.presented(frame(1, 1s));
+    scheduler.presented(frame(2, 3s));
+
+    EXPECT_THAT(scheduler.refresh_period(), Eq(std::nullopt));
+}
+
+TEST_F(FrameScheduler, reset_frame_counter_forgets_refresh_period)
+{
+    scheduler.presented(frame(10, 1s));
+    scheduler.presented(frame(11, 1s + 16ms));
+    scheduler.presented(frame(1, 2s));
+
+    EXPECT_THAT(scheduler.refresh_period(), Eq(std::nullopt));
+}
+
+TEST_F(FrameScheduler, margin_covers_slowest_recent_render)
+{
+    EXPECT_THAT(scheduler.margin(), Eq(headroom));
+
+    scheduler.rendered(3ms);
+    scheduler.rendered(5ms);
+    scheduler.rendered(4ms);
+
+    EXPECT_THAT(scheduler.margin(), Eq(headroom + 5ms));
+}
+
+TEST_F(FrameScheduler, composites_margin_before_next_vblank)
+{
+    scheduler.presented(frame(1, 1s));
+    scheduler.presented(frame(2, 1s + 16ms));
+    scheduler.rendered(3ms);
+
+    auto const margin = headroom + 3ms;
+    EXPECT_THAT(scheduler.composite_time(at(1s + 17ms)), Eq(at(1s + 32ms - margin)));
+}
+
+TEST_F(FrameScheduler, composites_for_following_vblank_when_too_late_for_the_next)
+{
+    scheduler.presented(frame(1, 1s));
+    scheduler.presented(frame(2, 1s + 16ms));
+
+    EXPECT_THAT(scheduler.composite_time(at(1s + 31ms)), Eq(at(1s + 48ms - headroom)));
+}
+
+TEST_F(FrameScheduler, extrapolates_vblanks_after_idling)
+{
+    scheduler.presented(frame(1, 1s));
+    scheduler.presented(frame(2, 1s + 16ms));
+
+    EXPECT_THAT(scheduler.composite_time(at(1s + 100ms)), Eq(at(1s + 112ms - headroom)));
+}
+
+TEST_F(FrameScheduler, margin_longer_than_refresh_period_targets_a_later_vblank)
+{
+    scheduler.presented(frame(1, 1s));
+    scheduler.presented(frame(2, 1s + 16ms));
+    scheduler.rendered(20ms);
+
+    auto const margin = headroom + 20ms;
+    EXPECT_THAT(scheduler.composite_time(at(1s + 17ms)), Eq(at(1s + 48ms - margin)));
+}
@@ -200,3 +200,129 @@ TEST_F(OcclusionFilterTest,
     EXPECT_THAT(renderables_from(occlusions), ElementsAre(partially_onscreen));
     EXPECT_THAT(renderables_from(elements), ElementsAre(covering));
 }
+
+TEST_F(OcclusionFilterTest, window_covered_by_several_others_together_is_occluded)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(100, 100, 200, 200);
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 200, 400);
+    auto const right = std::make_shared<mtd::FakeRenderable>(200, 0, 200, 400);
+    auto elements = scene_elements_from({bottom, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(left, right));
+}
+
+TEST_F(OcclusionFilterTest, window_not_quite_covered_by_several_others_is_not_occluded)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(100, 100, 200, 200);
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 199, 400);
+    auto const right = std::make_shared<mtd::FakeRenderable>(200, 0, 200, 400);
+    auto elements = scene_elements_from({bottom, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, left, right));
+}
+
+TEST_F(OcclusionFilterTest, shaped_window_occludes_with_its_opaque_region)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {100, 100}}, 1.0f, false);
+    top->set_opaque_region({{{20, 20}, {80, 80}}});
+    auto const inside = std::make_shared<mtd::FakeRenderable>(30, 30, 10, 10);
+    auto const outside = std::make_shared<mtd::FakeRenderable>(10, 10, 5, 5);
+    auto elements = scene_elements_from({outside, inside, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(inside));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(outside, top));
+}
+
+TEST_F(OcclusionFilterTest, translucent_window_occludes_nothing_despite_opaque_region)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {100, 100}}, 0.5f);
+    top->set_opaque_region({{{10, 10}, {100, 100}}});
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(30, 30, 10, 10);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+}
+
+TEST_F(OcclusionFilterTest, unshaped_window_occludes_beyond_its_opaque_region)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {100, 100}});
+    top->set_opaque_region({{{20, 20}, {10, 10}}});
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(50, 50, 10, 10);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+}
+
+TEST_F(OcclusionFilterTest, opaque_region_outside_window_occludes_nothing)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {10, 10}}, 1.0f, false);
+    top->set_opaque_region({{{100, 100}, {100, 100}}});
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(120, 120, 10, 10);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+}
+
+TEST_F(OcclusionFilterTest, reports_visible_bounds_of_partly_covered_windows)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(0, 0, 200, 100);
+    auto const top = std::make_shared<mtd::FakeRenderable>(50, 0, 150, 100);
+    auto const beside = std::make_shared<mtd::FakeRenderable>(500, 500, 10, 10);
+    auto elements = scene_elements_from({bottom, beside, top});
+    std::vector<std::optional<Rectangle>> visible_bounds;
+
+    filter_occlusions_from(elements, monitor_rect, visible_bounds);
+
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, beside, top));
+    EXPECT_THAT(visible_bounds, ElementsAre(
+        Optional(Rectangle{{0, 0}, {50, 100}}),
+        Eq(std::nullopt),
+        Eq(std::nullopt)));
+}
+
+TEST_F(OcclusionFilterTest, window_visible_either_side_of_another_is_not_clipped)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(0, 0, 300, 100);
+    auto const middle = std::make_shared<mtd::FakeRenderable>(100, 0, 100, 100);
+    auto elements = scene_elements_from({bottom, middle});
+    std::vector<std::optional<Rectangle>> visible_bounds;
+
+    filter_occlusions_from(elements, monitor_rect, visible_bounds);
+
+    EXPECT_THAT(visible_bounds, ElementsAre(Eq(std::nullopt), Eq(std::nullopt)));
+}
+
+TEST_F(OcclusionFilterTest, many_occlusions_keep_the_order_of_both_lists)
+{
+    std::vector<std::shared_ptr<mg::Renderable>> renderables;
+    std::vector<std::shared_ptr<mg::Renderable>> expected_visible;
+    std::vector<std::shared_ptr<mg::Renderable>> expected_occluded;
+    for (auto i = 0; i != 50; ++i)
+    {
+        auto const covered = std::make_shared<mtd::FakeRenderable>(20 * i, 0, 10, 10);
+        auto const covering = std::make_shared<mtd::FakeRenderable>(20 * i, 0, 20, 10);
+        renderables.insert(renderables.end(), {covered, covering});
+        expected_occluded.push_back(covered);
+        expected_visible.push_back(covering);
+    }
+    auto elements = scene_elements_from(renderables);
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAreArray(expected_occluded));
+    EXPECT_THAT(renderables_from(elements), ElementsAreArray(expected_visible));
+}
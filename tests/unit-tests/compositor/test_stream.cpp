@@ -15,6 +15,7 @@
  */
 
 #include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/mock_gl_buffer.h"
 #include "mir/test/fake_shared.h"
 #include "src/server/compositor/stream.h"
 
@@ -236,3 +237,87 @@ TEST_F(Stream, stream_remembers_scale_when_buffer_added)
     stream.submit_buffer(buffers[0]);
     ASSERT_THAT(stream.stream_size(), Eq(initial_size / 2));
 }
+
+TEST_F(Stream, reports_damage_between_buffers)
+{
+    geom::Rectangle const first_damage{{0, 0}, {4, 1}};
+    geom::Rectangle const second_damage{{10, 1}, {2, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1], {first_damage});
+    stream.submit_buffer(buffers[2], {second_damage});
+
+    EXPECT_THAT(stream.damage_between(buffers[1]->id(), buffers[2]->id()),
+                Eq(geom::Rectangles{second_damage}));
+    EXPECT_THAT(stream.damage_between(buffers[0]->id(), buffers[2]->id()),
+                Eq(geom::Rectangles{first_damage, second_damage}));
+    EXPECT_THAT(stream.damage_between(buffers[2]->id(), buffers[2]->id()),
+                Eq(geom::Rectangles{}));
+}
+
+TEST_F(Stream, damage_is_unknown_when_submitted_without_damage)
+{
+    stream.submit_buffer(buffers[0], {});
+    stream.submit_buffer(buffers[1]);
+
+    EXPECT_THAT(stream.damage_between(buffers[0]->id(), buffers[1]->id()), Eq(std::nullopt));
+}
+
+TEST_F(Stream, damage_is_unknown_after_resize)
+{
+    auto const resized = std::make_shared<mtd::StubBuffer>(geom::Size{20, 20});
+
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(resized, {geom::Rectangle{{0, 0}, {1, 1}}});
+
+    EXPECT_THAT(stream.damage_between(buffers[0]->id(), resized->id()), Eq(std::nullopt));
+}
+
+TEST_F(Stream, damage_is_unknown_for_unknown_or_reordered_buffers)
+{
+    auto const never_submitted = std::make_shared<mtd::StubBuffer>(initial_size);
+
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1], {geom::Rectangle{{0, 0}, {1, 1}}});
+
+    EXPECT_THAT(stream.damage_between(never_submitted->id(), buffers[1]->id()), Eq(std::nullopt));
+    EXPECT_THAT(stream.damage_between(buffers[1]->id(), buffers[0]->id()), Eq(std::nullopt));
+}
+
+TEST_F(Stream, prepares_textures_that_need_uploading_in_full)
+{
+    auto const first = std::make_shared<NiceMock<mtd::MockTextureBuffer>>(
+        initial_size, geom::Stride{}, construction_format);
+    auto const undamaged = std::make_shared<NiceMock<mtd::MockTextureBuffer>>(
+        initial_size, geom::Stride{}, construction_format);
+
+    EXPECT_CALL(*first, prepare());
+    EXPECT_CALL(*undamaged, prepare());
+
+    stream.submit_buffer(first, {geom::Rectangle{{0, 0}, {1, 1}}});
+    stream.submit_buffer(undamaged);
+}
+
+TEST_F(Stream, does_not_prepare_textures_with_known_damage)
+{
+    auto const damaged = std::make_shared<NiceMock<mtd::MockTextureBuffer>>(
+        initial_size, geom::Stride{}, construction_format);
+
+    stream.submit_buffer(buffers[0]);
+
+    EXPECT_CALL(*damaged, prepare()).Times(0);
+    stream.submit_buffer(damaged, {geom::Rectangle{{0, 0}, {1, 1}}});
+}
+
+TEST_F(Stream, prepares_textures_damaged_all_over)
+{
+    auto const damaged = std::make_shared<NiceMock<mtd::MockTextureBuffer>>(
+        initial_size, geom::Stride{}, construction_format);
+
+    stream.submit_buffer(buffers[0]);
+
+    EXPECT_CALL(*damaged, prepare());
+    stream.submit_buffer(damaged, {geom::Rectangle{{0, 0}, {INT32_MAX, INT32_MAX}}});
+
+    EXPECT_THAT(stream.damage_between(buffers[0]->id(), damaged->id()), Eq(std::nullopt));
+}
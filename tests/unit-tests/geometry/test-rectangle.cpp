@@ -231,3 +231,51 @@ TEST(geometry, rectangle_intersection)
             << "test_case.rect = " << test_case.rect;
     }
 }
+
+TEST(geometry, rectangle_difference)
+{
+    using namespace testing;
+    using namespace geom;
+
+    Rectangle const rect_base{{5,5}, {5,5}};
+
+    struct TestData
+    {
+        Rectangle const hole;
+        std::vector<Rectangle> const difference;
+    };
+
+    std::vector<TestData> const test_data
+    {
+        { rect_base, {} },
+        { {{0,0}, {20,20}}, {} },
+        { {{20,20}, {1,1}}, {rect_base} },
+        { Rectangle(), {rect_base} },
+        { {{5,5}, {5,2}}, {{{5,7}, {5,3}}} },
+        { {{8,0}, {5,20}}, {{{5,5}, {3,5}}} },
+        { {{6,6}, {3,3}}, {
+            {{5,5}, {5,1}},
+            {{5,9}, {5,1}},
+            {{5,6}, {1,3}},
+            {{9,6}, {1,3}}} }
+    };
+
+    for (auto const& test_case : test_data)
+    {
+        std::vector<Rectangle> difference;
+        difference_of(rect_base, test_case.hole, std::back_inserter(difference));
+
+        EXPECT_THAT(difference, ElementsAreArray(test_case.difference))
+            << "test_case.hole = " << test_case.hole;
+    }
+}
+
+TEST(geometry, difference_from_empty_rectangle_is_empty)
+{
+    using namespace geom;
+
+    std::vector<Rectangle> difference;
+    difference_of(Rectangle{{5,5}, {0,5}}, Rectangle{{0,0}, {1,1}}, std::back_inserter(difference));
+
+    EXPECT_TRUE(difference.empty());
+}
@@ -351,3 +351,54 @@ TEST_F(ShmBufferTest, texture_is_destroyed_on_thread_with_current_context)
         eglMakeCurrent(dummy_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     }
 }
+
+TEST_F(ShmBufferTest, prepared_buffer_is_uploaded_on_thread_with_current_context)
+{
+    GLuint const tex_id{0x8087};
+    auto const data = std::make_shared<PlatformlessShmBuffer>(size, mir_pixel_format_abgr_8888, egl_delegate);
+    mgc::MappableBackedShmBuffer buffer{data, egl_delegate};
+
+    auto const test_thread = std::this_thread::get_id();
+    EXPECT_CALL(mock_gl, glGenTextures(1, _))
+        .WillOnce(SetArgPointee<1>(tex_id));
+    EXPECT_CALL(mock_gl, glTexImage2D(GL_TEXTURE_2D, 0, _, size.width.as_int(), size.height.as_int(), 0, _, _, _))
+        .WillOnce(InvokeWithoutArgs(
+            [this, test_thread]()
+            {
+                EXPECT_THAT(std::this_thread::get_id(), Ne(test_thread));
+                EXPECT_THAT(
+                    mock_egl.current_contexts[std::this_thread::get_id()],
+                    Ne(EGL_NO_CONTEXT));
+            }));
+
+    buffer.prepare();
+    wait_for_egl_thread(*egl_delegate);
+
+    EXPECT_CALL(mock_gl, glBindTexture(GL_TEXTURE_2D, tex_id));
+    buffer.bind();
+}
+
+TEST_F(ShmBufferTest, bind_waits_on_fence_after_prepared_upload)
+{
+    EGLSyncKHR const fence{reinterpret_cast<EGLSyncKHR>(0xfe7ce)};
+    ON_CALL(mock_egl, eglQueryString(_, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_fence_sync"));
+    ON_CALL(mock_gl, glGenTextures(1, _))
+        .WillByDefault(SetArgPointee<1>(0x8088));
+
+    auto const data = std::make_shared<PlatformlessShmBuffer>(size, mir_pixel_format_abgr_8888, egl_delegate);
+    mgc::MappableBackedShmBuffer buffer{data, egl_delegate};
+
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(_, EGL_SYNC_FENCE_KHR, _))
+        .WillOnce(Return(fence));
+    EXPECT_CALL(mock_gl, glFinish()).Times(0);
+
+    buffer.prepare();
+    wait_for_egl_thread(*egl_delegate);
+
+    EXPECT_CALL(mock_egl, eglClientWaitSyncKHR(_, fence, _, _));
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    buffer.bind();
+
+    EXPECT_CALL(mock_egl, eglDestroySyncKHR(_, fence));
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/input/coalescing_dispatcher.h"
+
+#include "mir/events/event_builders.h"
+#include "mir/events/event_private.h"
+
+#include "mir/test/fake_shared.h"
+#include "mir/test/doubles/fake_alarm_factory.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+namespace mi = mir::input;
+namespace mev = mir::events;
+namespace mt = mir::test;
+namespace mtd = mt::doubles;
+namespace geom = mir::geometry;
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct RecordingDispatcher : mi::InputDispatcher
+{
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override
+    {
+        events.push_back(event);
+        return true;
+    }
+
+    void start() override {}
+    void stop() override {}
+
+    auto pointer_event(size_t i) const -> MirPointerEvent const*
+    {
+        return events.at(i)->to_input()->to_pointer();
+    }
+
+    std::vector<std::shared_ptr<MirEvent const>> events;
+};
+
+MirInputDeviceId const mouse{3};
+MirInputDeviceId const other_mouse{4};
+
+auto motion(
+    int dx, int dy,
+    std::chrono::nanoseconds time,
+    MirInputDeviceId device = mouse,
+    MirPointerButtons buttons = 0) -> std::shared_ptr<MirEvent const>
+{
+    return mev::make_pointer_event(
+        device, time, {}, mir_input_event_modifier_none, mir_pointer_action_motion, buttons,
+        geom::PointF{100.0f + time.count(), 50.0f},
+        geom::DisplacementF{dx, dy},
+        mir_pointer_axis_source_none,
+        {}, {});
+}
+
+auto scroll(float dy, int discrete, std::chrono::nanoseconds time, bool stop = false)
+    -> std::shared_ptr<MirEvent const>
+{
+    return mev::make_pointer_event(
+        mouse, time, {}, mir_input_event_modifier_none, mir_pointer_action_motion, 0,
+        geom::PointF{100.0f, 50.0f},
+        geom::DisplacementF{},
+        mir_pointer_axis_source_wheel,
+        {},
+        {geom::DeltaYF{dy}, geom::DeltaY{discrete}, stop});
+}
+
+auto button_down(std::chrono::nanoseconds time) -> std::shared_ptr<MirEvent const>
+{
+    return mev::make_pointer_event(
+        mouse, time, {}, mir_input_event_modifier_none, mir_pointer_action_button_down,
+        mir_pointer_button_primary,
+        geom::PointF{100.0f + time.count(), 50.0f},
+        geom::DisplacementF{},
+        mir_pointer_axis_source_none,
+        {}, {});
+}
+
+struct CoalescingDispatcher : Test
+{
+    std::chrono::milliseconds const interval{16ms};
+    mtd::FakeAlarmFactory alarm_factory;
+    RecordingDispatcher next;
+    mi::CoalescingDispatcher dispatcher{mt::fake_shared(next), mt::fake_shared(alarm_factory), interval};
+};
+}
+
+TEST_F(CoalescingDispatcher, passes_motion_on_at_once_after_a_quiet_interval)
+{
+    dispatcher.dispatch(motion(1, 0, 1ns));
+    EXPECT_THAT(next.events.size(), Eq(1u));
+
+    alarm_factory.advance_by(interval + 1ms);
+    alarm_factory.advance_by(interval + 1ms);
+
+    dispatcher.dispatch(motion(1, 0, 2ns));
+    EXPECT_THAT(next.events.size(), Eq(2u));
+}
+
+TEST_F(CoalescingDispatcher, merges_motion_within_an_interval_into_one_event)
+{
+    dispatcher.dispatch(motion(1, 0, 1ns));
+    dispatcher.dispatch(motion(2, 1, 2ns));
+    dispatcher.dispatch(motion(3, -4, 3ns));
+    dispatcher.dispatch(motion(4, 2, 4ns));
+
+    ASSERT_THAT(next.events.size(), Eq(1u));
+
+    alarm_factory.advance_by(interval + 1ms);
+
+    ASSERT_THAT(next.events.size(), Eq(2u));
+    auto const merged = next.pointer_event(1);
+    EXPECT_THAT(merged->motion(), Eq(geom::DisplacementF{9, -1}));
+    EXPECT_THAT(merged->position(), Eq(geom::PointF{104.0f, 50.0f}));
+    EXPECT_THAT(merged->event_time(), Eq(4ns));
+    EXPECT_THAT(merged->coalesced_event_times(), ElementsAre(2ns, 3ns));
+}
+
+TEST_F(CoalescingDispatcher, delivers_pending_motion_before_a_button_event)
+{
+    dispatcher.dispatch(motion(1, 0, 1ns));
+    dispatcher.dispatch(motion(1, 0, 2ns));
+    dispatcher.dispatch(motion(1, 0, 3ns));
+    dispatcher.dispatch(button_down(4ns));
+
+    ASSERT_THAT(next.events.size(), Eq(3u));
+    EXPECT_THAT(next.pointer_event(1)->motion(), Eq(geom::DisplacementF{2, 0}));
+    EXPECT_THAT(next.pointer_event(2)->action(), Eq(mir_pointer_action_button_down));
+}
+
+TEST_F(CoalescingDispatcher, delivers_pending_motion_before_a_key_event)
+{
+    dispatcher.dispatch(motion(1, 0, 1ns));
+    dispatcher.dispatch(motion(1, 0, 2ns));
+    dispatcher.dispatch(mev::make_key_event(
+        mouse, 3ns, {}, mir_keyboard_action_down, 0, 30, mir_input_event_modifier_none));
+
+    ASSERT_THAT(next.events.size(), Eq(3u));
+    EXPECT_THAT(next.events[1]->to_input()->input_type(), Eq(mir_input_event_type_pointer));
+    EXPECT_THAT(next.events[2]->to_input()->input_type(), Eq(mir_input_event_type_key));
+}
+
+TEST_F(CoalescingDispatcher, does_not_merge_motion_with_different_buttons_held)
+{
+    dispatcher.dispatch(motion(1, 0, 1ns));
+    dispatcher.dispatch(motion(1, 0, 2ns));
+    dispatcher.dispatch(motion(1, 0, 3ns, mouse, mir_pointer_button_primary));
+
+    ASSERT_THAT(next.events.size(), Eq(2u));
+    EXPECT_THAT(next.pointer_event(1)->event_time(), Eq(2ns));
+
+    alarm_factory.advance_by(interval + 1ms);
+
+    ASSERT_THAT(next.events.size(), Eq(3u));
+    EXPECT_THAT(next.pointer_event(2)->buttons(), Eq(mir_pointer_button_primary));
+}
+
+TEST_F(CoalescingDispatcher, does_not_merge_motion_from_different_devices)
+{
+    dispatcher.dispatch(motion(1, 0, 1ns));
+    dispatcher.dispatch(motion(1, 0, 2ns));
+    dispatcher.dispatch(motion(5, 0, 3ns, other_mouse));
+
+    ASSERT_THAT(next.events.size(), Eq(2u));
+    EXPECT_THAT(next.pointer_event(1)->device_id(), Eq(mouse));
+
+    alarm_factory.advance_by(interval + 1ms);
+
+    ASSERT_THAT(next.events.size(), Eq(3u));
+    EXPECT_THAT(next.pointer_event(2)->device_id(), Eq(other_mouse));
+    EXPECT_THAT(next.pointer_event(2)->motion(), Eq(geom::DisplacementF{5, 0}));
+}
+
+TEST_F(CoalescingDispatcher, sums_scrolling_and_ends_merging_at_a_scroll_stop)
+{
+    dispatcher.dispatch(scroll(1.5f, 1, 1ns));
+    dispatcher.dispatch(scroll(2.5f, 1, 2ns));
+    dispatcher.dispatch(scroll(3.0f, 2, 3ns));
+    dispatcher.dispatch(scroll(0.0f, 0, 4ns, true));
+    dispatcher.dispatch(scroll(7.0f, 1, 5ns));
+
+    alarm_factory.advance_by(interval + 1ms);
+
+    ASSERT_THAT(next.events.size(), Eq(3u));
+    auto const merged = next.pointer_event(1)->v_scroll();
+    EXPECT_THAT(merged.precise, Eq(geom::DeltaYF{5.5f}));
+    EXPECT_THAT(merged.discrete, Eq(geom::DeltaY{3}));
+    EXPECT_THAT(merged.value120, Eq(geom::DeltaY{360}));
+    EXPECT_TRUE(merged.stop);
+
+    alarm_factory.advance_by(interval + 1ms);
+
+    ASSERT_THAT(next.events.size(), Eq(3u));
+    EXPECT_THAT(next.pointer_event(2)->v_scroll().precise, Eq(geom::DeltaYF{7.0f}));
+}
+
+TEST_F(CoalescingDispatcher, delivers_pending_motion_when_stopped)
+{
+    dispatcher.dispatch(motion(1, 0, 1ns));
+    dispatcher.dispatch(motion(1, 0, 2ns));
+
+    dispatcher.stop();
+
+    EXPECT_THAT(next.events.size(), Eq(2u));
+}
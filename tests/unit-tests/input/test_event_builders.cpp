@@ -22,6 +22,8 @@
 
 #include <linux/input.h>
 
+#include <thread>
+
 namespace mev = mir::events;
 using namespace ::testing;
 
@@ -33,6 +35,13 @@ struct InputEventBuilder : public Test
     std::chrono::nanoseconds const timestamp = std::chrono::nanoseconds(39);
     std::vector<uint8_t> const cookie{};
     MirInputEventModifiers const modifiers = mir_input_event_modifier_meta;
+
+    auto a_pointer_event() const -> mir::EventUPtr
+    {
+        return mev::make_pointer_event(
+            device_id, timestamp, cookie, modifiers,
+            mir_pointer_action_motion, 0, 1.0f, 2.0f, 0.0f, 0.0f, 1.0f, 2.0f);
+    }
 };
 }
 
@@ -226,3 +235,50 @@ TEST_F(InputEventBuilder, when_creating_input_device_state_event_it_has_supplied
     EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_count(ids_event, 1), Eq(0));
     EXPECT_THAT(mir_input_device_state_event_device_pointer_buttons(ids_event, 1), Eq(button_state));
 }
+
+TEST_F(InputEventBuilder, reuses_the_storage_of_released_input_events)
+{
+    auto pointer_event = a_pointer_event();
+    auto const storage = pointer_event.get();
+    pointer_event.reset();
+
+    auto const key_event = mev::make_key_event(
+        device_id, timestamp, cookie, mir_keyboard_action_down, 34, 17, modifiers);
+
+    EXPECT_THAT(key_event.get(), Eq(storage));
+}
+
+TEST_F(InputEventBuilder, reuses_the_storage_of_input_events_released_on_another_thread)
+{
+    // A fresh thread, so there's no storage already free on the allocating thread
+    std::thread{
+        [this]
+        {
+            auto pointer_event = a_pointer_event();
+            auto const storage = pointer_event.get();
+
+            std::thread{[&pointer_event] { pointer_event.reset(); }}.join();
+
+            EXPECT_THAT(a_pointer_event().get(), Eq(storage));
+        }}.join();
+}
+
+TEST_F(InputEventBuilder, input_events_outlive_the_thread_that_made_them)
+{
+    mir::EventUPtr pointer_event{nullptr, [](MirEvent*) {}};
+    std::thread{[&, this] { pointer_event = a_pointer_event(); }}.join();
+
+    auto const pev = mir_input_event_get_pointer_event(mir_event_get_input_event(pointer_event.get()));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_x), Eq(1.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_y), Eq(2.0f));
+}
+
+TEST_F(InputEventBuilder, clones_of_input_events_are_released_like_the_originals)
+{
+    auto const pointer_event = a_pointer_event();
+    auto clone = mev::clone_event(*pointer_event);
+    auto const storage = clone.get();
+    clone.reset();
+
+    EXPECT_THAT(a_pointer_event().get(), Eq(storage));
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/input/input_latency.h"
+#include "mir/compositor/frame_clock.h"
+#include "mir/graphics/frame.h"
+
+#include "src/server/report/null_report_factory.h"
+#include "mir/test/doubles/mock_compositor_report.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mi = mir::input;
+namespace mr = mir::report;
+namespace mt = mir::time;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+struct InputLatency : Test
+{
+    std::shared_ptr<mc::FrameClock> const frame_clock{std::make_shared<mc::FrameClock>()};
+    std::shared_ptr<NiceMock<mtd::MockCompositorReport>> const report{
+        std::make_shared<NiceMock<mtd::MockCompositorReport>>()};
+    std::shared_ptr<mi::InputLatency> const latency{
+        std::make_shared<mi::InputLatency>(frame_clock, mr::null_input_report(), report)};
+    int const compositor{0};
+
+    static auto trace(uint64_t id, std::chrono::nanoseconds age) -> mi::InputLatency::Trace
+    {
+        return {id, mt::PosixTimestamp::now(CLOCK_MONOTONIC).nanoseconds - age};
+    }
+
+    void present(int64_t msc)
+    {
+        mg::Frame frame;
+        frame.msc = msc;
+        frame.ust = mt::PosixTimestamp::now(CLOCK_MONOTONIC);
+        frame_clock->presented(&compositor, frame, 16ms);
+    }
+};
+}
+
+TEST_F(InputLatency, reports_each_stage_of_a_trace)
+{
+    auto const traced = trace(7, 0ns);
+
+    InSequence seq;
+    EXPECT_CALL(*report, traced_input_committed(7));
+    EXPECT_CALL(*report, traced_input_composited(7));
+    EXPECT_CALL(*report, traced_input_presented(7, 42, _));
+
+    latency->sent(traced);
+    latency->committed(traced);
+    latency->composited(traced, true);
+    present(42);
+}
+
+TEST_F(InputLatency, measures_from_event_to_presentation)
+{
+    latency->composited(trace(1, 5500us), true);
+    present(1);
+
+    auto const histogram = latency->histogram();
+    EXPECT_THAT(histogram.samples, Eq(1u));
+    EXPECT_THAT(histogram.counts[5], Eq(1u));
+    EXPECT_THAT(histogram.max, Ge(5500us));
+    EXPECT_THAT(histogram.max, Lt(6ms));
+}
+
+TEST_F(InputLatency, is_presented_only_by_the_next_frame)
+{
+    latency->composited(trace(1, 1ms), true);
+    present(1);
+    present(2);
+
+    EXPECT_THAT(latency->histogram().samples, Eq(1u));
+}
+
+TEST_F(InputLatency, is_presented_by_the_compositor_that_used_it)
+{
+    int const other_compositor{0};
+
+    mc::FrameClock::set_compositor_on_this_thread(&compositor);
+    latency->composited(trace(1, 1ms), true);
+    mc::FrameClock::set_compositor_on_this_thread(std::nullopt);
+
+    frame_clock->posted(&other_compositor);
+    frame_clock->presented(&other_compositor, {}, 16ms);
+    EXPECT_THAT(latency->histogram().samples, Eq(0u));
+
+    frame_clock->posted(&compositor);
+    present(1);
+    EXPECT_THAT(latency->histogram().samples, Eq(1u));
+}
+
+TEST_F(InputLatency, counts_discarded_responses_without_sampling_them)
+{
+    EXPECT_CALL(*report, traced_input_discarded(3));
+
+    latency->composited(trace(3, 1ms), false);
+    present(1);
+
+    auto const histogram = latency->histogram();
+    EXPECT_THAT(histogram.discarded, Eq(1u));
+    EXPECT_THAT(histogram.samples, Eq(0u));
+}
+
+TEST_F(InputLatency, slow_responses_are_counted_in_the_last_bucket)
+{
+    latency->composited(trace(1, 1s), true);
+    present(1);
+
+    auto const histogram = latency->histogram();
+    EXPECT_THAT(histogram.counts.back(), Eq(1u));
+    EXPECT_THAT(histogram.percentile(1.0), Ge(1s));
+}
+
+TEST_F(InputLatency, percentiles_are_bucket_upper_bounds)
+{
+    for (auto age : {1500us, 2500us, 2500us, 9500us})
+    {
+        latency->composited(trace(1, age), true);
+        present(1);
+    }
+
+    auto const histogram = latency->histogram();
+    EXPECT_THAT(histogram.percentile(0.25), Eq(2ms));
+    EXPECT_THAT(histogram.percentile(0.5), Eq(3ms));
+    EXPECT_THAT(histogram.percentile(0.75), Eq(3ms));
+    EXPECT_THAT(histogram.percentile(1.0), Le(10ms));
+    EXPECT_THAT(histogram.mean(), Ge(4ms));
+}
+
+TEST_F(InputLatency, reset_clears_the_histogram)
+{
+    latency->composited(trace(1, 1ms), true);
+    latency->composited(trace(2, 1ms), false);
+    present(1);
+
+    latency->reset_histogram();
+
+    auto const histogram = latency->histogram();
+    EXPECT_THAT(histogram.samples, Eq(0u));
+    EXPECT_THAT(histogram.discarded, Eq(0u));
+}
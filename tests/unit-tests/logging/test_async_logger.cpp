@@ -0,0 +1,231 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ml = mir::logging;
+using namespace testing;
+
+namespace
+{
+struct Message
+{
+    ml::Severity severity;
+    std::string message;
+    std::string component;
+    std::thread::id thread;
+    std::string formatted;
+};
+
+class Recorder : public ml::Logger
+{
+public:
+    void log(ml::Severity severity, std::string const& message, std::string const& component) override
+    {
+        std::stringstream formatted;
+        ml::format_message(formatted, severity, message, component);
+
+        std::lock_guard lock{mutex};
+        messages.push_back({severity, message, component, std::this_thread::get_id(), formatted.str()});
+    }
+
+    auto recorded() -> std::vector<Message>
+    {
+        std::lock_guard lock{mutex};
+        return messages;
+    }
+
+    auto recorded_messages() -> std::vector<std::string>
+    {
+        std::vector<std::string> result;
+        for (auto const& m : recorded())
+            result.push_back(m.message);
+        return result;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<Message> messages;
+};
+
+struct AsyncLogger : Test
+{
+    std::shared_ptr<Recorder> const sink{std::make_shared<Recorder>()};
+};
+}
+
+TEST_F(AsyncLogger, passes_messages_to_sink_from_another_thread)
+{
+    ml::AsyncLogger logger{sink};
+    ml::Logger& as_logger = logger;
+
+    as_logger.log(ml::Severity::informational, "hello", "component");
+    as_logger.log("other component", ml::Severity::debug, "%s, %d", "formatted", 42);
+    logger.flush();
+
+    auto const recorded = sink->recorded();
+    ASSERT_THAT(recorded.size(), Eq(2u));
+    EXPECT_THAT(recorded[0].severity, Eq(ml::Severity::informational));
+    EXPECT_THAT(recorded[0].message, Eq("hello"));
+    EXPECT_THAT(recorded[0].component, Eq("component"));
+    EXPECT_THAT(recorded[0].thread, Ne(std::this_thread::get_id()));
+    EXPECT_THAT(recorded[1].severity, Eq(ml::Severity::debug));
+    EXPECT_THAT(recorded[1].message, Eq("formatted, 42"));
+    EXPECT_THAT(recorded[1].component, Eq("other component"));
+}
+
+TEST_F(AsyncLogger, keeps_each_threads_messages_in_order)
+{
+    int const per_thread = 1000;
+    {
+        ml::AsyncLogger logger{sink};
+
+        std::vector<std::thread> threads;
+        for (auto t = 0; t != 4; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    for (auto i = 0; i != per_thread; ++i)
+                        logger.log(ml::Severity::debug, std::to_string(i), std::to_string(t));
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    std::vector<int> next(4, 0);
+    for (auto const& m : sink->recorded())
+    {
+        auto const t = std::stoi(m.component);
+        EXPECT_THAT(std::stoi(m.message), Eq(next[t]));
+        next[t] = std::stoi(m.message) + 1;
+    }
+    // Nothing should be dropped unless a thread's buffer is full
+    EXPECT_THAT(next, Each(Eq(per_thread)));
+}
+
+TEST_F(AsyncLogger, writes_everything_logged_before_destruction)
+{
+    {
+        ml::AsyncLogger logger{sink};
+        for (auto i = 0; i != 100; ++i)
+            logger.log(ml::Severity::debug, std::to_string(i), "test");
+    }
+
+    EXPECT_THAT(sink->recorded().size(), Eq(100u));
+}
+
+TEST_F(AsyncLogger, writes_critical_messages_before_returning_after_earlier_ones)
+{
+    ml::AsyncLogger logger{sink};
+
+    logger.log(ml::Severity::debug, "before", "test");
+    logger.log(ml::Severity::critical, "critical", "test");
+
+    EXPECT_THAT(sink->recorded_messages(), ElementsAre("before", "critical"));
+}
+
+TEST_F(AsyncLogger, counts_and_reports_messages_dropped_when_a_buffer_is_full)
+{
+    class BlockingSink : public Recorder
+    {
+    public:
+        void log(ml::Severity severity, std::string const& message, std::string const& component) override
+        {
+            std::unique_lock lock{mutex};
+            released.wait(lock, [this] { return !blocked; });
+            lock.unlock();
+            Recorder::log(severity, message, component);
+        }
+
+        void release()
+        {
+            {
+                std::lock_guard lock{mutex};
+                blocked = false;
+            }
+            released.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable released;
+        bool blocked{true};
+    };
+
+    auto const blocking_sink = std::make_shared<BlockingSink>();
+    ml::AsyncLogger logger{blocking_sink, 4096};
+
+    std::string const big(500, 'x');
+    for (auto i = 0; i != 100; ++i)
+        logger.log(ml::Severity::debug, big, "test");
+
+    auto const dropped = logger.dropped_messages();
+    EXPECT_THAT(dropped, Gt(0u));
+    EXPECT_THAT(dropped, Lt(100u));
+
+    blocking_sink->release();
+    logger.flush();
+
+    auto const recorded = blocking_sink->recorded();
+    EXPECT_THAT(recorded.size(), Eq(100 - dropped + 1));
+    EXPECT_THAT(recorded.back().severity, Eq(ml::Severity::warning));
+    EXPECT_THAT(recorded.back().message, StartsWith(std::to_string(dropped) + " log messages dropped"));
+}
+
+TEST_F(AsyncLogger, messages_keep_the_time_they_were_logged)
+{
+    class SlowSink : public Recorder
+    {
+    public:
+        void log(ml::Severity severity, std::string const& message, std::string const& component) override
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+            Recorder::log(severity, message, component);
+        }
+    };
+
+    auto const slow_sink = std::make_shared<SlowSink>();
+    ml::AsyncLogger logger{slow_sink};
+
+    logger.log(ml::Severity::debug, "first", "test");
+    logger.log(ml::Severity::debug, "second", "test");
+    logger.flush();
+
+    auto const recorded = slow_sink->recorded();
+    ASSERT_THAT(recorded.size(), Eq(2u));
+
+    // Timestamps look like "[YYYY-MM-DD HH:MM:SS.uuuuuu]"
+    auto const seconds_of = [](std::string const& formatted) { return std::stod(formatted.substr(18, 9)); };
+    auto interval = seconds_of(recorded[1].formatted) - seconds_of(recorded[0].formatted);
+    if (interval < 0)
+        interval += 60;
+
+    // The messages were written 100ms apart, but logged almost together
+    EXPECT_THAT(interval, Lt(0.05));
+}
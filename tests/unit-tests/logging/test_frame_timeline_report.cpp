@@ -0,0 +1,156 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/logging/frame_timeline_report.h"
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace mtd = mir::test::doubles;
+namespace mrl = mir::report::logging;
+using Stage = mir::compositor::CompositorReport::FrameStage;
+
+namespace
+{
+struct FrameTimelineReport : Test
+{
+    std::shared_ptr<mtd::AdvanceableClock> const clock = std::make_shared<mtd::AdvanceableClock>();
+    void const* const display{&clock};
+
+    auto dump(mrl::FrameTimelineReport const& report) const -> std::string
+    {
+        std::ostringstream out;
+        report.dump(out);
+        return out.str();
+    }
+
+    void frame(mrl::FrameTimelineReport& report)
+    {
+        report.began_frame(display);
+        report.began_stage(display, Stage::render);
+        clock->advance_by(1500us);
+        report.finished_stage(display, Stage::render);
+        report.finished_frame(display);
+    }
+};
+}
+
+TEST_F(FrameTimelineReport, dumps_stages_as_chrome_trace_events)
+{
+    mrl::FrameTimelineReport report{clock, 64};
+
+    clock->advance_by(2ms);
+    frame(report);
+
+    auto const trace = dump(report);
+
+    EXPECT_THAT(trace, StartsWith(R"({"displayTimeUnit":"ns","traceEvents":[)"));
+    EXPECT_THAT(trace, HasSubstr(R"("name":"frame","cat":"frame","ph":"B","ts":2000.000)"));
+    EXPECT_THAT(trace, HasSubstr(R"("name":"render","cat":"frame","ph":"B","ts":2000.000)"));
+    EXPECT_THAT(trace, HasSubstr(R"("name":"render","cat":"frame","ph":"E","ts":3500.000)"));
+    EXPECT_THAT(trace, HasSubstr(R"("name":"frame","cat":"frame","ph":"E","ts":3500.000)"));
+    EXPECT_THAT(trace, EndsWith("]}\n"));
+}
+
+TEST_F(FrameTimelineReport, names_a_track_for_each_display)
+{
+    mrl::FrameTimelineReport report{clock, 64};
+    void const* const other_display{&report};
+
+    report.began_frame(display);
+    report.began_frame(other_display);
+
+    auto const trace = dump(report);
+
+    EXPECT_THAT(trace, HasSubstr(R"("tid":1,"args":{"name":"Display )"));
+    EXPECT_THAT(trace, HasSubstr(R"("tid":2,"args":{"name":"Display )"));
+}
+
+TEST_F(FrameTimelineReport, keeps_only_the_latest_events)
+{
+    mrl::FrameTimelineReport report{clock, 8};
+
+    report.scheduled();
+    for (int i = 0; i != 4; ++i)
+        frame(report);
+
+    auto const trace = dump(report);
+
+    // 17 events were recorded, so the first 9 have been overwritten
+    EXPECT_THAT(trace, Not(HasSubstr(R"("name":"scheduled")")));
+    EXPECT_THAT(trace, Not(HasSubstr(R"("ts":1500.000)")));
+    EXPECT_THAT(trace, HasSubstr(R"("ph":"E","ts":6000.000)"));
+}
+
+TEST_F(FrameTimelineReport, drops_ends_whose_beginnings_were_overwritten)
+{
+    mrl::FrameTimelineReport report{clock, 3};
+
+    frame(report);
+
+    auto const trace = dump(report);
+
+    EXPECT_THAT(trace, HasSubstr(R"("name":"render","cat":"frame","ph":"E")"));
+    EXPECT_THAT(trace, Not(HasSubstr(R"("name":"frame","cat":"frame","ph":"E")")));
+}
+
+TEST_F(FrameTimelineReport, dumps_traced_input_latency)
+{
+    mrl::FrameTimelineReport report{clock, 64};
+
+    report.traced_input_presented(42, 7, 12'345'678);
+
+    EXPECT_THAT(dump(report), HasSubstr(R"("args":{"trace_id":42,"latency_us":12345})"));
+}
+
+TEST_F(FrameTimelineReport, can_dump_while_compositors_record)
+{
+    mrl::FrameTimelineReport report{clock, 256};
+    std::atomic<bool> done{false};
+    int const ids[2]{};
+
+    std::vector<std::thread> compositors;
+    for (auto const& id : ids)
+    {
+        compositors.emplace_back([&, id = &id]
+            {
+                while (!done)
+                {
+                    report.began_stage(id, Stage::post);
+                    report.finished_stage(id, Stage::post);
+                }
+            });
+    }
+
+    for (int i = 0; i != 100; ++i)
+    {
+        auto const trace = dump(report);
+        EXPECT_THAT(trace, EndsWith("]}\n"));
+        EXPECT_THAT(trace, Not(HasSubstr("unknown")));
+    }
+
+    done = true;
+    for (auto& compositor : compositors)
+        compositor.join();
+}
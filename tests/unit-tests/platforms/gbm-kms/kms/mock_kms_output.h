@@ -49,6 +49,19 @@ struct MockKMSOutput : public graphics::gbm::KMSOutput
     MOCK_METHOD1(schedule_page_flip_thunk, bool(graphics::gbm::FBHandle const*));
     MOCK_METHOD0(wait_for_page_flip, void());
 
+    auto planes() -> std::vector<graphics::gbm::KMSPlane> const& override
+    {
+        return fake_planes;
+    }
+    std::vector<graphics::gbm::KMSPlane> fake_planes;
+    MOCK_METHOD1(test_planes, bool(graphics::gbm::PlaneConfiguration const&));
+    bool schedule_page_flip(graphics::gbm::PlaneConfiguration const& configuration) override
+    {
+        return schedule_planes_flip(configuration);
+    }
+    MOCK_METHOD1(schedule_planes_flip, bool(graphics::gbm::PlaneConfiguration const&));
+    MOCK_METHOD2(add_page_flip, bool(graphics::gbm::AtomicCommit&, graphics::gbm::FBHandle const&));
+
     MOCK_CONST_METHOD0(last_frame, graphics::Frame());
 
     MOCK_METHOD1(set_cursor, bool(gbm_bo*));
@@ -0,0 +1,282 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/gbm-kms/server/kms/atomic_kms_output.h"
+#include "src/platforms/gbm-kms/server/kms/atomic_commit.h"
+#include "src/platforms/gbm-kms/server/kms/fb_handle.h"
+#include "src/platforms/gbm-kms/server/kms/page_flipper.h"
+
+#include "mir/test/fake_shared.h"
+#include "mir/test/doubles/mock_drm.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fcntl.h>
+
+#include <cerrno>
+#include <cstring>
+#include <unordered_map>
+
+namespace mg = mir::graphics;
+namespace mgg = mir::graphics::gbm;
+namespace geom = mir::geometry;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+
+using namespace ::testing;
+
+namespace
+{
+
+class MockPageFlipper : public mgg::PageFlipper
+{
+public:
+    MOCK_METHOD3(schedule_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD2(schedule_commit, bool(std::vector<Target> const&, std::function<int(void*)> const&));
+    MOCK_METHOD1(wait_for_flip, mg::Frame(uint32_t));
+};
+
+struct FakeObject
+{
+    std::vector<uint32_t> property_ids;
+    std::vector<uint64_t> property_values;
+    drmModeObjectProperties properties;
+};
+
+class AtomicKMSOutputTest : public Test
+{
+public:
+    AtomicKMSOutputTest()
+        : drm_fd{open(drm_device, 0, 0)}
+    {
+        modes.push_back(mtd::FakeDRMResources::create_mode(1920, 1080, 138500, 2080, 1111, mtd::FakeDRMResources::PreferredMode));
+
+        mock_drm.reset(drm_device);
+        mock_drm.add_crtc(drm_device, crtc_id, drmModeModeInfo());
+        mock_drm.add_encoder(drm_device, encoder_id, crtc_id, 0x1);
+        mock_drm.add_connector(
+            drm_device,
+            connector_id,
+            DRM_MODE_CONNECTOR_HDMIA,
+            DRM_MODE_CONNECTED,
+            encoder_id,
+            modes,
+            possible_encoder_ids,
+            geom::Size());
+        mock_drm.prepare(drm_device);
+
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, _))
+            .WillByDefault(Invoke(
+                [this](int, uint32_t id, uint32_t) -> drmModeObjectPropertiesPtr
+                {
+                    auto const object = objects.find(id);
+                    return object != objects.end() ? &object->second.properties : &no_properties;
+                }));
+        ON_CALL(mock_drm, drmModeGetProperty(_, _))
+            .WillByDefault(Invoke([this](int, uint32_t id) { return &properties.at(id); }));
+        ON_CALL(mock_drm, drmModeGetPlaneResources(_))
+            .WillByDefault(InvokeWithoutArgs(
+                [this]()
+                {
+                    plane_resources.count_planes = plane_ids.size();
+                    plane_resources.planes = plane_ids.data();
+                    return &plane_resources;
+                }));
+        ON_CALL(mock_drm, drmModeGetPlane(_, primary_plane_id))
+            .WillByDefault(InvokeWithoutArgs([this]() { return &primary_plane; }));
+        ON_CALL(mock_drm, drmModeCreatePropertyBlob(_, _, sizeof(drmModeModeInfo), _))
+            .WillByDefault(DoAll(SetArgPointee<3>(mode_blob_id), Return(0)));
+        ON_CALL(mock_page_flipper, schedule_commit(_, _))
+            .WillByDefault(Invoke(
+                [](auto const&, std::function<int(void*)> const& commit)
+                {
+                    return commit(nullptr) == 0;
+                }));
+    }
+
+    /// Give the CRTC, connector and a primary plane the properties an atomic modeset needs
+    void add_atomic_properties()
+    {
+        uint32_t next_id{100};
+        auto const add_object = [&](uint32_t object_id, std::vector<char const*> const& names)
+            {
+                auto& object = objects[object_id];
+                for (auto const name : names)
+                {
+                    auto& property = properties[next_id];
+                    memset(&property, 0, sizeof(property));
+                    property.prop_id = next_id;
+                    strncpy(property.name, name, sizeof(property.name) - 1);
+
+                    object.property_ids.push_back(next_id++);
+                    object.property_values.push_back(strcmp(name, "type") ? 0 : DRM_PLANE_TYPE_PRIMARY);
+                }
+                object.properties.count_props = object.property_ids.size();
+                object.properties.props = object.property_ids.data();
+                object.properties.prop_values = object.property_values.data();
+            };
+
+        add_object(crtc_id, {"MODE_ID", "ACTIVE"});
+        add_object(connector_id, {"CRTC_ID"});
+        add_object(
+            primary_plane_id,
+            {"type", "FB_ID", "CRTC_ID", "SRC_X", "SRC_Y", "SRC_W", "SRC_H",
+             "CRTC_X", "CRTC_Y", "CRTC_W", "CRTC_H"});
+
+        memset(&primary_plane, 0, sizeof(primary_plane));
+        primary_plane.plane_id = primary_plane_id;
+        primary_plane.possible_crtcs = 0x1;
+        primary_plane.count_formats = 1;
+        primary_plane.formats = &primary_format;
+        plane_ids.push_back(primary_plane_id);
+    }
+
+    auto make_output() -> std::unique_ptr<mgg::AtomicKMSOutput>
+    {
+        return std::make_unique<mgg::AtomicKMSOutput>(
+            drm_fd,
+            mg::kms::get_connector(drm_fd, connector_id),
+            mt::fake_shared(mock_page_flipper));
+    }
+
+    NiceMock<mtd::MockDRM> mock_drm;
+    NiceMock<MockPageFlipper> mock_page_flipper;
+
+    char const* const drm_device = "/dev/dri/card0";
+    int const drm_fd;
+    uint32_t const crtc_id{10};
+    uint32_t const encoder_id{20};
+    uint32_t const connector_id{30};
+    uint32_t const primary_plane_id{40};
+    uint32_t const mode_blob_id{50};
+    uint32_t const fb_id{66};
+    uint32_t primary_format{0x34325258};    // DRM_FORMAT_XRGB8888
+    std::vector<drmModeModeInfo> modes;
+    std::vector<uint32_t> possible_encoder_ids{encoder_id};
+
+    std::unordered_map<uint32_t, drmModePropertyRes> properties;
+    std::unordered_map<uint32_t, FakeObject> objects;
+    drmModeObjectProperties no_properties{};
+    std::vector<uint32_t> plane_ids;
+    drmModePlaneRes plane_resources{};
+    drmModePlane primary_plane{};
+};
+
+}
+
+TEST_F(AtomicKMSOutputTest, set_crtc_is_a_single_atomic_modeset)
+{
+    add_atomic_properties();
+    auto const output = make_output();
+    mgg::FBHandle const fb{drm_fd, fb_id};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, _, DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, _, fb_id, _, _, _, _, _))
+        .Times(0);
+
+    EXPECT_TRUE(output->set_crtc(fb));
+}
+
+TEST_F(AtomicKMSOutputTest, failed_modeset_releases_mode_blob)
+{
+    add_atomic_properties();
+    auto const output = make_output();
+    mgg::FBHandle const fb{drm_fd, fb_id};
+
+    ON_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .WillByDefault(Return(-EINVAL));
+    EXPECT_CALL(mock_drm, drmModeDestroyPropertyBlob(drm_fd, mode_blob_id));
+
+    EXPECT_FALSE(output->set_crtc(fb));
+}
+
+TEST_F(AtomicKMSOutputTest, page_flip_is_a_nonblocking_commit_through_the_page_flipper)
+{
+    add_atomic_properties();
+    auto const output = make_output();
+    mgg::FBHandle const fb{drm_fd, fb_id};
+    ASSERT_TRUE(output->set_crtc(fb));
+
+    EXPECT_CALL(
+        mock_page_flipper,
+        schedule_commit(ElementsAre(Field(&mgg::PageFlipper::Target::crtc_id, crtc_id)), _));
+    EXPECT_CALL(
+        mock_drm,
+        drmModeAtomicCommit(drm_fd, _, DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_page_flipper, schedule_flip(_, _, _))
+        .Times(0);
+
+    EXPECT_TRUE(output->schedule_page_flip(fb));
+}
+
+TEST_F(AtomicKMSOutputTest, clear_crtc_is_a_single_atomic_modeset)
+{
+    add_atomic_properties();
+    auto const output = make_output();
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, _, DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, _, _, _, _, _, _, _))
+        .Times(0);
+
+    output->clear_crtc();
+}
+
+TEST_F(AtomicKMSOutputTest, outputs_flipped_together_share_a_commit)
+{
+    add_atomic_properties();
+    auto const output = make_output();
+    mgg::FBHandle const fb{drm_fd, fb_id};
+    ASSERT_TRUE(output->set_crtc(fb));
+
+    mgg::AtomicCommit commit{drm_fd};
+    EXPECT_TRUE(output->add_page_flip(commit, fb));
+
+    EXPECT_CALL(
+        mock_page_flipper,
+        schedule_commit(ElementsAre(Field(&mgg::PageFlipper::Target::crtc_id, crtc_id)), _));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, _, _, _))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(commit.schedule());
+}
+
+TEST_F(AtomicKMSOutputTest, does_not_join_commit_for_another_device)
+{
+    add_atomic_properties();
+    auto const output = make_output();
+    mgg::FBHandle const fb{drm_fd, fb_id};
+    ASSERT_TRUE(output->set_crtc(fb));
+
+    mgg::AtomicCommit commit{drm_fd + 1};
+
+    EXPECT_FALSE(output->add_page_flip(commit, fb));
+}
+
+TEST_F(AtomicKMSOutputTest, falls_back_to_legacy_modesetting_without_planes)
+{
+    auto const output = make_output();
+    mgg::FBHandle const fb{drm_fd, fb_id};
+
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, crtc_id, fb_id, _, _, Pointee(connector_id), _, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .Times(0);
+
+    EXPECT_TRUE(output->set_crtc(fb));
+}
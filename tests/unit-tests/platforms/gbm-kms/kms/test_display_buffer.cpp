@@ -32,6 +32,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <gbm.h>
+#include <drm_fourcc.h>
 
 using namespace testing;
 using namespace mir;
@@ -481,3 +482,89 @@ TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_incompatible_list)
 
     EXPECT_FALSE(db.overlay(list));
 }
+
+TEST_F(MesaDisplayBufferTest, without_planes_fullscreen_dmabuf_is_bypassed)
+{
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_THAT(db.assign_planes(bypassable_list), Eq(std::nullopt));
+
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_));
+    EXPECT_CALL(*mock_kms_output, schedule_planes_flip(_))
+        .Times(0);
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, fullscreen_dmabuf_is_flipped_onto_primary_plane)
+{
+    uint32_t const primary_id{31};
+    ON_CALL(mock_dmabuf_buffer, drm_fourcc())
+        .WillByDefault(Return(DRM_FORMAT_XRGB8888));
+    mock_kms_output->fake_planes = {
+        KMSPlane{primary_id, KMSPlane::Type::primary, std::nullopt, {{DRM_FORMAT_XRGB8888, {}}}}};
+    ON_CALL(*mock_kms_output, test_planes(_))
+        .WillByDefault(Return(true));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_THAT(db.assign_planes(bypassable_list), Eq(std::nullopt));
+
+    EXPECT_CALL(*mock_kms_output, schedule_planes_flip(ElementsAre(Field(&PlaneState::plane_id, primary_id))))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, composited_frame_is_flipped_beneath_overlay)
+{
+    uint32_t const primary_id{31};
+    uint32_t const overlay_id{32};
+    ON_CALL(mock_dmabuf_buffer, drm_fourcc())
+        .WillByDefault(Return(DRM_FORMAT_XRGB8888));
+    mock_kms_output->fake_planes = {
+        KMSPlane{primary_id, KMSPlane::Type::primary, std::nullopt, {{DRM_FORMAT_XRGB8888, {}}}},
+        KMSPlane{overlay_id, KMSPlane::Type::overlay, std::nullopt, {{DRM_FORMAT_XRGB8888, {}}}}};
+    ON_CALL(*mock_kms_output, test_planes(_))
+        .WillByDefault(Return(true));
+
+    auto const overlay_buffer = std::make_shared<NiceMock<MockBuffer>>();
+    ON_CALL(*overlay_buffer, size())
+        .WillByDefault(Return(geometry::Size{10, 10}));
+    ON_CALL(*overlay_buffer, native_buffer_base())
+        .WillByDefault(Return(&mock_dmabuf_buffer));
+    auto const overlaid = std::make_shared<FakeRenderable>(geometry::Rectangle{{22, 44}, {10, 10}});
+    overlaid->set_buffer(overlay_buffer);
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    auto const to_render = db.assign_planes({fake_software_renderable, overlaid});
+    ASSERT_THAT(to_render, Ne(std::nullopt));
+    EXPECT_THAT(*to_render, ElementsAre(fake_software_renderable));
+
+    EXPECT_CALL(
+        *mock_kms_output,
+        schedule_planes_flip(ElementsAre(
+            Field(&PlaneState::plane_id, overlay_id),
+            Field(&PlaneState::plane_id, primary_id))))
+        .WillOnce(Return(true));
+    db.post();
+}
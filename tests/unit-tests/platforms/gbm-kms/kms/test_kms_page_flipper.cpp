@@ -25,6 +25,7 @@
 #include <gmock/gmock.h>
 
 #include <stdexcept>
+#include <cerrno>
 #include <atomic>
 #include <thread>
 #include <unordered_set>
@@ -579,3 +580,64 @@ TEST_F(KMSPageFlipperTest, threads_concurrent_page_flips_dont_deadlock)
     EXPECT_EQ(counter.count_flips(), counter.count_handle_events());
     EXPECT_TRUE(counter.no_consecutive_flips_for_same_crtc_id());
 }
+
+namespace
+{
+ACTION_P2(InvokePageFlipHandler2, param, crtc_id)
+{
+    int const dont_care{0};
+    char dummy;
+
+    arg1->page_flip_handler2(dont_care, dont_care, dont_care, dont_care, crtc_id, *param);
+    ASSERT_EQ(1, read(arg0, &dummy, 1));
+}
+}
+
+TEST_F(KMSPageFlipperTest, commit_of_several_crtcs_is_waited_for_per_crtc)
+{
+    using namespace testing;
+
+    uint32_t const crtc_ids[] = {10, 11};
+    uint32_t const connector_ids[] = {23, 45};
+    void* user_data{nullptr};
+
+    // An atomic commit delivers one event per CRTC, all with the same user data
+    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
+        .WillOnce(DoAll(InvokePageFlipHandler2(&user_data, crtc_ids[1]), Return(0)))
+        .WillOnce(DoAll(InvokePageFlipHandler2(&user_data, crtc_ids[0]), Return(0)));
+    EXPECT_CALL(report, report_vsync(connector_ids[0], _));
+    EXPECT_CALL(report, report_vsync(connector_ids[1], _));
+
+    EXPECT_TRUE(page_flipper.schedule_commit(
+        {{crtc_ids[0], connector_ids[0]}, {crtc_ids[1], connector_ids[1]}},
+        [&user_data](void* data)
+        {
+            user_data = data;
+            return 0;
+        }));
+
+    mock_drm.generate_event_on(drm_device);
+    mock_drm.generate_event_on(drm_device);
+
+    page_flipper.wait_for_flip(crtc_ids[0]);
+    page_flipper.wait_for_flip(crtc_ids[1]);
+}
+
+TEST_F(KMSPageFlipperTest, failed_commit_leaves_no_flips_pending)
+{
+    using namespace testing;
+
+    uint32_t const crtc_ids[] = {10, 11};
+    uint32_t const connector_ids[] = {23, 45};
+
+    EXPECT_CALL(mock_drm, drmHandleEvent(_, _))
+        .Times(0);
+
+    EXPECT_FALSE(page_flipper.schedule_commit(
+        {{crtc_ids[0], connector_ids[0]}, {crtc_ids[1], connector_ids[1]}},
+        [](void*) { return -EINVAL; }));
+
+    page_flipper.wait_for_flip(crtc_ids[0]);
+    page_flipper.wait_for_flip(crtc_ids[1]);
+    EXPECT_NO_THROW(page_flipper.schedule_flip(crtc_ids[0], 101, connector_ids[0]));
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/gbm-kms/server/kms/kms_plane.h"
+
+#include "mir/test/doubles/mock_drm.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <drm_fourcc.h>
+#include <fcntl.h>
+
+#include <cstring>
+#include <unordered_map>
+
+namespace mgg = mir::graphics::gbm;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+struct FakePlane
+{
+    drmModePlane plane;
+    std::vector<uint32_t> formats;
+    std::vector<uint32_t> property_ids;
+    std::vector<uint64_t> property_values;
+    drmModeObjectProperties properties;
+};
+
+class KMSPlaneTest : public Test
+{
+public:
+    KMSPlaneTest()
+        : drm_fd{open(drm_device, 0, 0)}
+    {
+        mock_drm.reset(drm_device);
+        mock_drm.add_crtc(drm_device, crtc_ids[0], drmModeModeInfo());
+        mock_drm.add_crtc(drm_device, crtc_ids[1], drmModeModeInfo());
+        mock_drm.prepare(drm_device);
+
+        for (auto const& [id, name] : std::unordered_map<uint32_t, char const*>{
+                {type_property, "type"},
+                {zpos_property, "zpos"},
+                {in_formats_property, "IN_FORMATS"}})
+        {
+            auto& property = properties[id];
+            memset(&property, 0, sizeof(property));
+            property.prop_id = id;
+            strncpy(property.name, name, sizeof(property.name) - 1);
+        }
+
+        ON_CALL(mock_drm, drmModeGetPlaneResources(_))
+            .WillByDefault(InvokeWithoutArgs(
+                [this]()
+                {
+                    plane_resources.count_planes = plane_ids.size();
+                    plane_resources.planes = plane_ids.data();
+                    return &plane_resources;
+                }));
+        ON_CALL(mock_drm, drmModeGetPlane(_, _))
+            .WillByDefault(Invoke([this](int, uint32_t id) { return &planes.at(id).plane; }));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, DRM_MODE_OBJECT_PLANE))
+            .WillByDefault(Invoke([this](int, uint32_t id, uint32_t) { return &planes.at(id).properties; }));
+        ON_CALL(mock_drm, drmModeGetProperty(_, _))
+            .WillByDefault(Invoke([this](int, uint32_t id) { return &properties.at(id); }));
+        ON_CALL(mock_drm, drmModeGetPropertyBlob(_, in_formats_blob_id))
+            .WillByDefault(InvokeWithoutArgs([this]() { return &in_formats_blob; }));
+    }
+
+    void add_plane(
+        uint32_t id,
+        uint64_t type,
+        uint32_t possible_crtcs,
+        std::optional<uint64_t> zpos = std::nullopt,
+        bool has_in_formats = false)
+    {
+        auto& fake = planes[id];
+        memset(&fake.plane, 0, sizeof(fake.plane));
+        fake.formats = {DRM_FORMAT_XRGB8888, DRM_FORMAT_ARGB8888};
+        fake.plane.plane_id = id;
+        fake.plane.possible_crtcs = possible_crtcs;
+        fake.plane.count_formats = fake.formats.size();
+        fake.plane.formats = fake.formats.data();
+
+        fake.property_ids = {type_property};
+        fake.property_values = {type};
+        if (zpos)
+        {
+            fake.property_ids.push_back(zpos_property);
+            fake.property_values.push_back(*zpos);
+        }
+        if (has_in_formats)
+        {
+            fake.property_ids.push_back(in_formats_property);
+            fake.property_values.push_back(in_formats_blob_id);
+        }
+        fake.properties.count_props = fake.property_ids.size();
+        fake.properties.props = fake.property_ids.data();
+        fake.properties.prop_values = fake.property_values.data();
+
+        plane_ids.push_back(id);
+    }
+
+    /// An IN_FORMATS blob with XRGB8888 in linear and X-tiled layouts, and NV12 only linear
+    void set_in_formats()
+    {
+        std::vector<uint32_t> const formats{DRM_FORMAT_XRGB8888, DRM_FORMAT_NV12};
+        std::vector<drm_format_modifier> const modifiers{
+            {0b11, 0, 0, DRM_FORMAT_MOD_LINEAR},
+            {0b01, 0, 0, I915_FORMAT_MOD_X_TILED}};
+
+        drm_format_modifier_blob header{};
+        header.version = FORMAT_BLOB_CURRENT;
+        header.count_formats = formats.size();
+        header.formats_offset = sizeof(header);
+        header.count_modifiers = modifiers.size();
+        header.modifiers_offset = header.formats_offset + formats.size() * sizeof(uint32_t);
+
+        in_formats_data.resize(header.modifiers_offset + modifiers.size() * sizeof(drm_format_modifier));
+        memcpy(in_formats_data.data(), &header, sizeof(header));
+        memcpy(in_formats_data.data() + header.formats_offset, formats.data(), formats.size() * sizeof(uint32_t));
+        memcpy(
+            in_formats_data.data() + header.modifiers_offset,
+            modifiers.data(),
+            modifiers.size() * sizeof(drm_format_modifier));
+
+        in_formats_blob.id = in_formats_blob_id;
+        in_formats_blob.length = in_formats_data.size();
+        in_formats_blob.data = in_formats_data.data();
+    }
+
+    static auto ids_of(std::vector<mgg::KMSPlane> const& planes) -> std::vector<uint32_t>
+    {
+        std::vector<uint32_t> ids;
+        for (auto const& plane : planes)
+            ids.push_back(plane.id());
+        return ids;
+    }
+
+    NiceMock<mtd::MockDRM> mock_drm;
+    char const* const drm_device = "/dev/dri/card0";
+    int const drm_fd;
+    std::vector<uint32_t> const crtc_ids{10, 11};
+
+    uint32_t const type_property{1};
+    uint32_t const zpos_property{2};
+    uint32_t const in_formats_property{3};
+    uint32_t const in_formats_blob_id{40};
+
+    std::unordered_map<uint32_t, drmModePropertyRes> properties;
+    std::unordered_map<uint32_t, FakePlane> planes;
+    std::vector<uint32_t> plane_ids;
+    drmModePlaneRes plane_resources{};
+    std::vector<char> in_formats_data;
+    drmModePropertyBlobRes in_formats_blob{};
+};
+}
+
+TEST_F(KMSPlaneTest, enumerates_planes_dedicated_to_crtc)
+{
+    add_plane(20, DRM_PLANE_TYPE_PRIMARY, 0b01);
+    add_plane(21, DRM_PLANE_TYPE_PRIMARY, 0b10);
+    add_plane(22, DRM_PLANE_TYPE_OVERLAY, 0b01);
+    add_plane(23, DRM_PLANE_TYPE_OVERLAY, 0b10);
+    add_plane(24, DRM_PLANE_TYPE_OVERLAY, 0b11);
+    add_plane(25, DRM_PLANE_TYPE_CURSOR, 0b01);
+
+    auto const planes = mgg::KMSPlane::planes_for_crtc(drm_fd, crtc_ids[0]);
+
+    EXPECT_THAT(ids_of(planes), ElementsAre(20u, 22u, 25u));
+}
+
+TEST_F(KMSPlaneTest, reports_type_and_zpos)
+{
+    add_plane(20, DRM_PLANE_TYPE_PRIMARY, 0b01, 0);
+    add_plane(22, DRM_PLANE_TYPE_OVERLAY, 0b01, 3);
+    add_plane(25, DRM_PLANE_TYPE_CURSOR, 0b01);
+
+    auto const planes = mgg::KMSPlane::planes_for_crtc(drm_fd, crtc_ids[0]);
+
+    ASSERT_THAT(planes.size(), Eq(3u));
+    EXPECT_THAT(planes[0].type(), Eq(mgg::KMSPlane::Type::primary));
+    EXPECT_THAT(planes[0].zpos(), Eq(std::optional<uint64_t>{0}));
+    EXPECT_THAT(planes[1].type(), Eq(mgg::KMSPlane::Type::overlay));
+    EXPECT_THAT(planes[1].zpos(), Eq(std::optional<uint64_t>{3}));
+    EXPECT_THAT(planes[2].type(), Eq(mgg::KMSPlane::Type::cursor));
+    EXPECT_THAT(planes[2].zpos(), Eq(std::nullopt));
+}
+
+TEST_F(KMSPlaneTest, without_modifier_information_only_linear_buffers_are_supported)
+{
+    add_plane(22, DRM_PLANE_TYPE_OVERLAY, 0b01);
+
+    auto const planes = mgg::KMSPlane::planes_for_crtc(drm_fd, crtc_ids[0]);
+
+    ASSERT_THAT(planes.size(), Eq(1u));
+    EXPECT_TRUE(planes[0].supports(DRM_FORMAT_XRGB8888, std::nullopt));
+    EXPECT_TRUE(planes[0].supports(DRM_FORMAT_XRGB8888, DRM_FORMAT_MOD_LINEAR));
+    EXPECT_FALSE(planes[0].supports(DRM_FORMAT_XRGB8888, I915_FORMAT_MOD_X_TILED));
+    EXPECT_FALSE(planes[0].supports(DRM_FORMAT_NV12, std::nullopt));
+}
+
+TEST_F(KMSPlaneTest, supported_modifiers_are_read_from_in_formats)
+{
+    set_in_formats();
+    add_plane(22, DRM_PLANE_TYPE_OVERLAY, 0b01, std::nullopt, true);
+
+    auto const planes = mgg::KMSPlane::planes_for_crtc(drm_fd, crtc_ids[0]);
+
+    ASSERT_THAT(planes.size(), Eq(1u));
+    EXPECT_TRUE(planes[0].supports(DRM_FORMAT_XRGB8888, I915_FORMAT_MOD_X_TILED));
+    EXPECT_TRUE(planes[0].supports(DRM_FORMAT_NV12, DRM_FORMAT_MOD_LINEAR));
+    EXPECT_FALSE(planes[0].supports(DRM_FORMAT_NV12, I915_FORMAT_MOD_X_TILED));
+    EXPECT_FALSE(planes[0].supports(DRM_FORMAT_ARGB8888, DRM_FORMAT_MOD_LINEAR));
+}
@@ -0,0 +1,389 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/gbm-kms/server/kms/plane_assigner.h"
+#include "mir/graphics/dmabuf_buffer.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <drm_fourcc.h>
+
+namespace mg = mir::graphics;
+namespace mgg = mir::graphics::gbm;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+class StubDMABuf : public mg::DMABufBuffer
+{
+public:
+    StubDMABuf(geom::Size size, uint32_t format)
+        : size_{size},
+          format{format}
+    {
+    }
+
+    auto drm_fourcc() const -> uint32_t override { return format; }
+    auto modifier() const -> std::optional<uint64_t> override { return std::nullopt; }
+    auto planes() const -> std::vector<PlaneDescriptor> const& override { return no_planes; }
+    auto size() const -> geom::Size override { return size_; }
+
+private:
+    geom::Size const size_;
+    uint32_t const format;
+    std::vector<PlaneDescriptor> const no_planes;
+};
+
+class ScanoutBuffer : public mtd::StubBuffer
+{
+public:
+    ScanoutBuffer(geom::Size size, uint32_t format)
+        : StubBuffer{size},
+          dmabuf{size, format}
+    {
+    }
+
+    mg::NativeBufferBase* native_buffer_base() override
+    {
+        return &dmabuf;
+    }
+
+    StubDMABuf dmabuf;
+};
+
+auto fb_of(mg::DMABufBuffer const& buffer) -> std::shared_ptr<mgg::FBHandle const>
+{
+    return {std::shared_ptr<void>{}, reinterpret_cast<mgg::FBHandle const*>(&buffer)};
+}
+
+struct PlaneAssigner : Test
+{
+    auto scanout_renderable(geom::Rectangle position, uint32_t format = DRM_FORMAT_XRGB8888)
+        -> std::shared_ptr<mtd::FakeRenderable>
+    {
+        auto renderable = std::make_shared<mtd::FakeRenderable>(position);
+        renderable->set_buffer(std::make_shared<ScanoutBuffer>(position.size, format));
+        return renderable;
+    }
+
+    auto shm_renderable(geom::Rectangle position) -> std::shared_ptr<mtd::FakeRenderable>
+    {
+        auto renderable = std::make_shared<mtd::FakeRenderable>(position);
+        renderable->set_buffer(std::make_shared<mtd::StubBuffer>(position.size));
+        return renderable;
+    }
+
+    auto assigner() -> mgg::PlaneAssigner
+    {
+        return mgg::PlaneAssigner{
+            planes,
+            output_size,
+            &fb_of,
+            [this](mgg::PlaneConfiguration const& configuration)
+            {
+                tested.push_back(configuration);
+                return accept(configuration);
+            }};
+    }
+
+    static auto plane_ids_of(mgg::PlaneConfiguration const& configuration) -> std::vector<uint32_t>
+    {
+        std::vector<uint32_t> ids;
+        for (auto const& state : configuration)
+            ids.push_back(state.plane_id);
+        return ids;
+    }
+
+    std::unordered_map<uint32_t, std::vector<uint64_t>> const formats{
+        {DRM_FORMAT_XRGB8888, {}},
+        {DRM_FORMAT_ARGB8888, {}}};
+    std::unordered_map<uint32_t, std::vector<uint64_t>> const video_formats{
+        {DRM_FORMAT_XRGB8888, {}},
+        {DRM_FORMAT_NV12, {}}};
+
+    uint32_t const primary_id{20};
+    uint32_t const low_overlay_id{21};
+    uint32_t const high_overlay_id{22};
+    uint32_t const cursor_id{23};
+
+    std::vector<mgg::KMSPlane> planes{
+        mgg::KMSPlane{primary_id, mgg::KMSPlane::Type::primary, 0, formats},
+        mgg::KMSPlane{low_overlay_id, mgg::KMSPlane::Type::overlay, 1, video_formats},
+        mgg::KMSPlane{high_overlay_id, mgg::KMSPlane::Type::overlay, 2, formats},
+        mgg::KMSPlane{cursor_id, mgg::KMSPlane::Type::cursor, 3, formats}};
+
+    geom::Rectangle const area{{0, 0}, {1920, 1080}};
+    geom::Size output_size{area.size};
+    std::shared_ptr<mgg::FBHandle const> const composite_fb{
+        std::shared_ptr<void>{}, reinterpret_cast<mgg::FBHandle const*>(0x12ad)};
+
+    std::function<bool(mgg::PlaneConfiguration const&)> accept =
+        [](mgg::PlaneConfiguration const&) { return true; };
+    std::vector<mgg::PlaneConfiguration> tested;
+};
+}
+
+TEST_F(PlaneAssigner, fullscreen_dmabuf_is_scanned_out_from_primary_plane)
+{
+    auto const fullscreen = scanout_renderable(area);
+
+    auto const assignment = assigner().assign({fullscreen}, area, composite_fb);
+
+    EXPECT_THAT(assignment.to_composite, Eq(std::nullopt));
+    EXPECT_THAT(plane_ids_of(assignment.planes), ElementsAre(primary_id));
+    EXPECT_THAT(assignment.buffers, ElementsAre(fullscreen->buffer()));
+}
+
+TEST_F(PlaneAssigner, dmabuf_above_fullscreen_video_is_scanned_out_from_overlay)
+{
+    auto const video = scanout_renderable(area);
+    auto const osd = scanout_renderable({{100, 900}, {400, 100}});
+
+    auto const assignment = assigner().assign({video, osd}, area, composite_fb);
+
+    EXPECT_THAT(assignment.to_composite, Eq(std::nullopt));
+    EXPECT_THAT(plane_ids_of(assignment.planes), ElementsAre(high_overlay_id, primary_id));
+}
+
+TEST_F(PlaneAssigner, video_window_is_scanned_out_above_composited_desktop)
+{
+    auto const desktop = shm_renderable(area);
+    auto const video = scanout_renderable({{100, 100}, {640, 480}}, DRM_FORMAT_NV12);
+
+    auto const assignment = assigner().assign({desktop, video}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop));
+    EXPECT_THAT(plane_ids_of(assignment.planes), ElementsAre(low_overlay_id));
+    EXPECT_THAT(assignment.planes[0].destination, Eq(video->screen_position()));
+}
+
+TEST_F(PlaneAssigner, overlays_are_filled_from_the_top_down)
+{
+    auto const desktop = shm_renderable(area);
+    auto const lower = scanout_renderable({{100, 100}, {640, 480}});
+    auto const upper = scanout_renderable({{200, 200}, {640, 480}});
+
+    auto const assignment = assigner().assign({desktop, lower, upper}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop));
+    EXPECT_THAT(plane_ids_of(assignment.planes), ElementsAre(high_overlay_id, low_overlay_id));
+    EXPECT_THAT(assignment.buffers, ElementsAre(upper->buffer(), lower->buffer()));
+}
+
+TEST_F(PlaneAssigner, nothing_below_a_composited_renderable_is_scanned_out)
+{
+    auto const video = scanout_renderable(area);
+    auto const osd = shm_renderable({{100, 900}, {400, 100}});
+
+    auto const assignment = assigner().assign({video, osd}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(video, osd));
+    EXPECT_THAT(assignment.planes, IsEmpty());
+}
+
+TEST_F(PlaneAssigner, candidates_are_tested_with_composited_frame_on_primary_plane)
+{
+    auto const desktop = shm_renderable(area);
+    auto const video = scanout_renderable({{100, 100}, {640, 480}});
+
+    assigner().assign({desktop, video}, area, composite_fb);
+
+    ASSERT_THAT(tested, Not(IsEmpty()));
+    EXPECT_THAT(plane_ids_of(tested.front()), ElementsAre(high_overlay_id, primary_id));
+    EXPECT_THAT(tested.front().back().fb, Eq(composite_fb));
+}
+
+TEST_F(PlaneAssigner, configurations_failing_test_are_composited)
+{
+    auto const desktop = shm_renderable(area);
+    auto const video = scanout_renderable({{100, 100}, {640, 480}});
+    accept = [](mgg::PlaneConfiguration const& configuration) { return configuration.size() < 2; };
+
+    auto const assignment = assigner().assign({desktop, video}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop, video));
+    EXPECT_THAT(assignment.planes, IsEmpty());
+}
+
+TEST_F(PlaneAssigner, lower_overlay_is_tried_when_higher_one_fails_test)
+{
+    auto const desktop = shm_renderable(area);
+    auto const video = scanout_renderable({{100, 100}, {640, 480}});
+    accept = [this](mgg::PlaneConfiguration const& configuration)
+        {
+            return configuration.front().plane_id != high_overlay_id;
+        };
+
+    auto const assignment = assigner().assign({desktop, video}, area, composite_fb);
+
+    EXPECT_THAT(plane_ids_of(assignment.planes), ElementsAre(low_overlay_id));
+}
+
+TEST_F(PlaneAssigner, unsupported_formats_are_composited)
+{
+    auto const desktop = shm_renderable(area);
+    auto const video = scanout_renderable({{100, 100}, {640, 480}}, DRM_FORMAT_YUYV);
+
+    auto const assignment = assigner().assign({desktop, video}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop, video));
+    EXPECT_THAT(tested, IsEmpty());
+}
+
+TEST_F(PlaneAssigner, translucent_renderables_are_composited)
+{
+    auto const desktop = shm_renderable(area);
+    auto const translucent = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{100, 100}, {640, 480}}, 0.5f);
+    translucent->set_buffer(std::make_shared<ScanoutBuffer>(geom::Size{640, 480}, DRM_FORMAT_XRGB8888));
+
+    auto const assignment = assigner().assign({desktop, translucent}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop, translucent));
+}
+
+TEST_F(PlaneAssigner, shaped_renderables_are_composited)
+{
+    auto const desktop = shm_renderable(area);
+    auto const shaped = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{100, 100}, {640, 480}}, 1.0f, false);
+    shaped->set_buffer(std::make_shared<ScanoutBuffer>(geom::Size{640, 480}, DRM_FORMAT_ARGB8888));
+
+    auto const assignment = assigner().assign({desktop, shaped}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop, shaped));
+}
+
+TEST_F(PlaneAssigner, renderables_partly_off_the_output_are_composited)
+{
+    auto const desktop = shm_renderable(area);
+    auto const straddling = scanout_renderable({{1800, 100}, {640, 480}});
+
+    auto const assignment = assigner().assign({desktop, straddling}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop, straddling));
+}
+
+TEST_F(PlaneAssigner, renderables_on_other_outputs_do_not_prevent_scanout)
+{
+    auto const fullscreen = scanout_renderable(area);
+    auto const elsewhere = shm_renderable({{1920, 0}, {640, 480}});
+
+    auto const assignment = assigner().assign({fullscreen, elsewhere}, area, composite_fb);
+
+    EXPECT_THAT(assignment.to_composite, Eq(std::nullopt));
+    EXPECT_THAT(plane_ids_of(assignment.planes), ElementsAre(primary_id));
+}
+
+TEST_F(PlaneAssigner, destination_is_relative_to_output)
+{
+    geom::Rectangle const second_output{{1920, 0}, {1280, 1024}};
+    output_size = second_output.size;
+    auto const desktop = shm_renderable(second_output);
+    auto const video = scanout_renderable({{2020, 100}, {640, 480}});
+
+    auto const assignment = assigner().assign({desktop, video}, second_output, composite_fb);
+
+    ASSERT_THAT(assignment.planes.size(), Eq(1u));
+    EXPECT_THAT(assignment.planes[0].destination, Eq(geom::Rectangle{{100, 100}, {640, 480}}));
+    EXPECT_THAT(assignment.planes[0].source, Eq(geom::Rectangle{{0, 0}, {640, 480}}));
+}
+
+TEST_F(PlaneAssigner, planes_are_positioned_in_pixels_of_scaled_output)
+{
+    geom::Rectangle const scaled_output{{1920, 0}, {960, 540}};
+    output_size = {1920, 1080};
+    auto const desktop = shm_renderable(scaled_output);
+    auto const video = scanout_renderable({{2020, 50}, {320, 240}});
+
+    auto const assignment = assigner().assign({desktop, video}, scaled_output, composite_fb);
+
+    ASSERT_THAT(assignment.planes.size(), Eq(1u));
+    EXPECT_THAT(assignment.planes[0].destination, Eq(geom::Rectangle{{200, 100}, {640, 480}}));
+    EXPECT_THAT(assignment.planes[0].source, Eq(geom::Rectangle{{0, 0}, {320, 240}}));
+    ASSERT_THAT(tested, Not(IsEmpty()));
+    EXPECT_THAT(tested.front().back().source, Eq(geom::Rectangle{{0, 0}, {1920, 1080}}));
+    EXPECT_THAT(tested.front().back().destination, Eq(geom::Rectangle{{0, 0}, {1920, 1080}}));
+}
+
+TEST_F(PlaneAssigner, native_resolution_buffer_covers_scaled_output)
+{
+    geom::Rectangle const scaled_output{{0, 0}, {960, 540}};
+    output_size = {1920, 1080};
+    auto const fullscreen = std::make_shared<mtd::FakeRenderable>(scaled_output);
+    fullscreen->set_buffer(std::make_shared<ScanoutBuffer>(output_size, DRM_FORMAT_XRGB8888));
+
+    auto const assignment = assigner().assign({fullscreen}, scaled_output, composite_fb);
+
+    EXPECT_THAT(assignment.to_composite, Eq(std::nullopt));
+    ASSERT_THAT(plane_ids_of(assignment.planes), ElementsAre(primary_id));
+    EXPECT_THAT(assignment.planes[0].destination, Eq(geom::Rectangle{{0, 0}, {1920, 1080}}));
+}
+
+TEST_F(PlaneAssigner, logical_size_buffer_does_not_cover_scaled_output)
+{
+    geom::Rectangle const scaled_output{{0, 0}, {960, 540}};
+    output_size = {1920, 1080};
+    auto const fullscreen = scanout_renderable(scaled_output);
+
+    auto const assignment = assigner().assign({fullscreen}, scaled_output, composite_fb);
+
+    EXPECT_THAT(plane_ids_of(assignment.planes), Not(Contains(primary_id)));
+}
+
+TEST_F(PlaneAssigner, only_one_overlay_is_used_without_zpos)
+{
+    planes = {
+        mgg::KMSPlane{primary_id, mgg::KMSPlane::Type::primary, std::nullopt, formats},
+        mgg::KMSPlane{low_overlay_id, mgg::KMSPlane::Type::overlay, std::nullopt, formats},
+        mgg::KMSPlane{high_overlay_id, mgg::KMSPlane::Type::overlay, std::nullopt, formats}};
+    auto const desktop = shm_renderable(area);
+    auto const lower = scanout_renderable({{100, 100}, {640, 480}});
+    auto const upper = scanout_renderable({{200, 200}, {640, 480}});
+
+    auto const assignment = assigner().assign({desktop, lower, upper}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop, lower));
+    EXPECT_THAT(assignment.planes.size(), Eq(1u));
+}
+
+TEST_F(PlaneAssigner, cursor_planes_are_not_used)
+{
+    planes = {
+        mgg::KMSPlane{primary_id, mgg::KMSPlane::Type::primary, 0, formats},
+        mgg::KMSPlane{cursor_id, mgg::KMSPlane::Type::cursor, 3, formats}};
+    auto const desktop = shm_renderable(area);
+    auto const small = scanout_renderable({{100, 100}, {64, 64}});
+
+    auto const assignment = assigner().assign({desktop, small}, area, composite_fb);
+
+    ASSERT_THAT(assignment.to_composite, Ne(std::nullopt));
+    EXPECT_THAT(*assignment.to_composite, ElementsAre(desktop, small));
+    EXPECT_THAT(tested, IsEmpty());
+}
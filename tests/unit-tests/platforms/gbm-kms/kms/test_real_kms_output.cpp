@@ -44,6 +44,7 @@ class NullPageFlipper : public mgg::PageFlipper
 {
 public:
     bool schedule_flip(uint32_t,uint32_t,uint32_t) override { return true; }
+    bool schedule_commit(std::vector<Target> const&, std::function<int(void*)> const&) override { return true; }
     mg::Frame wait_for_flip(uint32_t) override { return {}; }
 };
 
@@ -51,6 +52,7 @@ class MockPageFlipper : public mgg::PageFlipper
 {
 public:
     MOCK_METHOD3(schedule_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD2(schedule_commit, bool(std::vector<Target> const&, std::function<int(void*)> const&));
     MOCK_METHOD1(wait_for_flip, mg::Frame(uint32_t));
 };
 
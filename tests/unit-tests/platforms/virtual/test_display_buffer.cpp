@@ -0,0 +1,160 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/virtual/display_buffer.h"
+#include "src/platforms/virtual/platform.h"
+#include "src/server/report/null/display_report.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace mg = mir::graphics;
+namespace mgv = mir::graphics::virt;
+namespace geom = mir::geometry;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct VirtualDisplayBuffer : Test
+{
+    auto make_display_buffer(mgv::FrameOptions const& options) -> std::unique_ptr<mgv::DisplayBuffer>
+    {
+        return std::make_unique<mgv::DisplayBuffer>(
+            mg::DisplayConfigurationOutputId{1},
+            geom::Rectangle{{0, 0}, size},
+            mg::DisplayConfigurationMode{size, refresh_hz},
+            options,
+            std::make_shared<mir::report::null::DisplayReport>());
+    }
+
+    void draw_frame(mgv::DisplayBuffer& db, uint32_t colour)
+    {
+        auto const mapping = db.map_back_buffer();
+        auto const pixels = reinterpret_cast<uint32_t*>(mapping->data());
+        std::fill(pixels, pixels + size.width.as_int() * size.height.as_int(), colour);
+        db.swap_buffers();
+        db.post();
+    }
+
+    geom::Size const size{8, 4};
+    double const refresh_hz{100.0};
+    mgv::FrameOptions const vsync_options{true, std::nullopt, 1};
+    mgv::FrameOptions const no_vsync_options{false, std::nullopt, 1};
+};
+}
+
+TEST_F(VirtualDisplayBuffer, renders_in_software)
+{
+    auto const db = make_display_buffer(vsync_options);
+
+    auto const target = dynamic_cast<mir::renderer::software::RenderTarget*>(db->native_display_buffer());
+    ASSERT_THAT(target, NotNull());
+    EXPECT_THAT(target->size(), Eq(size));
+
+    auto const mapping = target->map_back_buffer();
+    EXPECT_THAT(mapping->format(), Eq(mir_pixel_format_xrgb_8888));
+    EXPECT_THAT(mapping->len(), Eq(static_cast<size_t>(size.width.as_int() * size.height.as_int() * 4)));
+}
+
+TEST_F(VirtualDisplayBuffer, buffer_age_is_one_after_the_first_frame)
+{
+    auto const db = make_display_buffer(no_vsync_options);
+
+    EXPECT_THAT(db->buffer_age(), Eq(0));
+    draw_frame(*db, 0xff000000);
+    EXPECT_THAT(db->buffer_age(), Eq(1));
+}
+
+TEST_F(VirtualDisplayBuffer, mode_change_invalidates_contents)
+{
+    auto const db = make_display_buffer(no_vsync_options);
+    draw_frame(*db, 0xff000000);
+
+    db->set_mode(mg::DisplayConfigurationMode{geom::Size{16, 16}, refresh_hz});
+
+    EXPECT_THAT(db->buffer_age(), Eq(0));
+    EXPECT_THAT(db->size(), Eq(geom::Size{16, 16}));
+}
+
+TEST_F(VirtualDisplayBuffer, has_no_last_frame_until_posted)
+{
+    auto const db = make_display_buffer(vsync_options);
+
+    EXPECT_THAT(db->last_frame(), Eq(std::nullopt));
+    draw_frame(*db, 0xff000000);
+    EXPECT_THAT(db->last_frame(), Ne(std::nullopt));
+}
+
+TEST_F(VirtualDisplayBuffer, post_waits_for_the_simulated_vblank)
+{
+    auto const db = make_display_buffer(vsync_options);
+    auto const period = std::chrono::duration_cast<std::chrono::nanoseconds>(1s / refresh_hz);
+
+    draw_frame(*db, 0xff000000);
+    auto const first = db->last_frame().value();
+    draw_frame(*db, 0xff000000);
+    auto const second = db->last_frame().value();
+
+    EXPECT_TRUE(second.vsync);
+    EXPECT_THAT(second.msc, Gt(first.msc));
+    EXPECT_THAT(second.ust - first.ust, Eq((second.msc - first.msc) * period));
+    EXPECT_THAT(mir::time::PosixTimestamp::now(CLOCK_MONOTONIC), Ge(second.ust));
+}
+
+TEST_F(VirtualDisplayBuffer, post_without_vsync_counts_every_frame)
+{
+    auto const db = make_display_buffer(no_vsync_options);
+
+    for (int i = 0; i != 10; ++i)
+    {
+        draw_frame(*db, 0xff000000);
+    }
+
+    EXPECT_FALSE(db->last_frame()->vsync);
+    EXPECT_THAT(db->last_frame()->msc, Eq(10));
+    EXPECT_THAT(db->frames_posted().first, Eq(10));
+}
+
+TEST_F(VirtualDisplayBuffer, dumps_frames_as_ppm)
+{
+    char dir_template[] = "/tmp/mir-virtual-dump-XXXXXX";
+    ASSERT_THAT(mkdtemp(dir_template), NotNull());
+    std::filesystem::path const dir{dir_template};
+
+    auto const db = make_display_buffer(mgv::FrameOptions{false, dir.string(), 2});
+    draw_frame(*db, 0xff102030);
+    draw_frame(*db, 0xff405060);
+    draw_frame(*db, 0xff708090);
+
+    EXPECT_TRUE(std::filesystem::exists(dir / "output-1-000000.ppm"));
+    EXPECT_FALSE(std::filesystem::exists(dir / "output-1-000001.ppm"));
+    ASSERT_TRUE(std::filesystem::exists(dir / "output-1-000002.ppm"));
+
+    std::ifstream file{dir / "output-1-000002.ppm", std::ios::binary};
+    std::string const contents{std::istreambuf_iterator<char>{file}, {}};
+    std::string const header{"P6\n8 4\n255\n"};
+    ASSERT_THAT(contents.size(), Eq(header.size() + 8 * 4 * 3));
+    EXPECT_THAT(contents.substr(0, header.size()), Eq(header));
+    EXPECT_THAT(contents.substr(header.size(), 3), Eq("\x70\x80\x90"));
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/virtual/platform.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgv = mir::graphics::virt;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+MATCHER_P2(Mode, size, hz, "")
+{
+    return arg.size == size && Value(arg.vrefresh_hz, DoubleEq(hz));
+}
+}
+
+TEST(VirtualPlatformOutputs, parses_a_single_mode_at_60hz_by_default)
+{
+    auto const outputs = mgv::Platform::parse_output_configs("1280x1024");
+
+    ASSERT_THAT(outputs.size(), Eq(1u));
+    EXPECT_THAT(outputs[0].modes, ElementsAre(Mode(geom::Size{1280, 1024}, 60.0)));
+    EXPECT_THAT(outputs[0].scale, FloatEq(1.0f));
+}
+
+TEST(VirtualPlatformOutputs, parses_refresh_rates_and_scale)
+{
+    auto const outputs = mgv::Platform::parse_output_configs("3840x2160@144,1920x1080@59.94^2");
+
+    ASSERT_THAT(outputs.size(), Eq(1u));
+    EXPECT_THAT(outputs[0].modes, ElementsAre(
+        Mode(geom::Size{3840, 2160}, 144.0),
+        Mode(geom::Size{1920, 1080}, 59.94)));
+    EXPECT_THAT(outputs[0].scale, FloatEq(2.0f));
+}
+
+TEST(VirtualPlatformOutputs, parses_multiple_outputs)
+{
+    auto const outputs = mgv::Platform::parse_output_configs("640x480:800x600@30^1.5:1024x768");
+
+    ASSERT_THAT(outputs.size(), Eq(3u));
+    EXPECT_THAT(outputs[0].modes, ElementsAre(Mode(geom::Size{640, 480}, 60.0)));
+    EXPECT_THAT(outputs[1].modes, ElementsAre(Mode(geom::Size{800, 600}, 30.0)));
+    EXPECT_THAT(outputs[1].scale, FloatEq(1.5f));
+    EXPECT_THAT(outputs[2].modes, ElementsAre(Mode(geom::Size{1024, 768}, 60.0)));
+}
+
+TEST(VirtualPlatformOutputs, rejects_malformed_outputs)
+{
+    for (auto const bad : {"", "1280", "x1024", "1280x", "1280x1024@", "1280x1024@0", "1280xabc",
+                           "1280x1024^", "1280x1024^-1", "-1280x1024", "1280x1024:", "1280x1024,"})
+    {
+        EXPECT_THROW(mgv::Platform::parse_output_configs(bad), std::runtime_error) << "for \"" << bad << "\"";
+    }
+}
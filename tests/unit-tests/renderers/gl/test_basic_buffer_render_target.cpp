@@ -16,12 +16,16 @@
 
 #include "mir/renderer/gl/basic_buffer_render_target.h"
 
+#include "mir/graphics/buffer_basic.h"
+#include "mir/graphics/dmabuf_buffer.h"
 #include "mir/test/doubles/null_gl_context.h"
 #include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
 #include "mir/test/doubles/stub_buffer.h"
 #include "mir/test/fake_shared.h"
 
 #include <gtest/gtest.h>
+#include <drm_fourcc.h>
 #include <set>
 
 namespace mr = mir::renderer;
@@ -36,6 +40,27 @@ using namespace testing;
 namespace
 {
 
+class StubDMABufBuffer : public mg::BufferBasic, public mg::DMABufBuffer
+{
+public:
+    explicit StubDMABufBuffer(geom::Size size)
+        : size_{size},
+          planes_{{mir::Fd{mir::IntOwnedFd{7}}, static_cast<uint32_t>(size.width.as_int() * 4), 0}}
+    {
+    }
+
+    auto size() const -> geom::Size override { return size_; }
+    auto pixel_format() const -> MirPixelFormat override { return mir_pixel_format_argb_8888; }
+    auto native_buffer_base() -> mg::NativeBufferBase* override { return this; }
+    auto drm_fourcc() const -> uint32_t override { return DRM_FORMAT_ARGB8888; }
+    auto modifier() const -> std::optional<uint64_t> override { return std::nullopt; }
+    auto planes() const -> std::vector<PlaneDescriptor> const& override { return planes_; }
+
+private:
+    geom::Size const size_;
+    std::vector<PlaneDescriptor> const planes_;
+};
+
 struct BasicBufferRenderTarget : Test
 {
     NiceMock<mtd::MockGL> mock_gl;
@@ -148,3 +173,55 @@ TEST_F(BasicBufferRenderTarget, throws_on_invalid_buffer)
         render_target.swap_buffers();
     }, std::logic_error);
 }
+
+TEST_F(BasicBufferRenderTarget, renders_into_dmabuf_without_reading_pixels)
+{
+    NiceMock<mtd::MockEGL> mock_egl;
+    mock_egl.provide_egl_extensions();
+    StubDMABufBuffer dmabuf{reasonable_size};
+    GLuint const texture{17};
+    ON_CALL(mock_gl, glGenTextures(1, _)).WillByDefault(SetArgPointee<1>(texture));
+
+    mrg::BasicBufferRenderTarget render_target{mt::fake_shared(ctx)};
+    EXPECT_CALL(mock_egl, eglCreateImageKHR(_, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, _));
+    EXPECT_CALL(mock_egl, glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, _));
+    EXPECT_CALL(mock_gl, glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0));
+    EXPECT_CALL(mock_gl, glViewport(0, 0, reasonable_width, reasonable_height));
+    render_target.set_dmabuf(mt::fake_shared(dmabuf));
+    Mock::VerifyAndClearExpectations(&mock_gl);
+
+    EXPECT_THAT(render_target.size(), Eq(reasonable_size));
+    EXPECT_CALL(mock_gl, glReadPixels(_, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glFinish()).Times(0);
+    EXPECT_CALL(mock_gl, glFlush());
+    render_target.swap_buffers();
+}
+
+TEST_F(BasicBufferRenderTarget, imports_a_dmabuf_only_once)
+{
+    NiceMock<mtd::MockEGL> mock_egl;
+    mock_egl.provide_egl_extensions();
+    StubDMABufBuffer dmabuf{reasonable_size};
+
+    mrg::BasicBufferRenderTarget render_target{mt::fake_shared(ctx)};
+    EXPECT_CALL(mock_egl, eglCreateImageKHR(_, _, EGL_LINUX_DMA_BUF_EXT, _, _)).Times(1);
+    EXPECT_CALL(mock_gl, glDeleteFramebuffers(_, _)).Times(0);
+    render_target.set_dmabuf(mt::fake_shared(dmabuf));
+    render_target.swap_buffers();
+    render_target.set_buffer(mt::fake_shared(reasonable_buffer));
+    render_target.swap_buffers();
+
+    EXPECT_CALL(mock_gl, glViewport(0, 0, reasonable_width, reasonable_height));
+    render_target.set_dmabuf(mt::fake_shared(dmabuf));
+    EXPECT_THAT(render_target.size(), Eq(reasonable_size));
+    Mock::VerifyAndClearExpectations(&mock_egl);
+    Mock::VerifyAndClearExpectations(&mock_gl);
+}
+
+TEST_F(BasicBufferRenderTarget, throws_on_dmabuf_that_is_not_a_dmabuf)
+{
+    mrg::BasicBufferRenderTarget render_target{mt::fake_shared(ctx)};
+    EXPECT_THROW(
+        render_target.set_dmabuf(mt::fake_shared(reasonable_buffer)),
+        std::logic_error);
+}
@@ -130,16 +130,7 @@ public:
                     return factory.compile_fragment_shader(&unused, "extension code", "fragment code");
                 }));
 
-        renderable = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
-        EXPECT_CALL(*renderable, id()).WillRepeatedly(Return(&renderable));
-        EXPECT_CALL(*renderable, buffer()).WillRepeatedly(Return(mock_buffer));
-        EXPECT_CALL(*renderable, shaped()).WillRepeatedly(Return(false));
-        EXPECT_CALL(*renderable, alpha()).WillRepeatedly(Return(1.0f));
-        EXPECT_CALL(*renderable, transformation()).WillRepeatedly(Return(trans));
-        EXPECT_CALL(*renderable, screen_position())
-            .WillRepeatedly(Return(mir::geometry::Rectangle{{1,2},{3,4}}));
-        EXPECT_CALL(*renderable, clip_area())
-            .WillRepeatedly(Return(std::optional<mir::geometry::Rectangle>()));
+        renderable = make_renderable();
         EXPECT_CALL(mock_gl, glDisable(_)).Times(AnyNumber());
 
         renderable_list.push_back(renderable);
@@ -151,6 +142,21 @@ public:
             .WillRepeatedly(Return(screen_to_gl_coords_uniform_location));
     }
 
+    auto make_renderable() -> std::shared_ptr<testing::NiceMock<mtd::MockRenderable>>
+    {
+        auto const result = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+        EXPECT_CALL(*result, id()).WillRepeatedly(Return(result.get()));
+        EXPECT_CALL(*result, buffer()).WillRepeatedly(Return(mock_buffer));
+        EXPECT_CALL(*result, shaped()).WillRepeatedly(Return(false));
+        EXPECT_CALL(*result, alpha()).WillRepeatedly(Return(1.0f));
+        EXPECT_CALL(*result, transformation()).WillRepeatedly(Return(trans));
+        EXPECT_CALL(*result, screen_position())
+            .WillRepeatedly(Return(mir::geometry::Rectangle{{1,2},{3,4}}));
+        EXPECT_CALL(*result, clip_area())
+            .WillRepeatedly(Return(std::optional<mir::geometry::Rectangle>()));
+        return result;
+    }
+
     testing::NiceMock<mtd::MockGL> mock_gl;
     testing::NiceMock<mtd::MockEGL> mock_egl;
     std::shared_ptr<mtd::MockTextureBuffer> mock_buffer;
@@ -226,6 +232,60 @@ TEST_F(GLRenderer, avoids_src_alpha_for_rgbx_blending)  // LP: #1423462
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, uploads_all_renderables_in_one_vertex_buffer)
+{
+    renderable_list.push_back(make_renderable());
+    renderable_list.push_back(make_renderable());
+
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, _, _, GL_STREAM_DRAW)).Times(1);
+    {
+        InSequence seq;
+        // Each rectangle is drawn as two triangles, in stacking order
+        EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 0, 6));
+        EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 6, 6));
+        EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 12, 6));
+    }
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, sets_uniforms_once_per_frame_rather_than_per_renderable)
+{
+    renderable_list.push_back(make_renderable());
+    renderable_list.push_back(make_renderable());
+
+    mrg::Renderer renderer(display_buffer);
+
+    // Only display_transform and screen_to_gl_coords, for the one program in use
+    EXPECT_CALL(mock_gl, glUseProgram(stub_program)).Times(1);
+    EXPECT_CALL(mock_gl, glUniformMatrix4fv(_, _, _, _)).Times(2);
+    EXPECT_CALL(mock_gl, glUniform1f(_, _)).Times(0);
+    EXPECT_CALL(mock_gl, glUniform2f(_, _, _)).Times(0);
+
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, does_not_repeat_unchanged_blend_state)
+{
+    auto const translucent = make_renderable();
+    EXPECT_CALL(*translucent, alpha()).WillRepeatedly(Return(0.5f));
+    auto const also_translucent = make_renderable();
+    EXPECT_CALL(*also_translucent, alpha()).WillRepeatedly(Return(0.5f));
+    renderable_list.push_back(make_renderable());
+    renderable_list.push_back(translucent);
+    renderable_list.push_back(also_translucent);
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glBlendFuncSeparate(_, _, _, _));
+    EXPECT_CALL(mock_gl, glBlendColor(0.0f, 0.0f, 0.0f, 0.5f));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, clears_to_opaque_black)
 {
     InSequence seq;
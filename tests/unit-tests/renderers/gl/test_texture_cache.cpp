@@ -0,0 +1,218 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/gl/texture_cache.h"
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_gl_buffer.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/graphics/buffer_properties.h"
+
+#include <GLES2/gl2ext.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+namespace geom = mir::geometry;
+namespace mg = mir::graphics;
+namespace mrg = mir::renderer::gl;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+class DamagedRenderable : public mtd::FakeRenderable
+{
+public:
+    using FakeRenderable::FakeRenderable;
+
+    std::optional<geom::Rectangles> buffer_damage_since(mg::BufferID) const override
+    {
+        return buffer_damage;
+    }
+
+    std::optional<geom::Rectangles> buffer_damage;
+};
+
+auto shm_buffer(geom::Size size) -> std::shared_ptr<mtd::StubBuffer>
+{
+    return std::make_shared<mtd::StubBuffer>(
+        nullptr,
+        mg::BufferProperties{size, mir_pixel_format_abgr_8888, mg::BufferUsage::software},
+        geom::Stride{size.width.as_int() * 4});
+}
+
+/// A mappable buffer that can also be bound as a texture of its own, as the platform's SHM buffers can
+class TextureShmBuffer : public mtd::StubBuffer, public mg::gl::Texture
+{
+public:
+    TextureShmBuffer(geom::Size size)
+        : StubBuffer{
+              nullptr,
+              mg::BufferProperties{size, mir_pixel_format_abgr_8888, mg::BufferUsage::software},
+              geom::Stride{size.width.as_int() * 4}}
+    {
+    }
+
+    MOCK_METHOD(mg::gl::Program const&, shader, (mg::gl::ProgramFactory&), (const override));
+    MOCK_METHOD(Layout, layout, (), (const override));
+    MOCK_METHOD(void, bind, (), (override));
+    MOCK_METHOD(void, add_syncpoint, (), (override));
+};
+
+struct TextureCache : Test
+{
+    TextureCache()
+    {
+        ON_CALL(mock_gl, glGenTextures(1, _))
+            .WillByDefault(SetArgPointee<1>(texture_id));
+    }
+
+    GLuint const texture_id{42};
+    geom::Size const size{64, 32};
+    NiceMock<mtd::MockGL> mock_gl;
+    DamagedRenderable renderable{geom::Rectangle{{0, 0}, size}};
+    mrg::TextureCache cache;
+};
+}
+
+TEST_F(TextureCache, first_bind_uploads_whole_buffer)
+{
+    auto const buffer = shm_buffer(size);
+
+    EXPECT_CALL(mock_gl, glTexImage2D(GL_TEXTURE_2D, 0, _, 64, 32, 0, _, _, buffer->written_pixels.data()));
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+
+    EXPECT_TRUE(cache.bind(renderable, *buffer));
+    EXPECT_THAT(cache.bytes_uploaded(), Eq(64u * 32u * 4u));
+}
+
+TEST_F(TextureCache, rebinding_same_buffer_uploads_nothing)
+{
+    auto const buffer = shm_buffer(size);
+    cache.bind(renderable, *buffer);
+
+    EXPECT_CALL(mock_gl, glBindTexture(GL_TEXTURE_2D, texture_id));
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+
+    EXPECT_TRUE(cache.bind(renderable, *buffer));
+}
+
+TEST_F(TextureCache, new_buffer_uploads_only_damage)
+{
+    cache.bind(renderable, *shm_buffer(size));
+    auto const uploaded_before = cache.bytes_uploaded();
+
+    auto const next = shm_buffer(size);
+    renderable.buffer_damage = geom::Rectangles{geom::Rectangle{{3, 5}, {10, 2}}};
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(
+        GL_TEXTURE_2D, 0, 3, 5, 10, 2, _, _,
+        next->written_pixels.data() + 5 * 64 * 4 + 3 * 4));
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 64));
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0));
+    EXPECT_CALL(mock_gl, glPixelStorei(GL_UNPACK_ALIGNMENT, _)).Times(AnyNumber());
+
+    EXPECT_TRUE(cache.bind(renderable, *next));
+    EXPECT_THAT(cache.bytes_uploaded() - uploaded_before, Eq(10u * 2u * 4u));
+}
+
+TEST_F(TextureCache, damage_is_clipped_to_buffer)
+{
+    cache.bind(renderable, *shm_buffer(size));
+
+    renderable.buffer_damage = geom::Rectangles{geom::Rectangle{{60, 30}, {100, 100}}};
+
+    EXPECT_CALL(mock_gl, glTexSubImage2D(GL_TEXTURE_2D, 0, 60, 30, 4, 2, _, _, _));
+
+    cache.bind(renderable, *shm_buffer(size));
+}
+
+TEST_F(TextureCache, new_buffer_without_damage_reuses_storage)
+{
+    cache.bind(renderable, *shm_buffer(size));
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 64, 32, _, _, _));
+
+    cache.bind(renderable, *shm_buffer(size));
+}
+
+TEST_F(TextureCache, resized_buffer_reallocates_storage)
+{
+    cache.bind(renderable, *shm_buffer(size));
+
+    renderable.buffer_damage = geom::Rectangles{};
+
+    EXPECT_CALL(mock_gl, glTexImage2D(GL_TEXTURE_2D, 0, _, 16, 16, 0, _, _, _));
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+
+    cache.bind(renderable, *shm_buffer({16, 16}));
+}
+
+TEST_F(TextureCache, declines_buffers_that_cannot_be_mapped)
+{
+    NiceMock<mtd::MockTextureBuffer> buffer;
+
+    EXPECT_CALL(mock_gl, glGenTextures(_, _)).Times(0);
+
+    EXPECT_FALSE(cache.bind(renderable, buffer));
+}
+
+TEST_F(TextureCache, drops_textures_of_renderables_no_longer_drawn)
+{
+    cache.bind(renderable, *shm_buffer(size));
+    cache.drop_unused();
+
+    EXPECT_CALL(mock_gl, glDeleteTextures(1, Pointee(texture_id)));
+
+    cache.drop_unused();
+}
+
+TEST_F(TextureCache, full_update_is_copied_from_buffers_own_texture)
+{
+    GLuint const buffer_texture{7};
+    NiceMock<TextureShmBuffer> buffer{size};
+    ON_CALL(mock_gl, glGetIntegerv(GL_TEXTURE_BINDING_2D, _))
+        .WillByDefault(SetArgPointee<1>(buffer_texture));
+
+    EXPECT_CALL(buffer, bind());
+    EXPECT_CALL(mock_gl, glFramebufferTexture2D(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, buffer_texture, 0));
+    EXPECT_CALL(mock_gl, glFramebufferTexture2D(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0));
+    EXPECT_CALL(mock_gl, glTexImage2D(GL_TEXTURE_2D, 0, _, 64, 32, 0, _, _, nullptr));
+    EXPECT_CALL(mock_gl, glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, 64, 32));
+
+    EXPECT_TRUE(cache.bind(renderable, buffer));
+    EXPECT_THAT(cache.bytes_uploaded(), Eq(0u));
+}
+
+TEST_F(TextureCache, full_update_is_uploaded_if_buffers_own_texture_cannot_be_copied)
+{
+    NiceMock<TextureShmBuffer> buffer{size};
+    ON_CALL(mock_gl, glGetIntegerv(GL_TEXTURE_BINDING_2D, _))
+        .WillByDefault(SetArgPointee<1>(7));
+    ON_CALL(mock_gl, glCheckFramebufferStatus(_))
+        .WillByDefault(Return(GL_FRAMEBUFFER_UNSUPPORTED));
+
+    EXPECT_CALL(mock_gl, glCopyTexSubImage2D(_, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexImage2D(GL_TEXTURE_2D, 0, _, 64, 32, 0, _, _, buffer.written_pixels.data()));
+
+    EXPECT_TRUE(cache.bind(renderable, buffer));
+}
@@ -0,0 +1,318 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/kernels.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace mrsk = mir::renderer::software::kernels;
+
+using namespace testing;
+
+namespace
+{
+/*
+ * Per-pixel versions of the kernels, to check the vectorised ones against
+ */
+auto div255(unsigned x) -> unsigned
+{
+    return (x + 127) / 255;
+}
+
+auto channel(uint32_t pixel, int i) -> unsigned
+{
+    return (pixel >> (8 * i)) & 0xFF;
+}
+
+auto reference_over(uint32_t dst, uint32_t src) -> uint32_t
+{
+    uint32_t result = 0;
+    for (int i = 0; i != 4; ++i)
+    {
+        auto const c = channel(src, i) + div255(channel(dst, i) * (255 - channel(src, 3)));
+        result |= std::min(c, 255u) << (8 * i);
+    }
+    return result;
+}
+
+auto reference_scale(uint32_t pixel, unsigned alpha) -> uint32_t
+{
+    uint32_t result = 0;
+    for (int i = 0; i != 4; ++i)
+        result |= div255(channel(pixel, i) * alpha) << (8 * i);
+    return result;
+}
+
+auto reference_lerp(uint32_t a, uint32_t b, unsigned weight_b) -> uint32_t
+{
+    uint32_t result = 0;
+    for (int i = 0; i != 4; ++i)
+        result |= ((channel(a, i) * (256 - weight_b) + channel(b, i) * weight_b) >> 8) << (8 * i);
+    return result;
+}
+
+/// Premultiplied pixels, with a good share of opaque and clear ones to hit the fast paths
+auto premultiplied_pixels(std::size_t n, unsigned seed) -> std::vector<uint32_t>
+{
+    std::mt19937 generator{seed};
+    std::vector<uint32_t> pixels(n);
+    for (auto& pixel : pixels)
+    {
+        unsigned alpha;
+        switch (generator() % 4)
+        {
+        case 0: alpha = 0; break;
+        case 1: alpha = 255; break;
+        default: alpha = generator() % 256;
+        }
+        pixel = alpha << 24;
+        for (int i = 0; i != 3; ++i)
+            pixel |= (alpha ? generator() % (alpha + 1) : 0) << (8 * i);
+    }
+    return pixels;
+}
+
+auto random_pixels(std::size_t n, unsigned seed) -> std::vector<uint32_t>
+{
+    std::mt19937 generator{seed};
+    std::vector<uint32_t> pixels(n);
+    for (auto& pixel : pixels)
+        pixel = generator();
+    return pixels;
+}
+
+// Enough pixels to cover the vector widths, their remainders and starts at any alignment
+std::size_t const max_length = 67;
+std::size_t const max_offset = 8;
+}
+
+TEST(SoftwareKernels, fill_sets_every_pixel_and_no_more)
+{
+    for (std::size_t offset = 0; offset != max_offset; ++offset)
+    {
+        for (std::size_t n = 0; n != max_length; ++n)
+        {
+            std::vector<uint32_t> pixels(max_length + max_offset + 1, 0x12345678);
+            mrsk::fill(pixels.data() + offset, n, 0xFF204060);
+
+            for (std::size_t i = 0; i != pixels.size(); ++i)
+            {
+                auto const inside = i >= offset && i < offset + n;
+                ASSERT_THAT(pixels[i], Eq(inside ? 0xFF204060 : 0x12345678)) << "offset " << offset << ", n " << n;
+            }
+        }
+    }
+}
+
+TEST(SoftwareKernels, copy_opaque_copies_with_alpha_set)
+{
+    auto const src = random_pixels(max_length + max_offset, 1);
+    for (std::size_t offset = 0; offset != max_offset; ++offset)
+    {
+        for (std::size_t n = 0; n != max_length; ++n)
+        {
+            std::vector<uint32_t> dst(max_length + max_offset + 1, 0);
+            mrsk::copy_opaque(dst.data() + offset, src.data() + offset, n);
+
+            for (std::size_t i = 0; i != dst.size(); ++i)
+            {
+                auto const inside = i >= offset && i < offset + n;
+                ASSERT_THAT(dst[i], Eq(inside ? src[i] | 0xFF000000 : 0u)) << "offset " << offset << ", n " << n;
+            }
+        }
+    }
+}
+
+TEST(SoftwareKernels, blend_matches_per_pixel_over)
+{
+    auto const src = premultiplied_pixels(max_length + max_offset, 2);
+    auto const background = random_pixels(max_length + max_offset, 3);
+    for (std::size_t offset = 0; offset != max_offset; ++offset)
+    {
+        for (std::size_t n = 0; n != max_length; ++n)
+        {
+            auto dst = background;
+            mrsk::blend(dst.data() + offset, src.data(), n);
+
+            for (std::size_t i = 0; i != dst.size(); ++i)
+            {
+                auto const inside = i >= offset && i < offset + n;
+                auto const expected = inside ? reference_over(background[i], src[i - offset]) : background[i];
+                ASSERT_THAT(dst[i], Eq(expected)) << "offset " << offset << ", n " << n << ", pixel " << i;
+            }
+        }
+    }
+}
+
+TEST(SoftwareKernels, blend_with_alpha_matches_per_pixel_scale_and_over)
+{
+    auto const src = premultiplied_pixels(max_length, 4);
+    auto const background = random_pixels(max_length, 5);
+    for (unsigned alpha : {0u, 1u, 128u, 200u, 255u})
+    {
+        for (bool src_opaque : {false, true})
+        {
+            for (std::size_t n = 0; n != max_length; ++n)
+            {
+                auto dst = background;
+                mrsk::blend_with_alpha(dst.data(), src.data(), n, alpha, src_opaque);
+
+                for (std::size_t i = 0; i != dst.size(); ++i)
+                {
+                    auto const source = src_opaque ? src[i] | 0xFF000000 : src[i];
+                    auto const expected = i < n ?
+                        reference_over(background[i], reference_scale(source, alpha)) :
+                        background[i];
+                    ASSERT_THAT(dst[i], Eq(expected))
+                        << "alpha " << alpha << ", opaque " << src_opaque << ", n " << n << ", pixel " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(SoftwareKernels, swap_red_blue_swaps_only_red_and_blue)
+{
+    uint32_t const pixel = 0x11223344;
+    uint32_t swapped;
+    mrsk::swap_red_blue(&swapped, &pixel, 1);
+    EXPECT_THAT(swapped, Eq(0x11443322u));
+
+    auto const src = random_pixels(max_length, 6);
+    std::vector<uint32_t> dst(max_length);
+    mrsk::swap_red_blue(dst.data(), src.data(), max_length);
+    for (std::size_t i = 0; i != max_length; ++i)
+    {
+        auto const expected = (src[i] & 0xFF00FF00) | ((src[i] >> 16) & 0xFF) | ((src[i] & 0xFF) << 16);
+        ASSERT_THAT(dst[i], Eq(expected)) << "pixel " << i;
+    }
+}
+
+TEST(SoftwareKernels, sample_nearest_picks_the_pixel_under_each_sample)
+{
+    auto const src = random_pixels(3 * max_length, 7);
+    for (int32_t step : {0x4000, 0x10000, 0x18000, 0x2A000})
+    {
+        for (std::size_t n = 0; n != max_length; ++n)
+        {
+            int32_t const x = 0x8000;
+            std::vector<uint32_t> dst(n);
+            mrsk::sample_nearest(dst.data(), src.data(), n, x, step);
+
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                ASSERT_THAT(dst[i], Eq(src[(x + static_cast<int32_t>(i) * step) >> 16]))
+                    << "step " << step << ", n " << n << ", pixel " << i;
+            }
+        }
+    }
+}
+
+TEST(SoftwareKernels, sample_bilinear_matches_per_pixel_interpolation)
+{
+    int const width = 20;
+    auto const row0 = random_pixels(width, 8);
+    auto const row1 = random_pixels(width, 9);
+    // Includes samples starting left of the row and running off its right, which are clamped
+    for (int32_t x : {-0x18000, 0, 0x4321, 0x30000})
+    {
+        for (int32_t step : {0x2000, 0x10000, 0x15555})
+        {
+            for (unsigned fy : {0u, 1u, 100u, 255u})
+            {
+                std::size_t const n = 30;
+                std::vector<uint32_t> dst(n);
+                mrsk::sample_bilinear(dst.data(), row0.data(), row1.data(), width, n, x, step, fy);
+
+                for (std::size_t i = 0; i != n; ++i)
+                {
+                    auto const at = std::clamp(x + static_cast<int32_t>(i) * step, 0, (width - 1) << 16);
+                    auto const left = at >> 16;
+                    auto const right = std::min(left + 1, width - 1);
+                    auto const fx = (at >> 8) & 0xFF;
+                    auto const expected = reference_lerp(
+                        reference_lerp(row0[left], row0[right], fx),
+                        reference_lerp(row1[left], row1[right], fx),
+                        fy);
+                    ASSERT_THAT(dst[i], Eq(expected))
+                        << "x " << x << ", step " << step << ", fy " << fy << ", pixel " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(SoftwareKernels, copy_transformed_maps_every_pixel_for_each_orientation)
+{
+    // Odd sizes so that the vectorised blocks leave edges behind
+    int const src_width = 11;
+    int const src_height = 13;
+    auto const src = random_pixels(src_width * src_height, 10);
+
+    for (int transposed = 0; transposed != 2; ++transposed)
+    {
+        for (int flip_x : {1, -1})
+        {
+            for (int flip_y : {1, -1})
+            {
+                mrsk::PixelTransform t{};
+                int const dst_width = transposed ? src_height : src_width;
+                int const dst_height = transposed ? src_width : src_height;
+                if (transposed)
+                {
+                    t.xy = flip_x;
+                    t.yx = flip_y;
+                }
+                else
+                {
+                    t.xx = flip_x;
+                    t.yy = flip_y;
+                }
+                t.x0 = flip_x > 0 ? 0 : src_width - 1;
+                t.y0 = flip_y > 0 ? 0 : src_height - 1;
+
+                // Copy into part of a larger destination, to check nothing outside it is touched
+                int const dst_stride = dst_width + 9;
+                int const dst_x = 5;
+                int const dst_y = 2;
+                int const width = dst_width - dst_x - 1;
+                int const height = dst_height - dst_y - 1;
+                std::vector<uint32_t> dst(dst_stride * dst_height, 0xDEADBEEF);
+
+                mrsk::copy_transformed(dst.data(), dst_stride, dst_x, dst_y, width, height, src.data(), src_width, t);
+
+                for (int y = 0; y != dst_height; ++y)
+                {
+                    for (int x = 0; x != dst_stride; ++x)
+                    {
+                        auto const inside = x >= dst_x && x < dst_x + width && y >= dst_y && y < dst_y + height;
+                        auto const sx = t.x0 + t.xx * x + t.xy * y;
+                        auto const sy = t.y0 + t.yx * x + t.yy * y;
+                        auto const expected = inside ? src[sy * src_width + sx] : 0xDEADBEEF;
+                        ASSERT_THAT(dst[y * dst_stride + x], Eq(expected))
+                            << "transposed " << transposed << ", flip " << flip_x << "," << flip_y
+                            << " at " << x << "," << y;
+                    }
+                }
+            }
+        }
+    }
+}
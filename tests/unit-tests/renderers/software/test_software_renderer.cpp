@@ -0,0 +1,327 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/graphics/transformation.h"
+
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/fake_renderable.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+uint32_t const black = 0xFF000000;
+uint32_t const red = 0xFFFF0000;
+uint32_t const green = 0xFF00FF00;
+uint32_t const blue = 0xFF0000FF;
+
+auto make_buffer(geom::Size size, MirPixelFormat format = mir_pixel_format_argb_8888)
+    -> std::shared_ptr<mtd::StubBuffer>
+{
+    return std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{size, format, mg::BufferUsage::software});
+}
+
+auto pixel_at(mtd::StubBuffer const& buffer, int x, int y) -> uint32_t
+{
+    uint32_t pixel;
+    std::memcpy(&pixel, buffer.written_pixels.data() + y * buffer.buf_stride.as_int() + x * 4, sizeof pixel);
+    return pixel;
+}
+
+void set_pixel(mtd::StubBuffer& buffer, int x, int y, uint32_t pixel)
+{
+    std::memcpy(buffer.written_pixels.data() + y * buffer.buf_stride.as_int() + x * 4, &pixel, sizeof pixel);
+}
+
+auto filled_buffer(geom::Size size, uint32_t pixel) -> std::shared_ptr<mtd::StubBuffer>
+{
+    auto const buffer = make_buffer(size);
+    for (int y = 0; y != size.height.as_int(); ++y)
+        for (int x = 0; x != size.width.as_int(); ++x)
+            set_pixel(*buffer, x, y, pixel);
+    return buffer;
+}
+
+struct StubRenderTarget : mrs::RenderTarget
+{
+    explicit StubRenderTarget(geom::Size size)
+        : buffer{make_buffer(size)}
+    {
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return buffer->size();
+    }
+
+    auto map_back_buffer() -> std::unique_ptr<mrs::Mapping<unsigned char>> override
+    {
+        return buffer->map_rw();
+    }
+
+    auto buffer_age() const -> int override
+    {
+        return age;
+    }
+
+    void swap_buffers() override
+    {
+        ++swaps;
+    }
+
+    auto pixel(int x, int y) const -> uint32_t
+    {
+        return pixel_at(*buffer, x, y);
+    }
+
+    std::shared_ptr<mtd::StubBuffer> const buffer;
+    int age{0};
+    int swaps{0};
+};
+
+class ClippedRenderable : public mtd::FakeRenderable
+{
+public:
+    ClippedRenderable(geom::Rectangle const& rect, geom::Rectangle const& clip)
+        : FakeRenderable{rect},
+          clip{clip}
+    {
+    }
+
+    auto clip_area() const -> std::optional<geom::Rectangle> override
+    {
+        return clip;
+    }
+
+private:
+    geom::Rectangle const clip;
+};
+
+struct SoftwareRenderer : Test
+{
+    auto renderable(geom::Rectangle const& rect, std::shared_ptr<mg::Buffer> const& buffer,
+                    float alpha = 1.0f, bool shaped = false) -> std::shared_ptr<mtd::FakeRenderable>
+    {
+        auto const result = std::make_shared<mtd::FakeRenderable>(rect, alpha, !shaped);
+        result->set_buffer(buffer);
+        return result;
+    }
+
+    StubRenderTarget target{{8, 8}};
+    mrs::Renderer renderer{target};
+
+    SoftwareRenderer()
+    {
+        renderer.set_viewport({{0, 0}, {8, 8}});
+    }
+};
+}
+
+TEST_F(SoftwareRenderer, clears_to_opaque_black_and_swaps_once_per_frame)
+{
+    std::fill(target.buffer->written_pixels.begin(), target.buffer->written_pixels.end(), 0x55);
+
+    renderer.render({});
+
+    for (int y = 0; y != 8; ++y)
+        for (int x = 0; x != 8; ++x)
+            ASSERT_THAT(target.pixel(x, y), Eq(black)) << x << "," << y;
+    EXPECT_THAT(target.swaps, Eq(1));
+}
+
+TEST_F(SoftwareRenderer, copies_opaque_renderable_to_its_position)
+{
+    renderer.render({renderable({{2, 3}, {4, 2}}, filled_buffer({4, 2}, red))});
+
+    for (int y = 0; y != 8; ++y)
+    {
+        for (int x = 0; x != 8; ++x)
+        {
+            auto const inside = x >= 2 && x < 6 && y >= 3 && y < 5;
+            ASSERT_THAT(target.pixel(x, y), Eq(inside ? red : black)) << x << "," << y;
+        }
+    }
+}
+
+TEST_F(SoftwareRenderer, treats_alpha_of_unshaped_renderables_as_opaque)
+{
+    renderer.render({renderable({{0, 0}, {2, 2}}, filled_buffer({2, 2}, 0x00FF0000))});
+
+    EXPECT_THAT(target.pixel(0, 0), Eq(red));
+}
+
+TEST_F(SoftwareRenderer, blends_shaped_renderables_over_those_beneath)
+{
+    // Half-transparent premultiplied green
+    auto const translucent = filled_buffer({4, 4}, 0x80008000);
+
+    renderer.render({
+        renderable({{0, 0}, {4, 4}}, filled_buffer({4, 4}, red)),
+        renderable({{2, 0}, {4, 4}}, translucent, 1.0f, true)});
+
+    EXPECT_THAT(target.pixel(0, 0), Eq(red));
+    EXPECT_THAT(target.pixel(2, 0), Eq(0xFF7F8000u));
+    EXPECT_THAT(target.pixel(5, 0), Eq(0xFF008000u));
+}
+
+TEST_F(SoftwareRenderer, applies_renderable_alpha)
+{
+    renderer.render({
+        renderable({{0, 0}, {4, 4}}, filled_buffer({4, 4}, blue)),
+        renderable({{0, 0}, {4, 4}}, filled_buffer({4, 4}, red), 0.5f)});
+
+    EXPECT_THAT(target.pixel(1, 1), Eq(0xFF80007Fu));
+}
+
+TEST_F(SoftwareRenderer, skips_fully_transparent_renderables)
+{
+    renderer.render({renderable({{0, 0}, {4, 4}}, filled_buffer({4, 4}, red), 0.0f)});
+
+    EXPECT_THAT(target.pixel(1, 1), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, converts_abgr_buffers)
+{
+    auto const buffer = make_buffer({1, 1}, mir_pixel_format_abgr_8888);
+    set_pixel(*buffer, 0, 0, 0xFF0000FF);
+
+    renderer.render({renderable({{0, 0}, {1, 1}}, buffer)});
+
+    EXPECT_THAT(target.pixel(0, 0), Eq(red));
+}
+
+TEST_F(SoftwareRenderer, draws_only_within_clip_area)
+{
+    auto const clipped = std::make_shared<ClippedRenderable>(geom::Rectangle{{0, 0}, {8, 8}}, geom::Rectangle{{1, 1}, {2, 3}});
+    clipped->set_buffer(filled_buffer({8, 8}, green));
+
+    renderer.render({clipped});
+
+    for (int y = 0; y != 8; ++y)
+    {
+        for (int x = 0; x != 8; ++x)
+        {
+            auto const inside = x >= 1 && x < 3 && y >= 1 && y < 4;
+            ASSERT_THAT(target.pixel(x, y), Eq(inside ? green : black)) << x << "," << y;
+        }
+    }
+}
+
+TEST_F(SoftwareRenderer, scales_buffers_up_by_whole_numbers_without_blurring)
+{
+    auto const buffer = make_buffer({2, 2});
+    set_pixel(*buffer, 0, 0, red);
+    set_pixel(*buffer, 1, 0, green);
+    set_pixel(*buffer, 0, 1, blue);
+    set_pixel(*buffer, 1, 1, black);
+
+    renderer.render({renderable({{0, 0}, {4, 4}}, buffer)});
+
+    EXPECT_THAT(target.pixel(0, 0), Eq(red));
+    EXPECT_THAT(target.pixel(1, 1), Eq(red));
+    EXPECT_THAT(target.pixel(2, 0), Eq(green));
+    EXPECT_THAT(target.pixel(3, 1), Eq(green));
+    EXPECT_THAT(target.pixel(0, 2), Eq(blue));
+    EXPECT_THAT(target.pixel(1, 3), Eq(blue));
+    EXPECT_THAT(target.pixel(3, 3), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, scales_viewport_to_fit_output)
+{
+    renderer.set_viewport({{100, 100}, {4, 4}});
+
+    renderer.render({renderable({{100, 100}, {2, 2}}, filled_buffer({2, 2}, red))});
+
+    EXPECT_THAT(target.pixel(0, 0), Eq(red));
+    EXPECT_THAT(target.pixel(3, 3), Eq(red));
+    EXPECT_THAT(target.pixel(4, 4), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, letterboxes_viewport_of_a_different_aspect)
+{
+    renderer.set_viewport({{0, 0}, {8, 4}});
+
+    renderer.render({renderable({{0, 0}, {8, 4}}, filled_buffer({8, 4}, red))});
+
+    EXPECT_THAT(target.pixel(0, 1), Eq(black));
+    EXPECT_THAT(target.pixel(0, 2), Eq(red));
+    EXPECT_THAT(target.pixel(7, 5), Eq(red));
+    EXPECT_THAT(target.pixel(7, 6), Eq(black));
+}
+
+TEST(SoftwareRendererOutputTransform, rotates_frame_as_the_gl_renderer_does)
+{
+    StubRenderTarget target{{2, 4}};
+    mrs::Renderer renderer{target};
+    renderer.set_viewport({{0, 0}, {4, 2}});
+    renderer.set_output_transform(mg::transformation(mir_orientation_left));
+
+    auto const buffer = make_buffer({4, 2});
+    for (int y = 0; y != 2; ++y)
+        for (int x = 0; x != 4; ++x)
+            set_pixel(*buffer, x, y, 0xFF000000 | (x << 8) | y);
+    auto const window = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {4, 2}});
+    window->set_buffer(buffer);
+
+    renderer.render({window});
+
+    // The right of the viewport is at the top of the output, and its top to the left
+    EXPECT_THAT(target.pixel(0, 0), Eq(0xFF000300u));
+    EXPECT_THAT(target.pixel(1, 0), Eq(0xFF000301u));
+    EXPECT_THAT(target.pixel(0, 3), Eq(0xFF000000u));
+    EXPECT_THAT(target.pixel(1, 3), Eq(0xFF000001u));
+}
+
+TEST_F(SoftwareRenderer, repaints_only_damage_into_buffers_of_known_age)
+{
+    auto const window = renderable({{0, 0}, {8, 8}}, filled_buffer({8, 8}, red));
+    renderer.render({window});
+
+    // A single-buffered target, reused as is
+    target.age = 1;
+    set_pixel(*target.buffer, 7, 7, blue);
+    renderer.set_damage(geom::Rectangles{{{0, 0}, {2, 2}}});
+    renderer.render({renderable({{0, 0}, {8, 8}}, filled_buffer({8, 8}, green))});
+
+    EXPECT_THAT(target.pixel(0, 0), Eq(green));
+    EXPECT_THAT(target.pixel(1, 1), Eq(green));
+    EXPECT_THAT(target.pixel(2, 2), Eq(red));
+    EXPECT_THAT(target.pixel(7, 7), Eq(blue));
+}
+
+TEST_F(SoftwareRenderer, repaints_everything_into_buffers_of_unknown_age)
+{
+    renderer.render({renderable({{0, 0}, {8, 8}}, filled_buffer({8, 8}, red))});
+
+    target.age = 0;
+    renderer.set_damage(geom::Rectangles{{{0, 0}, {2, 2}}});
+    renderer.render({renderable({{0, 0}, {8, 8}}, filled_buffer({8, 8}, green))});
+
+    EXPECT_THAT(target.pixel(7, 7), Eq(green));
+}
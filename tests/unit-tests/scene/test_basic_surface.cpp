@@ -74,6 +74,7 @@ public:
     MOCK_METHOD2(cursor_image_set_to, void(ms::Surface const*, std::weak_ptr<mir::graphics::CursorImage> const& image));
     MOCK_METHOD1(cursor_image_removed, void(ms::Surface const*));
     MOCK_METHOD2(application_id_set_to, void(ms::Surface const*, std::string const&));
+    MOCK_METHOD2(input_region_set_to, void(ms::Surface const*, std::vector<geom::Rectangle> const&));
 };
 
 struct BasicSurfaceTest : public testing::Test
@@ -438,6 +439,27 @@ TEST_F(BasicSurfaceTest, test_surface_is_opaque_by_default)
     EXPECT_FALSE(renderables[0]->shaped());
 }
 
+TEST_F(BasicSurfaceTest, opaque_region_is_unknown_by_default)
+{
+    auto renderables = surface.generate_renderables(compositor_id);
+    ASSERT_THAT(renderables.size(), testing::Eq(1));
+    EXPECT_THAT(renderables[0]->opaque_region(), testing::Eq(std::nullopt));
+}
+
+TEST_F(BasicSurfaceTest, opaque_region_is_in_screen_coordinates)
+{
+    using namespace testing;
+    geom::Displacement const stream_offset{7, 10};
+
+    surface.set_streams({ms::StreamInfo{mock_buffer_stream, stream_offset, {}, {{{{1, 2}, {3, 4}}}}}});
+
+    auto renderables = surface.generate_renderables(compositor_id);
+    ASSERT_THAT(renderables.size(), Eq(1));
+    EXPECT_THAT(
+        renderables[0]->opaque_region(),
+        Optional(geom::Rectangles{{rect.top_left + stream_offset + geom::Displacement{1, 2}, {3, 4}}}));
+}
+
 TEST_F(BasicSurfaceTest, test_surface_visibility)
 {
     using namespace testing;
@@ -601,6 +623,32 @@ TEST_F(BasicSurfaceTest, set_input_region)
     }
 }
 
+TEST_F(BasicSurfaceTest, observer_notified_of_input_region_change)
+{
+    using namespace testing;
+
+    std::vector<geom::Rectangle> const rectangles{{{0, 0}, {1, 1}}};
+
+    EXPECT_CALL(*mock_surface_observer, input_region_set_to(_, rectangles))
+        .Times(1);
+
+    surface.register_interest(mock_surface_observer, executor);
+    surface.set_input_region(rectangles);
+    surface.set_input_region(rectangles);
+}
+
+TEST_F(BasicSurfaceTest, input_area_bounds_cover_input_region_beyond_content)
+{
+    surface.set_input_region({{{0, 0}, {1, 1}}, {{20, 30}, {5, 5}}});
+
+    EXPECT_THAT(surface.input_area_bounds(), testing::Eq(geom::Rectangle{rect.top_left, {25, 35}}));
+}
+
+TEST_F(BasicSurfaceTest, default_input_area_bounds_are_the_content_area)
+{
+    EXPECT_THAT(surface.input_area_bounds(), testing::Eq(rect));
+}
+
 TEST_F(BasicSurfaceTest, updates_default_input_region_when_surface_is_resized_to_larger_size)
 {
     geom::Rectangle const new_rect{rect.top_left,{20,20}};
@@ -0,0 +1,212 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/input_region_index.h"
+#include "mir/test/doubles/stub_surface.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+/// A surface accepting input within area, and reporting bounds as its input area bounds
+struct RectangularSurface : mtd::StubSurface
+{
+    explicit RectangularSurface(geom::Rectangle const& area)
+        : area{area},
+          bounds{area}
+    {
+    }
+
+    auto input_area_bounds() const -> std::optional<geom::Rectangle> override
+    {
+        return bounds;
+    }
+
+    bool input_area_contains(geom::Point const& point) const override
+    {
+        return area.contains(point);
+    }
+
+    void set_area(geom::Rectangle const& new_area)
+    {
+        area = new_area;
+        bounds = new_area;
+    }
+
+    geom::Rectangle area;
+    std::optional<geom::Rectangle> bounds;
+};
+
+struct InputRegionIndex : Test
+{
+    auto make_surface(geom::Rectangle const& area) -> std::shared_ptr<RectangularSurface>
+    {
+        return std::make_shared<RectangularSurface>(area);
+    }
+
+    ms::InputRegionIndex index{64};
+};
+}
+
+TEST_F(InputRegionIndex, empty_index_finds_nothing)
+{
+    EXPECT_THAT(index.surface_at({10, 10}), IsNull());
+}
+
+TEST_F(InputRegionIndex, finds_topmost_surface_containing_point)
+{
+    auto const bottom = make_surface({{0, 0}, {100, 100}});
+    auto const middle = make_surface({{50, 50}, {100, 100}});
+    auto const top = make_surface({{200, 200}, {100, 100}});
+
+    index.restack({bottom, middle, top});
+
+    EXPECT_THAT(index.surface_at({10, 10}), Eq(bottom));
+    EXPECT_THAT(index.surface_at({75, 75}), Eq(middle));
+    EXPECT_THAT(index.surface_at({250, 250}), Eq(top));
+    EXPECT_THAT(index.surface_at({175, 25}), IsNull());
+}
+
+TEST_F(InputRegionIndex, restack_changes_which_surface_is_hit)
+{
+    auto const a = make_surface({{0, 0}, {100, 100}});
+    auto const b = make_surface({{0, 0}, {100, 100}});
+
+    index.restack({a, b});
+    EXPECT_THAT(index.surface_at({10, 10}), Eq(b));
+
+    index.restack({b, a});
+    EXPECT_THAT(index.surface_at({10, 10}), Eq(a));
+
+    index.restack({b});
+    EXPECT_THAT(index.surface_at({10, 10}), Eq(b));
+}
+
+TEST_F(InputRegionIndex, surface_is_found_at_new_position_after_update)
+{
+    auto const surface = make_surface({{0, 0}, {100, 100}});
+    index.restack({surface});
+
+    surface->set_area({{500, 500}, {100, 100}});
+    index.update(surface.get());
+
+    EXPECT_THAT(index.surface_at({10, 10}), IsNull());
+    EXPECT_THAT(index.surface_at({550, 550}), Eq(surface));
+}
+
+TEST_F(InputRegionIndex, surfaces_spanning_many_cells_and_negative_coordinates_are_found)
+{
+    auto const surface = make_surface({{-300, -300}, {600, 600}});
+    index.restack({surface});
+
+    EXPECT_THAT(index.surface_at({-300, -300}), Eq(surface));
+    EXPECT_THAT(index.surface_at({-1, -1}), Eq(surface));
+    EXPECT_THAT(index.surface_at({0, 0}), Eq(surface));
+    EXPECT_THAT(index.surface_at({299, 299}), Eq(surface));
+    EXPECT_THAT(index.surface_at({300, 300}), IsNull());
+    EXPECT_THAT(index.surface_at({-301, 0}), IsNull());
+}
+
+TEST_F(InputRegionIndex, unbounded_surfaces_are_interleaved_in_stacking_order)
+{
+    auto const bottom = make_surface({{0, 0}, {100, 100}});
+    auto const unbounded = make_surface({{0, 0}, {100, 100}});
+    unbounded->bounds = std::nullopt;
+    auto const top = make_surface({{50, 50}, {100, 100}});
+
+    index.restack({bottom, unbounded, top});
+
+    EXPECT_THAT(index.surface_at({10, 10}), Eq(unbounded));
+    EXPECT_THAT(index.surface_at({75, 75}), Eq(top));
+}
+
+TEST_F(InputRegionIndex, surface_whose_bounds_contain_point_but_input_area_does_not_is_skipped)
+{
+    auto const bottom = make_surface({{0, 0}, {100, 100}});
+    auto const top = make_surface({{0, 0}, {100, 100}});
+    top->area = {{0, 0}, {10, 10}};
+
+    index.restack({bottom, top});
+
+    EXPECT_THAT(index.surface_at({5, 5}), Eq(top));
+    EXPECT_THAT(index.surface_at({50, 50}), Eq(bottom));
+}
+
+TEST_F(InputRegionIndex, surface_stacked_twice_is_hit_at_its_topmost_position)
+{
+    auto const twice = make_surface({{0, 0}, {100, 100}});
+    auto const once = make_surface({{0, 0}, {100, 100}});
+
+    index.restack({twice, once, twice});
+
+    EXPECT_THAT(index.surface_at({10, 10}), Eq(twice));
+}
+
+TEST_F(InputRegionIndex, update_of_unindexed_surface_is_ignored)
+{
+    auto const surface = make_surface({{0, 0}, {100, 100}});
+
+    index.update(surface.get());
+
+    EXPECT_THAT(index.surface_at({10, 10}), IsNull());
+}
+
+TEST_F(InputRegionIndex, is_stale_once_a_surface_moves)
+{
+    auto const surface = make_surface({{0, 0}, {100, 100}});
+    index.restack({surface});
+    EXPECT_FALSE(index.is_stale(surface.get()));
+
+    surface->set_area({{500, 500}, {100, 100}});
+    EXPECT_TRUE(index.is_stale(surface.get()));
+
+    index.update(surface.get());
+    EXPECT_FALSE(index.is_stale(surface.get()));
+}
+
+TEST_F(InputRegionIndex, copy_changes_independently)
+{
+    auto const bottom = make_surface({{0, 0}, {100, 100}});
+    auto const top = make_surface({{0, 0}, {100, 100}});
+    index.restack({bottom, top});
+
+    ms::InputRegionIndex copy{index};
+    top->set_area({{500, 500}, {100, 100}});
+    copy.update(top.get());
+
+    EXPECT_THAT(copy.surface_at({10, 10}), Eq(bottom));
+    EXPECT_THAT(copy.surface_at({550, 550}), Eq(top));
+    EXPECT_THAT(index.surface_at({550, 550}), IsNull());
+}
+
+TEST_F(InputRegionIndex, copy_restacks_independently)
+{
+    auto const bottom = make_surface({{0, 0}, {100, 100}});
+    auto const top = make_surface({{0, 0}, {100, 100}});
+    index.restack({bottom, top});
+
+    ms::InputRegionIndex copy{index};
+    copy.restack({top, bottom});
+
+    EXPECT_THAT(copy.surface_at({10, 10}), Eq(bottom));
+    EXPECT_THAT(index.surface_at({10, 10}), Eq(top));
+}
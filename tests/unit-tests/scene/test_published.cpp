@@ -0,0 +1,95 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/published.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ms = mir::scene;
+using namespace testing;
+
+TEST(Published, gets_initial_value)
+{
+    ms::Published<int> published{std::make_shared<int const>(1)};
+
+    EXPECT_THAT(*published.get(), Eq(1));
+}
+
+TEST(Published, gets_latest_value)
+{
+    ms::Published<int> published{std::make_shared<int const>(1)};
+
+    published.publish(std::make_shared<int const>(2));
+    published.publish(std::make_shared<int const>(3));
+
+    EXPECT_THAT(*published.get(), Eq(3));
+}
+
+TEST(Published, releases_replaced_value_when_nothing_is_reading)
+{
+    auto const first = std::make_shared<int const>(1);
+    ms::Published<int> published{first};
+
+    published.publish(std::make_shared<int const>(2));
+
+    EXPECT_THAT(first.use_count(), Eq(1));
+}
+
+TEST(Published, value_got_outlives_its_replacement)
+{
+    ms::Published<int> published{std::make_shared<int const>(1)};
+
+    auto const got = published.get();
+    published.publish(std::make_shared<int const>(2));
+
+    EXPECT_THAT(*got, Eq(1));
+}
+
+TEST(Published, readers_see_published_values_while_writer_publishes)
+{
+    ms::Published<int> published{std::make_shared<int const>(0)};
+    int const last = 10000;
+
+    std::atomic<bool> mismatched{false};
+    std::vector<std::thread> readers;
+    for (auto i = 0; i != 4; ++i)
+    {
+        readers.emplace_back([&]
+            {
+                int previous = 0;
+                while (previous != last)
+                {
+                    auto const value = *published.get();
+                    if (value < previous)
+                        mismatched = true;
+                    previous = value;
+                }
+            });
+    }
+
+    for (auto i = 1; i <= last; ++i)
+        published.publish(std::make_shared<int const>(i));
+
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_FALSE(mismatched);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/recycling_pool.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <array>
+
+namespace ms = mir::scene;
+using namespace testing;
+
+namespace
+{
+struct Payload
+{
+    explicit Payload(int value) : value{value} {}
+    int value;
+    std::array<char, 64> padding{};
+};
+
+struct RecyclingPool : Test
+{
+    std::shared_ptr<ms::RecyclingPool> const pool{std::make_shared<ms::RecyclingPool>()};
+
+    auto make(int value) -> std::shared_ptr<Payload>
+    {
+        return std::allocate_shared<Payload>(ms::RecyclingAllocator<Payload>{pool}, value);
+    }
+};
+}
+
+TEST_F(RecyclingPool, released_block_is_reused)
+{
+    auto first = make(1);
+    auto const address = first.get();
+    first.reset();
+
+    auto const second = make(2);
+
+    EXPECT_THAT(second.get(), Eq(address));
+    EXPECT_THAT(second->value, Eq(2));
+    EXPECT_THAT(pool->blocks_allocated(), Eq(1u));
+}
+
+TEST_F(RecyclingPool, blocks_in_use_are_not_reused)
+{
+    auto const first = make(1);
+    auto const second = make(2);
+
+    EXPECT_THAT(second.get(), Ne(first.get()));
+    EXPECT_THAT(first->value, Eq(1));
+    EXPECT_THAT(second->value, Eq(2));
+    EXPECT_THAT(pool->blocks_allocated(), Eq(2u));
+}
+
+TEST_F(RecyclingPool, steady_state_allocates_no_new_blocks)
+{
+    for (auto frame = 0; frame != 10; ++frame)
+    {
+        std::vector<std::shared_ptr<Payload>> const objects{make(1), make(2), make(3)};
+    }
+
+    EXPECT_THAT(pool->blocks_allocated(), Eq(3u));
+}
+
+TEST_F(RecyclingPool, larger_allocations_bypass_the_pool)
+{
+    auto const small = make(1);
+    auto const large = pool->allocate(4096);
+
+    EXPECT_THAT(large, NotNull());
+    EXPECT_THAT(pool->blocks_allocated(), Eq(1u));
+
+    pool->deallocate(large, 4096);
+}
+
+TEST_F(RecyclingPool, objects_keep_their_pool_alive)
+{
+    std::weak_ptr<ms::RecyclingPool> weak_pool;
+    std::shared_ptr<Payload> object;
+    {
+        auto const local_pool = std::make_shared<ms::RecyclingPool>();
+        weak_pool = local_pool;
+        object = std::allocate_shared<Payload>(ms::RecyclingAllocator<Payload>{local_pool}, 42);
+    }
+
+    EXPECT_THAT(weak_pool.expired(), Eq(false));
+    EXPECT_THAT(object->value, Eq(42));
+
+    object.reset();
+
+    EXPECT_THAT(weak_pool.expired(), Eq(true));
+}
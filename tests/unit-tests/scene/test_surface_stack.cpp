@@ -35,6 +35,7 @@
 #include <stdexcept>
 #include <atomic>
 #include <future>
+#include <set>
 
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
@@ -985,6 +986,7 @@ TEST_F(SurfaceStack, surface_at_returns_top_surface_under_cursor)
     stub_surface1->resize({900, 900});
     stub_surface2->resize({500, 200});
     stub_surface3->resize({200, 500});
+    executor.execute();
 
     EXPECT_THAT(stack.surface_at(cursor_over_all),  Eq(stub_surface3));
     EXPECT_THAT(stack.surface_at(cursor_over_12),   Eq(stub_surface2));
@@ -1006,6 +1008,7 @@ TEST_F(SurfaceStack, input_surface_at_returns_top_surface_under_cursor)
     stub_surface1->resize({900, 900});
     stub_surface2->resize({500, 200});
     stub_surface3->resize({200, 500});
+    executor.execute();
 
     EXPECT_THAT(stack.surface_at(cursor_over_all),  Eq(stub_surface3));
     EXPECT_THAT(stack.surface_at(cursor_over_12),   Eq(stub_surface2));
@@ -1029,6 +1032,7 @@ TEST_F(SurfaceStack, surface_at_returns_top_visible_surface_under_cursor)
     stub_surface2->resize({500, 200});
     stub_surface3->resize({200, 500});
     invisible_stub_surface->resize({999, 999});
+    executor.execute();
 
     EXPECT_THAT(stack.surface_at(cursor_over_all),  Eq(stub_surface3));
     EXPECT_THAT(stack.surface_at(cursor_over_12),   Eq(stub_surface2));
@@ -1052,6 +1056,7 @@ TEST_F(SurfaceStack, input_surface_at_returns_top_visible_surface_under_cursor)
     stub_surface2->resize({500, 200});
     stub_surface3->resize({200, 500});
     invisible_stub_surface->resize({999, 999});
+    executor.execute();
 
     EXPECT_THAT(stack.surface_at(cursor_over_all),  Eq(stub_surface3));
     EXPECT_THAT(stack.surface_at(cursor_over_12),   Eq(stub_surface2));
@@ -1059,6 +1064,47 @@ TEST_F(SurfaceStack, input_surface_at_returns_top_visible_surface_under_cursor)
     EXPECT_THAT(stack.surface_at(cursor_over_none).get(), IsNull());
 }
 
+TEST_F(SurfaceStack, surface_at_follows_moved_surface)
+{
+    stack.add_surface(stub_surface1, mi::InputReceptionMode::normal);
+    stub_surface1->resize({100, 100});
+    executor.execute();
+
+    stub_surface1->move_to({500, 500});
+    executor.execute();
+
+    EXPECT_THAT(stack.surface_at({50, 50}).get(), IsNull());
+    EXPECT_THAT(stack.surface_at({550, 550}), Eq(stub_surface1));
+}
+
+TEST_F(SurfaceStack, surface_at_follows_input_region)
+{
+    stack.add_surface(stub_surface1, mi::InputReceptionMode::normal);
+    stack.add_surface(stub_surface2, mi::InputReceptionMode::normal);
+    stub_surface1->resize({100, 100});
+    stub_surface2->resize({100, 100});
+    executor.execute();
+
+    stub_surface2->set_input_region({{{0, 0}, {10, 10}}});
+    executor.execute();
+
+    EXPECT_THAT(stack.surface_at({5, 5}), Eq(stub_surface2));
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+}
+
+TEST_F(SurfaceStack, surface_at_follows_raised_surface)
+{
+    stack.add_surface(stub_surface1, mi::InputReceptionMode::normal);
+    stack.add_surface(stub_surface2, mi::InputReceptionMode::normal);
+    stub_surface1->resize({100, 100});
+    stub_surface2->resize({100, 100});
+    executor.execute();
+
+    stack.raise(stub_surface1.get());
+
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+}
+
 TEST_F(SurfaceStack, raise_surfaces_to_top)
 {
     stack.add_surface(stub_surface1, mi::InputReceptionMode::normal);
@@ -1307,3 +1353,67 @@ TEST_F(SurfaceStack, all_depth_layers_are_handled)
     }
 
 }
+
+TEST_F(SurfaceStack, collecting_scene_elements_replaces_existing_contents)
+{
+    using namespace testing;
+
+    stack.add_surface(stub_surface1, mi::InputReceptionMode::normal);
+    stack.add_surface(stub_surface2, mi::InputReceptionMode::normal);
+
+    auto elements = stack.scene_elements_for(compositor_id);
+    stack.collect_scene_elements_for(compositor_id, elements);
+
+    EXPECT_THAT(
+        elements,
+        ElementsAre(
+            SceneElementForStream(stub_buffer_stream1),
+            SceneElementForStream(stub_buffer_stream2)));
+}
+
+TEST_F(SurfaceStack, registered_compositor_reuses_scene_elements_released_by_previous_frame)
+{
+    using namespace testing;
+
+    stack.register_compositor(compositor_id);
+    stack.add_surface(stub_surface1, mi::InputReceptionMode::normal);
+    stack.add_surface(stub_surface2, mi::InputReceptionMode::normal);
+
+    mc::SceneElementSequence elements;
+    stack.collect_scene_elements_for(compositor_id, elements);
+    ASSERT_THAT(elements.size(), Eq(2u));
+    std::set<mc::SceneElement const*> const first_frame{elements[0].get(), elements[1].get()};
+    elements.clear();
+
+    stack.collect_scene_elements_for(compositor_id, elements);
+
+    ASSERT_THAT(elements.size(), Eq(2u));
+    EXPECT_THAT(first_frame, Contains(elements[0].get()));
+    EXPECT_THAT(first_frame, Contains(elements[1].get()));
+    EXPECT_THAT(
+        elements,
+        ElementsAre(
+            SceneElementForStream(stub_buffer_stream1),
+            SceneElementForStream(stub_buffer_stream2)));
+
+    stack.unregister_compositor(compositor_id);
+}
+
+TEST_F(SurfaceStack, scene_elements_still_in_use_are_not_reused)
+{
+    using namespace testing;
+
+    stack.register_compositor(compositor_id);
+    stack.add_surface(stub_surface1, mi::InputReceptionMode::normal);
+
+    auto const held = stack.scene_elements_for(compositor_id);
+    ASSERT_THAT(held.size(), Eq(1u));
+
+    auto const next = stack.scene_elements_for(compositor_id);
+
+    ASSERT_THAT(next.size(), Eq(1u));
+    EXPECT_THAT(next[0].get(), Ne(held[0].get()));
+    EXPECT_THAT(held[0], SceneElementForStream(stub_buffer_stream1));
+
+    stack.unregister_compositor(compositor_id);
+}
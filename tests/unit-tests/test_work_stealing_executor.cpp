@@ -0,0 +1,273 @@
+/*
+ * Copyright © Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <boost/throw_exception.hpp>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "mir/executor.h"
+#include "mir/test/signal.h"
+#include "mir/test/current_thread_name.h"
+
+using namespace std::literals::chrono_literals;
+using namespace testing;
+
+namespace mt = mir::test;
+
+TEST(WorkStealingExecutor, executes_work_of_either_priority)
+{
+    auto const latency_critical_done = std::make_shared<mt::Signal>();
+    auto const background_done = std::make_shared<mt::Signal>();
+
+    mir::latency_critical_executor.spawn([latency_critical_done]() { latency_critical_done->raise(); });
+    mir::background_executor.spawn([background_done]() { background_done->raise(); });
+
+    EXPECT_TRUE(latency_critical_done->wait_for(60s));
+    EXPECT_TRUE(background_done->wait_for(60s));
+}
+
+TEST(WorkStealingExecutor, does_not_execute_work_on_the_spawning_thread)
+{
+    auto const spawning_thread = std::this_thread::get_id();
+    std::promise<std::thread::id> executing_thread;
+
+    mir::background_executor.spawn([&]() { executing_thread.set_value(std::this_thread::get_id()); });
+
+    auto result = executing_thread.get_future();
+    ASSERT_THAT(result.wait_for(60s), Eq(std::future_status::ready));
+    EXPECT_THAT(result.get(), Ne(spawning_thread));
+}
+
+TEST(WorkStealingExecutor, can_execute_work_from_within_work_item)
+{
+    auto const done = std::make_shared<mt::Signal>();
+
+    mir::background_executor.spawn(
+        [done]()
+        {
+            mir::latency_critical_executor.spawn(
+                [done]()
+                {
+                    mir::background_executor.spawn([done]() { done->raise(); });
+                });
+        });
+
+    EXPECT_TRUE(done->wait_for(60s));
+}
+
+TEST(WorkStealingExecutor, work_spawned_from_a_blocked_work_item_is_stolen)
+{
+    auto const done = std::make_shared<mt::Signal>();
+    auto const waited_for_done = std::make_shared<mt::Signal>();
+
+    mir::background_executor.spawn(
+        [done, waited_for_done]()
+        {
+            // This lands on our own worker's queue; only another worker can run it
+            mir::background_executor.spawn([done]() { done->raise(); });
+            if (!waited_for_done->wait_for(60s))
+            {
+                FAIL() << "Spawned work failed to execute";
+            }
+        });
+
+    EXPECT_TRUE(done->wait_for(60s));
+    waited_for_done->raise();
+}
+
+TEST(WorkStealingExecutor, executes_all_work_spawned_from_many_threads)
+{
+    int const threads = 8;
+    int const work_per_thread = 10000;
+    int const total_work = threads * work_per_thread;
+    std::atomic<int> executed{0};
+    auto const done = std::make_shared<mt::Signal>();
+
+    std::vector<std::thread> spawners;
+    for (auto i = 0; i != threads; ++i)
+    {
+        spawners.emplace_back(
+            [&, i]()
+            {
+                auto& executor = i % 2 ? mir::background_executor : mir::latency_critical_executor;
+                for (auto j = 0; j != work_per_thread; ++j)
+                {
+                    executor.spawn(
+                        [&executed, done, total_work]()
+                        {
+                            if (++executed == total_work)
+                            {
+                                done->raise();
+                            }
+                        });
+                }
+            });
+    }
+    for (auto& spawner : spawners)
+    {
+        spawner.join();
+    }
+
+    EXPECT_TRUE(done->wait_for(60s));
+    EXPECT_THAT(executed.load(), Eq(total_work));
+}
+
+TEST(WorkStealingExecutor, latency_critical_work_does_not_wait_behind_background_work)
+{
+    int const background_work = 200;
+    std::atomic<int> background_done{0};
+    std::promise<int> background_done_before_latency_critical_work;
+
+    for (auto i = 0; i != background_work; ++i)
+    {
+        mir::background_executor.spawn(
+            [&background_done]()
+            {
+                std::this_thread::sleep_for(2ms);
+                ++background_done;
+            });
+    }
+    mir::latency_critical_executor.spawn(
+        [&]()
+        {
+            background_done_before_latency_critical_work.set_value(background_done);
+        });
+
+    auto result = background_done_before_latency_critical_work.get_future();
+    ASSERT_THAT(result.wait_for(60s), Eq(std::future_status::ready));
+    EXPECT_THAT(result.get(), Lt(background_work));
+
+    mir::WorkStealingExecutor::quiesce();
+}
+
+TEST(WorkStealingExecutorDeathTest, unhandled_exception_in_work_item_causes_termination_by_default)
+{
+    EXPECT_DEATH(
+        {
+            mir::background_executor.spawn(
+                []()
+                {
+                    BOOST_THROW_EXCEPTION((std::runtime_error{"Oops, unhandled exception"}));
+                });
+            std::this_thread::sleep_for(std::chrono::seconds{60});
+        },
+        ""
+    );
+}
+
+TEST(WorkStealingExecutor, can_set_unhandled_exception_handler)
+{
+    static std::promise<std::exception_ptr> exception_pipe;
+
+    auto exception = exception_pipe.get_future();
+
+    mir::WorkStealingExecutor::set_unhandled_exception_handler(
+        []()
+        {
+            exception_pipe.set_value(std::current_exception());
+        });
+
+    mir::latency_critical_executor.spawn([]() { throw std::runtime_error{"Boop!"}; });
+
+    EXPECT_THAT(exception.wait_for(std::chrono::seconds{60}), Eq(std::future_status::ready));
+
+    try
+    {
+        std::rethrow_exception(exception.get());
+    }
+    catch (std::runtime_error const& err)
+    {
+        EXPECT_THAT(err.what(), StrEq("Boop!"));
+    }
+}
+
+#ifndef MIR_DONT_USE_PTHREAD_GETNAME_NP
+TEST(WorkStealingExecutor, executor_threads_have_sensible_name)
+#else
+TEST(WorkStealingExecutor, DISABLED_executor_threads_have_sensible_names)
+#endif
+{
+    auto thread_name_provider = std::make_shared<std::promise<std::string>>();
+    auto thread_name = thread_name_provider->get_future();
+
+    mir::background_executor.spawn(
+        [thread_name_provider]()
+        {
+            thread_name_provider->set_value(mt::current_thread_name());
+        });
+
+    ASSERT_THAT(thread_name.wait_for(std::chrono::seconds{60}), Eq(std::future_status::ready));
+    EXPECT_THAT(thread_name.get(), MatchesRegex("Mir/Worker.*"));
+}
+
+TEST(WorkStealingExecutor, new_work_can_be_submitted_after_quiesce)
+{
+    auto done = std::make_shared<mt::Signal>();
+    constexpr int const work_count{10};
+    std::atomic<int> work_index{0};
+
+    for (auto i = 0; i < work_count; ++i)
+    {
+        mir::background_executor.spawn(
+            [&work_index, done]()
+            {
+                if (++work_index == work_count)
+                {
+                    done->raise();
+                }
+            });
+    }
+
+    ASSERT_TRUE(done->wait_for(60s));
+    mir::WorkStealingExecutor::quiesce();
+    done->reset();
+
+    work_index = 0;
+    for (auto i = 0; i < work_count; ++i)
+    {
+        mir::background_executor.spawn(
+            [&work_index, done]()
+            {
+                if (++work_index == work_count)
+                {
+                    done->raise();
+                }
+            });
+    }
+    EXPECT_TRUE(done->wait_for(60s));
+}
+
+TEST(WorkStealingExecutor, quiesce_waits_until_work_completes)
+{
+    constexpr auto const delay = 500ms;
+
+    auto const expected_end = std::chrono::steady_clock::now() + delay;
+
+    mir::background_executor.spawn(
+        [delay]()
+        {
+            std::this_thread::sleep_for(delay);
+        });
+
+    mir::WorkStealingExecutor::quiesce();
+    EXPECT_THAT(std::chrono::steady_clock::now(), Gt(expected_end));
+}